@@ -0,0 +1,293 @@
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <new>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../includes/Visitor.h"
+#include "../includes/NodeFactory.h"
+#include "BenchUtils.h"
+
+
+/* Every allocation of the process goes through these operators: they count the calls
+and keep track of the live and peak number of bytes */
+static size_t allocations = 0;
+static size_t liveBytes = 0;
+static size_t peakBytes = 0;
+
+void* operator new(size_t size) {
+    // the size is stored in front of the block for operator delete
+    void* p = std::malloc(size + alignof(std::max_align_t));
+    if (p == nullptr) throw std::bad_alloc();
+    *static_cast<size_t*>(p) = size;
+    allocations++;
+    liveBytes += size;
+    if (liveBytes > peakBytes) peakBytes = liveBytes;
+    return static_cast<char*>(p) + alignof(std::max_align_t);
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+// free() receives the blocks obtained with malloc() by the operator new above
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void operator delete(void* p) noexcept {
+    if (p == nullptr) return;
+    void* block = static_cast<char*>(p) - alignof(std::max_align_t);
+    liveBytes -= *static_cast<size_t*>(block);
+    std::free(block);
+}
+
+void operator delete(void* p, size_t) noexcept { operator delete(p); }
+
+struct AllocStats {
+    size_t allocs;
+    size_t peak_kib;
+};
+
+/* Measure of the allocations made from now on, the peak being relative to the current live bytes */
+class AllocProbe {
+public:
+    AllocProbe() : allocs0{ allocations }, live0{ liveBytes } { peakBytes = liveBytes; }
+    AllocStats get() const { return AllocStats{ allocations - allocs0, (peakBytes - live0) / 1024 }; }
+
+private:
+    size_t allocs0;
+    size_t live0;
+};
+
+
+/* Allocation of one node at a time followed by one delete per node,
+as done by the BlockManager, StatementManager, NumExprManager and BoolExprManager */
+class HeapNodes {
+public:
+    HeapNodes() = default;
+    ~HeapNodes() { clear_memory(); }
+
+    HeapNodes(const HeapNodes& other) = delete;
+    HeapNodes& operator=(const HeapNodes& other) = delete;
+
+    Block* makeBlock(const std::vector<Statement*>& stmts) {
+        Statement** copy = new Statement*[stmts.size()];
+        for (unsigned int i = 0; i < stmts.size(); i++) copy[i] = stmts[i];
+        owned.push_back({ copy, [](void* p) { delete[] static_cast<Statement**>(p); } });
+        return node<Block>(copy, static_cast<unsigned int>(stmts.size()));
+    }
+    Statement* makeSetStmt(NumExpr* nexpr, Variable* var) { return node<SetStmt>(nexpr, var); }
+    Statement* makeInputStmt(Variable* v) { return node<InputStmt>(v); }
+    Statement* makePrintStmt(NumExpr* nexpr) { return node<PrintStmt>(nexpr); }
+    Statement* makeIfStmt(BoolExpr* bexpr, Block* b1, Block* b2) { return node<IfStmt>(bexpr, b1, b2); }
+    Statement* makeWhileStmt(BoolExpr* bexpr, Block* b) { return node<WhileStmt>(bexpr, b); }
+    NumExpr* makeOperator(Operator::OpCode op, NumExpr* l, NumExpr* r) { return node<Operator>(op, l, r); }
+    NumExpr* makeNumber(int64_t v) { return node<Number>(v); }
+    // the VARIABLE_ID is one of the strings of the Program symbol table, which outlives the nodes
+    NumExpr* makeVariable(const std::string& id) { return node<Variable>(std::string_view{ id }); }
+    BoolExpr* makeRelOp(RelOp::RelOpCode rop, NumExpr* f, NumExpr* s) { return node<RelOp>(rop, f, s); }
+    BoolExpr* makeBoolConst(BoolConst::BoolCode bcode) { return node<BoolConst>(bcode); }
+    BoolExpr* makeBoolOp(BoolOp::BopCode bcode, BoolExpr* f, BoolExpr* s) { return node<BoolOp>(bcode, f, s); }
+
+    void clear_memory() {
+        for (auto& o : owned) o.second(o.first);
+        owned.clear();
+    }
+
+private:
+    std::vector<std::pair<void*, void (*)(void*)>> owned;
+
+    template <typename T, typename... Args>
+    T* node(Args&&... args) {
+        T* p = new T(std::forward<Args>(args)...);
+        // the nodes have no virtual destructor: the exact type is destroyed before releasing the memory
+        owned.push_back({ p, [](void* q) { static_cast<T*>(q)->~T(); ::operator delete(q); } });
+        return p;
+    }
+};
+
+
+/* Copy of a resolved syntax tree made with the nodes of "Nodes" (HeapNodes or NodeFactory) */
+template <typename Nodes>
+class CloneVisitor : public Visitor {
+public:
+    CloneVisitor(Nodes& n, const std::vector<std::string>& ids) : nodes{ n }, var_ids{ ids } {}
+
+    Block* clone(Program* prg) {
+        prg->get_blk()->accept(this);
+        return blk;
+    }
+
+    void visitProgram(Program*) override {}
+    void visitBlock(Block* b) override {
+        // one buffer per nesting level, so that the copy doesn't allocate for each Block
+        if (scratch.size() <= depth) scratch.emplace_back();
+        depth++;
+        for (Statement* s : b->get_stmts()) {
+            s->accept(this);
+            scratch[depth - 1].push_back(stmt);
+        }
+        depth--;
+        blk = nodes.makeBlock(scratch[depth]);
+        scratch[depth].clear();
+    }
+
+    void visitSet(SetStmt* s) override {
+        s->get_nexpr()->accept(this);
+        NumExpr* val = nexpr;
+        s->get_var()->accept(this);
+        stmt = nodes.makeSetStmt(val, static_cast<Variable*>(nexpr));
+    }
+    void visitInput(InputStmt* s) override {
+        s->get_var()->accept(this);
+        stmt = nodes.makeInputStmt(static_cast<Variable*>(nexpr));
+    }
+    void visitPrint(PrintStmt* s) override {
+        s->get_nexpr()->accept(this);
+        stmt = nodes.makePrintStmt(nexpr);
+    }
+    void visitIf(IfStmt* s) override {
+        s->get_bexpr()->accept(this);
+        BoolExpr* cond = bexpr;
+        s->get_stmt_block1()->accept(this);
+        Block* b1 = blk;
+        s->get_stmt_block2()->accept(this);
+        stmt = nodes.makeIfStmt(cond, b1, blk);
+    }
+    void visitWhile(WhileStmt* s) override {
+        s->get_bexpr()->accept(this);
+        BoolExpr* cond = bexpr;
+        s->get_stmt_block()->accept(this);
+        stmt = nodes.makeWhileStmt(cond, blk);
+    }
+
+    void visitOperator(Operator* opNode) override {
+        opNode->getFirst()->accept(this);
+        NumExpr* first = nexpr;
+        opNode->getSecond()->accept(this);
+        nexpr = nodes.makeOperator(opNode->getOp(), first, nexpr);
+    }
+    void visitNumber(Number* numNode) override { nexpr = nodes.makeNumber(numNode->get_value()); }
+    void visitVariable(Variable* varNode) override {
+        Variable* v = static_cast<Variable*>(nodes.makeVariable(var_ids[varNode->get_slot()]));
+        v->set_slot(varNode->get_slot());
+        nexpr = v;
+    }
+
+    void visitRelOp(RelOp* rop) override {
+        rop->get_first_nexpr()->accept(this);
+        NumExpr* first = nexpr;
+        rop->get_second_nexpr()->accept(this);
+        bexpr = nodes.makeRelOp(rop->get_r_opcode(), first, nexpr);
+    }
+    void visitBoolConst(BoolConst* bconst) override { bexpr = nodes.makeBoolConst(bconst->get_bconst()); }
+    void visitBoolOp(BoolOp* bop) override {
+        bop->get_f_bexpr()->accept(this);
+        BoolExpr* first = bexpr;
+        BoolExpr* second = nullptr;
+        if (bop->get_s_bexpr() != nullptr) {
+            bop->get_s_bexpr()->accept(this);
+            second = bexpr;
+        }
+        bexpr = nodes.makeBoolOp(bop->get_b_opcode(), first, second);
+    }
+
+private:
+    Nodes& nodes;
+    const std::vector<std::string>& var_ids;
+    std::vector<std::vector<Statement*>> scratch;
+    unsigned int depth = 0;
+    Block* blk = nullptr;
+    Statement* stmt = nullptr;
+    NumExpr* nexpr = nullptr;
+    BoolExpr* bexpr = nullptr;
+};
+
+
+/* Program with "nstmts" top level statements mixing SETs, IFs and short WHILE loops (without output) */
+std::string makeProgram(int nstmts) {
+    std::stringstream src;
+    src << "(BLOCK\n  (SET a 1)\n  (SET b 2)\n";
+    for (int i = 0; i < nstmts; i++) {
+        switch (i % 3) {
+            case 0: src << "  (SET a (ADD (DIV a 2) (SUB b " << i % 97 << ")))\n"; break;
+            case 1: src << "  (IF (AND (GT a b) (NOT (EQ a 0))) (SET b (SUB a b)) (SET b (ADD b 1)))\n"; break;
+            default: src << "  (BLOCK (SET k 0) (WHILE (LT k 3) (SET k (ADD k 1))))\n";
+        }
+    }
+    src << ")\n";
+    return src.str();
+}
+
+struct Row {
+    AllocStats stats;
+    double buildMs;
+    double evalMs;
+    double freeMs;
+};
+
+template <typename Nodes>
+Row measure(Nodes& nodes, Program* prg) {
+    Row row;
+    AllocProbe probe;
+    BenchClock::time_point start = BenchClock::now();
+    CloneVisitor<Nodes> copy{ nodes, prg->get_var_ids() };
+    Program cloned{ copy.clone(prg) };
+    row.buildMs = millisSince(start);
+    row.stats = probe.get();
+
+    cloned.set_var_ids(prg->get_var_ids());
+    start = BenchClock::now();
+    EvaluationVisitor eval;
+    cloned.accept(&eval);
+    row.evalMs = millisSince(start);
+
+    start = BenchClock::now();
+    nodes.clear_memory();
+    row.freeMs = millisSince(start);
+    return row;
+}
+
+void printRow(int nstmts, unsigned int nodes, const char* strategy, const Row& r) {
+    std::cout << std::setw(8) << nstmts << std::setw(10) << nodes << std::setw(14) << strategy
+              << std::setw(10) << r.stats.allocs << std::setw(11) << r.stats.peak_kib
+              << std::setw(10) << std::fixed << std::setprecision(2) << r.buildMs
+              << std::setw(10) << r.evalMs << std::setw(10) << r.freeMs << std::endl;
+}
+
+int main() {
+    std::cout << std::setw(8) << "stmts" << std::setw(10) << "nodes" << std::setw(14) << "allocator"
+              << std::setw(10) << "allocs" << std::setw(11) << "peak KiB"
+              << std::setw(10) << "build ms" << std::setw(10) << "eval ms" << std::setw(10) << "free ms" << std::endl;
+
+    for (int nstmts : { 1000, 10000, 100000, 300000 }) {
+        std::string source = makeProgram(nstmts);
+
+        // Parsing straight into the arena
+        NodeFactory parsed;
+        AllocProbe probe;
+        BenchClock::time_point start = BenchClock::now();
+        ParseProgram parse{ parsed };
+        Program* prg = parse(source);
+        double parseMs = millisSince(start);
+        AllocStats parseStats = probe.get();
+        ResolveVisitor resolve;
+        prg->accept(&resolve);
+
+        // The same tree built again with one new per node and with the arena (fresh and reused after clear_memory)
+        HeapNodes heap;
+        NodeFactory arena;
+        Row heapRow = measure(heap, prg);
+        Row arenaRow = measure(arena, prg);
+        Row reusedRow = measure(arena, prg);
+
+        printRow(nstmts, parsed.get_n_nodes(), "new/node", heapRow);
+        printRow(nstmts, parsed.get_n_nodes(), "arena", arenaRow);
+        printRow(nstmts, parsed.get_n_nodes(), "arena reused", reusedRow);
+        std::cout << std::setw(32) << "parse (arena)" << std::setw(10) << parseStats.allocs << std::setw(11) << parseStats.peak_kib
+                  << std::setw(10) << std::setprecision(2) << parseMs
+                  << "   arena: " << parsed.get_arena().get_bytes_used() / 1024 << " KiB used in "
+                  << parsed.get_arena().get_n_chunks() << " chunks" << std::endl;
+        delete(prg);
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,81 @@
+#include <cstdio>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+
+#include "../includes/Visitor.h"
+#include "../includes/OutputSink.h"
+#include "../includes/InputSource.h"
+#include "BenchUtils.h"
+
+
+/* INPUT loops evaluated by the EvaluationVisitor with the values read from the console
+(std::cin reading from memory, prompts written on a temporary file) and from a temporary file
+by a batch InputSource, one word at a time and preloaded before the run */
+std::string makeProgram(long values) {
+    return "(BLOCK (SET s 0) (SET i 0) (WHILE (LT i " + std::to_string(values) + ") (BLOCK (INPUT v) (SET s (ADD s v)) (SET i (ADD i 1)))) (PRINT s))";
+}
+
+std::string makeInput(long values) {
+    std::string text;
+    for (long i = 0; i < values; i++) text += std::to_string((i * 7919) % 1000003 - 500000) + "\n";
+    return text;
+}
+
+double consoleMs(Program* prg, const std::string& text) {
+    std::stringstream in{ text };
+    std::streambuf* old = std::cin.rdbuf(in.rdbuf());
+    std::FILE* f = std::tmpfile();
+    BenchClock::time_point start = BenchClock::now();
+    {
+        OutputSink out{ f, OutputSink::SIZE };
+        Runtime rt{ &out, &InputSource::standard() };
+        EvaluationVisitor eval{ &rt };
+        prg->accept(&eval);
+    }
+    double ms = millisSince(start);
+    std::fclose(f);
+    std::cin.rdbuf(old);
+    return ms;
+}
+
+double batchMs(Program* prg, const std::string& text, bool preload) {
+    std::FILE* values = std::tmpfile();
+    std::fwrite(text.data(), 1, text.size(), values);
+    std::rewind(values);
+    std::FILE* f = std::tmpfile();
+    BenchClock::time_point start = BenchClock::now();
+    {
+        InputSource in{ values, true };
+        if (preload) in.preload();
+        OutputSink out{ f, OutputSink::SIZE };
+        Runtime rt{ &out, &in };
+        EvaluationVisitor eval{ &rt };
+        prg->accept(&eval);
+    }
+    double ms = millisSince(start);
+    std::fclose(f);
+    return ms;
+}
+
+int main() {
+    std::cout << std::setw(10) << "values" << std::setw(14) << "console ms" << std::setw(12) << "batch ms"
+              << std::setw(14) << "preload ms" << std::setw(10) << "speedup" << std::endl;
+
+    for (long values : { 10000L, 100000L, 1000000L }) {
+        NodeFactory nf;
+        Program* prg = parseSource(makeProgram(values), nf);
+        std::string text = makeInput(values);
+
+        double consMs = consoleMs(prg, text);
+        double streamMs = batchMs(prg, text, false);
+        double preloadMs = batchMs(prg, text, true);
+
+        std::cout << std::fixed << std::setprecision(1)
+                  << std::setw(10) << values << std::setw(14) << consMs << std::setw(12) << streamMs
+                  << std::setw(14) << preloadMs << std::setw(9) << consMs / streamMs << "x" << std::endl;
+        delete prg;
+    }
+    return 0;
+}
@@ -0,0 +1,70 @@
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "../includes/Compiler.h"
+#include "../includes/VM.h"
+#include "../includes/BatchRunner.h"
+#include "../includes/WorkStealingPool.h"
+#include "BenchUtils.h"
+
+
+/* Runs per second of the same script over many rows of INPUT values: parsing the script again for
+each row (like a process for each run) and parsing it once, with the BatchRunner on 1, 2, 4, ...
+threads up to the hardware threads. The runs use the bytecode VirtualMachine */
+int main() {
+    const std::string source =
+        "(BLOCK (INPUT n) (INPUT k) (SET s 0) (SET i 0) (WHILE (LT i n) (BLOCK "
+        "(IF (EQ (SUB i (MUL (DIV i k) k)) 0) (SET s (ADD s i)) (SET s (SUB s 1))) (SET i (ADD i 1)))) (PRINT s))";
+    const size_t n_rows = 20000;
+    std::ostringstream text;
+    for (size_t r = 0; r < n_rows; r++) text << 200 + r % 300 << ' ' << 1 + r % 7 << '\n';
+    const std::string rows = text.str();
+
+    std::string sink_text;
+    OutputSink sink{ sink_text };
+
+    // Parsing, resolution and compilation for each row
+    BenchClock::time_point start = BenchClock::now();
+    for (std::string_view row : BatchRunner::splitRows(rows)) {
+        NodeFactory nf;
+        Program* prg = parseSource(source, nf);
+        BytecodeCompiler compile;
+        Chunk chunk = compile(prg);
+        ExecutionContext ctx{ row };
+        ctx.run([&chunk](Runtime* r) { VirtualMachine vm{ r }; vm.run(chunk); });
+        sink.write(ctx.get_output());
+        delete(prg);
+    }
+    sink.flush();
+    double reparseMs = millisSince(start);
+    size_t expected = sink_text.size();
+
+    NodeFactory nf;
+    Program* prg = parseSource(source, nf);
+    BytecodeCompiler compile;
+    Chunk chunk = compile(prg);
+    ExecutionContext::Engine engine = [&chunk](Runtime* r) { VirtualMachine vm{ r }; vm.run(chunk); };
+
+    std::cout << std::setw(10) << "threads" << std::setw(12) << "ms" << std::setw(14) << "runs/s" << std::setw(10) << "speedup" << std::endl;
+    std::cout << std::setw(10) << "reparse" << std::setw(12) << std::fixed << std::setprecision(1) << reparseMs
+              << std::setw(14) << std::setprecision(0) << n_rows / reparseMs * 1000 << std::endl;
+    double oneMs = 0;
+    for (unsigned int t = 1; t <= WorkStealingPool::defaultThreads(); t *= 2) {
+        sink_text.clear();
+        start = BenchClock::now();
+        BatchRunner batch{ engine, t };
+        batch(rows, sink, std::cerr);
+        sink.flush();
+        double ms = millisSince(start);
+        if (t == 1) oneMs = ms;
+        std::cout << std::setw(10) << t << std::setw(12) << std::setprecision(1) << ms
+                  << std::setw(14) << std::setprecision(0) << n_rows / ms * 1000
+                  << std::setw(9) << std::setprecision(2) << oneMs / ms << "x"
+                  << (sink_text.size() == expected ? "" : "  (different output)") << std::endl;
+    }
+    delete(prg);
+    return EXIT_SUCCESS;
+}
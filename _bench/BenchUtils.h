@@ -0,0 +1,26 @@
+#ifndef BENCH_UTILS_H
+#define BENCH_UTILS_H
+
+#include <string>
+#include <chrono>
+
+#include "../includes/Parser.h"
+#include "../includes/Resolver.h"
+
+
+using BenchClock = std::chrono::steady_clock;
+
+inline double millisSince(BenchClock::time_point start) {
+    return std::chrono::duration<double, std::milli>(BenchClock::now() - start).count();
+}
+
+/* Parsing and resolution of a source kept in memory; the nodes are owned by the given NodeFactory */
+inline Program* parseSource(const std::string& src, NodeFactory& nf) {
+    ParseProgram parse{ nf };
+    Program* prg = parse(src);
+    ResolveVisitor resolve;
+    prg->accept(&resolve);
+    return prg;
+}
+
+#endif /* BENCH_UTILS_H */
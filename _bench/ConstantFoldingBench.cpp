@@ -0,0 +1,26 @@
+#include <string>
+#include <vector>
+
+#include "../includes/ConstantFolder.h"
+#include "PassBench.h"
+
+
+/* Loops whose guards and bodies are full of constant subtrees and identities,
+run by the EvaluationVisitor and by the VirtualMachine before and after the ConstantFolder */
+
+int main() {
+    const std::string n = "2000000";
+    std::vector<Kernel> kernels = {
+        { "guard", "(BLOCK (SET i 0) (WHILE (AND (LT i (MUL " + n + " 1)) (OR FALSE (NOT (NOT (GT (ADD 2 3) 4))))) (SET i (ADD i (SUB 3 2)))))" },
+        { "arith", "(BLOCK (SET i 0) (SET s 0) (WHILE (LT i " + n + ") (BLOCK "
+                   "(SET s (ADD s (MUL (ADD 60 (MUL 2 30)) (DIV 100 (SUB 60 50))))) (SET s (SUB (MUL s 1) (MUL i 0))) (SET i (ADD i 1)))))" },
+        { "deadif", "(BLOCK (SET i 0) (WHILE (LT i " + n + ") (BLOCK "
+                    "(IF (EQ (MUL 6 7) 42) (SET i (ADD i 1)) (SET i (SUB i 1))) (WHILE (LT 1 0) (SET i 0)))))" },
+    };
+
+    return runPassBench(kernels, "folds", "folded", [](NodeFactory& nf, Program* prg) {
+        ConstantFolder fold{ nf };
+        fold(prg);
+        return std::to_string(fold.get_n_folded());
+    });
+}
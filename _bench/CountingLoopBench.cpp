@@ -0,0 +1,26 @@
+#include <string>
+#include <vector>
+
+#include "../includes/InductionVariableSimplifier.h"
+#include "PassBench.h"
+
+
+/* Counting loops with sums of constants and of the induction variable,
+run by the EvaluationVisitor and by the VirtualMachine before and after the InductionVariableSimplifier */
+
+int main() {
+    const std::string n = "2000000";
+    std::vector<Kernel> kernels = {
+        { "sum", "(BLOCK (SET n " + n + ") (SET i 0) (SET s 0) (WHILE (LT i n) (BLOCK (SET s (ADD s i)) (SET i (ADD i 1)))))" },
+        { "reduce", "(BLOCK (SET i " + n + ") (SET a 0) (SET b 0) (SET c 0) (WHILE (GT i 0) (BLOCK "
+                    "(SET i (SUB i 2)) (SET a (ADD a (MUL i 3))) (SET b (SUB b 7)) (SET c i))))" },
+        { "nested", "(BLOCK (SET s 0) (SET j 0) (WHILE (LT j 2000) (BLOCK (SET i 0) (WHILE (LT i 1000) (BLOCK "
+                    "(SET s (ADD s i)) (SET i (ADD i 1)))) (SET j (ADD j 1)))))" },
+    };
+
+    return runPassBench(kernels, "loops", "closed", [](NodeFactory& nf, Program* prg) {
+        InductionVariableSimplifier indvars{ nf };
+        indvars(prg);
+        return std::to_string(indvars.get_n_reduced());
+    });
+}
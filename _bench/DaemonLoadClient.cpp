@@ -0,0 +1,94 @@
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include "../includes/Daemon.h"
+#include "../includes/DaemonProtocol.h"
+#include "../includes/WorkStealingPool.h"
+#include "BenchUtils.h"
+
+
+/* Load generator of a Daemon: N clients, each one with its own connection, send requests for a few
+scripts with different INPUT values and the latency of each request (from the send to the trailer) is kept.
+It prints the percentiles of the latencies and the requests per second, for the first requests of each script
+(parsing and compilation) and for the others (program in the cache).
+USAGE: DaemonLoadClient [SOCKET [CLIENTS [REQUESTS]]]
+without SOCKET a Daemon with the bytecode engine is started in the process on a temporary socket */
+int main(int argc, char* argv[]) {
+    const std::vector<std::string> sources = {
+        "(BLOCK (INPUT n) (SET s 0) (SET i 0) (WHILE (LT i n) (BLOCK (SET s (ADD s (MUL i i))) (SET i (ADD i 1)))) (PRINT s))",
+        "(BLOCK (INPUT n) (SET a 0) (SET b 1) (WHILE (GT n 0) (BLOCK (PRINT a) (SET t b) (SET b (ADD a b)) (SET a t) (SET n (SUB n 1)))))",
+        "(BLOCK (INPUT n) (INPUT k) (SET c 0) (WHILE (GT n 0) (BLOCK "
+        "(IF (EQ (SUB n (MUL (DIV n k) k)) 0) (SET c (ADD c 1)) (SET c c)) (SET n (SUB n 1)))) (PRINT c))",
+    };
+    std::string path = (argc > 1) ? argv[1] : "/tmp/lisp-daemon-" + std::to_string(getpid()) + ".sock";
+    unsigned int n_clients = (argc > 2) ? std::stoi(argv[2]) : std::max(4u, WorkStealingPool::defaultThreads());
+    size_t n_requests = (argc > 3) ? std::stoul(argv[3]) : 5000;
+
+    Options opts;
+    opts.engine = Options::VM;
+    Daemon daemon{ opts };
+    std::thread server;
+    if (argc <= 1) {
+        server = std::thread{ [&daemon, &path] { if (!daemon.serve(path)) std::perror("serve"); } };
+        // wait for the socket
+        DaemonClient probe;
+        while (!probe.connect(path)) std::this_thread::yield();
+    }
+
+    std::vector<std::vector<double>> cold(n_clients), warm(n_clients);
+    std::vector<size_t> failures(n_clients, 0);
+    BenchClock::time_point start = BenchClock::now();
+    std::vector<std::thread> clients;
+    for (unsigned int c = 0; c < n_clients; c++) {
+        clients.emplace_back([&, c] {
+            DaemonClient client;
+            if (!client.connect(path)) {
+                failures[c] = n_requests;
+                return;
+            }
+            std::string output, error;
+            for (size_t r = 0; r < n_requests; r++) {
+                size_t s = (r + c) % sources.size();
+                std::string input = std::to_string(50 + (r * 7 + c) % 200) + " " + std::to_string(1 + r % 5);
+                BenchClock::time_point t = BenchClock::now();
+                DaemonProtocol::Status status = client.run(sources[s], input, output, error);
+                double ms = millisSince(t);
+                if (status != DaemonProtocol::OK || output.empty()) failures[c]++;
+                (r < sources.size() ? cold[c] : warm[c]).push_back(ms * 1000);
+            }
+        });
+    }
+    for (std::thread& t : clients) t.join();
+    double totalMs = millisSince(start);
+
+    std::cout << n_clients << " clients, " << n_requests << " requests each, "
+              << std::fixed << std::setprecision(0) << n_clients * n_requests / totalMs * 1000 << " requests/s" << std::endl;
+    std::cout << std::setw(8) << "" << std::setw(10) << "count" << std::setw(10) << "p50 us" << std::setw(10) << "p90 us"
+              << std::setw(10) << "p99 us" << std::setw(10) << "p99.9 us" << std::setw(10) << "max us" << std::endl;
+    for (auto* set : { &cold, &warm }) {
+        std::vector<double> all;
+        for (std::vector<double>& v : *set) all.insert(all.end(), v.begin(), v.end());
+        if (all.empty()) continue;
+        std::sort(all.begin(), all.end());
+        auto at = [&all](double p) { return all[std::min(all.size() - 1, static_cast<size_t>(p * all.size()))]; };
+        std::cout << std::setw(8) << (set == &cold ? "first" : "cached") << std::setw(10) << all.size() << std::setprecision(1)
+                  << std::setw(10) << at(0.5) << std::setw(10) << at(0.9) << std::setw(10) << at(0.99)
+                  << std::setw(10) << at(0.999) << std::setw(10) << all.back() << std::endl;
+    }
+    size_t n_failed = 0;
+    for (size_t f : failures) n_failed += f;
+    if (n_failed > 0) std::cout << n_failed << " requests failed" << std::endl;
+
+    if (server.joinable()) {
+        std::cout << "cache: " << daemon.get_cache().get_n_hits() << " hits, " << daemon.get_cache().get_n_misses() << " misses" << std::endl;
+        daemon.stop();
+        server.join();
+    }
+    return n_failed == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
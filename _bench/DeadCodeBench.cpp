@@ -0,0 +1,27 @@
+#include <string>
+#include <vector>
+
+#include "../includes/DeadCodeEliminator.h"
+#include "PassBench.h"
+
+
+/* Loops whose bodies compute temporaries never read (dead stores, also chains of them),
+run by the EvaluationVisitor and by the VirtualMachine before and after the DeadCodeEliminator */
+
+int main() {
+    const std::string n = "2000000";
+    std::vector<Kernel> kernels = {
+        { "temps", "(BLOCK (SET i 0) (SET s 0) (WHILE (LT i " + n + ") (BLOCK "
+                   "(SET t (MUL i 3)) (SET u (ADD t i)) (SET s (ADD s i)) (SET i (ADD i 1)))) (PRINT s))" },
+        { "overwr", "(BLOCK (SET i 0) (SET x 0) (WHILE (LT i " + n + ") (BLOCK "
+                    "(SET x (MUL i i)) (SET x (ADD i 2)) (SET x (SUB i 1)) (SET i (ADD i 1)))) (PRINT x))" },
+        { "branch", "(BLOCK (SET i 0) (WHILE (LT i " + n + ") (BLOCK "
+                    "(IF (GT i 1000) (BLOCK (SET a i) (SET b (ADD a 1))) (SET a 0)) (SET i (ADD i 1)))))" },
+    };
+
+    return runPassBench(kernels, "stores/nodes", "dce", [](NodeFactory& nf, Program* prg) {
+        DeadCodeEliminator dce{ nf };
+        dce(prg);
+        return std::to_string(dce.get_n_dead_stores()) + "/" + std::to_string(dce.get_n_removed_nodes());
+    });
+}
@@ -0,0 +1,27 @@
+#include <string>
+#include <vector>
+
+#include "../includes/DefiniteAssignment.h"
+#include "PassBench.h"
+
+
+/* Loops reading their variables many times, run by the EvaluationVisitor and by the VirtualMachine
+with a check of the declaration at each read and after the DefiniteAssignment (reads without checks) */
+
+int main() {
+    const std::string n = "1000000";
+    std::vector<Kernel> kernels = {
+        { "poly", "(BLOCK (SET n " + n + ") (SET x 3) (SET i 0) (SET s 0) (WHILE (LT i n) (BLOCK "
+                  "(SET s (ADD s (ADD (MUL (MUL x x) x) (MUL i (SUB x i))))) (SET i (ADD i 1)))) (PRINT s))" },
+        { "fib", "(BLOCK (SET n " + n + ") (SET a 0) (SET b 1) (SET i 0) (WHILE (LT i n) (BLOCK "
+                 "(SET t (ADD a b)) (SET a b) (SET b t) (SET i (ADD i 1)))) (PRINT a))" },
+        { "branch", "(BLOCK (SET n " + n + ") (SET i 0) (SET e 0) (SET o 0) (WHILE (LT i n) (BLOCK "
+                    "(IF (EQ (MUL (DIV i 2) 2) i) (SET e (ADD e i)) (SET o (ADD o i))) (SET i (ADD i 1)))) (PRINT (SUB e o)))" },
+    };
+
+    return runPassBench(kernels, "reads", "proved", [](NodeFactory& nf, Program* prg) {
+        DefiniteAssignment assignment{ nf };
+        assignment(prg);
+        return std::to_string(assignment.get_n_unchecked());
+    });
+}
@@ -0,0 +1,238 @@
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../includes/SourceFile.h"
+#include "../includes/PreparedProgram.h"
+#include "../includes/ExecutionContext.h"
+#include "BenchUtils.h"
+#include "PerfCounters.h"
+
+
+/* Suite of the execution engines: every PASS_ program of the test directory and synthetic kernels
+(deep expressions, many variables, nested WHILE, short-circuited guards) prepared once and run in process
+on each engine, with warmup runs and then timed runs, each one in its own ExecutionContext (output kept
+in memory). For each kernel and engine it reports the minimum, median, mean and standard deviation
+of the time of a run and the hardware counters of a run (see PerfCounters), also in CSV and JSON
+to compare the engines and the versions of the interpreter.
+USAGE: EngineSuiteBench [--dir=TEST_DIR] [--reps=N] [--warmup=N] [--engines=tree,vm,...] [--csv=FILE] [--json=FILE] */
+
+struct Kernel {
+    std::string name;
+    std::string source;
+};
+
+struct Result {
+    std::string kernel;
+    std::string engine;
+    unsigned int runs;
+    bool failed;
+    double min_us, median_us, mean_us, stddev_us;
+    double counters[PerfCounters::NULL_VAL]; // mean of a run
+};
+
+// (op (op ... x ...)): an expression of "depth" operators mixing the variables a and b
+static std::string deepExpr(int depth) {
+    std::string e = "a";
+    for (int d = 0; d < depth; d++) {
+        switch (d % 3) {
+            case 0: e = "(ADD " + e + " b)"; break;
+            case 1: e = "(MUL " + e + " 3)"; break;
+            default: e = "(SUB " + e + " a)";
+        }
+    }
+    return e;
+}
+
+// VARIABLE_ID of only letters for the variable "v"
+static std::string varName(int v) {
+    std::string id = "v";
+    do {
+        id += static_cast<char>('a' + v % 26);
+        v /= 26;
+    } while (v > 0);
+    return id;
+}
+
+static std::vector<Kernel> syntheticKernels() {
+    std::vector<Kernel> kernels;
+    // The updates multiply the accumulators, so the InductionVariableSimplifier leaves the loops in place
+
+    kernels.push_back({ "deep_expressions", "(BLOCK (SET a 1) (SET b 2) (SET s 0) (SET i 0) (WHILE (LT i 20000) (BLOCK "
+        "(SET s " + deepExpr(60) + ") (SET a (ADD (MUL a 5) i)) (SET i (ADD i 1)))) (PRINT s))" });
+
+    std::stringstream vars;
+    vars << "(BLOCK";
+    for (int v = 0; v < 256; v++) vars << " (SET " << varName(v) << " " << v << ")";
+    vars << " (SET i 0) (WHILE (LT i 2000) (BLOCK";
+    for (int v = 0; v < 256; v++) vars << " (SET " << varName(v) << " (ADD (MUL " << varName(v) << " 3) " << varName((v + 1) % 256) << "))";
+    vars << " (SET i (ADD i 1)))) (PRINT " << varName(0) << "))";
+    kernels.push_back({ "many_variables", vars.str() });
+
+    kernels.push_back({ "nested_while", "(BLOCK (SET s 1) (SET i 0) (WHILE (LT i 60) (BLOCK (SET j 0) (WHILE (LT j 60) (BLOCK "
+        "(SET k 0) (WHILE (LT k 60) (BLOCK (SET s (ADD (MUL s 3) k)) (SET k (ADD k 1)))) (SET j (ADD j 1)))) "
+        "(SET i (ADD i 1)))) (PRINT s))" });
+
+    kernels.push_back({ "short_circuit", "(BLOCK (SET s 0) (SET i 0) (WHILE (LT i 200000) (BLOCK "
+        "(IF (OR (LT i 0) (OR (AND (GT s 100) (EQ i 0)) (AND (NOT (EQ i 7)) (OR (GT i 5) (LT s 0))))) "
+        "(SET s (SUB (MUL s 3) i)) (SET s (ADD (MUL s 3) i))) "
+        "(IF (AND (LT s 0) (AND (GT s 0) (EQ s 0))) (SET s 0) (SET s (DIV s 2))) (SET i (ADD i 1)))) (PRINT s))" });
+    return kernels;
+}
+
+static std::vector<Kernel> testKernels(const std::string& dir) {
+    std::vector<Kernel> kernels;
+    std::error_code ec;
+    for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator{ dir, ec }) {
+        std::string name = entry.path().filename().string();
+        if (name.rfind("PASS_", 0) != 0 || entry.path().extension() != ".txt") continue;
+        SourceFile src{ entry.path().string() };
+        if (!src.fail()) kernels.push_back({ entry.path().stem().string(), std::string{ src.text() } });
+    }
+    std::sort(kernels.begin(), kernels.end(), [](const Kernel& a, const Kernel& b) { return a.name < b.name; });
+    return kernels;
+}
+
+static Result measure(const Kernel& k, const PreparedProgram& program, const std::string& engine,
+                      unsigned int warmup, unsigned int reps, PerfCounters& perf) {
+    Result r{ k.name, engine, reps, false, 0, 0, 0, 0, {} };
+    for (unsigned int i = 0; i < warmup; i++) {
+        ExecutionContext ctx{ "" };
+        ctx.run(program.get_engine());
+        r.failed = r.failed || ctx.failed();
+    }
+    std::vector<double> times;
+    for (unsigned int i = 0; i < reps; i++) {
+        ExecutionContext ctx{ "" };
+        perf.start();
+        BenchClock::time_point start = BenchClock::now();
+        ctx.run(program.get_engine());
+        double us = 1000 * millisSince(start);
+        PerfCounters::Reading reading = perf.stop();
+        times.push_back(us);
+        for (int e = 0; e < PerfCounters::NULL_VAL; e++) r.counters[e] += static_cast<double>(reading.values[e]) / reps;
+        r.failed = r.failed || ctx.failed();
+    }
+    std::sort(times.begin(), times.end());
+    r.min_us = times.front();
+    r.median_us = (reps % 2 == 1) ? times[reps / 2] : (times[reps / 2 - 1] + times[reps / 2]) / 2;
+    for (double t : times) r.mean_us += t / reps;
+    double var = 0;
+    for (double t : times) var += (t - r.mean_us) * (t - r.mean_us);
+    r.stddev_us = (reps > 1) ? std::sqrt(var / (reps - 1)) : 0;
+    return r;
+}
+
+static void writeCsv(std::ostream& out, const std::vector<Result>& results, bool counters) {
+    out << "kernel,engine,runs,failed,min_us,median_us,mean_us,stddev_us";
+    for (int e = 0; e < PerfCounters::NULL_VAL; e++) out << "," << PerfCounters::event2String(static_cast<PerfCounters::Event>(e));
+    out << std::endl << std::fixed << std::setprecision(3);
+    for (const Result& r : results) {
+        out << r.kernel << "," << r.engine << "," << r.runs << "," << (r.failed ? 1 : 0) << "," << r.min_us << "," << r.median_us
+            << "," << r.mean_us << "," << r.stddev_us;
+        for (double c : r.counters) {
+            out << ",";
+            if (counters) out << std::setprecision(0) << c << std::setprecision(3);
+        }
+        out << std::endl;
+    }
+}
+
+static void writeJson(std::ostream& out, const std::vector<Result>& results, bool counters) {
+    out << "[" << std::fixed << std::setprecision(3);
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result& r = results[i];
+        out << (i > 0 ? ",\n " : "\n ") << "{\"kernel\":\"" << r.kernel << "\",\"engine\":\"" << r.engine << "\",\"runs\":" << r.runs
+            << ",\"failed\":" << (r.failed ? "true" : "false") << ",\"min_us\":" << r.min_us << ",\"median_us\":" << r.median_us
+            << ",\"mean_us\":" << r.mean_us << ",\"stddev_us\":" << r.stddev_us;
+        for (int e = 0; e < PerfCounters::NULL_VAL; e++) {
+            out << ",\"" << PerfCounters::event2String(static_cast<PerfCounters::Event>(e)) << "\":";
+            if (counters) out << std::setprecision(0) << r.counters[e] << std::setprecision(3);
+            else out << "null";
+        }
+        out << "}";
+    }
+    out << "\n]" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    std::string dir = "_test/TestFiles";
+    std::string csv_file, json_file;
+    unsigned int reps = 20, warmup = 3;
+    std::vector<std::string> engines = { "tree", "vm", "jit", "flat", "switch" };
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg.rfind("--dir=", 0) == 0) dir = arg.substr(6);
+        else if (arg.rfind("--reps=", 0) == 0) reps = std::max(1, std::atoi(arg.c_str() + 7));
+        else if (arg.rfind("--warmup=", 0) == 0) warmup = std::max(0, std::atoi(arg.c_str() + 9));
+        else if (arg.rfind("--csv=", 0) == 0) csv_file = arg.substr(6);
+        else if (arg.rfind("--json=", 0) == 0) json_file = arg.substr(7);
+        else if (arg.rfind("--engines=", 0) == 0) {
+            engines.clear();
+            std::stringstream list{ arg.substr(10) };
+            for (std::string e; std::getline(list, e, ',');) engines.push_back(e);
+        } else {
+            std::cerr << "USAGE: " << argv[0] << " [--dir=TEST_DIR] [--reps=N] [--warmup=N] [--engines=tree,vm,...] [--csv=FILE] [--json=FILE]" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::vector<Kernel> kernels = testKernels(dir);
+    for (Kernel& k : syntheticKernels()) kernels.push_back(std::move(k));
+    PerfCounters perf;
+    if (!perf.available()) std::cerr << "(hardware counters not available: only the times are measured)" << std::endl;
+
+    std::cout << std::left << std::setw(24) << "kernel" << std::setw(8) << "engine" << std::right << std::setw(12) << "min us"
+              << std::setw(12) << "median us" << std::setw(12) << "stddev us" << std::setw(14) << "instructions"
+              << std::setw(7) << "IPC" << std::setw(12) << "br misses" << std::setw(12) << "$ misses" << std::endl;
+    std::vector<Result> results;
+    for (const Kernel& k : kernels) {
+        for (const std::string& name : engines) {
+            Options opts;
+            opts.engine = Options::string2Engine(name);
+            if (opts.engine == Options::NULL_VAL) {
+                std::cerr << "(unknown engine \"" << name << "\" )" << std::endl;
+                return EXIT_FAILURE;
+            }
+            std::unique_ptr<PreparedProgram> program;
+            try {
+                program.reset(new PreparedProgram(k.source, opts));
+            } catch (std::exception& exc) {
+                std::cerr << k.name << ": " << exc.what() << std::endl;
+                break;
+            }
+            // the JIT falls back to the tree where native code isn't supported: its row would repeat the tree one
+            if (program->get_engine_kind() != opts.engine) continue;
+            Result r = measure(k, *program, name, warmup, reps, perf);
+            results.push_back(r);
+
+            std::cout << std::left << std::setw(24) << k.name << std::setw(8) << name << std::right << std::fixed << std::setprecision(1)
+                      << std::setw(12) << r.min_us << std::setw(12) << r.median_us << std::setw(12) << r.stddev_us;
+            if (perf.available()) {
+                double ipc = r.counters[PerfCounters::CYCLES] > 0 ? r.counters[PerfCounters::INSTRUCTIONS] / r.counters[PerfCounters::CYCLES] : 0;
+                std::cout << std::setprecision(0) << std::setw(14) << r.counters[PerfCounters::INSTRUCTIONS] << std::setprecision(2)
+                          << std::setw(7) << ipc << std::setprecision(0) << std::setw(12) << r.counters[PerfCounters::BRANCH_MISSES]
+                          << std::setw(12) << r.counters[PerfCounters::CACHE_MISSES];
+            } else {
+                std::cout << std::setw(14) << "n/a" << std::setw(7) << "n/a" << std::setw(12) << "n/a" << std::setw(12) << "n/a";
+            }
+            std::cout << (r.failed ? "  (error)" : "") << std::endl;
+        }
+    }
+
+    if (!csv_file.empty()) {
+        std::ofstream out{ csv_file };
+        writeCsv(out, results, perf.available());
+    }
+    if (!json_file.empty()) {
+        std::ofstream out{ json_file };
+        writeJson(out, results, perf.available());
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,76 @@
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+
+#include "../includes/Visitor.h"
+#include "../includes/Flattener.h"
+#include "../includes/FlatEvaluator.h"
+#include "BenchUtils.h"
+
+
+/* Deep expression trees evaluated by the EvaluationVisitor (nodes in the NodeArena)
+and by the FlatEvaluator (FlatAst layout): footprint of a node and evaluation time.
+The number of iterations is scaled so that every size evaluates about the same number of nodes */
+constexpr long NODE_EVALS = 1L << 25;
+
+// Balanced NUM_EXPR of the given depth mixing ADD and SUB over the variables a, b and small literals
+void makeExpr(std::stringstream& src, int depth, int& leaf) {
+    if (depth == 0) {
+        switch (leaf++ % 3) {
+            case 0: src << "a"; break;
+            case 1: src << "b"; break;
+            default: src << leaf % 10;
+        }
+        return;
+    }
+    src << ((depth % 2) ? "(ADD " : "(SUB ");
+    makeExpr(src, depth - 1, leaf);
+    src << " ";
+    makeExpr(src, depth - 1, leaf);
+    src << ")";
+}
+
+std::string makeProgram(int depth, long iterations) {
+    std::stringstream src;
+    int leaf = 0;
+    src << "(BLOCK (SET a 1) (SET b 2) (SET i 0) (WHILE (LT i " << iterations << ") (BLOCK (SET x ";
+    makeExpr(src, depth, leaf);
+    src << ") (SET i (ADD i 1)))))";
+    return src.str();
+}
+
+int main() {
+    std::cout << std::setw(6) << "depth" << std::setw(10) << "nodes"
+              << std::setw(12) << "tree B/node" << std::setw(12) << "flat B/node"
+              << std::setw(10) << "tree ms" << std::setw(10) << "flat ms" << std::setw(10) << "speedup" << std::endl;
+
+    for (int depth : { 4, 8, 12, 16, 18, 20 }) {
+        long iterations = NODE_EVALS >> (depth + 1);
+        if (iterations < 1) iterations = 1;
+        NodeFactory nf;
+        Program* prg = parseSource(makeProgram(depth, iterations), nf);
+
+        BenchClock::time_point start = BenchClock::now();
+        EvaluationVisitor eval;
+        prg->accept(&eval);
+        double treeMs = millisSince(start);
+
+        FlattenVisitor flatten;
+        FlatAst ast = flatten(prg);
+        start = BenchClock::now();
+        FlatEvaluator flat;
+        flat.run(ast);
+        double flatMs = millisSince(start);
+
+        std::cout << std::setw(6) << depth << std::setw(10) << nf.get_n_nodes()
+                  << std::setw(12) << std::fixed << std::setprecision(1)
+                  << static_cast<double>(nf.get_arena().get_bytes_used()) / nf.get_n_nodes()
+                  << std::setw(12) << static_cast<double>(ast.get_bytes()) / ast.get_n_nodes()
+                  << std::setw(10) << std::setprecision(2) << treeMs
+                  << std::setw(10) << flatMs
+                  << std::setw(9) << std::setprecision(1) << treeMs / flatMs << "x" << std::endl;
+        delete(prg);
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,85 @@
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <filesystem>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../includes/Tokenizer.h"
+#include "../includes/SourceFile.h"
+#include "../includes/Lexer.h"
+#include "BenchUtils.h"
+
+
+/* Load of multi-megabyte generated scripts from disk: the Tokenizer (std::ifstream read one
+character at a time, a std::vector of Token owning their text) against the SourceFile mapped
+in memory read by the Lexer, alone and feeding the parser */
+
+// Program of about "bytes" characters: many statements with long VARIABLE_IDs and numbers
+std::string makeProgram(size_t bytes) {
+    std::stringstream src;
+    src << "(BLOCK\n  (SET counter 0)\n  (SET total 1)\n";
+    for (long i = 0; static_cast<size_t>(src.tellp()) < bytes; i++) {
+        switch (i % 4) {
+            case 0: src << "  (SET total (ADD (MUL total 3) (SUB counter " << i << ")))\n"; break;
+            case 1: src << "  (IF (AND (GT total 1000000) (NOT (EQ counter -" << i << "))) (SET total (DIV total 7)) (SET counter (ADD counter 1)))\n"; break;
+            case 2: src << "  (BLOCK (SET index 0) (WHILE (LT index 2) (SET index (ADD index 1))))\n"; break;
+            default: src << "  (SET counter (SUB counter total))\n";
+        }
+    }
+    src << ")\n";
+    return src.str();
+}
+
+int main() {
+    std::filesystem::path file = std::filesystem::temp_directory_path() / "lisp_frontend_bench.txt";
+
+    std::cout << std::setw(8) << "MiB" << std::setw(10) << "tokens"
+              << std::setw(15) << "Tokenizer ms" << std::setw(12) << "Lexer ms" << std::setw(20) << "Lexer+parser ms"
+              << std::setw(12) << "MiB/s" << std::endl;
+
+    for (size_t mib : { 1, 8, 32 }) {
+        {
+            std::ofstream out{ file };
+            out << makeProgram(mib << 20);
+        }
+
+        // Tokenizer: std::vector<Token>
+        BenchClock::time_point start = BenchClock::now();
+        std::ifstream in{ file };
+        Tokenizer tokenize;
+        std::vector<Token> tokens = tokenize(in);
+        double tokenizerMs = millisSince(start);
+
+        // Lexer only: tokens read one at a time and dropped
+        start = BenchClock::now();
+        size_t nLexed = 0;
+        {
+            SourceFile source{ file.string() };
+            Lexer lexer{ source.text() };
+            LexToken tok;
+            while (lexer.next(tok)) nLexed++;
+        }
+        double lexerMs = millisSince(start);
+
+        // Lexer feeding the parser: the whole Program is built
+        start = BenchClock::now();
+        {
+            SourceFile source{ file.string() };
+            NodeFactory nf;
+            ParseProgram parse{ nf };
+            Program* prg = parse(source.text());
+            delete(prg);
+        }
+        double parseMs = millisSince(start);
+
+        if (nLexed != tokens.size()) std::cout << "token count mismatch: " << nLexed << " vs " << tokens.size() << std::endl;
+        std::cout << std::setw(8) << mib << std::setw(10) << tokens.size()
+                  << std::setw(15) << std::fixed << std::setprecision(1) << tokenizerMs
+                  << std::setw(12) << lexerMs << std::setw(20) << parseMs
+                  << std::setw(12) << mib * 1000.0 / parseMs << std::endl;
+    }
+    std::filesystem::remove(file);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,365 @@
+#include <algorithm>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../includes/Tokenizer.h"
+#include "../includes/Parser.h"
+#include "../includes/PreparedProgram.h"
+#include "../includes/RunStats.h"
+#include "BenchUtils.h"
+#include "ProgramGenerator.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#define SCALING_BENCH_FORK 1
+#endif
+
+
+/* Scaling of the front end on generated programs (see ProgramGenerator): four sweeps grow the number of statements,
+the nesting depth of IF and WHILE, the number of variables and the depth of the expressions. For each program
+it measures the Tokenizer, the Lexer feeding the parser (ParseProgram) and the preparation for the tree engine
+(parsing again, resolution and optimizations, see PreparedProgram): time, allocations and the peak resident memory
+of the process. The costs are divided by the tokens of the program: the growth of a cost per token between the first
+and the last program of a sweep is flagged as SUPER-LINEAR beyond MAX_TIME_GROWTH (time) or MAX_ALLOC_GROWTH (allocations).
+Each program is measured in a child process (on Unix): its peak memory is its own, and the crash of a phase
+(the recursive parsing of an expression or visit of a syntax tree past the end of the stack) is reported
+as a STACK OVERFLOW of that phase instead of ending the benchmark, a phase running past CASE_TIMEOUT as a TIMEOUT.
+USAGE: FrontEndScalingBench [--max-stmts=N] [--max-depth=N] [--max-vars=N] [--max-expr-depth=N] [--runs=N] [--seed=N] */
+
+// Maximum growth of the cost per token between the smallest and the largest program of a sweep
+constexpr double MAX_TIME_GROWTH = 3.0;
+constexpr double MAX_ALLOC_GROWTH = 1.5;
+// Seconds given to the phases of a program in its child process: an exponential phase is reported as a TIMEOUT
+constexpr unsigned int CASE_TIMEOUT = 60;
+// Statements of the smallest programs: below, the costs per token are those of programs kept in the caches
+constexpr size_t MIN_STMTS = 1 << 14;
+
+
+/* Every allocation of the process goes through this operator: it counts the calls */
+static size_t allocations = 0;
+
+void* operator new(size_t size) {
+    allocations++;
+    void* p = std::malloc(size > 0 ? size : 1);
+    if (p == nullptr) throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+
+enum Phase { TOKENIZER, PARSER, PREPARE, NULL_VAL };
+static const char* phaseNames[NULL_VAL] = { "tokenizer", "parser", "prepare" };
+
+struct Measure {
+    double ms = 0;
+    size_t allocs = 0;
+    bool done = false;
+};
+
+struct Case {
+    ProgramShape shape;
+    size_t bytes = 0;
+    size_t tokens = 0;
+    Measure phases[NULL_VAL];
+    long peak_rss_kib = -1;   // growth of the resident memory of the child process
+    std::string failure;      // error or crash of the first phase not done
+    std::string slowest_pass; // pass of the preparation that took the most time
+};
+
+static long maxResidentKib() {
+#if defined(SCALING_BENCH_FORK)
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return -1;
+#if defined(__APPLE__)
+    return usage.ru_maxrss / 1024;
+#else
+    return usage.ru_maxrss;
+#endif
+#else
+    return -1;
+#endif
+}
+
+/* Measure of the phases of the program in "file" (its text in "source"), the best time of "runs" runs of each one
+(the allocations of a run): each result is written on "out" as a line as soon as the phase ends, so that the lines
+before a crash reach the parent */
+static void runPhases(const std::string& source, const std::filesystem::path& file, int runs, std::ostream& out) {
+    long rss_start = maxResidentKib();
+    double best = 0;
+    size_t allocs = 0;
+    auto keep = [&](int r, double ms, size_t before) {
+        if (r == 0 || ms < best) best = ms;
+        allocs = allocations - before;
+    };
+
+    size_t n_tokens = 0;
+    for (int r = 0; r < runs; r++) {
+        std::ifstream in{ file };
+        size_t before = allocations;
+        BenchClock::time_point start = BenchClock::now();
+        Tokenizer tokenize;
+        std::vector<Token> tokens = tokenize(in);
+        keep(r, millisSince(start), before);
+        n_tokens = tokens.size();
+    }
+    out << "phase " << TOKENIZER << " " << best << " " << allocs << " " << n_tokens << std::endl;
+
+    for (int r = 0; r < runs; r++) {
+        NodeFactory nf;
+        ParseProgram parse{ nf };
+        size_t before = allocations;
+        BenchClock::time_point start = BenchClock::now();
+        std::unique_ptr<Program> prg{ parse(source) };
+        keep(r, millisSince(start), before);
+    }
+    out << "phase " << PARSER << " " << best << " " << allocs << std::endl;
+
+    std::string slowest_pass = "-";
+    for (int r = 0; r < runs; r++) {
+        RunStats stats;
+        size_t before = allocations;
+        PreparedProgram program{ source, Options{}, &stats };
+        // the tokenization counted by the RunStats is not part of the preparation
+        double ms = 0;
+        const RunStats::Timing* slowest = nullptr;
+        for (const RunStats::Timing& t : stats.get_phases()) {
+            if (std::strcmp(t.name, "tokenize") == 0) continue;
+            ms += t.wall_ms;
+            if (std::strcmp(t.name, "parse") == 0) continue;
+            if (slowest == nullptr || t.wall_ms > slowest->wall_ms) slowest = &t;
+        }
+        if ((r == 0 || ms < best) && slowest != nullptr) slowest_pass = slowest->name;
+        keep(r, ms, before);
+    }
+    out << "phase " << PREPARE << " " << best << " " << allocs << " " << slowest_pass << std::endl;
+    out << "rss " << (maxResidentKib() - rss_start) << std::endl;
+}
+
+static void readResults(std::istream& in, Case& c) {
+    std::string key;
+    while (in >> key) {
+        if (key == "phase") {
+            int p;
+            Measure m;
+            in >> p >> m.ms >> m.allocs;
+            if (p == TOKENIZER) in >> c.tokens;
+            if (p == PREPARE) in >> c.slowest_pass;
+            m.done = true;
+            if (p >= 0 && p < NULL_VAL) c.phases[p] = m;
+        } else if (key == "rss") {
+            in >> c.peak_rss_kib;
+        } else if (key == "error") {
+            std::getline(in >> std::ws, c.failure);
+        }
+    }
+}
+
+// First phase not done, if any
+static int failedPhase(const Case& c) {
+    for (int p = 0; p < NULL_VAL; p++) {
+        if (!c.phases[p].done) return p;
+    }
+    return NULL_VAL;
+}
+
+static void measureCase(Case& c, const std::filesystem::path& file, int runs) {
+    ProgramGenerator generate{ c.shape };
+    std::string source = generate();
+    c.bytes = source.size();
+    {
+        std::ofstream out{ file, std::ios::trunc };
+        out << source;
+    }
+
+#if defined(SCALING_BENCH_FORK)
+    int fds[2];
+    if (pipe(fds) != 0) {
+        c.failure = "pipe() failed";
+        return;
+    }
+    std::cout.flush();
+    pid_t pid = fork();
+    if (pid < 0) {
+        ::close(fds[0]);
+        ::close(fds[1]);
+        c.failure = "fork() failed";
+        return;
+    }
+    if (pid == 0) {
+        ::close(fds[0]);
+        alarm(CASE_TIMEOUT);
+        // each line is sent by itself: the std::endl of runPhases flushes the stream into the pipe
+        struct PipeBuf : std::stringbuf {
+            int fd;
+            explicit PipeBuf(int f) : fd{ f } {}
+            int sync() override {
+                std::string s = str();
+                for (size_t done = 0; done < s.size();) {
+                    ssize_t n = ::write(fd, s.data() + done, s.size() - done);
+                    if (n <= 0) break;
+                    done += static_cast<size_t>(n);
+                }
+                str("");
+                return 0;
+            }
+        } buf{ fds[1] };
+        std::ostream out{ &buf };
+        try {
+            runPhases(source, file, runs, out);
+        } catch (std::exception& exc) {
+            out << "error " << exc.what() << std::endl;
+        }
+        ::_exit(EXIT_SUCCESS);
+    }
+    ::close(fds[1]);
+    std::string results;
+    char chunk[4096];
+    for (ssize_t n; (n = ::read(fds[0], chunk, sizeof(chunk))) > 0;) results.append(chunk, static_cast<size_t>(n));
+    ::close(fds[0]);
+    int status = 0;
+    waitpid(pid, &status, 0);
+    std::istringstream in{ results };
+    readResults(in, c);
+    if (WIFSIGNALED(status) && c.failure.empty()) {
+        int sig = WTERMSIG(status);
+        if (sig == SIGSEGV || sig == SIGBUS) c.failure = "STACK OVERFLOW";
+        else if (sig == SIGALRM) c.failure = "TIMEOUT";
+        else c.failure = "signal " + std::to_string(sig);
+    }
+#else
+    std::stringstream out;
+    try {
+        runPhases(source, file, runs, out);
+    } catch (std::exception& exc) {
+        out << "error " << exc.what() << std::endl;
+    }
+    readResults(out, c);
+#endif
+}
+
+// Growth of the cost per token of "phase" between the first and the last program measured in full
+static void reportGrowth(const std::vector<Case>& cases) {
+    const Case* first = nullptr;
+    const Case* last = nullptr;
+    for (const Case& c : cases) {
+        if (failedPhase(c) != NULL_VAL || c.tokens == 0) continue;
+        if (first == nullptr) first = &c;
+        last = &c;
+    }
+    if (first == nullptr || first == last) return;
+    for (int p = 0; p < NULL_VAL; p++) {
+        double time_growth = (last->phases[p].ms / last->tokens) / std::max(first->phases[p].ms / first->tokens, 1e-9);
+        double alloc_growth = (static_cast<double>(last->phases[p].allocs) / last->tokens)
+                            / std::max(static_cast<double>(first->phases[p].allocs) / first->tokens, 1e-9);
+        bool super_linear = time_growth > MAX_TIME_GROWTH || alloc_growth > MAX_ALLOC_GROWTH;
+        std::cout << "  " << std::left << std::setw(10) << phaseNames[p] << std::right << std::fixed << std::setprecision(2)
+                  << " growth per token: time x" << time_growth << ", allocations x" << alloc_growth
+                  << (super_linear ? "  SUPER-LINEAR" : "  linear") << std::endl;
+    }
+}
+
+static void runSweep(const char* title, std::vector<Case> cases, const std::filesystem::path& file, int runs) {
+    std::cout << std::endl << title << std::endl;
+    std::cout << std::setw(9) << "stmts" << std::setw(8) << "depth" << std::setw(8) << "vars" << std::setw(7) << "expr"
+              << std::setw(10) << "KiB" << std::setw(10) << "tokens"
+              << std::setw(11) << "token ms" << std::setw(11) << "parse ms" << std::setw(12) << "prepare ms"
+              << std::setw(12) << "parse alloc" << std::setw(12) << "RSS KiB" << "  slowest pass" << std::endl;
+    for (Case& c : cases) {
+        measureCase(c, file, runs);
+        std::cout << std::setw(9) << c.shape.statements << std::setw(8) << c.shape.depth << std::setw(8) << c.shape.variables
+                  << std::setw(7) << c.shape.expr_depth << std::setw(10) << (c.bytes >> 10) << std::setw(10) << c.tokens
+                  << std::fixed << std::setprecision(1);
+        for (int p = 0; p < NULL_VAL; p++) {
+            if (c.phases[p].done) std::cout << std::setw(p == PREPARE ? 12 : 11) << c.phases[p].ms;
+            else std::cout << std::setw(p == PREPARE ? 12 : 11) << "-";
+        }
+        std::cout << std::setw(12);
+        if (c.phases[PARSER].done) std::cout << c.phases[PARSER].allocs;
+        else std::cout << "-";
+        std::cout << std::setw(12);
+        if (c.peak_rss_kib >= 0) std::cout << c.peak_rss_kib;
+        else std::cout << "-";
+        std::cout << "  " << c.slowest_pass;
+        int failed = failedPhase(c);
+        if (failed != NULL_VAL) {
+            std::cout << "  " << (c.failure.empty() ? "no result" : c.failure) << " in " << phaseNames[failed];
+        }
+        std::cout << std::endl;
+    }
+    reportGrowth(cases);
+}
+
+int main(int argc, char* argv[]) {
+    size_t max_stmts = 1 << 18;
+    unsigned int max_depth = 1 << 15, max_vars = 1 << 16, max_expr_depth = 1 << 15;
+    int runs = 3;
+    uint32_t seed = 1;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg.rfind("--max-stmts=", 0) == 0) max_stmts = std::max(1L << 12, std::atol(arg.c_str() + 12));
+        else if (arg.rfind("--max-depth=", 0) == 0) max_depth = std::max(64, std::atoi(arg.c_str() + 12));
+        else if (arg.rfind("--max-vars=", 0) == 0) max_vars = std::max(64, std::atoi(arg.c_str() + 11));
+        else if (arg.rfind("--max-expr-depth=", 0) == 0) max_expr_depth = std::max(64, std::atoi(arg.c_str() + 17));
+        else if (arg.rfind("--runs=", 0) == 0) runs = std::max(1, std::atoi(arg.c_str() + 7));
+        else if (arg.rfind("--seed=", 0) == 0) seed = static_cast<uint32_t>(std::atol(arg.c_str() + 7));
+        else {
+            std::cerr << "USAGE: " << argv[0] << " [--max-stmts=N] [--max-depth=N] [--max-vars=N] [--max-expr-depth=N] [--runs=N] [--seed=N]" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+    std::filesystem::path file = std::filesystem::temp_directory_path() / "lisp_frontend_scaling_bench.txt";
+
+    // Programs doubled in size, the other parameters fixed
+    std::vector<Case> cases;
+    for (size_t n = MIN_STMTS; n <= max_stmts; n *= 2) {
+        Case c;
+        c.shape = ProgramShape{ n, 8, 64, 4, seed };
+        cases.push_back(c);
+    }
+    runSweep("STATEMENTS", cases, file, runs);
+
+    // Nesting doubled, with the statements once the deepest IF and WHILE take most of the program
+    cases.clear();
+    for (unsigned int d = 64; d <= max_depth; d *= 2) {
+        Case c;
+        c.shape = ProgramShape{ std::max(MIN_STMTS, 4 * static_cast<size_t>(d)), d, 64, 4, seed };
+        cases.push_back(c);
+    }
+    runSweep("NESTING DEPTH", cases, file, runs);
+
+    /* Variables doubled with the statements: a SET of each variable, then as many statements reading and writing them
+    (with more variables for each token the allocations for each token would grow, even if linear in the variables) */
+    cases.clear();
+    for (unsigned int v = MIN_STMTS / 2; v <= max_vars; v *= 2) {
+        Case c;
+        c.shape = ProgramShape{ 2 * static_cast<size_t>(v), 8, v, 4, seed };
+        cases.push_back(c);
+    }
+    runSweep("VARIABLES", cases, file, runs);
+
+    // One expression of growing depth, in a program of fixed size
+    cases.clear();
+    for (unsigned int e = 64; e <= max_expr_depth; e *= 2) {
+        Case c;
+        c.shape = ProgramShape{ 256, 4, 16, e, seed };
+        cases.push_back(c);
+    }
+    runSweep("EXPRESSION DEPTH", cases, file, runs);
+
+    std::filesystem::remove(file);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,223 @@
+#include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "../includes/IncrementalParser.h"
+#include "BenchUtils.h"
+#include "ProgramGenerator.h"
+
+
+/* Latency of the IncrementalParser on generated programs of growing size (see ProgramGenerator), against the parsing
+of the whole source. Four kinds of edits are made at random places, each one followed by the edit that takes it back:
+  digit       a NUM of one digit replaced by another one
+  expression  a NUM replaced by an expression of three tokens
+  statement   a statement inserted before a statement of a BLOCK (the number of statements of the Block changes)
+  newline     the space before a NUM replaced by a new line (the line of the statements after it changes)
+The time of each edit is the mean of EDITS edits after a warmup; "read" is the mean of the characters parsed
+again by an edit. The growth of the time of an edit between the smallest and the largest program is flagged
+as SIZE-DEPENDENT beyond MAX_EDIT_GROWTH, except for the statement edits, which move the array of the statements
+of their Block after the one inserted, growing with the size of the Block.
+USAGE: IncrementalParseBench [--max-stmts=N] [--edits=N] [--seed=N] */
+
+// Maximum growth of the time of an edit between the smallest and the largest program
+constexpr double MAX_EDIT_GROWTH = 3.0;
+constexpr size_t MIN_STMTS = 1 << 12;
+constexpr int WARMUP = 20;
+constexpr int RUNS = 3;
+
+enum EditKind { DIGIT, EXPRESSION, STATEMENT, NEWLINE, NULL_VAL };
+static const char* kindNames[NULL_VAL] = { "digit", "expression", "statement", "newline" };
+
+struct EditMeasure {
+    double micros = 0;
+    double bytes_read = 0;
+    int full = 0;  // edits that parsed the whole source
+};
+
+/* Source kept like an editor does, with the IncrementalParser told of each change */
+class Session {
+public:
+    explicit Session(std::string s) : src{ std::move(s) } { parser.parse(src); }
+
+    // Replacement of "removed" characters at "offset" by "text": it returns the time in microseconds
+    double edit(size_t offset, size_t removed, const std::string& text) {
+        src.replace(offset, removed, text);
+        auto start = BenchClock::now();
+        parser.edit(src, TextEdit{ offset, removed, text.size() });
+        return millisSince(start) * 1000;
+    }
+
+    const std::string& get_source() const { return src; }
+    const IncrementalParser::Stats& get_stats() const { return parser.get_stats(); }
+
+private:
+    std::string src;
+    IncrementalParser parser;
+};
+
+// Positions of the NUMs of one digit written after a space
+std::vector<size_t> digitPlaces(const std::string& src) {
+    std::vector<size_t> places;
+    for (size_t p = 1; p + 1 < src.size(); p++) {
+        if (src[p] >= '0' && src[p] <= '9' && src[p - 1] == ' ' && (src[p + 1] == ' ' || src[p + 1] == ')')) places.push_back(p);
+    }
+    return places;
+}
+
+// Positions of the statements at the start of a line, all in a BLOCK
+std::vector<size_t> statementPlaces(const std::string& src) {
+    std::vector<size_t> places;
+    for (size_t p = 1; p < src.size(); p++) {
+        if (src[p] == '(' && src[p - 1] == '\n') places.push_back(p);
+    }
+    return places;
+}
+
+/* Edit of the kind "k" at a random place, then the edit back: the source is the same after the two edits
+and the time of each one is accumulated in "m" if "measured" */
+void editAndBack(Session& s, EditKind k, size_t place, std::mt19937& rnd, EditMeasure& m, bool measured) {
+    double micros = 0;
+    size_t bytes = 0;
+    int full = 0;
+    auto done = [&](double t) {
+        micros += t;
+        bytes += s.get_stats().bytes_read;
+        full += s.get_stats().full ? 1 : 0;
+    };
+    const std::string& src = s.get_source();
+    switch (k) {
+        case DIGIT: {
+            std::string old{ src[place] };
+            char digit = static_cast<char>('1' + rnd() % 9);
+            if (digit == old[0]) digit = (digit == '9') ? '1' : digit + 1;
+            done(s.edit(place, 1, std::string{ digit }));
+            done(s.edit(place, 1, old));
+            break;
+        }
+        case EXPRESSION: {
+            std::string old{ src[place] };
+            done(s.edit(place, 1, "(ADD 7 8)"));
+            done(s.edit(place, 9, old));
+            break;
+        }
+        case STATEMENT: {
+            std::string stmt = "(PRINT 1) ";
+            done(s.edit(place, 0, stmt));
+            done(s.edit(place, stmt.size(), ""));
+            break;
+        }
+        case NEWLINE:
+            done(s.edit(place - 1, 1, "\n"));
+            done(s.edit(place - 1, 1, " "));
+            break;
+        case NULL_VAL: break;
+    }
+    if (!measured) return;
+    m.micros += micros;
+    m.bytes_read += bytes;
+    m.full += full;
+}
+
+struct Row {
+    size_t stmts = 0;
+    size_t bytes = 0;
+    double parse_ms = 0;        // ParseProgram alone
+    double full_ms = 0;         // IncrementalParser::parse(), with the positions of the statements
+    EditMeasure edits[NULL_VAL];
+};
+
+Row measure(size_t n_stmts, int n_edits, uint32_t seed) {
+    ProgramShape shape;
+    shape.statements = n_stmts;
+    shape.seed = seed;
+    Row row;
+    row.stmts = n_stmts;
+    std::string src = ProgramGenerator{ shape }();
+    row.bytes = src.size();
+
+    for (int r = 0; r < RUNS; r++) {
+        NodeFactory nf;
+        ParseProgram parse{ nf };
+        auto start = BenchClock::now();
+        delete parse(src);
+        double ms = millisSince(start);
+        row.parse_ms = (r == 0) ? ms : std::min(row.parse_ms, ms);
+
+        IncrementalParser parser;
+        start = BenchClock::now();
+        parser.parse(src);
+        ms = millisSince(start);
+        row.full_ms = (r == 0) ? ms : std::min(row.full_ms, ms);
+    }
+
+    std::mt19937 rnd{ seed };
+    Session session{ src };
+    std::vector<size_t> digits = digitPlaces(src);
+    std::vector<size_t> stmts = statementPlaces(src);
+    for (int k = 0; k < NULL_VAL; k++) {
+        EditKind kind = static_cast<EditKind>(k);
+        const std::vector<size_t>& places = (kind == STATEMENT) ? stmts : digits;
+        for (int e = 0; e < WARMUP + n_edits; e++) {
+            editAndBack(session, kind, places[rnd() % places.size()], rnd, row.edits[k], e >= WARMUP);
+        }
+        EditMeasure& m = row.edits[k];
+        m.micros /= 2 * n_edits;
+        m.bytes_read /= 2 * n_edits;
+    }
+    return row;
+}
+
+
+int main(int argc, char* argv[]) {
+    size_t max_stmts = 1 << 20;
+    int n_edits = 200;
+    uint32_t seed = 1;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg.rfind("--max-stmts=", 0) == 0) max_stmts = std::max<size_t>(MIN_STMTS, std::atol(arg.c_str() + 12));
+        else if (arg.rfind("--edits=", 0) == 0) n_edits = std::max(1, std::atoi(arg.c_str() + 8));
+        else if (arg.rfind("--seed=", 0) == 0) seed = static_cast<uint32_t>(std::atol(arg.c_str() + 7));
+        else {
+            std::cerr << "USAGE: " << argv[0] << " [--max-stmts=N] [--edits=N] [--seed=N]" << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::cout << "Incremental parsing: " << n_edits << " edits and their undo per kind, mean time per edit" << std::endl;
+    std::cout << std::left << std::setw(10) << "stmts" << std::setw(11) << "bytes" << std::setw(11) << "parse ms"
+        << std::setw(11) << "full ms";
+    for (const char* name : kindNames) std::cout << std::setw(22) << (std::string{ name } + " us (read)");
+    std::cout << std::endl;
+
+    std::vector<Row> rows;
+    for (size_t n = MIN_STMTS; n <= max_stmts; n *= 4) {
+        Row row = measure(n, n_edits, seed);
+        std::cout << std::setw(10) << row.stmts << std::setw(11) << row.bytes << std::fixed << std::setprecision(2)
+            << std::setw(11) << row.parse_ms << std::setw(11) << row.full_ms;
+        for (const EditMeasure& m : row.edits) {
+            std::ostringstream cell;
+            cell << std::fixed << std::setprecision(2) << m.micros << " (" << static_cast<size_t>(m.bytes_read) << ")";
+            if (m.full > 0) cell << " " << m.full << " full";
+            std::cout << std::setw(22) << cell.str();
+        }
+        std::cout << std::endl;
+        rows.push_back(row);
+    }
+
+    std::cout << std::endl << "growth from " << rows.front().stmts << " to " << rows.back().stmts << " statements:"
+        << " full parsing x" << std::setprecision(1) << rows.back().full_ms / rows.front().full_ms << std::endl;
+    bool pass = true;
+    for (int k = 0; k < NULL_VAL; k++) {
+        double growth = rows.back().edits[k].micros / rows.front().edits[k].micros;
+        bool bounded = k == STATEMENT || growth <= MAX_EDIT_GROWTH;
+        pass = pass && bounded;
+        std::cout << "  " << std::setw(12) << kindNames[k] << " edit x" << growth
+            << (bounded ? "" : "  SIZE-DEPENDENT") << std::endl;
+    }
+    return pass ? EXIT_SUCCESS : EXIT_FAILURE;
+}
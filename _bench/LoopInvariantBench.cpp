@@ -0,0 +1,26 @@
+#include <string>
+#include <vector>
+
+#include "../includes/LoopInvariantHoister.h"
+#include "PassBench.h"
+
+
+/* Loops whose guards and bodies recompute expressions of variables they never assign,
+run by the EvaluationVisitor and by the VirtualMachine before and after the LoopInvariantHoister */
+
+int main() {
+    const std::string n = "1000000";
+    std::vector<Kernel> kernels = {
+        { "guard", "(BLOCK (SET n " + n + ") (SET k 3) (SET i 0) (WHILE (AND (LT i (MUL n 2)) (NOT (EQ (MUL k k) 0))) (SET i (ADD i 1))))" },
+        { "body", "(BLOCK (SET n " + n + ") (SET a 7) (SET b 5) (SET i 0) (SET s 0) (WHILE (LT i n) (BLOCK "
+                  "(SET s (ADD s (MUL (ADD a b) (SUB a b)))) (SET s (SUB s (DIV (MUL a b) 3))) (SET i (ADD i 1)))))" },
+        { "nested", "(BLOCK (SET n 1000) (SET s 0) (SET i 0) (WHILE (LT i n) (BLOCK (SET j 0) (WHILE (LT j n) (BLOCK "
+                    "(SET s (ADD s (MUL i (MUL n 3)))) (SET j (ADD j 1)))) (SET i (ADD i 1)))))" },
+    };
+
+    return runPassBench(kernels, "hoisted", "licm", [](NodeFactory& nf, Program* prg) {
+        LoopInvariantHoister licm{ nf };
+        licm(prg);
+        return std::to_string(licm.get_n_hoisted());
+    });
+}
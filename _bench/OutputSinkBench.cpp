@@ -0,0 +1,52 @@
+#include <cstdio>
+#include <iostream>
+#include <iomanip>
+#include <string>
+
+#include "../includes/Visitor.h"
+#include "../includes/OutputSink.h"
+#include "BenchUtils.h"
+
+
+/* PRINT loops evaluated by the EvaluationVisitor writing on a temporary file through an OutputSink
+with each FlushPolicy, written by the evaluation thread and by the background writer (async).
+The LINE policy behaves like the former std::cout << val << std::endl (one write per value) */
+std::string makeProgram(long values) {
+    return "(BLOCK (SET i 0) (WHILE (LT i " + std::to_string(values) + ") (BLOCK (PRINT (MUL i 7919)) (SET i (ADD i 1)))))";
+}
+
+double runMs(Program* prg, OutputSink::FlushPolicy policy, bool async) {
+    std::FILE* f = std::tmpfile();
+    BenchClock::time_point start = BenchClock::now();
+    {
+        OutputSink out{ f, policy, async };
+        Runtime rt{ &out };
+        EvaluationVisitor eval{ &rt };
+        prg->accept(&eval);
+    }
+    double ms = millisSince(start);
+    std::fclose(f);
+    return ms;
+}
+
+int main() {
+    std::cout << std::setw(10) << "values" << std::setw(12) << "line ms" << std::setw(12) << "size ms"
+              << std::setw(12) << "end ms" << std::setw(14) << "async ms" << std::setw(10) << "speedup" << std::endl;
+
+    for (long values : { 10000L, 100000L, 1000000L }) {
+        NodeFactory nf;
+        Program* prg = parseSource(makeProgram(values), nf);
+
+        double lineMs = runMs(prg, OutputSink::LINE, false);
+        double sizeMs = runMs(prg, OutputSink::SIZE, false);
+        double endMs = runMs(prg, OutputSink::END, false);
+        double asyncMs = runMs(prg, OutputSink::SIZE, true);
+
+        std::cout << std::fixed << std::setprecision(1)
+                  << std::setw(10) << values << std::setw(12) << lineMs << std::setw(12) << sizeMs
+                  << std::setw(12) << endMs << std::setw(14) << asyncMs
+                  << std::setw(9) << lineMs / sizeMs << "x" << std::endl;
+        delete prg;
+    }
+    return 0;
+}
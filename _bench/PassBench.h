@@ -0,0 +1,68 @@
+#ifndef PASS_BENCH_H
+#define PASS_BENCH_H
+
+#include <algorithm>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../includes/Visitor.h"
+#include "../includes/Compiler.h"
+#include "../includes/VM.h"
+#include "BenchUtils.h"
+
+
+/* Harness of the benchmarks of a single optimization pass: each kernel is run by the EvaluationVisitor
+and by the VirtualMachine before and after the pass, in one row of the table */
+struct Kernel {
+    const char* name;
+    std::string src;
+};
+
+inline double runMs(Program* prg, bool vm) {
+    BenchClock::time_point start = BenchClock::now();
+    if (vm) {
+        BytecodeCompiler compile;
+        Chunk chunk = compile(prg);
+        VirtualMachine machine;
+        machine.run(chunk);
+    } else {
+        EvaluationVisitor eval;
+        prg->accept(&eval);
+    }
+    return millisSince(start);
+}
+
+/* Pass applied to the Program of a kernel, with its nodes made by the NodeFactory: it returns the text of the column
+"counted" (what the pass changed) */
+using PassRun = std::function<std::string(NodeFactory& nf, Program* prg)>;
+
+/* Table of the kernels: "counted" names the column of the changes and "after" the columns of the times after the pass.
+It returns the exit status of the benchmark */
+inline int runPassBench(const std::vector<Kernel>& kernels, const std::string& counted, const std::string& after, const PassRun& pass) {
+    const int count_w = std::max<int>(8, static_cast<int>(counted.size()) + 2);
+    const std::string after_ms = after + " ms";
+    std::cout << std::setw(8) << "kernel" << std::setw(count_w) << counted << std::setw(12) << "tree ms" << std::setw(12) << after_ms
+              << std::setw(10) << "vm ms" << std::setw(12) << after_ms << std::endl;
+    for (const Kernel& k : kernels) {
+        NodeFactory nf;
+        Program* prg = parseSource(k.src, nf);
+        double treeMs = runMs(prg, false);
+        double vmMs = runMs(prg, true);
+
+        std::string changes = pass(nf, prg);
+        double afterTreeMs = runMs(prg, false);
+        double afterVmMs = runMs(prg, true);
+
+        std::cout << std::fixed << std::setprecision(1)
+                  << std::setw(8) << k.name << std::setw(count_w) << changes
+                  << std::setw(12) << treeMs << std::setw(12) << afterTreeMs
+                  << std::setw(10) << vmMs << std::setw(12) << afterVmMs << std::endl;
+        delete prg;
+    }
+    return 0;
+}
+
+#endif /* PASS_BENCH_H */
@@ -0,0 +1,99 @@
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+
+/* Hardware counters of the calling thread read with perf_event_open (Linux only): cycles, instructions,
+branch misses and cache misses of the user space code, opened as a group so that they count the same interval.
+Where the counters can't be opened (another OS, a virtual machine without PMU, perf_event_paranoid too high)
+available() is false and the readings stay at 0; if the kernel multiplexes the group the values are scaled */
+class PerfCounters {
+public:
+    enum Event { CYCLES, INSTRUCTIONS, BRANCH_MISSES, CACHE_MISSES, NULL_VAL };
+
+    struct Reading {
+        uint64_t values[NULL_VAL] = {};
+    };
+
+    PerfCounters() {
+#if defined(__linux__)
+        static const uint64_t configs[NULL_VAL] = {
+            PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_BRANCH_MISSES, PERF_COUNT_HW_CACHE_MISSES
+        };
+        for (int e = 0; e < NULL_VAL; e++) {
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = configs[e];
+            attr.disabled = (e == 0) ? 1 : 0; // the group follows its leader
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            fds[e] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, (e == 0) ? -1 : fds[0], 0));
+            if (fds[e] < 0) {
+                close();
+                return;
+            }
+        }
+#endif
+    }
+
+    ~PerfCounters() { close(); }
+
+    PerfCounters(const PerfCounters& other) = delete;
+    PerfCounters& operator=(const PerfCounters& other) = delete;
+
+    bool available() const { return fds[0] >= 0; }
+
+    void start() {
+#if defined(__linux__)
+        if (!available()) return;
+        ioctl(fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+    }
+
+    // Counts since start()
+    Reading stop() {
+        Reading r;
+#if defined(__linux__)
+        if (!available()) return r;
+        ioctl(fds[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+        // nr, time_enabled, time_running, then one value for each event of the group
+        uint64_t buf[3 + NULL_VAL];
+        if (::read(fds[0], buf, sizeof(buf)) != static_cast<ssize_t>(sizeof(buf)) || buf[0] != NULL_VAL) return r;
+        double scale = (buf[2] > 0 && buf[2] < buf[1]) ? static_cast<double>(buf[1]) / buf[2] : 1.0;
+        for (int e = 0; e < NULL_VAL; e++) r.values[e] = static_cast<uint64_t>(buf[3 + e] * scale);
+#endif
+        return r;
+    }
+
+    static const char* event2String(Event e) {
+        static const char* names[NULL_VAL] = { "cycles", "instructions", "branch_misses", "cache_misses" };
+        return (e >= CYCLES && e < NULL_VAL) ? names[e] : "";
+    }
+
+private:
+    int fds[NULL_VAL] = { -1, -1, -1, -1 };
+
+    void close() {
+#if defined(__linux__)
+        for (int& fd : fds) {
+            if (fd >= 0) ::close(fd);
+            fd = -1;
+        }
+#endif
+    }
+};
+
+#endif /* PERF_COUNTERS_H */
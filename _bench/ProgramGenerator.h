@@ -0,0 +1,177 @@
+#ifndef PROGRAM_GENERATOR_H
+#define PROGRAM_GENERATOR_H
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+
+/* Generator of large valid programs for the benchmarks of the front end, with a tunable shape: the number
+of statements, the nesting depth of the IF and WHILE statements, the number of variables and the depth
+of the expressions. Every variable is set at the start of the main BLOCK, every WHILE runs its body once
+(a counter of its nesting level goes from 0 to 1) and every DIV divides by a constant other than 0:
+a generated program runs to its end without errors, with a time linear in its size.
+The same shape and seed give the same program; the text is written in a single pass, without recursion,
+so that the nesting and the expressions can be deeper than the stack of the generator */
+struct ProgramShape {
+    size_t statements = 1 << 12;  // statements in total, at least the SET of each variable
+    unsigned int depth = 4;       // maximum nesting of IF and WHILE statements (reached at least once)
+    unsigned int variables = 16;  // variables read and assigned by the statements, besides the loop counters
+    unsigned int expr_depth = 3;  // maximum nesting of the operators of an expression (reached by the first one)
+    uint32_t seed = 1;
+};
+
+class ProgramGenerator {
+public:
+    explicit ProgramGenerator(const ProgramShape& s) : shape{ s }, rnd{ s.seed } {
+        if (shape.variables == 0) shape.variables = 1;
+    }
+
+    std::string operator()() {
+        src.clear();
+        n_stmts = 0;
+        closers.clear();
+        deep_expr = true;
+
+        src += "(BLOCK\n";
+        for (unsigned int v = 0; v < shape.variables; v++) {
+            src += "(SET ";
+            src += name("v", v);
+            src += " ";
+            src += std::to_string(v % 97);
+            src += ")\n";
+            n_stmts++;
+        }
+        // The first statements open the deepest nesting, the other ones follow a random walk of the nesting
+        while (closers.size() < shape.depth && n_stmts + 3 <= shape.statements) open();
+        while (n_stmts < shape.statements) {
+            unsigned int dice = pick(16);
+            if (dice < 2 && closers.size() < shape.depth && n_stmts + 3 <= shape.statements) open();
+            else if (dice < 4 && !closers.empty()) close();
+            else simple();
+        }
+        while (!closers.empty()) close();
+        src += ")\n";
+        return std::move(src);
+    }
+
+    // Statements written by the last call, the SET and WHILE of the loop counters included
+    size_t get_n_stmts() const { return n_stmts; }
+
+    // VARIABLE_ID of only letters for the n-th variable with the given prefix
+    static std::string name(const char* prefix, size_t n) {
+        std::string id = prefix;
+        do {
+            id += static_cast<char>('a' + n % 26);
+            n /= 26;
+        } while (n > 0);
+        return id;
+    }
+
+private:
+    ProgramShape shape;
+    std::mt19937 rnd;
+    std::string src;
+    size_t n_stmts = 0;
+    bool deep_expr = true;                 // the next expression is the one of maximum depth
+    struct Open {
+        bool is_while;
+        bool empty;  // no statement in its BLOCK yet: an empty BLOCK is a syntax error
+    };
+    std::vector<Open> closers;             // statements open around the current point, the innermost last
+
+    unsigned int pick(unsigned int n) { return static_cast<unsigned int>(rnd() % n); }
+
+    void variable() { src += name("v", pick(shape.variables)); }
+
+    void leaf() {
+        if (pick(3) == 0) src += std::to_string(pick(10));
+        else variable();
+    }
+
+    // Left-leaning chain of operators: the opening parentheses first, then each right operand
+    void numExpr() {
+        unsigned int d = deep_expr ? shape.expr_depth : pick(shape.expr_depth + 1);
+        deep_expr = false;
+        std::vector<unsigned char> ops(d);
+        for (unsigned int i = 0; i < d; i++) {
+            static const char* names[] = { "(ADD ", "(SUB ", "(MUL ", "(DIV " };
+            ops[i] = static_cast<unsigned char>(pick(4));
+            src += names[ops[i]];
+        }
+        leaf();
+        for (unsigned int i = d; i-- > 0;) {
+            src += " ";
+            if (ops[i] == 3) src += std::to_string(2 + pick(8)); // never a division by 0 (nor by -1)
+            else leaf();
+            src += ")";
+        }
+    }
+
+    void boolExpr() {
+        static const char* rel[] = { "(LT ", "(GT ", "(EQ " };
+        unsigned int kind = pick(4);
+        if (kind == 3) src += pick(2) ? "(AND " : "(OR ";
+        src += rel[pick(3)];
+        numExpr();
+        src += " ";
+        numExpr();
+        src += ")";
+        if (kind == 3) {
+            src += " (NOT (EQ ";
+            variable();
+            src += " 0)))";
+        }
+    }
+
+    void simple() {
+        if (!closers.empty()) closers.back().empty = false;
+        if (pick(4) == 0) {
+            src += "(PRINT ";
+            numExpr();
+        } else {
+            src += "(SET ";
+            variable();
+            src += " ";
+            numExpr();
+        }
+        src += ")\n";
+        n_stmts++;
+    }
+
+    // IF with the BLOCK opened as its 1st branch, or WHILE run once with the BLOCK opened as its body
+    void open() {
+        if (!closers.empty()) closers.back().empty = false;
+        if (pick(2) == 0) {
+            src += "(IF ";
+            boolExpr();
+            src += " (BLOCK\n";
+            closers.push_back(Open{ false, true });
+            n_stmts++;
+        } else {
+            std::string counter = name("loop", closers.size());
+            src += "(SET " + counter + " 0)\n(WHILE (LT " + counter + " 1) (BLOCK\n";
+            closers.push_back(Open{ true, true });
+            n_stmts += 2;
+        }
+    }
+
+    void close() {
+        if (closers.back().empty) simple();
+        bool is_while = closers.back().is_while;
+        closers.pop_back();
+        if (!is_while) {
+            // 2nd branch of the IF
+            src += ") ";
+            simple();
+            src += ")\n";
+        } else {
+            std::string counter = name("loop", closers.size());
+            src += "(SET " + counter + " (ADD " + counter + " 1))))\n";
+            n_stmts++;
+        }
+    }
+};
+
+#endif /* PROGRAM_GENERATOR_H */
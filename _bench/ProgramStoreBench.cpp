@@ -0,0 +1,81 @@
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <filesystem>
+#include <sstream>
+#include <string>
+
+#include "../includes/SourceFile.h"
+#include "../includes/ProgramStore.h"
+#include "BenchUtils.h"
+
+
+/* Start of a run of multi-megabyte generated scripts: the source parsed, resolved and optimized at each run
+and the optimized program loaded from its image in the ProgramStore (mapped and run in place by the flat engine,
+rebuilt as a syntax tree and compiled by the bytecode engine). The times include the read of the source */
+
+// Program of about "bytes" characters: many statements with long VARIABLE_IDs and numbers
+std::string makeProgram(size_t bytes) {
+    std::stringstream src;
+    src << "(BLOCK\n  (INPUT limit)\n  (SET counter 0)\n  (SET total 1)\n";
+    for (long i = 0; static_cast<size_t>(src.tellp()) < bytes; i++) {
+        switch (i % 4) {
+            case 0: src << "  (SET total (ADD (MUL total 3) (SUB counter " << i << ")))\n"; break;
+            case 1: src << "  (IF (AND (GT total limit) (NOT (EQ counter -" << i << "))) (SET total (DIV total 7)) (SET counter (ADD counter 1)))\n"; break;
+            case 2: src << "  (BLOCK (SET index 0) (WHILE (LT index limit) (SET index (ADD index 1))))\n"; break;
+            default: src << "  (SET counter (SUB counter total))\n";
+        }
+    }
+    src << "  (PRINT total)\n)\n";
+    return src.str();
+}
+
+// Time of the preparation of the program in "file", best of 3
+template <typename Prepare>
+double bestOf3(const std::string& file, Prepare prepare) {
+    double best = 1e300;
+    for (int i = 0; i < 3; i++) {
+        BenchClock::time_point start = BenchClock::now();
+        SourceFile source{ file };
+        std::unique_ptr<PreparedProgram> program = prepare(source.text());
+        best = std::min(best, millisSince(start));
+    }
+    return best;
+}
+
+int main() {
+    std::filesystem::path dir = std::filesystem::temp_directory_path() / "lisp_store_bench";
+    std::filesystem::remove_all(dir);
+    std::string file = (std::filesystem::temp_directory_path() / "lisp_store_bench.txt").string();
+
+    std::cout << std::setw(6) << "MiB" << std::setw(8) << "engine" << std::setw(12) << "parse ms"
+              << std::setw(12) << "store ms" << std::setw(12) << "image ms" << std::setw(10) << "speedup" << std::endl;
+    for (size_t mib : { 1, 2, 4 }) {
+        {
+            std::ofstream out{ file };
+            out << makeProgram(mib << 20);
+        }
+        for (Options::Engine engine : { Options::FLAT, Options::VM }) {
+            Options opts;
+            opts.engine = engine;
+            double parseMs = bestOf3(file, [&opts](std::string_view src) { return std::make_unique<PreparedProgram>(src, opts); });
+
+            ProgramStore store{ (dir / (engine == Options::FLAT ? "flat" : "vm")).string(), opts };
+            BenchClock::time_point start = BenchClock::now();
+            {
+                SourceFile source{ file };
+                store.prepare(source.text());
+            }
+            double storeMs = millisSince(start);
+            double imageMs = bestOf3(file, [&store](std::string_view src) { return store.prepare(src); });
+
+            std::cout << std::setw(6) << mib << std::setw(8) << (engine == Options::FLAT ? "flat" : "vm")
+                      << std::setw(12) << std::fixed << std::setprecision(1) << parseMs << std::setw(12) << storeMs
+                      << std::setw(12) << imageMs << std::setw(9) << std::setprecision(2) << parseMs / imageMs << "x"
+                      << (store.get_n_hits() == 3 ? "" : "  (image not used)") << std::endl;
+        }
+    }
+    std::filesystem::remove_all(dir);
+    std::filesystem::remove(file);
+    return EXIT_SUCCESS;
+}
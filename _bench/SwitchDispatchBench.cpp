@@ -0,0 +1,52 @@
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+
+#include "../includes/Visitor.h"
+#include "../includes/SwitchEvaluator.h"
+#include "BenchUtils.h"
+
+
+/* Loops with deep arithmetic expressions, guards and branches evaluated on the syntax tree by the
+EvaluationVisitor (accept/visit and the accumulator) and by the SwitchEvaluator (switch on the kind of the nodes) */
+struct Kernel {
+    const char* name;
+    std::string source;
+};
+
+int main() {
+    std::vector<Kernel> kernels = {
+        { "count", "(BLOCK (SET i 0) (WHILE (LT i 2000000) (SET i (ADD i 1))))" },
+        { "arith", "(BLOCK (SET i 0) (SET s 0) (WHILE (LT i 1000000) (BLOCK "
+                   "(SET s (ADD s (SUB (MUL (ADD i 3) (ADD i 5)) (DIV (MUL i i) (ADD i 1))))) (SET i (ADD i 1)))))" },
+        { "branchy", "(BLOCK (SET i 0) (SET s 0) (WHILE (LT i 1000000) (BLOCK "
+                     "(IF (AND (GT s 1000) (NOT (EQ i 0))) (SET s (SUB s 1000)) (SET s (ADD s i))) (SET i (ADD i 1)))))" },
+        { "nested", "(BLOCK (SET i 0) (WHILE (LT i 1000) (BLOCK (SET j 0) "
+                    "(WHILE (LT j 1000) (SET j (ADD j 1))) (SET i (ADD i 1)))))" },
+    };
+
+    std::cout << std::setw(10) << "kernel" << std::setw(12) << "visitor ms" << std::setw(12) << "switch ms"
+              << std::setw(10) << "speedup" << std::endl;
+    for (const Kernel& k : kernels) {
+        NodeFactory nf;
+        Program* prg = parseSource(k.source, nf);
+
+        BenchClock::time_point start = BenchClock::now();
+        EvaluationVisitor visitor;
+        prg->accept(&visitor);
+        double visitorMs = millisSince(start);
+
+        start = BenchClock::now();
+        SwitchEvaluator eval;
+        eval.run(prg);
+        double switchMs = millisSince(start);
+
+        std::cout << std::setw(10) << k.name
+                  << std::setw(12) << std::fixed << std::setprecision(2) << visitorMs
+                  << std::setw(12) << switchMs
+                  << std::setw(9) << std::setprecision(1) << visitorMs / switchMs << "x" << std::endl;
+        delete(prg);
+    }
+    return EXIT_SUCCESS;
+}
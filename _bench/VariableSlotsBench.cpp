@@ -0,0 +1,102 @@
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+
+#include "../includes/Visitor.h"
+#include "BenchUtils.h"
+
+// Number of loop iterations of every generated program and SET statements in the loop body
+constexpr int ITERATIONS = 20000;
+constexpr int BODY_SETS = 16;
+
+// VARIABLE_IDs can only be made of letters: the index is written in base 26
+std::string varName(int i) {
+    std::string s = "v";
+    do {
+        s += static_cast<char>('a' + i % 26);
+        i /= 26;
+    } while (i > 0);
+    return s;
+}
+
+/* Program with "nvars" distinct variables, all declared up front, and a WHILE loop whose body
+updates BODY_SETS of them spread over the whole set: the work per iteration is fixed, only the
+number of distinct VARIABLE_IDs grows */
+std::string makeProgram(int nvars) {
+    std::stringstream src;
+    src << "(BLOCK\n";
+    for (int i = 0; i < nvars; i++) src << "  (SET " << varName(i) << " " << i << ")\n";
+    src << "  (SET i 0)\n";
+    src << "  (WHILE (LT i " << ITERATIONS << ")\n    (BLOCK\n";
+    for (int k = 0; k < BODY_SETS; k++) {
+        int dst = (k * 7919) % nvars;
+        int src1 = (k * 104729 + 1) % nvars;
+        src << "      (SET " << varName(dst) << " (SUB " << varName(src1) << " " << varName(dst) << "))\n";
+    }
+    src << "      (SET i (ADD i 1)))))\n";
+    return src.str();
+}
+
+int main() {
+    std::cout << "Accesses per iteration: " << 3 * BODY_SETS << ", iterations: " << ITERATIONS << std::endl;
+    std::cout << std::setw(8) << "vars"
+              << std::setw(14) << "eval ms"
+              << std::setw(16) << "map ns/access"
+              << std::setw(17) << "slot ns/access"
+              << std::setw(10) << "gain" << std::endl;
+
+    for (int nvars : { 1, 4, 16, 64, 256, 1024, 4096 }) {
+        NodeFactory nf;
+        Program* prg = parseSource(makeProgram(nvars), nf);
+
+        // End-to-end evaluation with the slot based EvaluationVisitor
+        BenchClock::time_point start = BenchClock::now();
+        EvaluationVisitor eval;
+        prg->accept(&eval);
+        double evalMs = millisSince(start);
+
+        /* Replay of the same access pattern on the two storage strategies:
+        the std::map keyed by VARIABLE_ID used before and the flat array indexed by slot */
+        const std::vector<std::string>& ids = prg->get_var_ids();
+        std::vector<std::string> pattern;
+        std::vector<int> slotPattern;
+        for (int k = 0; k < BODY_SETS; k++) {
+            int dst = (k * 7919) % nvars;
+            int src1 = (k * 104729 + 1) % nvars;
+            for (int v : { src1, dst, dst }) {
+                pattern.push_back(varName(v));
+                for (unsigned int s = 0; s < ids.size(); s++)
+                    if (ids[s] == pattern.back()) slotPattern.push_back(s);
+            }
+        }
+
+        std::map<std::string, int64_t> byName;
+        for (const std::string& id : ids) byName[id] = 1;
+        std::vector<int64_t> bySlot(ids.size(), 1);
+
+        int64_t sink = 0;
+        start = BenchClock::now();
+        for (int it = 0; it < ITERATIONS; it++)
+            for (const std::string& id : pattern) sink += byName.find(id)->second++;
+        double mapNs = millisSince(start) * 1e6 / (double(ITERATIONS) * pattern.size());
+
+        start = BenchClock::now();
+        for (int it = 0; it < ITERATIONS; it++)
+            for (int s : slotPattern) sink += bySlot[s]++;
+        double slotNs = millisSince(start) * 1e6 / (double(ITERATIONS) * slotPattern.size());
+
+        std::cout << std::setw(8) << nvars
+                  << std::setw(14) << std::fixed << std::setprecision(2) << evalMs
+                  << std::setw(16) << std::setprecision(3) << mapNs
+                  << std::setw(17) << slotNs
+                  << std::setw(9) << std::setprecision(1) << (mapNs / slotNs) << "x" << std::endl;
+        // the accumulated value keeps the replay loops from being optimized away
+        volatile int64_t keep = sink; (void)keep;
+        delete(prg);
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,68 @@
+#include <iostream>
+#include <iomanip>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "../includes/Visitor.h"
+#include "../includes/Compiler.h"
+#include "../includes/VM.h"
+#include "../includes/Jit.h"
+#include "BenchUtils.h"
+
+
+/* Tight WHILE loops run on the EvaluationVisitor, on the bytecode VirtualMachine and as native code
+(JitCompiler, only where supported) */
+struct Kernel {
+    const char* name;
+    std::string source;
+};
+
+int main() {
+    std::vector<Kernel> kernels = {
+        { "count", "(BLOCK (SET i 0) (WHILE (LT i 2000000) (SET i (ADD i 1))))" },
+        { "sum", "(BLOCK (SET i 0) (SET s 0) (WHILE (LT i 1000000) (BLOCK (SET s (ADD s (MUL i 3))) (SET i (ADD i 1)))))" },
+        { "branchy", "(BLOCK (SET i 0) (SET s 0) (WHILE (LT i 1000000) (BLOCK "
+                     "(IF (AND (GT s 1000) (NOT (EQ i 0))) (SET s (SUB s 1000)) (SET s (ADD s i))) (SET i (ADD i 1)))))" },
+        { "nested", "(BLOCK (SET i 0) (WHILE (LT i 1000) (BLOCK (SET j 0) "
+                    "(WHILE (LT j 1000) (SET j (ADD j 1))) (SET i (ADD i 1)))))" },
+    };
+
+    std::cout << std::setw(10) << "kernel" << std::setw(12) << "tree ms" << std::setw(12) << "vm ms" << std::setw(10) << "speedup";
+    if (JitCompiler::isSupported()) std::cout << std::setw(12) << "jit ms" << std::setw(10) << "speedup";
+    std::cout << std::endl;
+    for (const Kernel& k : kernels) {
+        NodeFactory nf;
+        Program* prg = parseSource(k.source, nf);
+
+        BenchClock::time_point start = BenchClock::now();
+        EvaluationVisitor eval;
+        prg->accept(&eval);
+        double treeMs = millisSince(start);
+
+        BytecodeCompiler compile;
+        Chunk chunk = compile(prg);
+        start = BenchClock::now();
+        VirtualMachine vm;
+        vm.run(chunk);
+        double vmMs = millisSince(start);
+
+        std::cout << std::setw(10) << k.name
+                  << std::setw(12) << std::fixed << std::setprecision(2) << treeMs
+                  << std::setw(12) << vmMs
+                  << std::setw(9) << std::setprecision(1) << treeMs / vmMs << "x";
+
+        if (JitCompiler::isSupported()) {
+            JitCompiler jit;
+            std::unique_ptr<JitProgram> native{ jit(prg) };
+            start = BenchClock::now();
+            native->run();
+            double jitMs = millisSince(start);
+            std::cout << std::setw(12) << std::setprecision(2) << jitMs
+                      << std::setw(9) << std::setprecision(1) << treeMs / jitMs << "x";
+        }
+        std::cout << std::endl;
+        delete(prg);
+    }
+    return EXIT_SUCCESS;
+}
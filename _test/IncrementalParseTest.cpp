@@ -0,0 +1,347 @@
+#include <algorithm>
+#include <dirent.h>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+#include "../includes/IncrementalParser.h"
+#include "../_bench/ProgramGenerator.h"
+
+// Build: g++ -std=c++17 -O2 -pthread -o IncrementalParseTest IncrementalParseTest.cpp ../includes/*.cpp
+
+// Random edits applied to each source
+constexpr int EDITS = 400;
+// Edits after which an invalid source is brought back to the last valid one
+constexpr int MAX_INVALID = 6;
+// Edits of the digits of a valid source, made to reach the compactions of the IncrementalParser
+constexpr int COMPACTION_EDITS = 20000;
+
+// Text of the tree of a Program: kind, line and values of every node
+void dump(NumExpr* e, std::string& out) {
+    switch (e->get_kind()) {
+        case NumExpr::OPERATOR: {
+            Operator* op = static_cast<Operator*> (e);
+            out += "(op" + std::to_string(op->getOp()) + " ";
+            dump(op->getFirst(), out);
+            out += " ";
+            dump(op->getSecond(), out);
+            out += ")";
+            break;
+        }
+        case NumExpr::NUMBER: out += std::to_string(static_cast<Number*> (e)->get_value()); break;
+        case NumExpr::VARIABLE: out += static_cast<Variable*> (e)->get_id(); break;
+        case NumExpr::CHECKED_VARIABLE: {
+            CheckedVariable* v = static_cast<CheckedVariable*> (e);
+            out += v->get_id() + "!" + v->undeclaredMessage();
+            break;
+        }
+    }
+}
+
+void dump(BoolExpr* e, std::string& out) {
+    switch (e->get_kind()) {
+        case BoolExpr::REL_OP: {
+            RelOp* r = static_cast<RelOp*> (e);
+            out += "(rel" + std::to_string(r->get_r_opcode()) + " ";
+            dump(r->get_first_nexpr(), out);
+            out += " ";
+            dump(r->get_second_nexpr(), out);
+            out += ")";
+            break;
+        }
+        case BoolExpr::BOOL_CONST: out += std::to_string(static_cast<BoolConst*> (e)->get_bconst()); break;
+        case BoolExpr::BOOL_OP: {
+            BoolOp* b = static_cast<BoolOp*> (e);
+            out += "(bool" + std::to_string(b->get_b_opcode()) + " ";
+            dump(b->get_f_bexpr(), out);
+            if (b->get_s_bexpr() != nullptr) {
+                out += " ";
+                dump(b->get_s_bexpr(), out);
+            }
+            out += ")";
+            break;
+        }
+    }
+}
+
+// The lines are the ones given by "lines" if any (see IncrementalParser::line()), the ones of the nodes otherwise
+void dump(Block* blk, std::string& out, IncrementalParser* lines = nullptr) {
+    out += "{";
+    for (Statement* s : blk->get_stmts()) {
+        out += "\n" + std::to_string(lines != nullptr ? lines->line(s) : s->get_line()) + ":";
+        switch (s->get_kind()) {
+            case Statement::SET:
+                out += "SET " + static_cast<SetStmt*> (s)->get_var()->get_id() + " ";
+                dump(static_cast<SetStmt*> (s)->get_nexpr(), out);
+                break;
+            case Statement::INPUT: out += "INPUT " + static_cast<InputStmt*> (s)->get_var()->get_id(); break;
+            case Statement::PRINT:
+                out += "PRINT ";
+                dump(static_cast<PrintStmt*> (s)->get_nexpr(), out);
+                break;
+            case Statement::IF: {
+                IfStmt* stmt = static_cast<IfStmt*> (s);
+                out += "IF ";
+                dump(stmt->get_bexpr(), out);
+                dump(stmt->get_stmt_block1(), out, lines);
+                dump(stmt->get_stmt_block2(), out, lines);
+                break;
+            }
+            case Statement::WHILE: {
+                WhileStmt* stmt = static_cast<WhileStmt*> (s);
+                out += "WHILE ";
+                dump(stmt->get_bexpr(), out);
+                dump(stmt->get_stmt_block(), out, lines);
+                break;
+            }
+        }
+    }
+    out += "}";
+}
+
+// Tree of the Program, or kind and message of the error, given by a parsing of the whole source
+std::string fullParse(const std::string& src) {
+    NodeFactory nf;
+    ParseProgram parse{ nf };
+    std::string out;
+    try {
+        Program* prg = parse(src);
+        dump(prg->get_blk(), out);
+        delete prg;
+    } catch (LexicalError& e) {
+        out = std::string{ "LexicalError " } + e.what();
+    } catch (SyntaxError& e) {
+        out = std::string{ "SyntaxError " } + e.what();
+    }
+    return out;
+}
+
+std::string incrementalParse(IncrementalParser& parser, const std::string& src, const TextEdit* e) {
+    std::string out;
+    try {
+        Program* prg = (e != nullptr) ? parser.edit(src, *e) : parser.parse(src);
+        dump(prg->get_blk(), out, &parser);
+    } catch (LexicalError& e) {
+        out = std::string{ "LexicalError " } + e.what();
+    } catch (SyntaxError& e) {
+        out = std::string{ "SyntaxError " } + e.what();
+    }
+    return out;
+}
+
+
+/* Random edits of a source like the ones of an editor: characters typed or deleted, tokens and statements
+inserted, removed or replaced, lines added or joined */
+class Editor {
+public:
+    explicit Editor(uint32_t seed) : rnd{ seed } {}
+
+    TextEdit next(std::string& src) {
+        static const char* snippets[] = {
+            "(SET x 1)", "(PRINT -2)", "\n(PRINT x)\n", "(SET y (ADD x 3))", "(IF TRUE (PRINT 1) (PRINT 0))",
+            "(WHILE FALSE (BLOCK (SET z 0)))", "(BLOCK (PRINT 7) (INPUT w))", " ", "\n", "(", ")", "-", "x", "5",
+            "BLOCK", "ADD", "0", "9", "(ADD 1 2)", "(SUB x -4)", "yz", "\n\n", "(BLOCK", ") (",
+        };
+        TextEdit e;
+        e.offset = pick(src.size() + 1);
+        unsigned int kind = pick(8);
+        if (kind < 3) {
+            // characters or tokens typed
+            std::string text = snippets[pick(sizeof(snippets) / sizeof(snippets[0]))];
+            src.insert(e.offset, text);
+            e.inserted = text.size();
+        } else if (kind < 5) {
+            // characters deleted
+            e.removed = std::min<size_t>(src.size() - e.offset, 1 + pick(kind == 3 ? 2 : 12));
+            src.erase(e.offset, e.removed);
+        } else if (kind < 7) {
+            // statement between parentheses removed or replaced, or a digit changed
+            size_t open = src.find('(', e.offset);
+            if (open == std::string::npos) return next(src);
+            size_t close = matching(src, open);
+            e.offset = open;
+            e.removed = close - open;
+            std::string text = (kind == 5) ? "" : snippets[pick(7)];
+            src.replace(open, e.removed, text);
+            e.inserted = text.size();
+        } else {
+            size_t digit = src.find_first_of("0123456789", e.offset);
+            if (digit == std::string::npos) return next(src);
+            e.offset = digit;
+            e.removed = 1;
+            e.inserted = 1;
+            src[digit] = static_cast<char>('1' + pick(9));
+        }
+        return e;
+    }
+
+    unsigned int pick(size_t n) { return static_cast<unsigned int>(rnd() % n); }
+
+private:
+    std::mt19937 rnd;
+
+    static size_t matching(const std::string& src, size_t open) {
+        int depth = 0;
+        for (size_t i = open; i < src.size(); i++) {
+            if (src[i] == '(') depth++;
+            else if (src[i] == ')' && --depth == 0) return i + 1;
+        }
+        return src.size();
+    }
+};
+
+// Single edit from "from" to "to": the text between their common prefix and suffix
+TextEdit difference(const std::string& from, const std::string& to) {
+    size_t prefix = 0;
+    while (prefix < from.size() && prefix < to.size() && from[prefix] == to[prefix]) prefix++;
+    size_t suffix = 0;
+    while (suffix < from.size() - prefix && suffix < to.size() - prefix
+        && from[from.size() - 1 - suffix] == to[to.size() - 1 - suffix]) suffix++;
+    return TextEdit{ prefix, from.size() - prefix - suffix, to.size() - prefix - suffix };
+}
+
+
+struct Result {
+    int edits = 0;
+    int partial = 0;  // edits parsed without the whole source
+    bool pass = true;
+};
+
+/* Random edits of "src": after each one the result of the IncrementalParser must be the one of a parsing
+of the whole new source. An invalid source is edited further, then brought back to the last valid one.
+At the end the lines written in the nodes by update_lines() must be the ones of the last valid source */
+void check(const std::string& name, std::string src, uint32_t seed, Result& r) {
+    IncrementalParser parser;
+    Editor editor{ seed };
+    std::string expected = fullParse(src);
+    if (incrementalParse(parser, src, nullptr) != expected) {
+        std::cout << name << ": first parsing differs" << std::endl;
+        r.pass = false;
+        return;
+    }
+    std::string valid = src;
+    int invalid = 0;
+    for (int i = 0; i < EDITS; i++) {
+        std::string before = src;
+        TextEdit e;
+        if (invalid >= MAX_INVALID) {
+            e = difference(src, valid);
+            src = valid;
+        } else {
+            e = editor.next(src);
+        }
+        expected = fullParse(src);
+        std::string got = incrementalParse(parser, src, &e);
+        r.edits++;
+        if (!parser.get_stats().full) r.partial++;
+        if (got != expected) {
+            std::cout << name << ": edit " << i << " at " << e.offset << " (-" << e.removed << " +" << e.inserted
+                << ") differs\n--- source before\n" << before << "\n--- source after\n" << src
+                << "\n--- expected\n" << expected << "\n--- got\n" << got << std::endl;
+            r.pass = false;
+            return;
+        }
+        bool error = expected.compare(0, 5, "Lexic") == 0 || expected.compare(0, 6, "Syntax") == 0;
+        if (error) {
+            invalid++;
+        } else {
+            invalid = 0;
+            valid = src;
+        }
+    }
+    // no Program if no source was valid
+    if (parser.get_program() == nullptr) return;
+    parser.update_lines();
+    std::string got;
+    dump(parser.get_program()->get_blk(), got);
+    if (got != fullParse(valid)) {
+        std::cout << name << ": lines of the nodes after update_lines() differ" << std::endl;
+        r.pass = false;
+    }
+}
+
+/* Many edits of the digits of a valid source: the nodes replaced by the edits must be released by the compactions,
+the nodes kept staying within the ones of the Program, the ones of the edits before a compaction and the ones
+of a last edit */
+void checkCompaction(const std::string& name, std::string src, uint32_t seed, Result& r) {
+    NodeFactory counted;
+    ParseProgram count{ counted };
+    delete count(src);
+    const unsigned int live = counted.get_n_nodes();
+    const unsigned int bound = 3 * live + IncrementalParser::MIN_COMPACTION_NODES;
+
+    IncrementalParser parser;
+    Editor editor{ seed };
+    parser.parse(src);
+    unsigned int max_nodes = 0;
+    int compactions = 0;
+    for (int i = 0; i < COMPACTION_EDITS; i++) {
+        size_t digit = src.find_first_of("0123456789", editor.pick(src.size()));
+        if (digit == std::string::npos) continue;
+        src[digit] = static_cast<char>('1' + editor.pick(9));
+        parser.edit(src, TextEdit{ digit, 1, 1 });
+        r.edits++;
+        if (parser.get_stats().full) compactions++;
+        else r.partial++;
+        max_nodes = std::max(max_nodes, parser.get_n_nodes());
+    }
+    std::string got;
+    dump(parser.get_program()->get_blk(), got);
+    if (compactions == 0 || max_nodes > bound || got != fullParse(src)) {
+        std::cout << name << ": " << compactions << " compactions, at most " << max_nodes << " nodes kept for "
+            << live << " nodes of the Program (bound " << bound << ")" << (got != fullParse(src) ? ", Program differs" : "")
+            << std::endl;
+        r.pass = false;
+    }
+}
+
+std::vector<std::string> corpus(const std::string& dir) {
+    std::vector<std::string> files;
+    if (DIR* d = opendir(dir.c_str())) {
+        while (dirent* entry = readdir(d)) {
+            std::string file = entry->d_name;
+            if (file.size() > 4 && file.compare(file.size() - 4, 4, ".txt") == 0) files.push_back(dir + "/" + file);
+        }
+        closedir(d);
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+
+int main(int argc, char* argv[]) {
+    // argv[1] can give the directory of the sources of the tests
+    std::string dir = (argc > 1) ? argv[1] : "TestFiles";
+    Result r;
+    uint32_t seed = 1;
+    for (const std::string& file : corpus(dir)) {
+        std::ifstream in{ file };
+        std::stringstream text;
+        text << in.rdbuf();
+        check(file, text.str(), seed++, r);
+    }
+    for (unsigned int depth : { 0u, 2u, 6u }) {
+        ProgramShape shape;
+        shape.statements = 200;
+        shape.depth = depth;
+        shape.variables = 4;
+        shape.seed = depth + 1;
+        check("generated program of depth " + std::to_string(depth), ProgramGenerator{ shape }(), seed++, r);
+    }
+
+    ProgramShape shape;
+    shape.statements = 200;
+    shape.depth = 2;
+    shape.seed = 7;
+    checkCompaction("compaction of a generated program", ProgramGenerator{ shape }(), seed++, r);
+
+    std::cout << r.edits << " edits, " << r.partial << " parsed without the whole source" << std::endl;
+    // most of the edits of valid sources touch only some statements
+    bool pass = r.pass && r.edits > 0 && r.partial * 4 >= r.edits;
+    std::cout << (pass ? "Incremental parsing: SUCCESS" : "Incremental parsing: FAILED") << std::endl;
+    return pass ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,158 @@
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+#include "../includes/Parser.h"
+#include "../includes/IncrementalParser.h"
+
+// Build: g++ -std=c++17 -O2 -pthread -o ParserScalingTest ParserScalingTest.cpp ../includes/*.cpp
+
+// Sizes of the programs, doubled from MIN_STMTS up to the maximum (1M statements by default)
+constexpr size_t MIN_STMTS = 1 << 16;
+constexpr size_t MAX_STMTS = 1 << 20;
+// Maximum growth of the time and memory per statement between the smallest and the largest program:
+// a parser quadratic in the number of statements would give a growth of MAX_STMTS / MIN_STMTS
+constexpr double MAX_TIME_GROWTH = 3.0;
+constexpr double MAX_MEMORY_GROWTH = 1.2;
+constexpr int RUNS = 3;
+// Lines joined and split again by the IncrementalParser in each program, and maximum growth of the time of an edit:
+// an edit that moves the line of all the statements after it would give a growth of MAX_STMTS / MIN_STMTS
+constexpr int EDITS = 2000;
+constexpr double MAX_EDIT_GROWTH = 3.0;
+
+// BLOCK of n statements: n - 2 PRINT, SET and IF statements, each on its own line, and one WHILE
+std::string flatProgram(size_t n) {
+    std::string src = "(BLOCK\n(SET x 1)\n";
+    for (size_t i = 2; i < n; i++) {
+        switch (i % 3) {
+            case 0: src += "(PRINT (ADD x " + std::to_string(i) + "))\n"; break;
+            case 1: src += "(SET x (MUL x 3))\n"; break;
+            case 2: src += "(IF (GT x 100) (SET x 0) (PRINT x))\n"; break;
+        }
+    }
+    src += "(WHILE (LT x 10) (SET x (ADD x 1)))\n)\n";
+    return src;
+}
+
+// n statements nested one into the other: WHILE and IF alternated around a PRINT
+std::string nestedProgram(size_t n) {
+    std::string src;
+    for (size_t i = 1; i < n; i++) src += (i % 2) ? "(WHILE FALSE " : "(IF TRUE ";
+    src += "(PRINT 1)";
+    for (size_t i = n - 1; i >= 1; i--) src += (i % 2) ? ")" : " (PRINT 0))";
+    return src;
+}
+
+struct Measure {
+    double nanos_per_stmt;
+    double bytes_per_stmt;
+};
+
+// Best time of RUNS parsings of "src" and memory used by its nodes
+Measure measure(const std::string& src, size_t n_stmts) {
+    NodeFactory nf;
+    ParseProgram parse{ nf };
+    double best = 0;
+    size_t bytes = 0;
+    for (int r = 0; r < RUNS; r++) {
+        nf.clear_memory();
+        auto start = std::chrono::steady_clock::now();
+        Program* prg = parse(src);
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        delete prg;
+        best = (r == 0) ? ns : std::min(best, ns);
+        bytes = nf.get_arena().get_bytes_used();
+    }
+    return Measure{ best / n_stmts, static_cast<double>(bytes) / n_stmts };
+}
+
+// Parsing of programs of growing size made by "generate": it returns false if the cost per statement grows
+bool checkScaling(const char* name, std::string (*generate)(size_t), size_t max_stmts) {
+    std::cout << name << std::endl;
+    Measure first{};
+    Measure last{};
+    for (size_t n = MIN_STMTS; n <= max_stmts; n *= 2) {
+        std::string src = generate(n);
+        Measure m;
+        try {
+            m = measure(src, n);
+        } catch (std::exception& e) {
+            std::cout << "  " << n << " statements: " << e.what() << std::endl;
+            return false;
+        }
+        if (n == MIN_STMTS) first = m;
+        last = m;
+        std::cout << "  " << n << " statements: " << m.nanos_per_stmt << " ns/stmt, "
+            << m.bytes_per_stmt << " bytes/stmt" << std::endl;
+    }
+    double time_growth = last.nanos_per_stmt / first.nanos_per_stmt;
+    double memory_growth = last.bytes_per_stmt / first.bytes_per_stmt;
+    bool pass = time_growth <= MAX_TIME_GROWTH && memory_growth <= MAX_MEMORY_GROWTH;
+    std::cout << "  growth per statement: time x" << time_growth << ", memory x" << memory_growth << std::endl;
+    std::cout << (pass ? "SUCCESS" : "FAILED") << std::endl << std::endl;
+    return pass;
+}
+
+/* Edits of the lines of flatProgram(n) with the IncrementalParser: the new line before a random statement replaced
+by a space, then put back. It returns false if the time of an edit grows with the statements */
+bool checkLineEdits(size_t max_stmts) {
+    std::cout << "Edits changing the lines of a BLOCK" << std::endl;
+    double first = 0;
+    double last = 0;
+    for (size_t n = MIN_STMTS; n <= max_stmts; n *= 2) {
+        std::string src = flatProgram(n);
+        std::vector<size_t> breaks;
+        for (size_t p = 1; p < src.size(); p++) {
+            if (src[p] == '(' && src[p - 1] == '\n') breaks.push_back(p - 1);
+        }
+        IncrementalParser parser;
+        std::mt19937 rnd{ 1 };
+        double best = 0;
+        try {
+            parser.parse(src);
+            for (int r = 0; r < RUNS; r++) {
+                auto start = std::chrono::steady_clock::now();
+                for (int e = 0; e < EDITS; e++) {
+                    size_t p = breaks[rnd() % breaks.size()];
+                    src[p] = ' ';
+                    parser.edit(src, TextEdit{ p, 1, 1 });
+                    src[p] = '\n';
+                    parser.edit(src, TextEdit{ p, 1, 1 });
+                }
+                double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / (2 * EDITS);
+                best = (r == 0) ? ns : std::min(best, ns);
+            }
+        } catch (std::exception& e) {
+            std::cout << "  " << n << " statements: " << e.what() << std::endl;
+            return false;
+        }
+        if (n == MIN_STMTS) first = best;
+        last = best;
+        std::cout << "  " << n << " statements: " << best << " ns/edit" << std::endl;
+    }
+    double growth = last / first;
+    bool pass = growth <= MAX_EDIT_GROWTH;
+    std::cout << "  growth per edit: time x" << growth << std::endl;
+    std::cout << (pass ? "SUCCESS" : "FAILED") << std::endl << std::endl;
+    return pass;
+}
+
+
+int main(int argc, char* argv[]) {
+    // argv[1] can give the maximum number of statements
+    size_t max_stmts = MAX_STMTS;
+    if (argc > 1) max_stmts = std::max<size_t>(MIN_STMTS, std::strtoull(argv[1], nullptr, 10));
+
+    bool pass = checkScaling("BLOCK of sibling statements", flatProgram, max_stmts);
+    // the nesting depth doesn't use the C++ stack of the parser
+    pass = checkScaling("Nested statements", nestedProgram, max_stmts) && pass;
+    // the edits of the IncrementalParser don't move the lines of the statements after them
+    pass = checkLineEdits(max_stmts) && pass;
+
+    std::cout << (pass ? "Linear parsing: SUCCESS" : "Linear parsing: FAILED") << std::endl;
+    return pass ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,242 @@
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+#include "../includes/Interpreter.h"
+#include "../includes/Options.h"
+#include "../includes/WorkStealingPool.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define TEST_RUNNER_ISOLATE 1
+#include <fcntl.h>
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
+#endif
+
+// Build: g++ -std=c++17 -O2 -pthread -o TestRunner TestRunner.cpp ../includes/*.cpp
+
+/* Runner of the same tests of TestProgram, with the interpreter linked as a library (see Interpreter):
+every <testname>.txt of the test directory is run in process on a WorkStealingPool, with no INPUT values
+and its output and error kept in memory, instead of a shell running the interpreter on a shared log file.
+The checks are the ones of TestProgram: a FAIL test passes if its log contains an ERROR, a PASS test
+if its log is the same as <testname>.out line by line (spaces trimmed).
+The results are written in the order of the names, with the time of each test.
+The tests run in process assume programs that don't crash the interpreter: a crash stops the whole run.
+With --isolate each test runs in a child process (the runner started again with --run-one on the test),
+so a crash is reported as a failed test (CRASHED) and the other tests go on. A CRASH test must be stopped
+by a signal after writing its <testname>.out: the child writes the output on stdout while the program runs,
+so the check covers the text that reaches stdout before the crash. It runs only with --isolate (SKIPPED otherwise):
+the CRASH tests are kept in CrashFiles, out of the directory of TestProgram, whose shell reports the signal in the log */
+
+namespace fsys = std::filesystem;
+
+constexpr const char* INPUT_EXT = ".txt";
+constexpr const char* OUTPUT_EXT = ".out";
+
+const char* ws = " \t\n\r\f\v";
+
+inline std::string& trim(std::string& s, const char* t = ws) {
+    s.erase(s.find_last_not_of(t) + 1);
+    s.erase(0, s.find_first_not_of(t));
+    return s;
+}
+
+// Same contents, line by line, as areSame() of TestProgram
+bool areSame(std::istream& log, std::istream& expected) {
+    while (!log.eof() && !expected.eof()) {
+        std::string l1; std::string l2;
+        std::getline(log, l1);
+        std::getline(expected, l2);
+        trim(l1); trim(l2);
+        if (l1 != l2) return false;
+    }
+    return log.eof() && expected.eof();
+}
+
+bool containsError(const std::string& log) {
+    return log.find("ERROR") != std::string::npos;
+}
+
+struct Test {
+    fsys::path input;
+    bool pass = false;
+    bool skipped = false;
+    std::string crash{};  // signal that stopped the child process of the test
+    double ms = 0;
+};
+
+// stdout and stderr of the interpreter in the same log, the output coming before the error
+std::string runInProcess(const Interpreter& interpreter, const fsys::path& input) {
+    std::ifstream src{ input, std::ios::binary };
+    std::stringstream source;
+    source << src.rdbuf();
+    Interpreter::Result result = interpreter.run(source.str());
+    return result.output + result.error;
+}
+
+// Run of the child process of --isolate: the output is written on stdout as the program runs, then the error
+void runOnStdout(const Interpreter& interpreter, const fsys::path& input) {
+    std::ifstream src{ input, std::ios::binary };
+    std::stringstream source;
+    source << src.rdbuf();
+    Interpreter::Result result = interpreter.run(source.str(), "", stdout);
+    std::fputs(result.error.c_str(), stdout);
+}
+
+#ifdef TEST_RUNNER_ISOLATE
+/* Log of the test written on the stdout of a child process running "self" with --run-one: the child is spawned,
+not forked, since the other threads of the pool may hold locks */
+std::string runIsolated(const std::string& self, const std::string& engine, Test& test) {
+    int fds[2];
+    if (::pipe(fds) != 0) {
+        test.crash = "pipe() failed";
+        return "";
+    }
+    // the read end isn't inherited by the children of the other tests
+    ::fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+    ::fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+    std::string args[] = { self, "--run-one=" + test.input.string(), "--engine=" + engine };
+    char* argv[] = { &args[0][0], &args[1][0], &args[2][0], nullptr };
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_adddup2(&actions, fds[1], STDOUT_FILENO);
+    pid_t pid;
+    int spawned = ::posix_spawn(&pid, self.c_str(), &actions, nullptr, argv, environ);
+    posix_spawn_file_actions_destroy(&actions);
+    ::close(fds[1]);
+
+    std::string log;
+    if (spawned == 0) {
+        char chunk[4096];
+        for (ssize_t n; (n = ::read(fds[0], chunk, sizeof(chunk))) > 0;) log.append(chunk, static_cast<size_t>(n));
+    }
+    ::close(fds[0]);
+    int status = 0;
+    if (spawned != 0 || ::waitpid(pid, &status, 0) != pid) test.crash = "spawn failed";
+    else if (WIFSIGNALED(status)) test.crash = "signal " + std::to_string(WTERMSIG(status));
+    return log;
+}
+#endif
+
+void runTest(const Interpreter& interpreter, const std::string& self, const std::string& engine, Test& test) {
+    const bool expects_crash = test.input.filename().string().find("CRASH") != std::string::npos;
+    if (expects_crash && self.empty()) {
+        test.skipped = true;
+        return;
+    }
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::string log;
+#ifdef TEST_RUNNER_ISOLATE
+    if (!self.empty()) log = runIsolated(self, engine, test);
+    else log = runInProcess(interpreter, test.input);
+#else
+    log = runInProcess(interpreter, test.input);
+#endif
+
+    if (test.input.string().find("FAIL") != std::string::npos) {
+        test.pass = containsError(log);
+    } else {
+        fsys::path output{ test.input };
+        output.replace_extension(OUTPUT_EXT);
+        std::ifstream expected{ output };
+        std::istringstream actual{ log };
+        test.pass = expected && areSame(actual, expected);
+    }
+    if (expects_crash) test.pass = test.pass && !test.crash.empty();
+    else if (!test.crash.empty()) test.pass = false;
+    test.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char* argv[]) {
+    // argv[1] must contain the path to the test directory, the options follow
+    if (argc < 2) {
+        std::cout << "Missing parameters!" << std::endl;
+        std::cout << "Usage: " << argv[0] << " <test_dir> [--jobs=N] [--engine=tree|vm|jit|flat|switch] [--isolate]" << std::endl;
+        return EXIT_FAILURE;
+    }
+    fsys::path testDirPath{ argv[1] };
+    unsigned int jobs = WorkStealingPool::defaultThreads();
+    Options opts;
+    std::string engine = "tree";
+    bool isolate = false;
+    // a child process of --isolate: argv[1] is --run-one=<test>, whose log is written on stdout
+    const bool run_one = testDirPath.string().rfind("--run-one=", 0) == 0;
+    for (int i = 2; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg.rfind("--jobs=", 0) == 0) {
+            jobs = std::max(1, std::atoi(arg.c_str() + 7));
+        } else if (arg.rfind("--engine=", 0) == 0 && Options::string2Engine(arg.substr(9)) != Options::NULL_VAL) {
+            engine = arg.substr(9);
+            opts.engine = Options::string2Engine(engine);
+        } else if (arg == "--isolate") {
+            isolate = true;
+        } else {
+            std::cout << "Unknown option " << arg << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (run_one) {
+        runOnStdout(Interpreter{ opts }, testDirPath.string().substr(10));
+        return EXIT_SUCCESS;
+    }
+
+    // path of the runner itself, started again for each test with --isolate
+    std::string self;
+    if (isolate) {
+#ifdef TEST_RUNNER_ISOLATE
+        std::error_code ec;
+        fsys::path exe = fsys::read_symlink("/proc/self/exe", ec);
+        self = ec ? fsys::absolute(argv[0]).string() : exe.string();
+#else
+        std::cout << "--isolate not supported on this platform" << std::endl;
+        return EXIT_FAILURE;
+#endif
+    }
+
+    std::vector<Test> tests;
+    for (const auto& entry : fsys::recursive_directory_iterator{ testDirPath }) {
+        if (entry.path().extension() == std::string(INPUT_EXT)) tests.push_back(Test{ entry.path() });
+    }
+    std::sort(tests.begin(), tests.end(), [](const Test& a, const Test& b) { return a.input < b.input; });
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    Interpreter interpreter{ opts };
+    {
+        WorkStealingPool pool{ jobs };
+        for (Test& test : tests) pool.submit([&interpreter, &self, &engine, &test] { runTest(interpreter, self, engine, test); });
+    }
+    double total_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    size_t passed = 0;
+    size_t skipped = 0;
+    for (const Test& test : tests) {
+        if (test.skipped) {
+            std::cout << std::left << std::setw(48) << test.input.filename().string() << "SKIPPED   (--isolate)" << std::endl;
+            skipped++;
+            continue;
+        }
+        std::cout << std::left << std::setw(48) << test.input.filename().string() << std::setw(10) << (test.pass ? "SUCCESS" : test.crash.empty() ? "FAILED" : "CRASHED")
+                  << std::right << std::fixed << std::setprecision(3) << std::setw(10) << test.ms << " ms";
+        if (!test.crash.empty()) std::cout << "  (" << test.crash << ")";
+        std::cout << std::endl;
+        if (test.pass) passed++;
+    }
+    size_t run = tests.size() - skipped;
+    std::cout << std::defaultfloat << std::setprecision(6) << std::endl << "Passed: " << passed << " Failed: " << (run - passed);
+    if (skipped > 0) std::cout << " Skipped: " << skipped;
+    std::cout << std::endl;
+    if (run > 0) std::cout << "GRADE: " << passed * 6.0F / run << std::endl;
+    std::cout << "Time: " << std::fixed << std::setprecision(1) << total_ms << " ms on " << jobs << " threads" << std::endl;
+    return (passed == run) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,71 @@
+#include <algorithm>
+
+#include "BatchRunner.h"
+#include "WorkStealingPool.h"
+
+
+std::vector<std::string_view> BatchRunner::splitRows(std::string_view rows) {
+    std::vector<std::string_view> result;
+    size_t begin = 0;
+    while (begin < rows.size()) {
+        size_t end = rows.find('\n', begin);
+        if (end == std::string_view::npos) end = rows.size();
+        result.push_back(rows.substr(begin, end - begin));
+        begin = end + 1;
+    }
+    return result;
+}
+
+
+size_t BatchRunner::operator()(std::string_view rows, OutputSink& out, std::ostream& err) {
+    lines = splitRows(rows);
+    size_t n_tasks = (lines.size() + ROWS_PER_TASK - 1) / ROWS_PER_TASK;
+    tasks.assign(n_tasks, Task{});
+
+    size_t n_failed = 0;
+    {
+        WorkStealingPool pool{ n_threads };
+        size_t window = WINDOW_PER_THREAD * pool.get_n_threads();
+        size_t submitted = 0;
+        for (; submitted < std::min(n_tasks, window); submitted++) pool.submit([this, submitted] { runTask(submitted); });
+
+        // The outputs are written in the order of the rows, while the next tasks run
+        for (size_t t = 0; t < n_tasks; t++) {
+            {
+                std::unique_lock<std::mutex> lock{ m };
+                done_cv.wait(lock, [this, t] { return tasks[t].done; });
+            }
+            if (submitted < n_tasks) {
+                pool.submit([this, submitted] { runTask(submitted); });
+                submitted++;
+            }
+            for (Result& r : tasks[t].results) {
+                out.write(r.output);
+                if (!r.error.empty()) {
+                    out.flush();
+                    err << r.error;
+                    n_failed++;
+                }
+            }
+            std::vector<Result>{}.swap(tasks[t].results);
+        }
+    }
+    return n_failed;
+}
+
+void BatchRunner::runTask(size_t t) {
+    size_t first = t * ROWS_PER_TASK;
+    size_t last = std::min(first + ROWS_PER_TASK, lines.size());
+    std::vector<Result> results;
+    results.reserve(last - first);
+    for (size_t i = first; i < last; i++) {
+        ExecutionContext ctx{ lines[i] };
+        ctx.run(engine);
+        results.push_back(Result{ std::move(ctx.get_output()), std::move(ctx.get_error()) });
+    }
+
+    std::lock_guard<std::mutex> lock{ m };
+    tasks[t].results = std::move(results);
+    tasks[t].done = true;
+    done_cv.notify_all();
+}
@@ -0,0 +1,62 @@
+#ifndef BATCH_RUNNER_H
+#define BATCH_RUNNER_H
+
+#include <condition_variable>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "ExecutionContext.h"
+#include "OutputSink.h"
+
+
+/* Function object running a Program once for each row of a text (one line for each run, with the
+values of its INPUT statements separated by white spaces) on a WorkStealingPool.
+The rows are run in tasks of ROWS_PER_TASK, each one in its own ExecutionContext; at most
+WINDOW_PER_THREAD tasks for each thread are submitted ahead of the oldest one whose outputs are
+not written yet, so the memory used doesn't depend on the number of rows */
+class BatchRunner {
+public:
+    static constexpr size_t ROWS_PER_TASK = 32;
+    static constexpr size_t WINDOW_PER_THREAD = 4;
+
+    BatchRunner(ExecutionContext::Engine e, unsigned int n_threads) : engine{ std::move(e) }, n_threads{ n_threads } {}
+    ~BatchRunner() = default;
+
+    // Deletion of copy constructor and assignment operator: a BatchRunner is used for a single run
+    BatchRunner(const BatchRunner& other) = delete;
+    BatchRunner& operator=(const BatchRunner& other) = delete;
+
+    /* Runs of all the rows: the outputs are written on "out" in the order of the rows, the message of a
+    failed run on "err" right after its output (out is flushed before). It returns the number of failed runs */
+    size_t operator()(std::string_view rows, OutputSink& out, std::ostream& err);
+
+    // Lines of "rows" (a last line without '\n' included, a last empty one excluded)
+    static std::vector<std::string_view> splitRows(std::string_view rows);
+
+private:
+    struct Result {
+        std::string output;
+        std::string error;
+    };
+
+    // Rows [first, first + ROWS_PER_TASK) and their results, ready when done is set
+    struct Task {
+        std::vector<Result> results;
+        bool done = false;
+    };
+
+    ExecutionContext::Engine engine;
+    unsigned int n_threads;
+
+    std::vector<std::string_view> lines;
+    std::vector<Task> tasks;
+    std::mutex m;
+    std::condition_variable done_cv;
+
+    void runTask(size_t t);
+};
+
+#endif /* BATCH_RUNNER_H */
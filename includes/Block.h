@@ -4,26 +4,44 @@
 
 #include <iostream>
 
-#include <vector>
-
 #include "Statement.h"
 
 class Visitor;
 
-/* Class Block where the only attribute is a std::vector of pointers to Statement objects */
+/* Read-only view of the statements of a Block, stored in a contiguous array */
+class StatementList {
+public:
+    StatementList(Statement* const* f, unsigned int n) : first{ f }, n_stmts{ n } {}
+
+    Statement* const* begin() const { return first; }
+    Statement* const* end() const { return first + n_stmts; }
+    unsigned int size() const { return n_stmts; }
+    Statement* operator[](unsigned int i) const { return first[i]; }
+
+private:
+    Statement* const* first;
+    unsigned int n_stmts;
+};
+
+
+/* Class Block where the only attribute is an array of pointers to Statement objects
+(the array is allocated, like the Block, by the NodeFactory) */
 class Block {
 public:
-    Block() = default;
+    Block() : stmts{ nullptr }, n_stmts{ 0 } {}
     Block(const Block& other) = default;
-    Block(std::vector<Statement*> s) : stmts{ s } {} 
+    Block(Statement* const* s, unsigned int n) : stmts{ s }, n_stmts{ n } {}
     ~Block() = default;
     
-    std::vector<Statement*> get_stmts() const { return stmts; } 
+    StatementList get_stmts() const { return StatementList{ stmts, n_stmts }; }
+    // Replacement of the statements by an array kept by the caller (e.g. the IncrementalParser)
+    void set_stmts(Statement* const* s, unsigned int n) { stmts = s; n_stmts = n; }
     
     void accept(Visitor* v);
 
 private:
-    std::vector<Statement*> stmts;
+    Statement* const* stmts;
+    unsigned int n_stmts;
 };
 
 
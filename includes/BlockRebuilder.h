@@ -0,0 +1,76 @@
+#ifndef BLOCK_REBUILDER_H
+#define BLOCK_REBUILDER_H
+
+#include <algorithm>
+#include <vector>
+
+#include "Visitor.h"
+#include "NodeFactory.h"
+
+
+/* Rebuild of the Blocks of a Program by a pass that rewrites its statements: the statements emitted while
+a Block is visited make its new Block, in one list for each nesting level, reused from a Block to the next.
+A Block, an IF or a WHILE whose parts are unchanged is kept, so the subtrees left as they are aren't copied */
+class BlockRebuilder {
+public:
+    BlockRebuilder(NodeFactory& node_f) : nf{ node_f } {}
+
+    // Deletion of copy constructor and assignment operator: the lists are the ones of a single pass
+    BlockRebuilder(const BlockRebuilder& other) = delete;
+    BlockRebuilder& operator=(const BlockRebuilder& other) = delete;
+
+    // Visit of "b" by "v", whose statements emitted make the Block returned ("b" itself if they are its statements)
+    Block* rebuild(Block* b, Visitor* v) {
+        open();
+        visitStatements(b, v);
+        return close(b);
+    }
+
+    // Start of a new Block, at a new nesting level
+    void open() {
+        if (scratch.size() <= depth) scratch.emplace_back();
+        depth++;
+    }
+
+    // Visit of the statements of "b" by "v", the nodes made in place of each one getting its line
+    void visitStatements(Block* b, Visitor* v) {
+        for (Statement* s : b->get_stmts()) visitStatement(s, v);
+    }
+
+    void visitStatement(Statement* s, Visitor* v) {
+        NodeFactory::LineScope line{ nf, s->get_line() };
+        s->accept(v);
+    }
+
+    void emit(Statement* s) { scratch[depth - 1].push_back(s); }
+    // Statements emitted in the Block being rebuilt
+    std::vector<Statement*>& statements() { return scratch[depth - 1]; }
+
+    // End of the Block being rebuilt: "old" if the statements emitted are its ones, a new Block otherwise
+    Block* close(Block* old) {
+        depth--;
+        std::vector<Statement*>& stmts = scratch[depth];
+        StatementList old_stmts = old->get_stmts();
+        Block* b = (stmts.size() == old_stmts.size() && std::equal(stmts.begin(), stmts.end(), old_stmts.begin())) ? old : nf.makeBlock(stmts);
+        stmts.clear();
+        return b;
+    }
+
+    // "s" if its parts are unchanged, a new statement otherwise
+    Statement* ifStmt(IfStmt* s, BoolExpr* cond, Block* blk1, Block* blk2) {
+        if (cond == s->get_bexpr() && blk1 == s->get_stmt_block1() && blk2 == s->get_stmt_block2()) return s;
+        return nf.makeIfStmt(cond, blk1, blk2);
+    }
+
+    Statement* whileStmt(WhileStmt* s, BoolExpr* cond, Block* body) {
+        if (cond == s->get_bexpr() && body == s->get_stmt_block()) return s;
+        return nf.makeWhileStmt(cond, body);
+    }
+
+private:
+    NodeFactory& nf;
+    std::vector<std::vector<Statement*>> scratch; // statements of the Blocks being rebuilt, one list for each nesting level
+    size_t depth = 0;
+};
+
+#endif /* BLOCK_REBUILDER_H */
@@ -9,11 +9,25 @@
 
 class Visitor;
 
-/* BoolExpr superclass used to identify the boolean expressions */
+/* BoolExpr superclass used to identify the boolean expressions.
+The nodes live in the NodeArena of a NodeFactory and are never deleted through the superclass */
 class BoolExpr {
 public:
-    virtual ~BoolExpr() {};
+    // Enumeration to identify the class of the node (see NumExpr::Kind)
+    enum Kind : uint8_t { REL_OP, BOOL_CONST, BOOL_OP };
+
+    Kind get_kind() const { return kind; }
+
     virtual void accept(Visitor* v) = 0;        
+
+protected:
+    BoolExpr(Kind k) : kind{ k } {}
+    BoolExpr(const BoolExpr& other) = default;
+    BoolExpr& operator=(const BoolExpr& other) = default;
+    ~BoolExpr() = default;
+
+private:
+    Kind kind;
 };
 
 
@@ -23,7 +37,7 @@ public:
     /* Enumeration used to identify the two boolean constants (the value NULL_VAL has the utility to identify a invalid value) */
     enum BoolCode { TRUE, FALSE, NULL_VAL };
 
-    BoolConst(BoolCode bcode) : bconst{ bcode } {};
+    BoolConst(BoolCode bcode) : BoolExpr(BOOL_CONST), bconst{ bcode } {};
     ~BoolConst() = default;
     BoolConst(const BoolConst& other) = default;
     BoolConst& operator=(const BoolConst& other) = default;
@@ -59,7 +73,7 @@ class BoolOp : public BoolExpr {
 public:
     enum BopCode { AND, OR, NOT, NULL_VAL };
 
-    BoolOp(BopCode b, BoolExpr* fbexpr, BoolExpr* sbexpr) : b_opcode{ b }, f_bexpr{ fbexpr }, s_bexpr{ sbexpr } {};
+    BoolOp(BopCode b, BoolExpr* fbexpr, BoolExpr* sbexpr) : BoolExpr(BOOL_OP), b_opcode{ b }, f_bexpr{ fbexpr }, s_bexpr{ sbexpr } {};
     ~BoolOp() = default; 
     BoolOp(const BoolOp& other) = default;
     BoolOp& operator=(const BoolOp& other) = default;
@@ -103,7 +117,7 @@ class RelOp : public BoolExpr {
 public:
     enum RelOpCode { LT, GT, EQ, NULL_VAL };
 
-    RelOp(RelOpCode r, NumExpr* f_nexpr, NumExpr* s_nexpr) : r_opcode{ r }, first_nexpr{ f_nexpr }, second_nexpr{ s_nexpr } {};
+    RelOp(RelOpCode r, NumExpr* f_nexpr, NumExpr* s_nexpr) : BoolExpr(REL_OP), r_opcode{ r }, first_nexpr{ f_nexpr }, second_nexpr{ s_nexpr } {};
     ~RelOp() = default;
     RelOp(const RelOp& other) = default;
     RelOp& operator=(const RelOp& other) = default;
@@ -0,0 +1,55 @@
+#include "Bytecode.h"
+
+
+const char* opCode2String(OpCode op) {
+    switch (op) {
+        case OpCode::CONST: return "CONST";
+        case OpCode::LOAD: return "LOAD";
+        case OpCode::LOAD_CHECKED: return "LOAD_CHECKED";
+        case OpCode::STORE: return "STORE";
+        case OpCode::INPUT: return "INPUT";
+        case OpCode::PRINT: return "PRINT";
+        case OpCode::ADD: return "ADD";
+        case OpCode::SUB: return "SUB";
+        case OpCode::MUL: return "MUL";
+        case OpCode::DIV: return "DIV";
+        case OpCode::LT: return "LT";
+        case OpCode::GT: return "GT";
+        case OpCode::EQ: return "EQ";
+        case OpCode::NOT: return "NOT";
+        case OpCode::JUMP: return "JUMP";
+        case OpCode::JUMP_IF_FALSE: return "JUMP_IF_FALSE";
+        case OpCode::JUMP_IF_TRUE: return "JUMP_IF_TRUE";
+        case OpCode::JUMP_IF_FALSE_OR_POP: return "JUMP_IF_FALSE_OR_POP";
+        case OpCode::JUMP_IF_TRUE_OR_POP: return "JUMP_IF_TRUE_OR_POP";
+        case OpCode::FAIL: return "FAIL";
+        case OpCode::HALT: return "HALT";
+        default: return " ";
+    }
+}
+
+std::ostream& operator<<(std::ostream& os, const Chunk& chunk) {
+    for (unsigned int pc = 0; pc < chunk.code.size(); pc++) {
+        const Instruction& ins = chunk.code[pc];
+        os << pc << "\t" << opCode2String(ins.op);
+        switch (ins.op) {
+            case OpCode::CONST:
+                os << " " << chunk.constants[ins.arg]; break;
+            case OpCode::LOAD:
+            case OpCode::STORE:
+            case OpCode::INPUT:
+                os << " " << chunk.var_ids[ins.arg]; break;
+            case OpCode::LOAD_CHECKED:
+                os << " " << chunk.var_ids[chunk.checks[ins.arg].slot]; break;
+            case OpCode::JUMP:
+            case OpCode::JUMP_IF_FALSE:
+            case OpCode::JUMP_IF_TRUE:
+            case OpCode::JUMP_IF_FALSE_OR_POP:
+            case OpCode::JUMP_IF_TRUE_OR_POP:
+                os << " " << ins.arg; break;
+            default: break;
+        }
+        os << std::endl;
+    }
+    return os;
+}
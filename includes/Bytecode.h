@@ -0,0 +1,59 @@
+#ifndef BYTECODE_H
+#define BYTECODE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <iostream>
+
+
+/* Instruction set of the stack based VirtualMachine.
+Boolean values are stored on the stack as the integers 1 (TRUE) and 0 (FALSE) */
+enum class OpCode : uint8_t {
+    CONST,                 // push constants[arg]
+    LOAD,                  // push vars[arg]
+    LOAD_CHECKED,          // push vars[checks[arg].slot], SemanticError checks[arg].message if it's not declared
+    STORE,                 // pop the top value into vars[arg], which is declared from now on
+    INPUT,                 // read vars[arg] through the Runtime, which is declared from now on
+    PRINT,                 // pop the top value and print it through the Runtime
+    ADD, SUB, MUL, DIV,    // pop two values, push the result
+    LT, GT, EQ,            // pop two values, push 1 or 0
+    NOT,                   // replace the top value with its negation
+    JUMP,                  // pc = arg
+    JUMP_IF_FALSE,         // pop the top value, pc = arg if it's 0
+    JUMP_IF_TRUE,          // pop the top value, pc = arg if it's not 0
+    JUMP_IF_FALSE_OR_POP,  // pc = arg if the top value is 0 (the value stays on the stack), otherwise pop it
+    JUMP_IF_TRUE_OR_POP,   // pc = arg if the top value is not 0 (the value stays on the stack), otherwise pop it
+    FAIL,                  // throw a SemanticError with errors[arg]
+    HALT,                  // end of the program
+    NULL_VAL
+};
+
+/* Single instruction: operation code and an operand whose meaning depends on the operation */
+struct Instruction {
+    OpCode op;
+    int32_t arg;
+};
+
+/* Variable read that needs to verify at run time that the variable has been declared before */
+struct ReadCheck {
+    int32_t slot;
+    std::string message; // text of the SemanticError thrown if the variable is not declared
+};
+
+/* Result of the compilation of a Program: linear code plus the tables referenced by the operands */
+struct Chunk {
+    std::vector<Instruction> code;
+    std::vector<int64_t> constants;
+    std::vector<ReadCheck> checks;
+    std::vector<std::string> errors; // messages of the FAIL instructions
+    std::vector<std::string> var_ids; // slot -> VARIABLE_ID
+    int max_stack = 0; // maximum depth reached by the stack of values
+};
+
+const char* opCode2String(OpCode op);
+
+// Disassembly of a Chunk, one instruction for each line
+std::ostream& operator<<(std::ostream& os, const Chunk& chunk);
+
+#endif /* BYTECODE_H */
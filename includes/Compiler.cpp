@@ -0,0 +1,176 @@
+#include "Compiler.h"
+
+
+int BytecodeCompiler::emit(OpCode op, int32_t arg, int effect) {
+    chunk.code.push_back(Instruction{ op, arg });
+    depth += effect;
+    if (depth > chunk.max_stack) chunk.max_stack = depth;
+    return static_cast<int>(chunk.code.size()) - 1;
+}
+
+int32_t BytecodeCompiler::constant(int64_t val) {
+    // Each distinct value is stored only once in the constant pool
+    auto it = const_index.find(val);
+    if (it != const_index.end()) return it->second;
+    int32_t idx = static_cast<int32_t>(chunk.constants.size());
+    chunk.constants.push_back(val);
+    const_index.emplace(val, idx);
+    return idx;
+}
+
+void BytecodeCompiler::emitCheckedLoad(Variable* var, std::string message) {
+    // A read proved to follow a declaration (see DefiniteAssignment) needs no check
+    if (dynamic_cast<CheckedVariable*> (var) == nullptr) {
+        emit(OpCode::LOAD, var->get_slot(), +1);
+        return;
+    }
+    int32_t idx = static_cast<int32_t>(chunk.checks.size());
+    chunk.checks.push_back(ReadCheck{ var->get_slot(), std::move(message) });
+    emit(OpCode::LOAD_CHECKED, idx, +1);
+}
+
+
+void BytecodeCompiler::visitProgram(Program* prg) {
+    chunk.var_ids = prg->get_var_ids();
+    if (prg->get_is_not_empty()) {
+        prg->get_blk()->accept(this);
+    }
+    emit(OpCode::HALT, 0, 0);
+}
+
+void BytecodeCompiler::visitBlock(Block* blk) {
+    StatementList stmts = blk->get_stmts();
+    // An empty Block is an error only if it gets executed, like in the EvaluationVisitor
+    if (stmts.size() == 0) {
+        chunk.errors.push_back(SemanticMessage::emptyBlock());
+        emit(OpCode::FAIL, static_cast<int32_t>(chunk.errors.size()) - 1, 0);
+    }
+    for (Statement* s : stmts)
+        s->accept(this);
+}
+
+
+/* STATEMENTS */
+void BytecodeCompiler::visitSet(SetStmt* s) {
+    s->get_nexpr()->accept(this);
+    emit(OpCode::STORE, s->get_var()->get_slot(), -1);
+}
+
+void BytecodeCompiler::visitInput(InputStmt* s) {
+    emit(OpCode::INPUT, s->get_var()->get_slot(), 0);
+}
+
+void BytecodeCompiler::visitPrint(PrintStmt* s) {
+    Variable* v = dynamic_cast<Variable*> (s->get_nexpr());
+    if (v != nullptr) emitCheckedLoad(v, SemanticMessage::undeclaredPrint(v->get_id()));
+    else s->get_nexpr()->accept(this);
+    emit(OpCode::PRINT, 0, -1);
+}
+
+void BytecodeCompiler::visitIf(IfStmt* s) {
+    /*      <bool_expr>
+            JUMP_IF_FALSE else
+            <stmt_block1>
+            JUMP end
+      else: <stmt_block2>
+      end:                   */
+    s->get_bexpr()->accept(this);
+    int jump_else = emit(OpCode::JUMP_IF_FALSE, 0, -1);
+    s->get_stmt_block1()->accept(this);
+    int jump_end = emit(OpCode::JUMP, 0, 0);
+    patch(jump_else);
+    s->get_stmt_block2()->accept(this);
+    patch(jump_end);
+}
+
+void BytecodeCompiler::visitWhile(WhileStmt* s) {
+    /*      JUMP guard
+      body: <stmt_block>
+     guard: <bool_expr>
+            JUMP_IF_TRUE body   
+    The guard is placed after the body so that each iteration executes a single jump */
+    int jump_guard = emit(OpCode::JUMP, 0, 0);
+    int32_t body = static_cast<int32_t>(chunk.code.size());
+    s->get_stmt_block()->accept(this);
+    patch(jump_guard);
+    s->get_bexpr()->accept(this);
+    emit(OpCode::JUMP_IF_TRUE, body, -1);
+}
+
+
+/* NUM_EXPR */
+void BytecodeCompiler::visitOperator(Operator* opNode) {
+    std::string op_name = Operator::opCode2String(opNode->getOp());
+    Variable* v = dynamic_cast<Variable*> (opNode->getFirst());
+    if (v != nullptr) emitCheckedLoad(v, SemanticMessage::undeclaredOperand(op_name, v->get_id()));
+    else opNode->getFirst()->accept(this);
+
+    v = dynamic_cast<Variable*> (opNode->getSecond());
+    if (v != nullptr) emitCheckedLoad(v, SemanticMessage::undeclaredOperand(op_name, v->get_id()));
+    else opNode->getSecond()->accept(this);
+
+    switch (opNode->getOp()) {
+        case Operator::ADD: emit(OpCode::ADD, 0, -1); break;
+        case Operator::SUB: emit(OpCode::SUB, 0, -1); break;
+        case Operator::MUL: emit(OpCode::MUL, 0, -1); break;
+        case Operator::DIV: emit(OpCode::DIV, 0, -1); break;
+        default: break;
+    }
+}
+
+void BytecodeCompiler::visitNumber(Number* numNode) {
+    emit(OpCode::CONST, constant(numNode->get_value()), +1);
+}
+
+void BytecodeCompiler::visitVariable(Variable* varNode) {
+    // A variable visited directly is the whole NUM_EXPR of a SET statement
+    emitCheckedLoad(varNode, SemanticMessage::undeclaredVariable(varNode->get_id()));
+}
+
+
+/* BOOL_EXPR */
+void BytecodeCompiler::visitRelOp(RelOp* rop) {
+    std::string op_name = RelOp::relOpCode2String(rop->get_r_opcode());
+    Variable* v = dynamic_cast<Variable*> (rop->get_first_nexpr());
+    if (v != nullptr) emitCheckedLoad(v, SemanticMessage::undeclaredRelOperand(op_name, v->get_id()));
+    else rop->get_first_nexpr()->accept(this);
+
+    v = dynamic_cast<Variable*> (rop->get_second_nexpr());
+    if (v != nullptr) emitCheckedLoad(v, SemanticMessage::undeclaredRelOperand(op_name, v->get_id()));
+    else rop->get_second_nexpr()->accept(this);
+
+    switch (rop->get_r_opcode()) {
+        case RelOp::LT: emit(OpCode::LT, 0, -1); break;
+        case RelOp::GT: emit(OpCode::GT, 0, -1); break;
+        case RelOp::EQ: emit(OpCode::EQ, 0, -1); break;
+        default: break;
+    }
+}
+
+void BytecodeCompiler::visitBoolConst(BoolConst* bconst) {
+    emit(OpCode::CONST, constant(bconst->get_bconst() == BoolConst::TRUE ? TRUE_VAL : FALSE_VAL), +1);
+}
+
+void BytecodeCompiler::visitBoolOp(BoolOp* bop) {
+    bop->get_f_bexpr()->accept(this);
+    switch (bop->get_b_opcode()) {
+        case BoolOp::NOT:
+            emit(OpCode::NOT, 0, 0);
+            return;
+        case BoolOp::AND: {
+            // FALSE as 1st operand is already the result: the 2nd one is skipped
+            int jump_end = emit(OpCode::JUMP_IF_FALSE_OR_POP, 0, -1);
+            bop->get_s_bexpr()->accept(this);
+            patch(jump_end);
+            return;
+        }
+        case BoolOp::OR: {
+            // TRUE as 1st operand is already the result: the 2nd one is skipped
+            int jump_end = emit(OpCode::JUMP_IF_TRUE_OR_POP, 0, -1);
+            bop->get_s_bexpr()->accept(this);
+            patch(jump_end);
+            return;
+        }
+        default: return;
+    }
+}
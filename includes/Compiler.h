@@ -0,0 +1,62 @@
+#ifndef COMPILER_H
+#define COMPILER_H
+
+#include <string>
+#include <unordered_map>
+
+#include "Visitor.h"
+#include "Bytecode.h"
+
+
+/* Class that extends Visitor superclass to translate a resolved Program (see ResolveVisitor)
+into the linear bytecode executed by the VirtualMachine.
+IF and WHILE become conditional jumps and AND/OR jump over their 2nd operand (short-circuit) */
+class BytecodeCompiler : public Visitor {
+public:
+    BytecodeCompiler() = default;
+    ~BytecodeCompiler() = default;
+
+    // Deletion of copy constructor and assignment operator: a compiler is used for a single Program
+    BytecodeCompiler(const BytecodeCompiler& other) = delete;
+    BytecodeCompiler& operator=(const BytecodeCompiler& other) = delete;
+
+    Chunk operator()(Program* prg) {
+        chunk = Chunk{};
+        const_index.clear();
+        depth = 0;
+        prg->accept(this);
+        return std::move(chunk);
+    }
+
+    void visitProgram(Program* prg) override;
+    void visitBlock(Block* blk) override;
+
+    void visitSet(SetStmt* s) override;
+    void visitInput(InputStmt* s) override;
+    void visitPrint(PrintStmt* s) override;
+    void visitIf(IfStmt* s) override;
+    void visitWhile(WhileStmt* s) override;
+
+    void visitOperator(Operator* opNode) override;
+    void visitNumber(Number* numNode) override;
+    void visitVariable(Variable* varNode) override;
+
+    void visitRelOp(RelOp* rop) override;
+    void visitBoolConst(BoolConst* bconst) override;
+    void visitBoolOp(BoolOp* bop) override;
+
+private:
+    Chunk chunk;
+    std::unordered_map<int64_t, int32_t> const_index; // value -> position in the constant pool
+    int depth = 0; // depth of the stack of values after the last emitted instruction
+
+    // Append an instruction updating the stack depth by "effect"; it returns its position
+    int emit(OpCode op, int32_t arg, int effect);
+    // Set the destination of the jump in position "at" to the next emitted instruction
+    void patch(int at) { chunk.code[at].arg = static_cast<int32_t>(chunk.code.size()); }
+    int32_t constant(int64_t val);
+    // Read of a variable with a check that fails with "message" if it's not declared
+    void emitCheckedLoad(Variable* var, std::string message);
+};
+
+#endif /* COMPILER_H */
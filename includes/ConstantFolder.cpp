@@ -0,0 +1,255 @@
+#include <limits>
+
+#include "ConstantFolder.h"
+
+
+// Arithmetic with the wrap around of the evaluation on two's complement integers
+static int64_t wrap(uint64_t v) { return static_cast<int64_t>(v); }
+
+/* A NumExpr can replace the Operator it belongs to if it doesn't change the error given by its evaluation:
+the message of an undeclared Variable depends on the node where it is used */
+static bool keepsErrors(NumExpr* e, bool may_fail) {
+    return !may_fail || dynamic_cast<Variable*>(e) == nullptr;
+}
+
+
+bool ConstantFolder::isNumber(NumExpr* e, int64_t& val) {
+    Number* n = dynamic_cast<Number*>(e);
+    if (n == nullptr) return false;
+    val = n->get_value();
+    return true;
+}
+
+bool ConstantFolder::isBoolConst(BoolExpr* e, bool& val) {
+    BoolConst* c = dynamic_cast<BoolConst*>(e);
+    if (c == nullptr) return false;
+    val = (c->get_bconst() == BoolConst::TRUE);
+    return true;
+}
+
+
+void ConstantFolder::visitProgram(Program* prg) {
+    n_folded = 0;
+    declared.assign(prg->get_n_vars());
+    if (prg->get_is_not_empty()) {
+        prg->get_blk()->accept(this);
+        prg->set_blk(blk);
+    }
+}
+
+void ConstantFolder::visitBlock(Block* b) {
+    blocks.open();
+    blocks.visitStatements(b, this);
+    // A Block emptied by the removal of its statements keeps the first one, as an empty Block is an error at run time
+    StatementList old_stmts = b->get_stmts();
+    if (blocks.statements().empty() && old_stmts.size() > 0) emit(old_stmts[0]);
+    blk = blocks.close(b);
+}
+
+
+/* STATEMENTS */
+void ConstantFolder::visitSet(SetStmt* s) {
+    s->get_nexpr()->accept(this);
+    // The variable is declared from now on
+    declared.declare(s->get_var()->get_slot());
+    emit((nexpr == s->get_nexpr()) ? s : nf.makeSetStmt(nexpr, s->get_var()));
+}
+
+void ConstantFolder::visitInput(InputStmt* s) {
+    declared.declare(s->get_var()->get_slot());
+    emit(s);
+}
+
+void ConstantFolder::visitPrint(PrintStmt* s) {
+    s->get_nexpr()->accept(this);
+    emit((nexpr == s->get_nexpr()) ? s : nf.makePrintStmt(nexpr));
+}
+
+void ConstantFolder::visitIf(IfStmt* s) {
+    s->get_bexpr()->accept(this);
+    BoolExpr* cond = bexpr;
+
+    // Known guard: the statements of the taken block take the place of the IF (unless the block is empty)
+    bool val;
+    if (isBoolConst(cond, val)) {
+        Block* taken = val ? s->get_stmt_block1() : s->get_stmt_block2();
+        if (taken->get_stmts().size() > 0) {
+            n_folded++;
+            blocks.visitStatements(taken, this);
+            return;
+        }
+    }
+
+    Block* blk1 = nullptr;
+    Block* blk2 = nullptr;
+    declared.branches([&] { s->get_stmt_block1()->accept(this); blk1 = blk; },
+                      [&] { s->get_stmt_block2()->accept(this); blk2 = blk; });
+    emit(blocks.ifStmt(s, cond, blk1, blk2));
+}
+
+void ConstantFolder::visitWhile(WhileStmt* s) {
+    /* The guard is simplified with the variables declared before the loop, which are declared
+    in every later evaluation of the guard too */
+    s->get_bexpr()->accept(this);
+    BoolExpr* cond = bexpr;
+
+    bool val;
+    if (isBoolConst(cond, val) && !val) {
+        // the body is never run
+        n_folded++;
+        return;
+    }
+
+    declared.mayNotRun([&] { s->get_stmt_block()->accept(this); });
+    emit(blocks.whileStmt(s, cond, blk));
+}
+
+
+/* NUM_EXPR */
+void ConstantFolder::visitOperator(Operator* opNode) {
+    opNode->getFirst()->accept(this);
+    NumExpr* first = nexpr;
+    bool first_fails = may_fail;
+    opNode->getSecond()->accept(this);
+    NumExpr* second = nexpr;
+    bool second_fails = may_fail;
+
+    int64_t fval = 0, sval = 0;
+    bool f_const = isNumber(first, fval);
+    bool s_const = isNumber(second, sval);
+    Operator::OpCode op = opNode->getOp();
+    may_fail = first_fails || second_fails;
+
+    switch (op) {
+        case Operator::ADD:
+            if (f_const && s_const) nexpr = nf.makeNumber(wrap(static_cast<uint64_t>(fval) + static_cast<uint64_t>(sval)));
+            else if (s_const && sval == 0 && keepsErrors(first, first_fails)) nexpr = first;
+            else if (f_const && fval == 0 && keepsErrors(second, second_fails)) nexpr = second;
+            else break;
+            n_folded++;
+            return;
+        case Operator::SUB:
+            if (f_const && s_const) nexpr = nf.makeNumber(wrap(static_cast<uint64_t>(fval) - static_cast<uint64_t>(sval)));
+            else if (s_const && sval == 0 && keepsErrors(first, first_fails)) nexpr = first;
+            else break;
+            n_folded++;
+            return;
+        case Operator::MUL:
+            if (f_const && s_const) nexpr = nf.makeNumber(wrap(static_cast<uint64_t>(fval) * static_cast<uint64_t>(sval)));
+            else if (s_const && sval == 1 && keepsErrors(first, first_fails)) nexpr = first;
+            else if (f_const && fval == 1 && keepsErrors(second, second_fails)) nexpr = second;
+            // x*0 only if the evaluation of x can't throw an error
+            else if ((s_const && sval == 0 && !first_fails) || (f_const && fval == 0 && !second_fails)) nexpr = nf.makeNumber(0);
+            else break;
+            n_folded++;
+            return;
+        case Operator::DIV:
+            // DIV by 0 and INT64_MIN / -1 are left to the run time
+            if (f_const && s_const && sval != 0 && !(sval == -1 && fval == std::numeric_limits<int64_t>::min())) nexpr = nf.makeNumber(fval / sval);
+            else if (s_const && sval == 1 && keepsErrors(first, first_fails)) nexpr = first;
+            else {
+                if (!s_const || sval == 0 || sval == -1) may_fail = true;
+                break;
+            }
+            n_folded++;
+            return;
+        default: break;
+    }
+    nexpr = (first == opNode->getFirst() && second == opNode->getSecond()) ? opNode : nf.makeOperator(op, first, second);
+}
+
+void ConstantFolder::visitNumber(Number* numNode) {
+    nexpr = numNode;
+    may_fail = false;
+}
+
+void ConstantFolder::visitVariable(Variable* varNode) {
+    nexpr = varNode;
+    may_fail = !declared[varNode->get_slot()];
+}
+
+
+/* BOOL_EXPR */
+void ConstantFolder::visitRelOp(RelOp* rop) {
+    rop->get_first_nexpr()->accept(this);
+    NumExpr* first = nexpr;
+    bool first_fails = may_fail;
+    rop->get_second_nexpr()->accept(this);
+    NumExpr* second = nexpr;
+    may_fail = first_fails || may_fail;
+
+    int64_t fval, sval;
+    if (isNumber(first, fval) && isNumber(second, sval)) {
+        bool val = false;
+        switch (rop->get_r_opcode()) {
+            case RelOp::LT: val = fval < sval; break;
+            case RelOp::GT: val = fval > sval; break;
+            case RelOp::EQ: val = fval == sval; break;
+            default: break;
+        }
+        bexpr = makeBool(val);
+        n_folded++;
+        return;
+    }
+    bexpr = (first == rop->get_first_nexpr() && second == rop->get_second_nexpr()) ? rop : nf.makeRelOp(rop->get_r_opcode(), first, second);
+}
+
+void ConstantFolder::visitBoolConst(BoolConst* bconst) {
+    bexpr = bconst;
+    may_fail = false;
+}
+
+void ConstantFolder::visitBoolOp(BoolOp* bop) {
+    BoolOp::BopCode code = bop->get_b_opcode();
+    bop->get_f_bexpr()->accept(this);
+    BoolExpr* first = bexpr;
+    bool first_fails = may_fail;
+    bool fval, sval;
+
+    if (code == BoolOp::NOT) {
+        BoolOp* inner = dynamic_cast<BoolOp*>(first);
+        if (isBoolConst(first, fval)) bexpr = makeBool(!fval);
+        else if (inner != nullptr && inner->get_b_opcode() == BoolOp::NOT) bexpr = inner->get_f_bexpr(); // NOT NOT b
+        else {
+            bexpr = (first == bop->get_f_bexpr()) ? bop : nf.makeBoolOp(code, first, nullptr);
+            return;
+        }
+        n_folded++;
+        return;
+    }
+
+    // AND with FALSE and OR with TRUE as 1st operand: the 2nd one is not evaluated (short-circuit)
+    bool absorbing = (code == BoolOp::OR); // value that decides the result by itself
+    if (isBoolConst(first, fval)) {
+        n_folded++;
+        if (fval == absorbing) {
+            bexpr = makeBool(absorbing);
+            may_fail = false;
+        } else {
+            // AND TRUE b, OR FALSE b
+            bop->get_s_bexpr()->accept(this);
+        }
+        return;
+    }
+
+    bop->get_s_bexpr()->accept(this);
+    BoolExpr* second = bexpr;
+    bool second_fails = may_fail;
+    may_fail = first_fails || second_fails;
+    if (isBoolConst(second, sval)) {
+        if (sval != absorbing) {
+            // b AND TRUE, b OR FALSE
+            bexpr = first;
+            may_fail = first_fails;
+            n_folded++;
+            return;
+        } else if (!first_fails) {
+            // b AND FALSE, b OR TRUE, if the evaluation of b can't throw an error
+            bexpr = makeBool(absorbing);
+            may_fail = false;
+            n_folded++;
+            return;
+        }
+    }
+    bexpr = (first == bop->get_f_bexpr() && second == bop->get_s_bexpr()) ? bop : nf.makeBoolOp(code, first, second);
+}
@@ -0,0 +1,73 @@
+#ifndef CONSTANT_FOLDER_H
+#define CONSTANT_FOLDER_H
+
+#include <cstdint>
+
+#include "Visitor.h"
+#include "NodeFactory.h"
+#include "DeclaredSlots.h"
+#include "BlockRebuilder.h"
+
+
+/* Class that extends Visitor superclass to simplify a resolved Program (see ResolveVisitor) before its run.
+Constant subtrees of NUM_EXPR and BOOL_EXPR are replaced by their value and algebraic identities
+are applied (x+0, x-0, x*1, x/1, x*0, NOT NOT b, AND/OR with TRUE or FALSE), IF statements with
+a known guard are replaced by the statements of the taken block and WHILE statements with a FALSE guard
+are removed. The new nodes are created by the NodeFactory of the Program.
+A rewrite never drops a computation that can fail at run time: the variables are tracked to know
+the ones surely declared at each point (an undeclared variable gives an error whose text depends on
+where it is used), while DIV by 0 and overflowing divisions are left to the run time */
+class ConstantFolder : public Visitor {
+public:
+    ConstantFolder(NodeFactory& node_f) : nf{ node_f }, blocks{ node_f } {}
+    ~ConstantFolder() = default;
+
+    // Deletion of copy constructor and assignment operator: a ConstantFolder is used for a single Program
+    ConstantFolder(const ConstantFolder& other) = delete;
+    ConstantFolder& operator=(const ConstantFolder& other) = delete;
+
+    // Simplification of the Program, whose main Block is replaced
+    void operator()(Program* prg) { prg->accept(this); }
+
+    // Number of expressions and statements rewritten by the last run
+    unsigned int get_n_folded() const { return n_folded; }
+
+    void visitProgram(Program* prg) override;
+    void visitBlock(Block* blk) override;
+
+    void visitSet(SetStmt* s) override;
+    void visitInput(InputStmt* s) override;
+    void visitPrint(PrintStmt* s) override;
+    void visitIf(IfStmt* s) override;
+    void visitWhile(WhileStmt* s) override;
+
+    void visitOperator(Operator* opNode) override;
+    void visitNumber(Number* numNode) override;
+    void visitVariable(Variable* varNode) override;
+
+    void visitRelOp(RelOp* rop) override;
+    void visitBoolConst(BoolConst* bconst) override;
+    void visitBoolOp(BoolOp* bop) override;
+
+private:
+    NodeFactory& nf;
+    unsigned int n_folded = 0;
+
+    DeclaredSlots declared; // variables surely declared at the current point
+    BlockRebuilder blocks;
+
+    // result of the last visit of an expression: the simplified node and if its evaluation can throw an error
+    NumExpr* nexpr = nullptr;
+    BoolExpr* bexpr = nullptr;
+    bool may_fail = false;
+    Block* blk = nullptr; // result of the last visit of a Block
+
+    void emit(Statement* s) { blocks.emit(s); }
+
+    // value of a Number or of a BoolConst, if "e" is one of them
+    static bool isNumber(NumExpr* e, int64_t& val);
+    static bool isBoolConst(BoolExpr* e, bool& val);
+    BoolExpr* makeBool(bool val) { return nf.makeBoolConst(val ? BoolConst::TRUE : BoolConst::FALSE); }
+};
+
+#endif /* CONSTANT_FOLDER_H */
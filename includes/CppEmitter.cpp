@@ -0,0 +1,396 @@
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+#include "CppEmitter.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define CPP_EMITTER_SPAWN 1
+#include <spawn.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
+#endif
+
+
+/* Visitor collecting the slots read by a CheckedVariable: only these ones need a flag in the emitted code */
+class CheckedReads : public Visitor {
+public:
+    CheckedReads(std::vector<unsigned char>& c) : checked{ c } {}
+
+    void visitProgram(Program*) override {}
+
+    void visitBlock(Block* b) override {
+        for (Statement* s : b->get_stmts())
+            s->accept(this);
+    }
+
+    void visitSet(SetStmt* s) override { s->get_nexpr()->accept(this); }
+    void visitInput(InputStmt*) override {}
+    void visitPrint(PrintStmt* s) override { s->get_nexpr()->accept(this); }
+
+    void visitIf(IfStmt* s) override {
+        s->get_bexpr()->accept(this);
+        s->get_stmt_block1()->accept(this);
+        s->get_stmt_block2()->accept(this);
+    }
+
+    void visitWhile(WhileStmt* s) override {
+        s->get_bexpr()->accept(this);
+        s->get_stmt_block()->accept(this);
+    }
+
+    void visitOperator(Operator* opNode) override {
+        opNode->getFirst()->accept(this);
+        opNode->getSecond()->accept(this);
+    }
+    void visitNumber(Number*) override {}
+    void visitVariable(Variable*) override {}
+    void visitCheckedVariable(CheckedVariable* varNode) override { checked[varNode->get_slot()] = 1; }
+
+    void visitRelOp(RelOp* rop) override {
+        rop->get_first_nexpr()->accept(this);
+        rop->get_second_nexpr()->accept(this);
+    }
+    void visitBoolConst(BoolConst*) override {}
+    void visitBoolOp(BoolOp* bop) override {
+        bop->get_f_bexpr()->accept(this);
+        if (bop->get_b_opcode() != BoolOp::NOT) bop->get_s_bexpr()->accept(this);
+    }
+
+private:
+    std::vector<unsigned char>& checked;
+};
+
+
+std::string CppEmitter::operator()(Program* prg) {
+    body.str("");
+    indent = 1;
+    n_temps = 0;
+    prg->accept(this);
+
+    // The texts of the errors of INPUT are the ones of SemanticMessage, split around the word given
+    std::string invalid = SemanticMessage::invalidInput("\x01");
+    size_t word_at = invalid.find('\x01');
+
+    std::ostringstream src;
+    src << "// Generated by lispInterpreter --emit-cpp\n"
+           "#include <charconv>\n"
+           "#include <csignal>\n"
+           "#include <cstdint>\n"
+           "#include <cstdio>\n"
+           "#include <cstdlib>\n"
+           "#include <iostream>\n"
+           "#include <string>\n"
+           "#include <unistd.h>\n"
+           "\n"
+           "namespace rt {\n"
+           "\n"
+           "// Output of PRINT and of the prompts: written after each line on a terminal, in blocks of 64KiB otherwise\n"
+           "static char out[64 * 1024];\n"
+           "static size_t out_len = 0;\n"
+           "static const bool out_line = isatty(STDOUT_FILENO);\n"
+           "\n"
+           "static void flush() {\n"
+           "    std::fwrite(out, 1, out_len, stdout);\n"
+           "    std::fflush(stdout);\n"
+           "    out_len = 0;\n"
+           "}\n"
+           "\n"
+           "static void write(const std::string& s) {\n"
+           "    if (sizeof(out) - out_len < s.size()) flush();\n"
+           "    if (s.size() > sizeof(out)) { std::fwrite(s.data(), 1, s.size(), stdout); return; }\n"
+           "    s.copy(out + out_len, s.size());\n"
+           "    out_len += s.size();\n"
+           "}\n"
+           "\n"
+           "static void print(int64_t val) {\n"
+           "    if (sizeof(out) - out_len < 24) flush();\n"
+           "    char* end = std::to_chars(out + out_len, out + sizeof(out), val).ptr;\n"
+           "    *end++ = '\\n';\n"
+           "    out_len = end - out;\n"
+           "    if (out_line) flush();\n"
+           "}\n"
+           "\n"
+           "// Errors of the run: the output written so far comes before the message\n"
+           "[[noreturn]] static void fail(const std::string& msg) {\n"
+           "    flush();\n"
+           "    std::cerr << msg << std::endl;\n"
+           "    std::exit(EXIT_FAILURE);\n"
+           "}\n"
+           "\n"
+           "[[noreturn]] static void generic(const char* what) {\n"
+           "    flush();\n"
+           "    std::cerr << \"(ERROR: generic error )\" << std::endl << what << std::endl;\n"
+           "    std::exit(EXIT_FAILURE);\n"
+           "}\n"
+           "\n"
+           "// Value of INPUT read from the console after a prompt, validated like InputSource::toValue()\n"
+           "static int64_t input(const char* id) {\n"
+           "    write(std::string{ \"INPUT \\\"\" } + id + \"\\\": \");\n"
+           "    flush();\n"
+           "    std::string word;\n"
+           "    std::cin >> word;\n"
+           "    bool valid = !((word.size() > 1 && word[0] == '0') || (word.size() > 2 && word[0] == '-' && word[1] == '0'));\n"
+           "    for (size_t i = 0; valid && i < word.size(); i++) valid = (word[i] >= '0' && word[i] <= '9') || word[i] == '-';\n"
+           "    if (!valid) fail(" << quote(invalid.substr(0, word_at)) << " + word + " << quote(invalid.substr(word_at + 1)) << ");\n"
+           "    int64_t val = 0;\n"
+           "    std::from_chars_result res = std::from_chars(word.data(), word.data() + word.size(), val);\n"
+           "    if (res.ec != std::errc{}) generic(\"stoll\");\n"
+           "    return val;\n"
+           "}\n"
+           "\n"
+           "static inline int64_t checked(bool declared, int64_t val, const char* msg) {\n"
+           "    if (!declared) fail(msg);\n"
+           "    return val;\n"
+           "}\n"
+           "\n"
+           "// Arithmetic of int64_t wrapping around on overflow, like the interpreter\n"
+           "static inline int64_t add(int64_t a, int64_t b) { return static_cast<int64_t>(static_cast<uint64_t>(a) + static_cast<uint64_t>(b)); }\n"
+           "static inline int64_t sub(int64_t a, int64_t b) { return static_cast<int64_t>(static_cast<uint64_t>(a) - static_cast<uint64_t>(b)); }\n"
+           "static inline int64_t mul(int64_t a, int64_t b) { return static_cast<int64_t>(static_cast<uint64_t>(a) * static_cast<uint64_t>(b)); }\n"
+           "static inline int64_t div(int64_t a, int64_t b) {\n"
+           "    if (b == 0) fail(" << quote(SemanticMessage::divisionByZero()) << ");\n"
+           "    // the division overflows: the run stops like on the idiv of the interpreter, after the output written so far\n"
+           "    if (b == -1 && a == INT64_MIN) {\n"
+           "        flush();\n"
+           "        std::raise(SIGFPE);\n"
+           "    }\n"
+           "    return a / b;\n"
+           "}\n"
+           "\n"
+           "} // namespace rt\n"
+           "\n"
+           "int main() {\n";
+
+    for (size_t slot = 0; slot < var_ids.size(); slot++) {
+        src << "    int64_t " << var(slot) << " = 0; // " << var_ids[slot] << "\n";
+        if (checked[slot]) src << "    bool " << declared(slot) << " = false;\n";
+    }
+    for (int i = 0; i < n_temps; i++) src << "    int64_t t" << i << ";\n";
+    src << body.str()
+        << "    rt::flush();\n"
+           "    return EXIT_SUCCESS;\n"
+           "}\n";
+    return src.str();
+}
+
+
+void CppEmitter::visitProgram(Program* prg) {
+    var_ids = prg->get_var_ids();
+    checked.assign(var_ids.size(), 0);
+    if (prg->get_is_not_empty()) {
+        CheckedReads reads{ checked };
+        prg->get_blk()->accept(&reads);
+        prg->get_blk()->accept(this);
+    }
+}
+
+void CppEmitter::visitBlock(Block* blk) {
+    StatementList stmts = blk->get_stmts();
+    // An empty Block is an error only if it gets executed, like in the EvaluationVisitor
+    if (stmts.size() == 0) line("rt::fail(" + quote(SemanticMessage::emptyBlock()) + ");");
+    for (Statement* s : stmts)
+        s->accept(this);
+}
+
+
+/* STATEMENTS */
+void CppEmitter::visitSet(SetStmt* s) {
+    s->get_nexpr()->accept(this);
+    int slot = s->get_var()->get_slot();
+    line(var(slot) + " = " + expr + ";");
+    if (checked[slot]) line(declared(slot) + " = true;");
+}
+
+void CppEmitter::visitInput(InputStmt* s) {
+    int slot = s->get_var()->get_slot();
+    line(var(slot) + " = rt::input(" + quote(var_ids[slot]) + ");");
+    if (checked[slot]) line(declared(slot) + " = true;");
+}
+
+void CppEmitter::visitPrint(PrintStmt* s) {
+    s->get_nexpr()->accept(this);
+    line("rt::print(" + expr + ");");
+}
+
+void CppEmitter::visitIf(IfStmt* s) {
+    s->get_bexpr()->accept(this);
+    line("if (" + expr + ") {");
+    indent++;
+    s->get_stmt_block1()->accept(this);
+    indent--;
+    line("} else {");
+    indent++;
+    s->get_stmt_block2()->accept(this);
+    indent--;
+    line("}");
+}
+
+void CppEmitter::visitWhile(WhileStmt* s) {
+    s->get_bexpr()->accept(this);
+    line("while (" + expr + ") {");
+    indent++;
+    s->get_stmt_block()->accept(this);
+    indent--;
+    line("}");
+}
+
+
+/* NUM_EXPR */
+bool CppEmitter::operands(NumExpr* first, NumExpr* second, std::string& a, std::string& b, std::string& seq) {
+    first->accept(this);
+    a = expr;
+    bool first_fails = may_fail;
+    second->accept(this);
+    b = expr;
+    seq.clear();
+    if (first_fails && may_fail) {
+        std::string t = "t" + std::to_string(n_temps++);
+        seq = t + " = " + a + ", ";
+        a = t;
+    }
+    return first_fails || may_fail;
+}
+
+void CppEmitter::visitOperator(Operator* opNode) {
+    std::string a, b, seq;
+    bool fails = operands(opNode->getFirst(), opNode->getSecond(), a, b, seq);
+    switch (opNode->getOp()) {
+        case Operator::ADD: expr = "rt::add(" + a + ", " + b + ")"; break;
+        case Operator::SUB: expr = "rt::sub(" + a + ", " + b + ")"; break;
+        case Operator::MUL: expr = "rt::mul(" + a + ", " + b + ")"; break;
+        case Operator::DIV: {
+            // A division by a constant other than 0 and -1 can't fail
+            Number* divisor = dynamic_cast<Number*> (opNode->getSecond());
+            if (divisor != nullptr && divisor->get_value() != 0 && divisor->get_value() != -1) {
+                expr = "(" + a + " / " + b + ")";
+            } else {
+                expr = "rt::div(" + a + ", " + b + ")";
+                fails = true;
+            }
+            break;
+        }
+        default: expr = "0";
+    }
+    expr = sequence(seq, expr);
+    may_fail = fails;
+}
+
+void CppEmitter::visitNumber(Number* numNode) {
+    expr = literal(numNode->get_value());
+    may_fail = false;
+}
+
+void CppEmitter::visitVariable(Variable* varNode) {
+    // Read of a variable surely declared (see DefiniteAssignment)
+    expr = var(varNode->get_slot());
+    may_fail = false;
+}
+
+void CppEmitter::visitCheckedVariable(CheckedVariable* varNode) {
+    int slot = varNode->get_slot();
+    expr = "rt::checked(" + declared(slot) + ", " + var(slot) + ", " + quote(varNode->undeclaredMessage()) + ")";
+    may_fail = true;
+}
+
+
+/* BOOL_EXPR */
+void CppEmitter::visitRelOp(RelOp* rop) {
+    std::string a, b, seq;
+    bool fails = operands(rop->get_first_nexpr(), rop->get_second_nexpr(), a, b, seq);
+    switch (rop->get_r_opcode()) {
+        case RelOp::LT: expr = "(" + a + " < " + b + ")"; break;
+        case RelOp::GT: expr = "(" + a + " > " + b + ")"; break;
+        case RelOp::EQ: expr = "(" + a + " == " + b + ")"; break;
+        default: expr = "false";
+    }
+    expr = sequence(seq, expr);
+    may_fail = fails;
+}
+
+void CppEmitter::visitBoolConst(BoolConst* bconst) {
+    expr = (bconst->get_bconst() == BoolConst::TRUE) ? "true" : "false";
+    may_fail = false;
+}
+
+void CppEmitter::visitBoolOp(BoolOp* bop) {
+    bop->get_f_bexpr()->accept(this);
+    std::string a = expr;
+    bool fails = may_fail;
+    if (bop->get_b_opcode() == BoolOp::NOT) {
+        expr = "!" + a;
+        return;
+    }
+    // && and || evaluate their 2nd operand after the 1st one, only if necessary, like AND and OR
+    bop->get_s_bexpr()->accept(this);
+    expr = "(" + a + (bop->get_b_opcode() == BoolOp::AND ? " && " : " || ") + expr + ")";
+    may_fail = fails || may_fail;
+}
+
+
+std::string CppEmitter::literal(int64_t val) {
+    // the opposite of INT64_MIN is not an int64_t literal
+    if (val == INT64_MIN) return "INT64_MIN";
+    return "INT64_C(" + std::to_string(val) + ")";
+}
+
+std::string CppEmitter::quote(const std::string& s) {
+    std::string q = "\"";
+    for (unsigned char c : s) {
+        if (c == '"' || c == '\\') {
+            q += '\\';
+            q += c;
+        } else if (c == '\n') {
+            q += "\\n";
+        } else if (c < 0x20 || c >= 0x7f) {
+            // octal escape: it takes at most 3 digits, so it can't absorb the characters that follow
+            char esc[5];
+            std::snprintf(esc, sizeof(esc), "\\%03o", c);
+            q += esc;
+        } else {
+            q += c;
+        }
+    }
+    return q + "\"";
+}
+
+
+#ifdef CPP_EMITTER_SPAWN
+bool CppEmitter::canBuild() { return true; }
+
+bool CppEmitter::buildExecutable(const std::string& source, const std::string& exe_path) {
+    std::string tmpl = (std::filesystem::temp_directory_path() / "lispXXXXXX.cpp").string();
+    int fd = ::mkstemps(&tmpl[0], 4);
+    if (fd < 0) return false;
+    ::close(fd);
+    {
+        std::ofstream f{ tmpl, std::ios::binary };
+        f << source;
+        if (!f) {
+            std::remove(tmpl.c_str());
+            return false;
+        }
+    }
+
+    const char* env_cxx = std::getenv("CXX");
+    std::string cxx = (env_cxx != nullptr && *env_cxx != '\0') ? env_cxx : "c++";
+    std::string args[] = { cxx, "-std=c++17", "-O2", "-o", exe_path, tmpl };
+    char* argv[] = { &args[0][0], &args[1][0], &args[2][0], &args[3][0], &args[4][0], &args[5][0], nullptr };
+
+    pid_t pid;
+    int status = 0;
+    bool ok = ::posix_spawnp(&pid, argv[0], nullptr, nullptr, argv, environ) == 0
+        && ::waitpid(pid, &status, 0) == pid && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    std::remove(tmpl.c_str());
+    return ok;
+}
+#else
+// without posix_spawn the compiler is never run: --emit-cpp still writes the C++ source
+bool CppEmitter::canBuild() { return false; }
+
+bool CppEmitter::buildExecutable(const std::string&, const std::string&) { return false; }
+#endif
@@ -0,0 +1,79 @@
+#ifndef CPP_EMITTER_H
+#define CPP_EMITTER_H
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "Visitor.h"
+
+
+/* Class that extends Visitor superclass to translate a resolved Program (see ResolveVisitor)
+into the source of a standalone C++ program, built ahead of time into a native executable.
+Each slot becomes a local int64_t of main() (with a flag only if it has checked reads, see DefiniteAssignment),
+IF and WHILE become native branches and loops, INPUT and PRINT call a small runtime written at the
+beginning of the source. The executable gives the same output and the same errors as the EvaluationVisitor,
+reading the values of INPUT from the console after a prompt */
+class CppEmitter : public Visitor {
+public:
+    CppEmitter() = default;
+    ~CppEmitter() = default;
+
+    // Deletion of copy constructor and assignment operator: an emitter is used for a single Program
+    CppEmitter(const CppEmitter& other) = delete;
+    CppEmitter& operator=(const CppEmitter& other) = delete;
+
+    std::string operator()(Program* prg);
+
+    /* Build of the C++ "source" into the executable "exe_path" by the compiler of the environment
+    variable CXX (c++ if not set); the diagnostics of the compiler are written on stderr.
+    It returns false if the compiler can't be run or fails */
+    static bool buildExecutable(const std::string& source, const std::string& exe_path);
+
+    // False on the platforms without posix_spawn, where buildExecutable always fails
+    static bool canBuild();
+
+    void visitProgram(Program* prg) override;
+    void visitBlock(Block* blk) override;
+
+    void visitSet(SetStmt* s) override;
+    void visitInput(InputStmt* s) override;
+    void visitPrint(PrintStmt* s) override;
+    void visitIf(IfStmt* s) override;
+    void visitWhile(WhileStmt* s) override;
+
+    void visitOperator(Operator* opNode) override;
+    void visitNumber(Number* numNode) override;
+    void visitVariable(Variable* varNode) override;
+    void visitCheckedVariable(CheckedVariable* varNode) override;
+
+    void visitRelOp(RelOp* rop) override;
+    void visitBoolConst(BoolConst* bconst) override;
+    void visitBoolOp(BoolOp* bop) override;
+
+private:
+    std::ostringstream body; // statements of main()
+    int indent = 0;
+    std::vector<std::string> var_ids;
+    std::vector<unsigned char> checked; // flag for each slot read by a CheckedVariable
+    int n_temps = 0; // temporaries t0, t1, ... that keep the order of evaluation of the operands
+
+    /* C++ expression of the last visited NUM_EXPR or BOOL_EXPR, and whether its evaluation can fail.
+    The operands of a C++ operator are evaluated in any order: when both of them can fail,
+    the 1st one is stored in a temporary before the 2nd one (comma operator) */
+    std::string expr;
+    bool may_fail = false;
+
+    void line(const std::string& s) { body << std::string(4 * indent, ' ') << s << '\n'; }
+    /* Visit of the two operands of a binary node: "a" and "b" are their expressions and "seq" the assignment
+    of the 1st one to a temporary, if needed ("a" is then the temporary). It returns whether one of them can fail */
+    bool operands(NumExpr* first, NumExpr* second, std::string& a, std::string& b, std::string& seq);
+    static std::string sequence(const std::string& seq, const std::string& e) { return seq.empty() ? e : "(" + seq + e + ")"; }
+    std::string var(int slot) const { return "v" + std::to_string(slot); }
+    std::string declared(int slot) const { return "d" + std::to_string(slot); }
+
+    static std::string literal(int64_t val);
+    static std::string quote(const std::string& s);
+};
+
+#endif /* CPP_EMITTER_H */
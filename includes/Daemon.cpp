@@ -0,0 +1,165 @@
+#include <cerrno>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define DAEMON_SOCKETS 1
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#include "Daemon.h"
+#include "DaemonProtocol.h"
+#include "ExecutionContext.h"
+#include "Exceptions.h"
+
+
+// Largest source or list of INPUT values accepted in a request
+static constexpr size_t MAX_REQUEST_PART = 64 * 1024 * 1024;
+
+
+#ifdef DAEMON_SOCKETS
+
+bool Daemon::supported() { return true; }
+
+bool Daemon::serve(const std::string& path) {
+    sockaddr_un addr{};
+    if (path.size() >= sizeof(addr.sun_path)) {
+        errno = ENAMETOOLONG;
+        return false;
+    }
+    addr.sun_family = AF_UNIX;
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+
+    // a client closing its connection early must not end the daemon
+    std::signal(SIGPIPE, SIG_IGN);
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return false;
+    ::unlink(path.c_str());
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || ::listen(fd, SOMAXCONN) != 0) {
+        int e = errno;
+        ::close(fd);
+        errno = e;
+        return false;
+    }
+    listen_fd.store(fd);
+    if (stopping.load()) ::shutdown(fd, SHUT_RDWR);
+
+    for (;;) {
+        int conn = ::accept(fd, nullptr, nullptr);
+        if (conn < 0) {
+            if (stopping.load()) break;
+            if (errno == EINTR || errno == ECONNABORTED || errno == EMFILE || errno == ENFILE) continue;
+            break;
+        }
+        std::lock_guard<std::mutex> lock{ m };
+        if (stopping.load()) {
+            ::close(conn);
+            break;
+        }
+        connections.insert(conn);
+        std::thread{ &Daemon::handle, this, conn }.detach();
+    }
+
+    // The threads of the connections end after their current request
+    {
+        std::unique_lock<std::mutex> lock{ m };
+        for (int conn : connections) ::shutdown(conn, SHUT_RD);
+        idle_cv.wait(lock, [this] { return connections.empty(); });
+    }
+    listen_fd.store(-1);
+    ::close(fd);
+    ::unlink(path.c_str());
+    return true;
+}
+
+void Daemon::stop() {
+    std::lock_guard<std::mutex> lock{ m };
+    stopping.store(true);
+    int fd = listen_fd.load();
+    if (fd >= 0) ::shutdown(fd, SHUT_RDWR);
+}
+
+void Daemon::handle(int fd) {
+    SocketStream stream{ fd };
+    // the output of the runs is written through stdio on a copy of the descriptor
+    std::FILE* out = ::fdopen(::dup(fd), "w");
+
+    std::string line, source, input;
+    while (out != nullptr && stream.readLine(line)) {
+        unsigned long long hash = 0;
+        size_t source_len = 0, input_len = 0;
+        char tail;
+        bool with_source = true;
+        if (std::sscanf(line.c_str(), "RUN %16llx - %zu%c", &hash, &input_len, &tail) == 2) {
+            with_source = false;
+        } else if (std::sscanf(line.c_str(), "RUN %16llx %zu %zu%c", &hash, &source_len, &input_len, &tail) != 3) {
+            input_len = MAX_REQUEST_PART + 1;
+        }
+        if (source_len > MAX_REQUEST_PART || input_len > MAX_REQUEST_PART) {
+            stream.write(DaemonProtocol::end(DaemonProtocol::BAD_REQUEST, "(ERROR: invalid request )\n"));
+            break;
+        }
+        if (!stream.read(source_len, source) || !stream.read(input_len, input)) break;
+
+        // PREPARATION of the program, or reuse of the one in the cache
+        std::shared_ptr<const PreparedProgram> program;
+        std::string error;
+        if (!with_source) {
+            program = cache.find(hash);
+            if (!program) {
+                if (!stream.write(DaemonProtocol::end(DaemonProtocol::UNKNOWN_PROGRAM, ""))) break;
+                continue;
+            }
+        } else {
+            try {
+                program = cache.get(source);
+            } catch (LexicalError& le) {
+                error = le.what();
+                error += '\n';
+            } catch (SyntaxError& pe) {
+                error = pe.what();
+                error += '\n';
+            } catch (std::exception& exc) {
+                error = "(ERROR: generic error )\n";
+                error += exc.what();
+                error += '\n';
+            }
+        }
+
+        // EVALUATION, with the output of PRINT sent while the program runs
+        if (program) {
+            ExecutionContext ctx{ input, out };
+            ctx.run(program->get_engine());
+            error = std::move(ctx.get_error());
+        }
+        if (std::ferror(out)) break;
+        if (!stream.write(DaemonProtocol::end(error.empty() ? DaemonProtocol::OK : DaemonProtocol::RUN_ERROR, error))) break;
+    }
+
+    if (out != nullptr) std::fclose(out);
+    // the descriptor leaves the set before it can be given to a new connection
+    std::lock_guard<std::mutex> lock{ m };
+    connections.erase(fd);
+    ::close(fd);
+    idle_cv.notify_all();
+}
+
+#else
+
+// Unix domain sockets are not available: the daemon can't be started
+bool Daemon::supported() { return false; }
+
+bool Daemon::serve(const std::string&) {
+    errno = ENOSYS;
+    return false;
+}
+
+void Daemon::stop() {}
+
+void Daemon::handle(int) {}
+
+#endif
@@ -0,0 +1,51 @@
+#ifndef DAEMON_H
+#define DAEMON_H
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+
+#include "Options.h"
+#include "ProgramCache.h"
+
+
+/* Server running the programs sent by its clients on a Unix domain socket (see DaemonProtocol).
+The programs are prepared once and kept in a ProgramCache, so a client sending the same program again
+pays neither the start of a process nor the parsing. Each connection is served by its own thread,
+so the requests of different connections run at the same time, and the output of PRINT
+is sent back in blocks while the program runs. There is no time limit: a run goes on to its end
+also if its client has gone away */
+class Daemon {
+public:
+    Daemon(const Options& opts) : cache{ opts.cache_size, opts } {}
+    ~Daemon() = default;
+
+    // Deletion of copy constructor and assignment operator: the threads of the connections point to the Daemon
+    Daemon(const Daemon& other) = delete;
+    Daemon& operator=(const Daemon& other) = delete;
+
+    // False where the Unix domain sockets are not available (serve() always fails there)
+    static bool supported();
+
+    /* Service of the connections on the socket "path" (replacing a stale one) until stop():
+    it returns false, with errno set, if the socket can't be created */
+    bool serve(const std::string& path);
+    // End of serve() after the requests in progress (it can be called from any thread)
+    void stop();
+
+    ProgramCache& get_cache() { return cache; }
+
+private:
+    ProgramCache cache;
+    std::atomic<int> listen_fd{ -1 };
+    std::atomic<bool> stopping{ false };
+    std::mutex m;
+    std::condition_variable idle_cv;
+    std::unordered_set<int> connections;
+
+    void handle(int fd);
+};
+
+#endif /* DAEMON_H */
@@ -0,0 +1,168 @@
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define DAEMON_SOCKETS 1
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+// the daemon ignores SIGPIPE where send() has no flag for it
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0
+#endif
+#endif
+
+#include "DaemonProtocol.h"
+#include "SourceFile.h"
+
+
+uint64_t DaemonProtocol::hashSource(std::string_view source) {
+    return SourceFile::hash(source);
+}
+
+std::string DaemonProtocol::request(uint64_t hash, std::string_view source, std::string_view input, bool with_source) {
+    char head[80];
+    int n = with_source
+        ? std::snprintf(head, sizeof(head), "RUN %016llx %zu %zu\n", static_cast<unsigned long long>(hash), source.size(), input.size())
+        : std::snprintf(head, sizeof(head), "RUN %016llx - %zu\n", static_cast<unsigned long long>(hash), input.size());
+    std::string msg{ head, static_cast<size_t>(n) };
+    if (with_source) msg += source;
+    msg += input;
+    return msg;
+}
+
+std::string DaemonProtocol::end(Status status, std::string_view error) {
+    std::string msg = "#END " + std::to_string(status) + ' ' + std::to_string(error.size()) + '\n';
+    msg += error;
+    return msg;
+}
+
+
+#ifdef DAEMON_SOCKETS
+
+bool SocketStream::fill() {
+    if (pos > 0) {
+        buf.erase(0, pos);
+        pos = 0;
+    }
+    char chunk[16 * 1024];
+    ssize_t n;
+    do {
+        n = ::read(fd, chunk, sizeof(chunk));
+    } while (n < 0 && errno == EINTR);
+    if (n <= 0) return false;
+    buf.append(chunk, n);
+    return true;
+}
+
+bool SocketStream::readLine(std::string& line) {
+    size_t end;
+    while ((end = buf.find('\n', pos)) == std::string::npos) {
+        if (!fill()) return false;
+    }
+    line.assign(buf, pos, end - pos);
+    pos = end + 1;
+    return true;
+}
+
+bool SocketStream::read(size_t n, std::string& out) {
+    while (buf.size() - pos < n) {
+        if (!fill()) return false;
+    }
+    out.assign(buf, pos, n);
+    pos += n;
+    return true;
+}
+
+bool SocketStream::write(std::string_view data) {
+    while (!data.empty()) {
+        ssize_t n = ::send(fd, data.data(), data.size(), MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        data.remove_prefix(n);
+    }
+    return true;
+}
+
+
+bool DaemonClient::connect(const std::string& path) {
+    close();
+    sockaddr_un addr{};
+    if (path.size() >= sizeof(addr.sun_path)) return false;
+    addr.sun_family = AF_UNIX;
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return false;
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        close();
+        return false;
+    }
+    stream = new SocketStream{ fd };
+    return true;
+}
+
+void DaemonClient::close() {
+    delete(stream);
+    stream = nullptr;
+    if (fd >= 0) ::close(fd);
+    fd = -1;
+    sent.clear();
+}
+
+#else
+
+// Unix domain sockets are not available: no connection is ever made
+bool SocketStream::fill() { return false; }
+
+bool SocketStream::readLine(std::string&) { return false; }
+
+bool SocketStream::read(size_t, std::string&) { return false; }
+
+bool SocketStream::write(std::string_view) { return false; }
+
+bool DaemonClient::connect(const std::string&) {
+    errno = ENOSYS;
+    return false;
+}
+
+void DaemonClient::close() {
+    delete(stream);
+    stream = nullptr;
+    sent.clear();
+}
+
+#endif
+
+DaemonProtocol::Status DaemonClient::run(std::string_view source, std::string_view input, std::string& output, std::string& error) {
+    uint64_t hash = DaemonProtocol::hashSource(source);
+    if (sent.count(hash) > 0) {
+        DaemonProtocol::Status status = send(DaemonProtocol::request(hash, source, input, false), output, error);
+        if (status != DaemonProtocol::UNKNOWN_PROGRAM) return status;
+    }
+    sent.insert(hash);
+    return send(DaemonProtocol::request(hash, source, input), output, error);
+}
+
+DaemonProtocol::Status DaemonClient::send(const std::string& request, std::string& output, std::string& error) {
+    output.clear();
+    error.clear();
+    if (stream == nullptr || !stream->write(request)) return DaemonProtocol::NULL_VAL;
+
+    // Lines of PRINT up to the trailer
+    std::string line;
+    while (stream->readLine(line)) {
+        if (line.rfind("#END ", 0) != 0) {
+            output += line;
+            output += '\n';
+            continue;
+        }
+        int status = 0;
+        size_t n = 0;
+        if (std::sscanf(line.c_str() + 5, "%d %zu", &status, &n) != 2 || status < 0 || status >= DaemonProtocol::NULL_VAL) break;
+        if (!stream->read(n, error)) break;
+        return static_cast<DaemonProtocol::Status>(status);
+    }
+    return DaemonProtocol::NULL_VAL;
+}
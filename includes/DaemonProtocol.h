@@ -0,0 +1,78 @@
+#ifndef DAEMON_PROTOCOL_H
+#define DAEMON_PROTOCOL_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+
+
+/* Messages exchanged on the Unix domain socket of a Daemon (see --serve).
+Request:  "RUN <hash> <source bytes> <input bytes>\n", followed by the source and by the values of INPUT
+          (words separated by white spaces). The source can be left out ("-" instead of its bytes) if the daemon
+          already has the program whose hash (16 hexadecimal digits of hashSource()) is given.
+Response: the lines of PRINT, sent while the program runs, then "#END <status> <bytes>\n" followed by
+          the message of the error that stopped the run (as the interpreter writes it on stderr), if any.
+A connection carries any number of requests, one after the other */
+struct DaemonProtocol {
+    /* Enumeration of the status of a response: the run ended normally or with an error (also a LexicalError
+    or a SyntaxError of the source), the daemon doesn't have the program of the hash (the source must be sent),
+    the request is not valid (the daemon closes the connection). NULL_VAL is useful to identify an invalid value */
+    enum Status { OK, RUN_ERROR, UNKNOWN_PROGRAM, BAD_REQUEST, NULL_VAL };
+
+    // FNV-1a hash of the source (see SourceFile::hash())
+    static uint64_t hashSource(std::string_view source);
+
+    // Request with the source, or with only its hash if "with_source" is false
+    static std::string request(uint64_t hash, std::string_view source, std::string_view input, bool with_source = true);
+    static std::string end(Status status, std::string_view error);
+};
+
+
+/* Buffered reader and writer of a connected socket */
+class SocketStream {
+public:
+    SocketStream(int f) : fd{ f } {}
+
+    // Next line, without the '\n': false at the end of the stream
+    bool readLine(std::string& line);
+    // Next "n" bytes: false if the stream ends before
+    bool read(size_t n, std::string& out);
+    bool write(std::string_view data);
+
+private:
+    int fd;
+    std::string buf;
+    size_t pos = 0;
+
+    bool fill();
+};
+
+
+/* Client of a Daemon: it sends only the hash of a source already sent on the same connection
+(and the whole source again if the daemon answers UNKNOWN_PROGRAM, e.g. after an eviction) */
+class DaemonClient {
+public:
+    DaemonClient() = default;
+    ~DaemonClient() { close(); }
+
+    // Deletion of copy constructor and assignment operator: the socket has a single owner
+    DaemonClient(const DaemonClient& other) = delete;
+    DaemonClient& operator=(const DaemonClient& other) = delete;
+
+    bool connect(const std::string& path);
+    void close();
+
+    /* Run of "source" with the values of INPUT "input": the output of PRINT and the error message are
+    written in "output" and "error". It returns NULL_VAL if the connection is lost */
+    DaemonProtocol::Status run(std::string_view source, std::string_view input, std::string& output, std::string& error);
+
+private:
+    int fd = -1;
+    SocketStream* stream = nullptr;
+    std::unordered_set<uint64_t> sent; // hashes of the sources sent on this connection
+
+    DaemonProtocol::Status send(const std::string& request, std::string& output, std::string& error);
+};
+
+#endif /* DAEMON_PROTOCOL_H */
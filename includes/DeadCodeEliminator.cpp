@@ -0,0 +1,383 @@
+#include <unordered_map>
+
+#include "DeadCodeEliminator.h"
+#include "SlotSet.h"
+#include "DeclaredSlots.h"
+
+
+/* Forward analysis of the errors: it finds the SET statements whose NUM_EXPR can throw an error
+(undeclared variable, DIV by a value that can be 0) and the statements that never complete.
+The variables surely declared at each point are the ones of DeclaredSlots */
+class FailureAnalysis : public Visitor {
+public:
+    FailureAnalysis(unsigned int n_vars, std::unordered_set<Statement*>& never) : never_completes{ never } { declared.assign(n_vars); }
+
+    std::unordered_set<Statement*> unsafe; // SET statements whose evaluation can throw an error
+
+    void visitProgram(Program*) override {}
+
+    void visitBlock(Block* b) override {
+        // an empty Block gives an error
+        completes = b->get_stmts().size() > 0;
+        for (Statement* s : b->get_stmts()) {
+            s->accept(this);
+            if (!completes) break; // the rest is unreachable
+        }
+    }
+
+    void visitSet(SetStmt* s) override {
+        s->get_nexpr()->accept(this);
+        if (may_fail) unsafe.insert(s);
+        declared.declare(s->get_var()->get_slot());
+        statement(s, !surely_fails);
+    }
+
+    void visitInput(InputStmt* s) override {
+        declared.declare(s->get_var()->get_slot());
+        statement(s, true);
+    }
+
+    void visitPrint(PrintStmt* s) override {
+        s->get_nexpr()->accept(this);
+        statement(s, !surely_fails);
+    }
+
+    void visitIf(IfStmt* s) override {
+        s->get_bexpr()->accept(this);
+        bool guard_fails = surely_fails;
+        bool completes1 = true;
+        declared.branches([&] { s->get_stmt_block1()->accept(this); completes1 = completes; },
+                          [&] { s->get_stmt_block2()->accept(this); });
+        statement(s, !guard_fails && (completes1 || completes));
+    }
+
+    void visitWhile(WhileStmt* s) override {
+        s->get_bexpr()->accept(this);
+        bool guard_fails = surely_fails;
+        BoolConst* c = dynamic_cast<BoolConst*>(s->get_bexpr());
+        bool endless = (c != nullptr && c->get_bconst() == BoolConst::TRUE);
+        declared.mayNotRun([&] { s->get_stmt_block()->accept(this); });
+        statement(s, !guard_fails && !endless);
+    }
+
+    void visitOperator(Operator* opNode) override {
+        opNode->getFirst()->accept(this);
+        bool first_may = may_fail, first_surely = surely_fails;
+        opNode->getSecond()->accept(this);
+        may_fail = may_fail || first_may;
+        surely_fails = surely_fails || first_surely;
+        if (opNode->getOp() == Operator::DIV) {
+            // DIV by 0 gives an error, INT64_MIN / -1 stops the program
+            Number* divisor = dynamic_cast<Number*>(opNode->getSecond());
+            if (divisor == nullptr || divisor->get_value() == 0 || divisor->get_value() == -1) may_fail = true;
+            if (divisor != nullptr && divisor->get_value() == 0) surely_fails = true;
+        }
+    }
+
+    void visitNumber(Number*) override {
+        may_fail = false;
+        surely_fails = false;
+    }
+
+    void visitVariable(Variable* varNode) override {
+        may_fail = !declared[varNode->get_slot()];
+        surely_fails = false;
+    }
+
+    void visitRelOp(RelOp* rop) override {
+        rop->get_first_nexpr()->accept(this);
+        bool first_may = may_fail, first_surely = surely_fails;
+        rop->get_second_nexpr()->accept(this);
+        may_fail = may_fail || first_may;
+        surely_fails = surely_fails || first_surely;
+    }
+
+    void visitBoolConst(BoolConst*) override {
+        may_fail = false;
+        surely_fails = false;
+    }
+
+    void visitBoolOp(BoolOp* bop) override {
+        bop->get_f_bexpr()->accept(this);
+        if (bop->get_b_opcode() == BoolOp::NOT) return;
+        // only the 1st operand is surely evaluated (short-circuit)
+        bool first_may = may_fail, first_surely = surely_fails;
+        bop->get_s_bexpr()->accept(this);
+        may_fail = may_fail || first_may;
+        surely_fails = first_surely;
+    }
+
+private:
+    DeclaredSlots declared; // variables surely declared at the current point
+    std::unordered_set<Statement*>& never_completes;
+    bool may_fail = false;     // the last expression visited can throw an error
+    bool surely_fails = false; // the last expression visited throws an error whenever it is evaluated
+    bool completes = true;     // the last statement or Block visited can complete
+
+    void statement(Statement* s, bool c) {
+        completes = c;
+        if (!c) never_completes.insert(s);
+    }
+};
+
+
+/* Backward analysis of the live variables (whose value can be read later): a SET of a variable
+not live after it is a dead store, unless its evaluation can throw an error.
+A dead store doesn't make live the variables of its NUM_EXPR, so the stores that only feed it are dead too */
+class LivenessAnalysis : public Visitor {
+public:
+    LivenessAnalysis(unsigned int n_vars, const std::unordered_set<Statement*>& u, const std::unordered_set<Statement*>& never, std::unordered_set<Statement*>& d)
+        : unsafe{ u }, never_completes{ never }, dead{ d } { live.assign(n_vars, 0); }
+
+    void visitProgram(Program*) override {}
+
+    void visitBlock(Block* b) override {
+        StatementList stmts = b->get_stmts();
+        size_t last = stmts.size();
+        // Nothing after a statement that never completes is run
+        for (size_t i = 0; i < stmts.size(); i++) {
+            if (never_completes.count(stmts[i])) {
+                for (size_t slot = 0; slot < live.size(); slot++) live.set(static_cast<int>(slot), 0);
+                last = i + 1;
+                break;
+            }
+        }
+        for (size_t i = last; i-- > 0;)
+            stmts[i]->accept(this);
+    }
+
+    void visitSet(SetStmt* s) override {
+        int slot = s->get_var()->get_slot();
+        if (!live[slot] && !unsafe.count(s)) {
+            if (commit) dead.insert(s);
+            return;
+        }
+        live.set(slot, 0);
+        s->get_nexpr()->accept(this);
+    }
+
+    void visitInput(InputStmt* s) override {
+        live.set(s->get_var()->get_slot(), 0);
+    }
+
+    void visitPrint(PrintStmt* s) override {
+        s->get_nexpr()->accept(this);
+    }
+
+    void visitIf(IfStmt* s) override {
+        size_t after = live.mark();
+        s->get_stmt_block2()->accept(this);
+        SlotSet::Changes live2 = live.take(after);
+        s->get_stmt_block1()->accept(this);
+        live.merge(live.take(after), live2, [](unsigned char a, unsigned char b) { return a | b; });
+        s->get_bexpr()->accept(this);
+    }
+
+    void visitWhile(WhileStmt* s) override {
+        /* Variables live before each evaluation of the guard: the least fixed point of
+        guard = uses(bexpr) + live after the WHILE + live before the body (with guard live after it).
+        The dead stores of the body are recorded only with the final set.
+        The live sets only grow from a visit of the WHILE to the next one (in the fixed point of an enclosing WHILE):
+        the iteration starts from the slots the body added to the guard at the last visit, instead of computing
+        an inner loop from the start for each iteration of the outer one. The visit recording the dead stores
+        follows one with the same live set after the WHILE, so its guard is already the final one */
+        s->get_bexpr()->accept(this);
+        // live holds the guard set between the visits of the body
+        size_t entry = live.mark();
+        bool known = guard_added.count(s) > 0;
+        std::vector<int>& added = guard_added[s];
+        for (int slot : added) live.set(slot);
+        if (!commit || !known) {
+            bool saved_commit = commit;
+            commit = false;
+            for (;;) {
+                size_t guard = live.mark();
+                s->get_stmt_block()->accept(this);
+                bool changed = false;
+                for (const SlotSet::Change& c : live.take(guard)) {
+                    if (c.value && !live[c.slot]) {
+                        live.set(c.slot);
+                        changed = true;
+                    }
+                }
+                if (!changed) break;
+            }
+            commit = saved_commit;
+            added.clear();
+            for (const SlotSet::Change& c : live.since(entry)) added.push_back(c.slot);
+        }
+        if (commit) {
+            size_t guard = live.mark();
+            s->get_stmt_block()->accept(this);
+            live.undo(guard);
+        }
+    }
+
+    void visitOperator(Operator* opNode) override {
+        opNode->getFirst()->accept(this);
+        opNode->getSecond()->accept(this);
+    }
+
+    void visitNumber(Number*) override {}
+
+    void visitVariable(Variable* varNode) override {
+        live.set(varNode->get_slot());
+    }
+
+    void visitRelOp(RelOp* rop) override {
+        rop->get_first_nexpr()->accept(this);
+        rop->get_second_nexpr()->accept(this);
+    }
+
+    void visitBoolConst(BoolConst*) override {}
+
+    void visitBoolOp(BoolOp* bop) override {
+        bop->get_f_bexpr()->accept(this);
+        if (bop->get_b_opcode() != BoolOp::NOT) bop->get_s_bexpr()->accept(this);
+    }
+
+private:
+    SlotSet live; // flag for each slot whose value can be read after the current point
+    const std::unordered_set<Statement*>& unsafe;
+    const std::unordered_set<Statement*>& never_completes;
+    std::unordered_set<Statement*>& dead;
+    bool commit = true; // false while the fixed point of a WHILE is computed
+    std::unordered_map<WhileStmt*, std::vector<int>> guard_added; // slots added to the guard set by the body of each WHILE at its last visit
+};
+
+
+/* Count of the nodes of a statement, with its expressions and Blocks */
+class NodeCounter : public Visitor {
+public:
+    unsigned int count(Statement* s) {
+        n = 0;
+        s->accept(this);
+        return n;
+    }
+
+    void visitProgram(Program*) override {}
+    void visitBlock(Block* b) override {
+        n++;
+        for (Statement* s : b->get_stmts()) s->accept(this);
+    }
+
+    void visitSet(SetStmt* s) override {
+        n++;
+        s->get_var()->accept(this);
+        s->get_nexpr()->accept(this);
+    }
+    void visitInput(InputStmt* s) override {
+        n++;
+        s->get_var()->accept(this);
+    }
+    void visitPrint(PrintStmt* s) override {
+        n++;
+        s->get_nexpr()->accept(this);
+    }
+    void visitIf(IfStmt* s) override {
+        n++;
+        s->get_bexpr()->accept(this);
+        s->get_stmt_block1()->accept(this);
+        s->get_stmt_block2()->accept(this);
+    }
+    void visitWhile(WhileStmt* s) override {
+        n++;
+        s->get_bexpr()->accept(this);
+        s->get_stmt_block()->accept(this);
+    }
+
+    void visitOperator(Operator* opNode) override {
+        n++;
+        opNode->getFirst()->accept(this);
+        opNode->getSecond()->accept(this);
+    }
+    void visitNumber(Number*) override { n++; }
+    void visitVariable(Variable*) override { n++; }
+
+    void visitRelOp(RelOp* rop) override {
+        n++;
+        rop->get_first_nexpr()->accept(this);
+        rop->get_second_nexpr()->accept(this);
+    }
+    void visitBoolConst(BoolConst*) override { n++; }
+    void visitBoolOp(BoolOp* bop) override {
+        n++;
+        bop->get_f_bexpr()->accept(this);
+        if (bop->get_b_opcode() != BoolOp::NOT) bop->get_s_bexpr()->accept(this);
+    }
+
+private:
+    unsigned int n = 0;
+};
+
+
+void DeadCodeEliminator::visitProgram(Program* prg) {
+    n_dead_stores = 0;
+    n_unreachable = 0;
+    n_removed_nodes = 0;
+    dead.clear();
+    never_completes.clear();
+    if (!prg->get_is_not_empty()) return;
+
+    FailureAnalysis failures{ prg->get_n_vars(), never_completes };
+    prg->get_blk()->accept(&failures);
+    LivenessAnalysis liveness{ prg->get_n_vars(), failures.unsafe, never_completes, dead };
+    prg->get_blk()->accept(&liveness);
+
+    prg->get_blk()->accept(this);
+    prg->set_blk(blk);
+}
+
+void DeadCodeEliminator::visitBlock(Block* b) {
+    blocks.open();
+    NodeCounter counter;
+    StatementList old_stmts = b->get_stmts();
+    SetStmt* first_dead = nullptr;
+    for (size_t i = 0; i < old_stmts.size(); i++) {
+        Statement* s = old_stmts[i];
+        if (dead.count(s)) {
+            if (first_dead == nullptr) first_dead = static_cast<SetStmt*>(s);
+            n_dead_stores++;
+            n_removed_nodes += counter.count(s);
+            continue;
+        }
+        blocks.visitStatement(s, this);
+        if (never_completes.count(s)) {
+            // the rest of the Block is unreachable
+            for (i++; i < old_stmts.size(); i++) {
+                n_unreachable++;
+                n_removed_nodes += counter.count(old_stmts[i]);
+            }
+        }
+    }
+
+    std::vector<Statement*>& stmts = blocks.statements();
+    if (stmts.empty() && first_dead != nullptr) {
+        // (SET x 0): the variable isn't live, the Block keeps a statement of 3 nodes
+        n_dead_stores--;
+        n_removed_nodes -= 3;
+        NodeFactory::LineScope line{ nf, first_dead->get_line() };
+        stmts.push_back(nf.makeSetStmt(nf.makeNumber(0), first_dead->get_var()));
+    }
+    blk = blocks.close(b);
+}
+
+
+/* STATEMENTS */
+void DeadCodeEliminator::visitSet(SetStmt* s) { emit(s); }
+
+void DeadCodeEliminator::visitInput(InputStmt* s) { emit(s); }
+
+void DeadCodeEliminator::visitPrint(PrintStmt* s) { emit(s); }
+
+void DeadCodeEliminator::visitIf(IfStmt* s) {
+    s->get_stmt_block1()->accept(this);
+    Block* blk1 = blk;
+    s->get_stmt_block2()->accept(this);
+    emit(blocks.ifStmt(s, s->get_bexpr(), blk1, blk));
+}
+
+void DeadCodeEliminator::visitWhile(WhileStmt* s) {
+    s->get_stmt_block()->accept(this);
+    emit(blocks.whileStmt(s, s->get_bexpr(), blk));
+}
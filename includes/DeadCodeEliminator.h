@@ -0,0 +1,71 @@
+#ifndef DEAD_CODE_ELIMINATOR_H
+#define DEAD_CODE_ELIMINATOR_H
+
+#include <unordered_set>
+
+#include "Visitor.h"
+#include "NodeFactory.h"
+#include "BlockRebuilder.h"
+
+
+/* Class that extends Visitor superclass to remove the statements of a resolved Program (see ResolveVisitor)
+that have no observable effect:
+- dead stores: SET statements whose value is never read (liveness of the variables, computed backwards
+  with a fixed point for the WHILE bodies), if the evaluation of their NUM_EXPR can't throw an error;
+- unreachable statements: the statements following, in the same Block, a statement that never completes
+  (a WHILE with a TRUE guard or an expression that surely gives an error, e.g. DIV by the constant 0).
+PRINT and INPUT statements and every error of the run are kept. The Blocks that change are rebuilt
+by the NodeFactory of the Program; a Block left without statements (an error at run time) keeps
+a (SET x 0) in place of its first dead store */
+class DeadCodeEliminator : public Visitor {
+public:
+    DeadCodeEliminator(NodeFactory& node_f) : nf{ node_f }, blocks{ node_f } {}
+    ~DeadCodeEliminator() = default;
+
+    // Deletion of copy constructor and assignment operator: a DeadCodeEliminator is used for a single Program
+    DeadCodeEliminator(const DeadCodeEliminator& other) = delete;
+    DeadCodeEliminator& operator=(const DeadCodeEliminator& other) = delete;
+
+    // Removal of the dead code of the Program, whose main Block is replaced
+    void operator()(Program* prg) { prg->accept(this); }
+
+    // Statistics of the last run
+    unsigned int get_n_dead_stores() const { return n_dead_stores; }
+    unsigned int get_n_unreachable() const { return n_unreachable; }
+    unsigned int get_n_removed_nodes() const { return n_removed_nodes; } // nodes of the removed statements
+
+    void visitProgram(Program* prg) override;
+    void visitBlock(Block* blk) override;
+
+    void visitSet(SetStmt* s) override;
+    void visitInput(InputStmt* s) override;
+    void visitPrint(PrintStmt* s) override;
+    void visitIf(IfStmt* s) override;
+    void visitWhile(WhileStmt* s) override;
+
+    // The expressions are kept as they are
+    void visitOperator(Operator*) override {}
+    void visitNumber(Number*) override {}
+    void visitVariable(Variable*) override {}
+
+    void visitRelOp(RelOp*) override {}
+    void visitBoolConst(BoolConst*) override {}
+    void visitBoolOp(BoolOp*) override {}
+
+private:
+    NodeFactory& nf;
+    unsigned int n_dead_stores = 0;
+    unsigned int n_unreachable = 0;
+    unsigned int n_removed_nodes = 0;
+
+    // Results of the analysis
+    std::unordered_set<Statement*> dead;            // dead stores
+    std::unordered_set<Statement*> never_completes; // statements after which the rest of the Block is unreachable
+
+    BlockRebuilder blocks;
+    Block* blk = nullptr; // result of the last visit of a Block
+
+    void emit(Statement* s) { blocks.emit(s); }
+};
+
+#endif /* DEAD_CODE_ELIMINATOR_H */
@@ -0,0 +1,42 @@
+#ifndef DECLARED_SLOTS_H
+#define DECLARED_SLOTS_H
+
+#include "SlotSet.h"
+
+
+/* Variables surely declared at each point of a forward pass over a resolved Program (the dataflow of
+DefiniteAssignment, shared by the passes that must not move or drop the error of an undeclared variable):
+a SET or an INPUT declares its variable, only the variables declared by both blocks of an IF are declared
+after it, and the code that may not be run (the body of a WHILE, the 2nd operand of AND and OR) declares
+nothing for what follows. The blocks are visited by the pass through the callbacks of branches() and mayNotRun() */
+class DeclaredSlots {
+public:
+    void assign(size_t n_slots) { declared.assign(n_slots, 0); }
+
+    bool operator[](int slot) const { return declared[slot]; }
+    void declare(int slot) { declared.set(slot); }
+
+    /* Visit of the two blocks of an IF by "first" and "second", each one from the variables declared before the IF:
+    only the variables declared by both blocks are surely declared after it */
+    template <typename First, typename Second>
+    void branches(First first, Second second) {
+        size_t before = declared.mark();
+        first();
+        SlotSet::Changes after1 = declared.take(before);
+        second();
+        declared.merge(after1, declared.take(before), [](unsigned char a, unsigned char b) { return a & b; });
+    }
+
+    // Visit by "code" of code that may not be run: the variables it declares are not surely declared after it
+    template <typename Code>
+    void mayNotRun(Code code) {
+        size_t before = declared.mark();
+        code();
+        declared.undo(before);
+    }
+
+private:
+    SlotSet declared;
+};
+
+#endif /* DECLARED_SLOTS_H */
@@ -0,0 +1,117 @@
+#include "DefiniteAssignment.h"
+
+
+void DefiniteAssignment::visitProgram(Program* prg) {
+    n_unchecked = 0;
+    n_checked = 0;
+    declared.assign(prg->get_n_vars());
+    if (prg->get_is_not_empty()) {
+        prg->get_blk()->accept(this);
+        prg->set_blk(blk);
+    }
+}
+
+void DefiniteAssignment::visitBlock(Block* b) {
+    blk = blocks.rebuild(b, this);
+}
+
+
+/* STATEMENTS */
+void DefiniteAssignment::visitSet(SetStmt* s) {
+    s->get_nexpr()->accept(this);
+    // The variable is declared from now on
+    declared.declare(s->get_var()->get_slot());
+    emit((nexpr == s->get_nexpr()) ? s : nf.makeSetStmt(nexpr, s->get_var()));
+}
+
+void DefiniteAssignment::visitInput(InputStmt* s) {
+    declared.declare(s->get_var()->get_slot());
+    emit(s);
+}
+
+void DefiniteAssignment::visitPrint(PrintStmt* s) {
+    s->get_nexpr()->accept(this);
+    emit((nexpr == s->get_nexpr()) ? s : nf.makePrintStmt(nexpr));
+}
+
+void DefiniteAssignment::visitIf(IfStmt* s) {
+    s->get_bexpr()->accept(this);
+    BoolExpr* cond = bexpr;
+
+    Block* blk1 = nullptr;
+    Block* blk2 = nullptr;
+    declared.branches([&] { s->get_stmt_block1()->accept(this); blk1 = blk; },
+                      [&] { s->get_stmt_block2()->accept(this); blk2 = blk; });
+    emit(blocks.ifStmt(s, cond, blk1, blk2));
+}
+
+void DefiniteAssignment::visitWhile(WhileStmt* s) {
+    /* Each evaluation of the guard follows the first one, or a run of the body: the variables
+    declared before the loop (and by the guard itself) are declared at every evaluation */
+    s->get_bexpr()->accept(this);
+    BoolExpr* cond = bexpr;
+
+    declared.mayNotRun([&] { s->get_stmt_block()->accept(this); });
+    emit(blocks.whileStmt(s, cond, blk));
+}
+
+
+/* NUM_EXPR */
+void DefiniteAssignment::visitOperator(Operator* opNode) {
+    opNode->getFirst()->accept(this);
+    NumExpr* first = nexpr;
+    opNode->getSecond()->accept(this);
+    NumExpr* second = nexpr;
+    nexpr = (first == opNode->getFirst() && second == opNode->getSecond()) ? opNode : nf.makeOperator(opNode->getOp(), first, second);
+}
+
+void DefiniteAssignment::visitNumber(Number* numNode) {
+    nexpr = numNode;
+}
+
+void DefiniteAssignment::visitVariable(Variable* varNode) {
+    nexpr = varNode;
+}
+
+void DefiniteAssignment::visitCheckedVariable(CheckedVariable* varNode) {
+    int slot = varNode->get_slot();
+    if (declared[slot]) {
+        Variable* v = static_cast<Variable*>(nf.makeVariable(varNode->get_id()));
+        v->set_slot(slot);
+        nexpr = v;
+        n_unchecked++;
+    } else {
+        nexpr = varNode;
+        n_checked++;
+        // the run goes on after this read only if the variable is declared
+        declared.declare(slot);
+    }
+}
+
+
+/* BOOL_EXPR */
+void DefiniteAssignment::visitRelOp(RelOp* rop) {
+    rop->get_first_nexpr()->accept(this);
+    NumExpr* first = nexpr;
+    rop->get_second_nexpr()->accept(this);
+    NumExpr* second = nexpr;
+    bexpr = (first == rop->get_first_nexpr() && second == rop->get_second_nexpr()) ? rop : nf.makeRelOp(rop->get_r_opcode(), first, second);
+}
+
+void DefiniteAssignment::visitBoolConst(BoolConst* bconst) {
+    bexpr = bconst;
+}
+
+void DefiniteAssignment::visitBoolOp(BoolOp* bop) {
+    bop->get_f_bexpr()->accept(this);
+    BoolExpr* first = bexpr;
+    if (bop->get_b_opcode() == BoolOp::NOT) {
+        bexpr = (first == bop->get_f_bexpr()) ? bop : nf.makeBoolOp(BoolOp::NOT, first, nullptr);
+        return;
+    }
+
+    // The 2nd operand may not be evaluated (short-circuit): its reads prove nothing after the BoolOp
+    declared.mayNotRun([&] { bop->get_s_bexpr()->accept(this); });
+    BoolExpr* second = bexpr;
+    bexpr = (first == bop->get_f_bexpr() && second == bop->get_s_bexpr()) ? bop : nf.makeBoolOp(bop->get_b_opcode(), first, second);
+}
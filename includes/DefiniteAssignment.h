@@ -0,0 +1,65 @@
+#ifndef DEFINITE_ASSIGNMENT_H
+#define DEFINITE_ASSIGNMENT_H
+
+#include "Visitor.h"
+#include "NodeFactory.h"
+#include "DeclaredSlots.h"
+#include "BlockRebuilder.h"
+
+
+/* Class that extends Visitor superclass to remove the run time checks of the variable reads
+of a resolved Program (see ResolveVisitor) that surely follow a declaration.
+A forward pass tracks the variables declared on every path to each point (see DeclaredSlots),
+where a read that doesn't throw an error proves its variable declared for what follows too. Each CheckedVariable read of a declared variable
+is replaced by a plain Variable, read without any check; the other ones keep their check and their message */
+class DefiniteAssignment : public Visitor {
+public:
+    DefiniteAssignment(NodeFactory& node_f) : nf{ node_f }, blocks{ node_f } {}
+    ~DefiniteAssignment() = default;
+
+    // Deletion of copy constructor and assignment operator: a DefiniteAssignment is used for a single Program
+    DefiniteAssignment(const DefiniteAssignment& other) = delete;
+    DefiniteAssignment& operator=(const DefiniteAssignment& other) = delete;
+
+    // Removal of the checks proved useless, the main Block of the Program is replaced
+    void operator()(Program* prg) { prg->accept(this); }
+
+    // Statistics of the last run: reads without check and reads that keep their check
+    unsigned int get_n_unchecked() const { return n_unchecked; }
+    unsigned int get_n_checked() const { return n_checked; }
+
+    void visitProgram(Program* prg) override;
+    void visitBlock(Block* blk) override;
+
+    void visitSet(SetStmt* s) override;
+    void visitInput(InputStmt* s) override;
+    void visitPrint(PrintStmt* s) override;
+    void visitIf(IfStmt* s) override;
+    void visitWhile(WhileStmt* s) override;
+
+    void visitOperator(Operator* opNode) override;
+    void visitNumber(Number* numNode) override;
+    void visitVariable(Variable* varNode) override;
+    void visitCheckedVariable(CheckedVariable* varNode) override;
+
+    void visitRelOp(RelOp* rop) override;
+    void visitBoolConst(BoolConst* bconst) override;
+    void visitBoolOp(BoolOp* bop) override;
+
+private:
+    NodeFactory& nf;
+    unsigned int n_unchecked = 0;
+    unsigned int n_checked = 0;
+
+    DeclaredSlots declared; // variables surely declared at the current point
+    BlockRebuilder blocks;
+
+    // result of the last visit: the rewritten node
+    NumExpr* nexpr = nullptr;
+    BoolExpr* bexpr = nullptr;
+    Block* blk = nullptr;
+
+    void emit(Statement* s) { blocks.emit(s); }
+};
+
+#endif /* DEFINITE_ASSIGNMENT_H */
@@ -3,6 +3,7 @@
 
 #include <stdexcept>
 #include <string>
+#include <sstream>
 
 
 /* Structures dedicated to classify possible errors during the execution of the interpreter */
@@ -22,4 +23,48 @@ struct SemanticError : std::runtime_error {
 };
 
 
+/* Texts of the SemanticErrors raised while a program runs.
+They are shared by every execution engine so that the same program fails with the same message */
+struct SemanticMessage {
+    // VARIABLE_ID read as the whole NUM_EXPR of a SET statement
+    static std::string undeclaredVariable(const std::string& id) {
+        std::stringstream tmp{};
+        tmp << "(ERROR (semantic): variable \"" << id << "\" NOT declared before )" << std::endl;
+        return tmp.str();
+    }
+
+    static std::string undeclaredPrint(const std::string& id) {
+        std::stringstream tmp{};
+        tmp << "(ERROR (semantic): PRINT of VARIABLE_ID \"" << id << "\" not declared before )";
+        return tmp.str();
+    }
+
+    static std::string undeclaredOperand(const std::string& op, const std::string& id) {
+        std::stringstream tmp{};
+        tmp << "(ERROR (semantic): ARITHMETIC_OPERATOR \"" << op << "\" is using VARIABLE_ID \"" << id << "\" not declared before )";
+        return tmp.str();
+    }
+
+    static std::string undeclaredRelOperand(const std::string& op, const std::string& id) {
+        std::stringstream tmp{};
+        tmp << "(ERROR (semantic): REL_OP \"" << op << "\" is using VARIABLE_ID \"" << id << "\" not declared before )";
+        return tmp.str();
+    }
+
+    static std::string divisionByZero() {
+        return "(ERROR (semantic): DIV by 0 )";
+    }
+
+    static std::string emptyBlock() {
+        return "(ERROR (semantic): empty block given )";
+    }
+
+    static std::string invalidInput(const std::string& input) {
+        std::stringstream tmp{};
+        tmp << "(ERROR (semantic): input value can only be a NUMBER and significant digits can't be after a series of 0, \"" << input << "\" given )";
+        return tmp.str();
+    }
+};
+
+
 #endif /* EXCEPTIONS_H */
\ No newline at end of file
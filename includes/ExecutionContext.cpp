@@ -0,0 +1,18 @@
+#include "ExecutionContext.h"
+#include "Exceptions.h"
+
+
+void ExecutionContext::run(const Engine& engine) {
+    try {
+        engine(&rt);
+    } catch (SemanticError& se) {
+        error = se.what();
+        error += '\n';
+    } catch (std::exception& exc) {
+        error = "(ERROR: generic error )\n";
+        error += exc.what();
+        error += '\n';
+    }
+    // the output of the run comes before its error
+    out.flush();
+}
@@ -0,0 +1,50 @@
+#ifndef EXECUTION_CONTEXT_H
+#define EXECUTION_CONTEXT_H
+
+#include <functional>
+#include <string>
+#include <string_view>
+
+#include "Runtime.h"
+#include "OutputSink.h"
+#include "InputSource.h"
+
+
+/* State of one run of a Program that shares its syntax tree (or its compiled code) with other runs:
+the values of INPUT are the words of a row, the output of PRINT and the message of the error
+that stops the run, if any, are collected in memory. The evaluators keep the values of the variables
+in their own storage and never write the nodes, so the runs in different ExecutionContexts
+can take place at the same time */
+class ExecutionContext {
+public:
+    // Function running the Program once with the given Runtime (an execution engine)
+    using Engine = std::function<void(Runtime*)>;
+
+    ExecutionContext(std::string_view row) : in{ row }, out{ output }, rt{ &out, &in } {}
+    // Context writing the output of PRINT on "f" in blocks (get_output() stays empty)
+    ExecutionContext(std::string_view row, std::FILE* f) : in{ row }, out{ f, OutputSink::SIZE }, rt{ &out, &in } {}
+    ~ExecutionContext() = default;
+
+    // Deletion of copy constructor and assignment operator: the Runtime points to the members
+    ExecutionContext(const ExecutionContext& other) = delete;
+    ExecutionContext& operator=(const ExecutionContext& other) = delete;
+
+    // Run by "engine": an error is caught and its message is kept as the interpreter writes it on stderr
+    void run(const Engine& engine);
+
+    // The output written on the file also if the process is stopped by a fatal signal (see OutputSink)
+    void flushOnFatalSignal() { out.flushOnFatalSignal(); }
+
+    bool failed() const { return !error.empty(); }
+    std::string& get_output() { return output; }
+    std::string& get_error() { return error; }
+
+private:
+    std::string output;
+    std::string error;
+    InputSource in;
+    OutputSink out;
+    Runtime rt;
+};
+
+#endif /* EXECUTION_CONTEXT_H */
@@ -0,0 +1,28 @@
+#include "FlatAst.h"
+
+
+const char* flatOp2String(FlatOp op) {
+    switch (op) {
+        case FlatOp::BLOCK: return "BLOCK";
+        case FlatOp::SET: return "SET";
+        case FlatOp::INPUT: return "INPUT";
+        case FlatOp::PRINT: return "PRINT";
+        case FlatOp::IF: return "IF";
+        case FlatOp::WHILE: return "WHILE";
+        case FlatOp::ADD: return "ADD";
+        case FlatOp::SUB: return "SUB";
+        case FlatOp::MUL: return "MUL";
+        case FlatOp::DIV: return "DIV";
+        case FlatOp::NUMBER: return "NUMBER";
+        case FlatOp::VARIABLE: return "VARIABLE";
+        case FlatOp::LT: return "LT";
+        case FlatOp::GT: return "GT";
+        case FlatOp::EQ: return "EQ";
+        case FlatOp::AND: return "AND";
+        case FlatOp::OR: return "OR";
+        case FlatOp::NOT: return "NOT";
+        case FlatOp::TRUE_CONST: return "TRUE";
+        case FlatOp::FALSE_CONST: return "FALSE";
+        default: return " ";
+    }
+}
@@ -0,0 +1,81 @@
+#ifndef FLAT_AST_H
+#define FLAT_AST_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+
+/* Kinds of the nodes of a FlatAst */
+enum class FlatOp : uint8_t {
+    BLOCK,                  // statements lists[first .. first + second)
+    SET,                    // vars[first] = value of the NUM_EXPR second
+    INPUT,                  // vars[first] read through the Runtime
+    PRINT,                  // print of the NUM_EXPR first
+    IF,                     // condition first, blocks lists[second] (TRUE) and lists[second + 1] (FALSE)
+    WHILE,                  // condition first, block second
+    ADD, SUB, MUL, DIV,     // NUM_EXPR operands first and second
+    NUMBER,                 // literal stored inline: low 32 bits in first, high 32 bits in second
+    VARIABLE,               // slot first, second 1 if the read surely follows a declaration (not checked)
+    LT, GT, EQ,             // NUM_EXPR operands first and second
+    AND, OR,                // BOOL_EXPR operands first and second
+    NOT,                    // BOOL_EXPR operand first
+    TRUE_CONST, FALSE_CONST,
+    NULL_VAL
+};
+
+const char* flatOp2String(FlatOp op);
+
+
+/* Read-only view of the arrays of a FlatAst: the ones of a FlatAst in memory (see FlatAst::view())
+or the ones mapped from a file (see FlatImage), which are run in place */
+struct FlatView {
+    const uint8_t* ops = nullptr;
+    const uint32_t* first = nullptr;
+    const uint32_t* second = nullptr;
+    const uint32_t* lists = nullptr;
+    uint32_t n_nodes = 0;
+    uint32_t n_lists = 0;
+    const std::vector<std::string>* var_ids = nullptr; // slot -> VARIABLE_ID
+    uint32_t root = UINT32_MAX;                        // main BLOCK (UINT32_MAX for an empty Program)
+};
+
+
+/* Struct-of-arrays layout of a resolved Program: node i is made of the operation ops[i]
+and of the two 32bit operands first[i] and second[i] (indices of other nodes, slots or
+halves of a literal, see FlatOp); the children of BLOCK and IF are listed in "lists".
+A node takes 9 bytes and the children of a node are always stored before it */
+struct FlatAst {
+    using NodeIndex = uint32_t;
+    static constexpr NodeIndex NO_NODE = UINT32_MAX;
+
+    std::vector<uint8_t> ops;
+    std::vector<uint32_t> first;
+    std::vector<uint32_t> second;
+    std::vector<NodeIndex> lists;
+    std::vector<std::string> var_ids; // slot -> VARIABLE_ID
+    NodeIndex root = NO_NODE;          // main BLOCK (NO_NODE for an empty Program)
+
+    unsigned int get_n_nodes() const { return ops.size(); }
+    size_t get_bytes() const {
+        return ops.size() * (sizeof(uint8_t) + 2 * sizeof(uint32_t)) + lists.size() * sizeof(NodeIndex);
+    }
+
+    NodeIndex add(FlatOp op, uint32_t f, uint32_t s) {
+        ops.push_back(static_cast<uint8_t>(op));
+        first.push_back(f);
+        second.push_back(s);
+        return static_cast<NodeIndex>(ops.size() - 1);
+    }
+
+    FlatView view() const {
+        return FlatView{ ops.data(), first.data(), second.data(), lists.data(),
+            static_cast<uint32_t>(ops.size()), static_cast<uint32_t>(lists.size()), &var_ids, root };
+    }
+
+    static int64_t literal(uint32_t low, uint32_t high) {
+        return static_cast<int64_t>((static_cast<uint64_t>(high) << 32) | low);
+    }
+};
+
+#endif /* FLAT_AST_H */
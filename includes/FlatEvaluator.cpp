@@ -0,0 +1,129 @@
+#include "FlatEvaluator.h"
+
+
+void FlatEvaluator::run(const FlatView& ast) {
+    ops = ast.ops;
+    first = ast.first;
+    second = ast.second;
+    lists = ast.lists;
+    var_ids = ast.var_ids;
+
+    // One slot for each VARIABLE_ID, all of them not declared yet
+    vars.assign(var_ids->size(), 0);
+    declared.assign(var_ids->size(), 0);
+    if (ast.root != FlatAst::NO_NODE) exec(ast.root);
+}
+
+
+/* STATEMENTS */
+void FlatEvaluator::exec(NodeIndex n) {
+    switch (op(n)) {
+        case FlatOp::BLOCK: {
+            if (second[n] == 0) throw SemanticError(SemanticMessage::emptyBlock());
+            const NodeIndex* stmts = lists + first[n];
+            for (uint32_t i = 0, size = second[n]; i < size; i++) exec(stmts[i]);
+            return;
+        }
+        case FlatOp::SET: {
+            int64_t val = num(second[n]);
+            vars[first[n]] = val;
+            declared[first[n]] = 1;
+            return;
+        }
+        case FlatOp::INPUT: {
+            vars[first[n]] = rt->input((*var_ids)[first[n]]);
+            declared[first[n]] = 1;
+            return;
+        }
+        case FlatOp::PRINT:
+            rt->print(operand(first[n], FlatOp::PRINT));
+            return;
+        case FlatOp::IF:
+            exec(cond(first[n]) ? lists[second[n]] : lists[second[n] + 1]);
+            return;
+        case FlatOp::WHILE:
+            while (cond(first[n])) exec(second[n]);
+            return;
+        default:
+            return;
+    }
+}
+
+
+/* NUM_EXPR */
+int64_t FlatEvaluator::operand(NodeIndex n, FlatOp context) {
+    if (op(n) != FlatOp::VARIABLE) return num(n);
+    if (!second[n] && !declared[first[n]]) undeclared(n, context);
+    return vars[first[n]];
+}
+
+int64_t FlatEvaluator::num(NodeIndex n) {
+    FlatOp o = op(n);
+    switch (o) {
+        case FlatOp::NUMBER:
+            return FlatAst::literal(first[n], second[n]);
+        case FlatOp::VARIABLE:
+            return operand(n, FlatOp::VARIABLE);
+        case FlatOp::ADD: {
+            int64_t fval = operand(first[n], o);
+            return fval + operand(second[n], o);
+        }
+        case FlatOp::SUB: {
+            int64_t fval = operand(first[n], o);
+            return fval - operand(second[n], o);
+        }
+        case FlatOp::MUL: {
+            int64_t fval = operand(first[n], o);
+            return fval * operand(second[n], o);
+        }
+        case FlatOp::DIV: {
+            int64_t fval = operand(first[n], o);
+            int64_t sval = operand(second[n], o);
+            if (sval == 0) throw SemanticError(SemanticMessage::divisionByZero());
+            return fval / sval;
+        }
+        default:
+            return 0;
+    }
+}
+
+
+/* BOOL_EXPR */
+bool FlatEvaluator::cond(NodeIndex n) {
+    FlatOp o = op(n);
+    switch (o) {
+        case FlatOp::LT: {
+            int64_t fval = operand(first[n], o);
+            return fval < operand(second[n], o);
+        }
+        case FlatOp::GT: {
+            int64_t fval = operand(first[n], o);
+            return fval > operand(second[n], o);
+        }
+        case FlatOp::EQ: {
+            int64_t fval = operand(first[n], o);
+            return fval == operand(second[n], o);
+        }
+        // short-circuit: the 2nd operand is evaluated only if necessary
+        case FlatOp::AND: return cond(first[n]) && cond(second[n]);
+        case FlatOp::OR: return cond(first[n]) || cond(second[n]);
+        case FlatOp::NOT: return !cond(first[n]);
+        case FlatOp::TRUE_CONST: return true;
+        default: return false;
+    }
+}
+
+
+void FlatEvaluator::undeclared(NodeIndex var, FlatOp context) const {
+    const std::string& id = (*var_ids)[first[var]];
+    switch (context) {
+        case FlatOp::PRINT:
+            throw SemanticError(SemanticMessage::undeclaredPrint(id));
+        case FlatOp::ADD: case FlatOp::SUB: case FlatOp::MUL: case FlatOp::DIV:
+            throw SemanticError(SemanticMessage::undeclaredOperand(flatOp2String(context), id));
+        case FlatOp::LT: case FlatOp::GT: case FlatOp::EQ:
+            throw SemanticError(SemanticMessage::undeclaredRelOperand(flatOp2String(context), id));
+        default:
+            throw SemanticError(SemanticMessage::undeclaredVariable(id));
+    }
+}
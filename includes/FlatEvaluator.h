@@ -0,0 +1,50 @@
+#ifndef FLAT_EVALUATOR_H
+#define FLAT_EVALUATOR_H
+
+#include <cstdint>
+#include <vector>
+
+#include "FlatAst.h"
+#include "Runtime.h"
+#include "Exceptions.h"
+
+
+/* Evaluator walking the arrays of a FlatAst directly: statements, NUM_EXPR and BOOL_EXPR
+are executed by three recursive functions switching on the operation of the node.
+Errors and their messages are the same as the EvaluationVisitor */
+class FlatEvaluator {
+public:
+    FlatEvaluator() : FlatEvaluator(&Runtime::standard()) {}
+    FlatEvaluator(Runtime* r) : rt{ r } {}
+    FlatEvaluator(const FlatEvaluator& other) = default;
+    ~FlatEvaluator() = default;
+    FlatEvaluator& operator=(const FlatEvaluator& other) = default;
+
+    void run(const FlatView& ast);
+    void run(const FlatAst& ast) { run(ast.view()); }
+
+private:
+    using NodeIndex = FlatAst::NodeIndex;
+
+    Runtime* rt; // services used by INPUT and PRINT
+    std::vector<int64_t> vars;
+    std::vector<unsigned char> declared;
+
+    // Arrays of the FlatAst being run
+    const uint8_t* ops = nullptr;
+    const uint32_t* first = nullptr;
+    const uint32_t* second = nullptr;
+    const NodeIndex* lists = nullptr;
+    const std::vector<std::string>* var_ids = nullptr;
+
+    FlatOp op(NodeIndex n) const { return static_cast<FlatOp>(ops[n]); }
+
+    void exec(NodeIndex n);
+    int64_t num(NodeIndex n);
+    bool cond(NodeIndex n);
+    // Value of the operand of "context": a VARIABLE_ID not declared yet fails with the message of the context
+    int64_t operand(NodeIndex n, FlatOp context);
+    [[noreturn]] void undeclared(NodeIndex var, FlatOp context) const;
+};
+
+#endif /* FLAT_EVALUATOR_H */
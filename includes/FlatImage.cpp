@@ -0,0 +1,200 @@
+#include <algorithm>
+#include <cstring>
+
+#include "FlatImage.h"
+
+
+constexpr char FlatImage::MAGIC[8];
+
+#if defined(__linux__)
+#define FLAT_IMAGE_ELF 1
+#include <link.h>
+#endif
+
+// Version of the optimizations, to be increased when a pass changes the programs it makes
+constexpr unsigned int OPTIMIZER_VERSION = 2;
+
+#ifdef FLAT_IMAGE_ELF
+// Callback of dl_iterate_phdr: copies in *data the GNU build ID note of the executable, the first object listed
+static int readBuildIdNote(struct dl_phdr_info* info, size_t, void* data) {
+    std::string& out = *static_cast<std::string*>(data);
+    for (ElfW(Half) i = 0; i < info->dlpi_phnum; i++) {
+        const ElfW(Phdr)& ph = info->dlpi_phdr[i];
+        if (ph.p_type != PT_NOTE) continue;
+        const char* p = reinterpret_cast<const char*>(info->dlpi_addr + ph.p_vaddr);
+        const char* end = p + ph.p_memsz;
+        while (p + sizeof(ElfW(Nhdr)) <= end) {
+            const ElfW(Nhdr)* note = reinterpret_cast<const ElfW(Nhdr)*>(p);
+            const char* name = p + sizeof(ElfW(Nhdr));
+            const char* desc = name + ((note->n_namesz + 3) & ~3u);
+            if (desc + note->n_descsz > end) break;
+            if (note->n_type == NT_GNU_BUILD_ID && note->n_namesz == 4 && std::memcmp(name, "GNU", 4) == 0) {
+                out.assign(desc, note->n_descsz);
+                return 1;
+            }
+            p = desc + ((note->n_descsz + 3) & ~3u);
+        }
+    }
+    return 1;
+}
+#endif
+
+/* Identity of the linked executable, which changes with any of its translation units: the build ID that
+the linker writes in the ELF notes or, without it, the hash of the executable file */
+static std::string binaryId() {
+#ifdef FLAT_IMAGE_ELF
+    std::string note;
+    dl_iterate_phdr(readBuildIdNote, &note);
+    if (!note.empty()) return "gnu " + std::to_string(SourceFile::hash(note));
+    SourceFile self{ "/proc/self/exe" };
+    if (!self.fail() && !self.text().empty()) return "exe " + std::to_string(SourceFile::hash(self.text()));
+#endif
+    // last resort: the time of the compilation of this file only
+    return __DATE__ " " __TIME__;
+}
+
+const std::string& FlatImage::buildId() {
+#ifdef LISP_BUILD_ID
+    static const std::string id = "opt" + std::to_string(OPTIMIZER_VERSION) + " " + LISP_BUILD_ID + " " + binaryId();
+#else
+    static const std::string id = "opt" + std::to_string(OPTIMIZER_VERSION) + " " + binaryId();
+#endif
+    return id;
+}
+
+uint64_t FlatImage::buildHash() {
+    static const uint64_t hash = SourceFile::hash(buildId());
+    return hash;
+}
+
+
+// Kinds of the nodes, as expected by their parents
+static bool isStatement(uint8_t op) { return op >= static_cast<uint8_t>(FlatOp::SET) && op <= static_cast<uint8_t>(FlatOp::WHILE); }
+static bool isNumExpr(uint8_t op) { return op >= static_cast<uint8_t>(FlatOp::ADD) && op <= static_cast<uint8_t>(FlatOp::VARIABLE); }
+static bool isBoolExpr(uint8_t op) { return op >= static_cast<uint8_t>(FlatOp::LT) && op <= static_cast<uint8_t>(FlatOp::FALSE_CONST); }
+
+
+std::string FlatImage::serialize(const FlatAst& ast, std::string_view source, uint32_t options, std::string_view report) {
+    Header h{};
+    std::memcpy(h.magic, MAGIC, sizeof(MAGIC));
+    h.version = VERSION;
+    h.options = options;
+    h.build = buildHash();
+    h.source_hash = SourceFile::hash(source);
+    h.source_size = source.size();
+    h.n_nodes = ast.get_n_nodes();
+    h.n_lists = static_cast<uint32_t>(ast.lists.size());
+    h.n_vars = static_cast<uint32_t>(ast.var_ids.size());
+    h.root = ast.root;
+    h.report_size = static_cast<uint32_t>(report.size());
+
+    // Interned VARIABLE_IDs: offsets in a single table of characters
+    std::vector<uint32_t> offsets{ 0 };
+    std::string chars;
+    for (const std::string& id : ast.var_ids) {
+        chars += id;
+        offsets.push_back(static_cast<uint32_t>(chars.size()));
+    }
+    h.var_chars_size = static_cast<uint32_t>(chars.size());
+
+    std::string out;
+    auto section = [&out](const void* p, size_t n) {
+        out.append(static_cast<const char*>(p), n);
+        out.resize(align(out.size()), '\0');
+    };
+    section(&h, sizeof(h));
+    section(ast.ops.data(), ast.ops.size());
+    section(ast.first.data(), ast.first.size() * sizeof(uint32_t));
+    section(ast.second.data(), ast.second.size() * sizeof(uint32_t));
+    section(ast.lists.data(), ast.lists.size() * sizeof(uint32_t));
+    section(offsets.data(), offsets.size() * sizeof(uint32_t));
+    section(chars.data(), chars.size());
+    section(report.data(), report.size());
+    section(source.data(), source.size());
+    h.checksum = SourceFile::hash(std::string_view{ out }.substr(align(sizeof(Header))));
+    std::memcpy(&out[0], &h, sizeof(h));
+    return out;
+}
+
+bool FlatImage::open(const std::string& path, std::string_view source, uint32_t options) {
+    file.open(path);
+    if (file.fail()) return false;
+    std::string_view data = file.text();
+    if (data.size() < sizeof(Header)) return false;
+    Header h;
+    std::memcpy(&h, data.data(), sizeof(h));
+    if (std::memcmp(h.magic, MAGIC, sizeof(MAGIC)) != 0 || h.version != VERSION || h.options != options
+        || h.source_size != source.size() || h.source_hash != SourceFile::hash(source)
+        || h.checksum != SourceFile::hash(data.substr(std::min(data.size(), align(sizeof(Header)))))) return false;
+
+    // Sections, checked against the size of the file before reading them
+    size_t pos = align(sizeof(Header));
+    bool fits = true;
+    auto section = [&data, &pos, &fits](size_t n) {
+        const char* p = data.data() + pos;
+        if (n > data.size() - pos) fits = false;
+        else pos = std::min(data.size(), pos + align(n));
+        return p;
+    };
+    flat.ops = reinterpret_cast<const uint8_t*>(section(h.n_nodes));
+    flat.first = reinterpret_cast<const uint32_t*>(section(size_t{ h.n_nodes } * sizeof(uint32_t)));
+    flat.second = reinterpret_cast<const uint32_t*>(section(size_t{ h.n_nodes } * sizeof(uint32_t)));
+    flat.lists = reinterpret_cast<const uint32_t*>(section(size_t{ h.n_lists } * sizeof(uint32_t)));
+    const uint32_t* offsets = reinterpret_cast<const uint32_t*>(section((size_t{ h.n_vars } + 1) * sizeof(uint32_t)));
+    const char* chars = section(h.var_chars_size);
+    const char* text = section(h.report_size);
+    const char* stored = section(h.source_size);
+    if (!fits || std::memcmp(stored, source.data(), source.size()) != 0) return false;
+
+    var_ids.clear();
+    var_ids.reserve(h.n_vars);
+    for (uint32_t v = 0; v < h.n_vars; v++) {
+        if (offsets[v] > offsets[v + 1] || offsets[v + 1] > h.var_chars_size) return false;
+        var_ids.emplace_back(chars + offsets[v], offsets[v + 1] - offsets[v]);
+    }
+    flat.n_nodes = h.n_nodes;
+    flat.n_lists = h.n_lists;
+    flat.var_ids = &var_ids;
+    flat.root = h.root;
+    report = std::string_view{ text, h.report_size };
+    build = h.build;
+    return valid();
+}
+
+bool FlatImage::valid() const {
+    if (build != buildHash()) return false;
+    const uint32_t n_vars = static_cast<uint32_t>(var_ids.size());
+    if (flat.root != FlatAst::NO_NODE && (flat.root >= flat.n_nodes || flat.ops[flat.root] != static_cast<uint8_t>(FlatOp::BLOCK))) return false;
+    // the children of a node are stored before it
+    for (uint32_t n = 0; n < flat.n_nodes; n++) {
+        uint32_t f = flat.first[n], s = flat.second[n];
+        auto child = [n, this](uint32_t c, bool (*kind)(uint8_t)) { return c < n && kind(flat.ops[c]); };
+        auto block = [n, this](uint32_t c) { return c < n && flat.ops[c] == static_cast<uint8_t>(FlatOp::BLOCK); };
+        bool ok;
+        switch (static_cast<FlatOp>(flat.ops[n])) {
+            case FlatOp::BLOCK:
+                ok = f <= flat.n_lists && s <= flat.n_lists - f;
+                for (uint32_t i = 0; ok && i < s; i++) ok = child(flat.lists[f + i], isStatement);
+                break;
+            case FlatOp::SET: ok = f < n_vars && child(s, isNumExpr); break;
+            case FlatOp::INPUT: ok = f < n_vars; break;
+            case FlatOp::PRINT: ok = child(f, isNumExpr); break;
+            case FlatOp::IF:
+                ok = child(f, isBoolExpr) && s < flat.n_lists && flat.n_lists - s >= 2 && block(flat.lists[s]) && block(flat.lists[s + 1]);
+                break;
+            case FlatOp::WHILE: ok = child(f, isBoolExpr) && block(s); break;
+            case FlatOp::ADD: case FlatOp::SUB: case FlatOp::MUL: case FlatOp::DIV:
+            case FlatOp::LT: case FlatOp::GT: case FlatOp::EQ:
+                ok = child(f, isNumExpr) && child(s, isNumExpr);
+                break;
+            case FlatOp::NUMBER: ok = true; break;
+            case FlatOp::VARIABLE: ok = f < n_vars && s <= 1; break;
+            case FlatOp::AND: case FlatOp::OR: ok = child(f, isBoolExpr) && child(s, isBoolExpr); break;
+            case FlatOp::NOT: ok = child(f, isBoolExpr); break;
+            case FlatOp::TRUE_CONST: case FlatOp::FALSE_CONST: ok = true; break;
+            default: ok = false;
+        }
+        if (!ok) return false;
+    }
+    return true;
+}
@@ -0,0 +1,82 @@
+#ifndef FLAT_IMAGE_H
+#define FLAT_IMAGE_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "FlatAst.h"
+#include "SourceFile.h"
+
+
+/* Binary image of an optimized Program in the FlatAst layout, as stored in the program cache (see ProgramStore).
+The file is made of a Header followed by the sections, each one starting at a multiple of 8 bytes:
+ops (1 byte per node), first and second (4 bytes per node), lists (4 bytes per entry), the offsets of the
+VARIABLE_IDs in the identifier table (4 bytes per slot, plus the end), the identifier table, the text of
+--opt-report and the source of the program (to tell apart two sources with the same hash).
+A damaged file is detected by the checksum of the sections and by the check of the indices.
+The nodes refer to each other by index only, so the file is mapped in memory and run in place,
+without creating a node; all the values are in the byte order of the machine that wrote the file */
+class FlatImage {
+public:
+    // Version of the format: the images of another version are ignored
+    static constexpr uint32_t VERSION = 2;
+
+    /* Identity of the build of the interpreter, whose optimizations made the image: the images written by
+    another build are ignored, as a pass changed or fixed since then would give another program.
+    It is OPTIMIZER_VERSION with the identity of the linked executable (its GNU build ID, or the hash of the file),
+    so that relinking after any change of an engine or a pass gives another one, and LISP_BUILD_ID if defined at
+    compile time (e.g. -DLISP_BUILD_ID="\"$(git describe --always --dirty)\""). The date and time of the compilation
+    are used only where the executable can't be identified */
+    static const std::string& buildId();
+    static uint64_t buildHash();
+
+    FlatImage() = default;
+    ~FlatImage() = default;
+
+    // Deletion of copy constructor and assignment operator: the view points into the mapping
+    FlatImage(const FlatImage& other) = delete;
+    FlatImage& operator=(const FlatImage& other) = delete;
+
+    // Contents of the image file of "ast", optimized with "options" (see ProgramStore::optionBits())
+    static std::string serialize(const FlatAst& ast, std::string_view source, uint32_t options, std::string_view report);
+
+    /* Mapping of the file "path": false if it is missing, not valid (e.g. truncated, of another version
+    or with indices out of the arrays) or if it doesn't hold the image of "source" optimized with "options" */
+    bool open(const std::string& path, std::string_view source, uint32_t options);
+
+    const FlatView& view() const { return flat; }
+    std::string_view get_report() const { return report; }
+
+private:
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t options;
+        uint64_t build;    // buildHash() of the interpreter that wrote the image
+        uint64_t source_hash;
+        uint64_t source_size;
+        uint32_t n_nodes;
+        uint32_t n_lists;
+        uint32_t n_vars;
+        uint32_t root;
+        uint32_t var_chars_size;
+        uint32_t report_size;
+        uint64_t checksum; // hash of the sections (see SourceFile::hash())
+    };
+    static constexpr char MAGIC[8] = { 'L', 'I', 'S', 'P', 'F', 'L', 'A', 'T' };
+
+    SourceFile file;
+    FlatView flat;
+    std::vector<std::string> var_ids;
+    std::string_view report;
+    uint64_t build = 0;
+
+    static size_t align(size_t n) { return (n + 7) & ~static_cast<size_t>(7); }
+    /* Check of the build that wrote the image and of the operands of every node, so that the image of another
+    optimizer isn't run and a damaged image can't be run out of its arrays */
+    bool valid() const;
+};
+
+#endif /* FLAT_IMAGE_H */
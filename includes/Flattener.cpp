@@ -0,0 +1,191 @@
+#include "Flattener.h"
+
+
+void FlattenVisitor::visitProgram(Program* prg) {
+    ast.var_ids = prg->get_var_ids();
+    if (prg->get_is_not_empty()) {
+        ast.root = flatten(prg->get_blk());
+    }
+}
+
+void FlattenVisitor::visitBlock(Block* blk) {
+    StatementList stmts = blk->get_stmts();
+    // The statements are flattened before listing them, so that the list of a nested Block doesn't get in the middle
+    std::vector<FlatAst::NodeIndex> children;
+    children.reserve(stmts.size());
+    for (Statement* s : stmts)
+        children.push_back(flatten(s));
+    uint32_t begin = static_cast<uint32_t>(ast.lists.size());
+    ast.lists.insert(ast.lists.end(), children.begin(), children.end());
+    last = ast.add(FlatOp::BLOCK, begin, static_cast<uint32_t>(children.size()));
+}
+
+
+/* STATEMENTS */
+void FlattenVisitor::visitSet(SetStmt* s) {
+    FlatAst::NodeIndex nexpr = flatten(s->get_nexpr());
+    last = ast.add(FlatOp::SET, s->get_var()->get_slot(), nexpr);
+}
+
+void FlattenVisitor::visitInput(InputStmt* s) {
+    last = ast.add(FlatOp::INPUT, s->get_var()->get_slot(), 0);
+}
+
+void FlattenVisitor::visitPrint(PrintStmt* s) {
+    FlatAst::NodeIndex nexpr = flatten(s->get_nexpr());
+    last = ast.add(FlatOp::PRINT, nexpr, 0);
+}
+
+void FlattenVisitor::visitIf(IfStmt* s) {
+    FlatAst::NodeIndex bexpr = flatten(s->get_bexpr());
+    FlatAst::NodeIndex blk1 = flatten(s->get_stmt_block1());
+    FlatAst::NodeIndex blk2 = flatten(s->get_stmt_block2());
+    uint32_t begin = static_cast<uint32_t>(ast.lists.size());
+    ast.lists.push_back(blk1);
+    ast.lists.push_back(blk2);
+    last = ast.add(FlatOp::IF, bexpr, begin);
+}
+
+void FlattenVisitor::visitWhile(WhileStmt* s) {
+    FlatAst::NodeIndex bexpr = flatten(s->get_bexpr());
+    FlatAst::NodeIndex blk = flatten(s->get_stmt_block());
+    last = ast.add(FlatOp::WHILE, bexpr, blk);
+}
+
+
+/* NUM_EXPR */
+void FlattenVisitor::visitOperator(Operator* opNode) {
+    FlatAst::NodeIndex f = flatten(opNode->getFirst());
+    FlatAst::NodeIndex s = flatten(opNode->getSecond());
+    switch (opNode->getOp()) {
+        case Operator::ADD: last = ast.add(FlatOp::ADD, f, s); break;
+        case Operator::SUB: last = ast.add(FlatOp::SUB, f, s); break;
+        case Operator::MUL: last = ast.add(FlatOp::MUL, f, s); break;
+        case Operator::DIV: last = ast.add(FlatOp::DIV, f, s); break;
+        default: break;
+    }
+}
+
+void FlattenVisitor::visitNumber(Number* numNode) {
+    uint64_t val = static_cast<uint64_t>(numNode->get_value());
+    last = ast.add(FlatOp::NUMBER, static_cast<uint32_t>(val), static_cast<uint32_t>(val >> 32));
+}
+
+void FlattenVisitor::visitVariable(Variable* varNode) {
+    last = ast.add(FlatOp::VARIABLE, varNode->get_slot(), 1);
+}
+
+void FlattenVisitor::visitCheckedVariable(CheckedVariable* varNode) {
+    last = ast.add(FlatOp::VARIABLE, varNode->get_slot(), 0);
+}
+
+
+/* BOOL_EXPR */
+void FlattenVisitor::visitRelOp(RelOp* rop) {
+    FlatAst::NodeIndex f = flatten(rop->get_first_nexpr());
+    FlatAst::NodeIndex s = flatten(rop->get_second_nexpr());
+    switch (rop->get_r_opcode()) {
+        case RelOp::LT: last = ast.add(FlatOp::LT, f, s); break;
+        case RelOp::GT: last = ast.add(FlatOp::GT, f, s); break;
+        case RelOp::EQ: last = ast.add(FlatOp::EQ, f, s); break;
+        default: break;
+    }
+}
+
+void FlattenVisitor::visitBoolConst(BoolConst* bconst) {
+    last = ast.add(bconst->get_bconst() == BoolConst::TRUE ? FlatOp::TRUE_CONST : FlatOp::FALSE_CONST, 0, 0);
+}
+
+void FlattenVisitor::visitBoolOp(BoolOp* bop) {
+    FlatAst::NodeIndex f = flatten(bop->get_f_bexpr());
+    switch (bop->get_b_opcode()) {
+        case BoolOp::AND: last = ast.add(FlatOp::AND, f, flatten(bop->get_s_bexpr())); break;
+        case BoolOp::OR: last = ast.add(FlatOp::OR, f, flatten(bop->get_s_bexpr())); break;
+        case BoolOp::NOT: last = ast.add(FlatOp::NOT, f, 0); break;
+        default: break;
+    }
+}
+
+
+Program* UnflattenProgram::operator()(const FlatView& flat) {
+    ast = flat;
+    Program* prg = (ast.root == FlatAst::NO_NODE) ? new Program() : new Program(block(ast.root));
+    prg->set_var_ids(*ast.var_ids);
+    return prg;
+}
+
+Block* UnflattenProgram::block(NodeIndex n) {
+    std::vector<Statement*> stmts;
+    stmts.reserve(ast.second[n]);
+    for (uint32_t i = 0; i < ast.second[n]; i++)
+        stmts.push_back(statement(ast.lists[ast.first[n] + i]));
+    return nf.makeBlock(stmts);
+}
+
+
+/* STATEMENTS */
+Statement* UnflattenProgram::statement(NodeIndex n) {
+    switch (op(n)) {
+        case FlatOp::SET: return nf.makeSetStmt(numExpr(ast.second[n], CheckedVariable::VALUE, 0), variable(ast.first[n]));
+        case FlatOp::INPUT: return nf.makeInputStmt(variable(ast.first[n]));
+        case FlatOp::PRINT: return nf.makePrintStmt(numExpr(ast.first[n], CheckedVariable::PRINT, 0));
+        case FlatOp::IF:
+            return nf.makeIfStmt(boolExpr(ast.first[n]), block(ast.lists[ast.second[n]]), block(ast.lists[ast.second[n] + 1]));
+        case FlatOp::WHILE: return nf.makeWhileStmt(boolExpr(ast.first[n]), block(ast.second[n]));
+        default: return nullptr;
+    }
+}
+
+
+/* NUM_EXPR */
+NumExpr* UnflattenProgram::numExpr(NodeIndex n, CheckedVariable::Use use, int code) {
+    Operator::OpCode opcode;
+    switch (op(n)) {
+        case FlatOp::NUMBER: return nf.makeNumber(FlatAst::literal(ast.first[n], ast.second[n]));
+        case FlatOp::VARIABLE: {
+            const std::string& id = (*ast.var_ids)[ast.first[n]];
+            Variable* v;
+            if (ast.second[n]) {
+                v = static_cast<Variable*>(nf.makeVariable(id));
+            } else {
+                CheckedVariable* checked = static_cast<CheckedVariable*>(nf.makeCheckedVariable(id));
+                checked->set_use(use, code);
+                v = checked;
+            }
+            v->set_slot(static_cast<int>(ast.first[n]));
+            return v;
+        }
+        case FlatOp::ADD: opcode = Operator::ADD; break;
+        case FlatOp::SUB: opcode = Operator::SUB; break;
+        case FlatOp::MUL: opcode = Operator::MUL; break;
+        case FlatOp::DIV: opcode = Operator::DIV; break;
+        default: return nullptr;
+    }
+    NumExpr* f = numExpr(ast.first[n], CheckedVariable::OPERAND, opcode);
+    return nf.makeOperator(opcode, f, numExpr(ast.second[n], CheckedVariable::OPERAND, opcode));
+}
+
+Variable* UnflattenProgram::variable(uint32_t slot) {
+    Variable* v = static_cast<Variable*>(nf.makeVariable((*ast.var_ids)[slot]));
+    v->set_slot(static_cast<int>(slot));
+    return v;
+}
+
+
+/* BOOL_EXPR */
+BoolExpr* UnflattenProgram::boolExpr(NodeIndex n) {
+    RelOp::RelOpCode relop;
+    switch (op(n)) {
+        case FlatOp::LT: relop = RelOp::LT; break;
+        case FlatOp::GT: relop = RelOp::GT; break;
+        case FlatOp::EQ: relop = RelOp::EQ; break;
+        case FlatOp::AND: return nf.makeBoolOp(BoolOp::AND, boolExpr(ast.first[n]), boolExpr(ast.second[n]));
+        case FlatOp::OR: return nf.makeBoolOp(BoolOp::OR, boolExpr(ast.first[n]), boolExpr(ast.second[n]));
+        case FlatOp::NOT: return nf.makeBoolOp(BoolOp::NOT, boolExpr(ast.first[n]), nullptr);
+        case FlatOp::TRUE_CONST: return nf.makeBoolConst(BoolConst::TRUE);
+        case FlatOp::FALSE_CONST: return nf.makeBoolConst(BoolConst::FALSE);
+        default: return nullptr;
+    }
+    NumExpr* f = numExpr(ast.first[n], CheckedVariable::REL_OPERAND, relop);
+    return nf.makeRelOp(relop, f, numExpr(ast.second[n], CheckedVariable::REL_OPERAND, relop));
+}
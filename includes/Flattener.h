@@ -0,0 +1,90 @@
+#ifndef FLATTENER_H
+#define FLATTENER_H
+
+#include <vector>
+
+#include "Visitor.h"
+#include "NodeFactory.h"
+#include "FlatAst.h"
+
+
+/* Class that extends Visitor superclass to copy a resolved Program (see ResolveVisitor)
+into the compact FlatAst layout executed by the FlatEvaluator */
+class FlattenVisitor : public Visitor {
+public:
+    FlattenVisitor() = default;
+    ~FlattenVisitor() = default;
+
+    // Deletion of copy constructor and assignment operator: a FlattenVisitor is used for a single Program
+    FlattenVisitor(const FlattenVisitor& other) = delete;
+    FlattenVisitor& operator=(const FlattenVisitor& other) = delete;
+
+    FlatAst operator()(Program* prg) {
+        ast = FlatAst{};
+        prg->accept(this);
+        return std::move(ast);
+    }
+
+    void visitProgram(Program* prg) override;
+    void visitBlock(Block* blk) override;
+
+    void visitSet(SetStmt* s) override;
+    void visitInput(InputStmt* s) override;
+    void visitPrint(PrintStmt* s) override;
+    void visitIf(IfStmt* s) override;
+    void visitWhile(WhileStmt* s) override;
+
+    void visitOperator(Operator* opNode) override;
+    void visitNumber(Number* numNode) override;
+    void visitVariable(Variable* varNode) override;
+    void visitCheckedVariable(CheckedVariable* varNode) override;
+
+    void visitRelOp(RelOp* rop) override;
+    void visitBoolConst(BoolConst* bconst) override;
+    void visitBoolOp(BoolOp* bop) override;
+
+private:
+    FlatAst ast;
+    FlatAst::NodeIndex last = FlatAst::NO_NODE; // index of the last node added
+
+    // Visit of a child node, returning its index
+    template <typename Node>
+    FlatAst::NodeIndex flatten(Node* n) {
+        n->accept(this);
+        return last;
+    }
+};
+
+
+/* Function object to build back a resolved Program from a FlatView (e.g. a FlatImage of the program cache)
+without parsing its source: the nodes are created by the NodeFactory with the slots and the VARIABLE_IDs
+of the FlatView. A read keeps its check, with the message given by the node using it as the parser does,
+unless the FlatView marks it as surely declared. The returned Program is owned by the caller */
+class UnflattenProgram {
+public:
+    UnflattenProgram(NodeFactory& node_f) : nf{ node_f } {}
+    ~UnflattenProgram() = default;
+
+    // Deletion of copy constructor and assignment operator: the nodes are owned by the NodeFactory
+    UnflattenProgram(const UnflattenProgram& other) = delete;
+    UnflattenProgram& operator=(const UnflattenProgram& other) = delete;
+
+    Program* operator()(const FlatView& flat);
+
+private:
+    using NodeIndex = FlatAst::NodeIndex;
+
+    NodeFactory& nf;
+    FlatView ast;
+
+    FlatOp op(NodeIndex n) const { return static_cast<FlatOp>(ast.ops[n]); }
+
+    Block* block(NodeIndex n);
+    Statement* statement(NodeIndex n);
+    // NUM_EXPR whose reads of a variable not declared yet give the message of "use" (see CheckedVariable)
+    NumExpr* numExpr(NodeIndex n, CheckedVariable::Use use, int code);
+    BoolExpr* boolExpr(NodeIndex n);
+    Variable* variable(uint32_t slot);
+};
+
+#endif /* FLATTENER_H */
@@ -0,0 +1,765 @@
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+#include "IncrementalParser.h"
+
+
+// Character classes of the "C" locale used by the Lexer
+static bool isAlpha(char ch) { return (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z'); }
+static bool isDigit(char ch) { return ch >= '0' && ch <= '9'; }
+static bool isSpace(char ch) { return ch == ' ' || (ch >= '\t' && ch <= '\r'); }
+static bool isTerminator(char ch) { return ch == ' ' || ch == '(' || ch == ')' || ch == '\n'; }
+
+
+/* Node of a statement in the tree of the statements of a Block (a treap: the tree is kept balanced by random
+priorities, a node having a priority higher than the ones below it). The statements are in order from left to right
+and each node sums the distances and the new lines of its subtree, so the position and the line of a statement,
+the statement at a position and the change of a distance take a time logarithmic in the statements */
+struct IncrementalParser::Node {
+    Node* left = nullptr;
+    Node* right = nullptr;
+    Node* up = nullptr;          // parent node, nullptr for the root
+    uint32_t priority = 0;
+    uint32_t count = 1;          // nodes of the subtree
+    uint64_t dist = 0;           // from the '(' of the statement to the '(' of the next one, the length for the last one
+    uint64_t rows = 0;           // new lines in the same text
+    uint64_t dist_sum = 0;       // of the subtree
+    uint64_t rows_sum = 0;
+    Statement* stmt = nullptr;
+    Child child;
+
+    static uint32_t countOf(const Node* t) { return t != nullptr ? t->count : 0; }
+    static uint64_t distOf(const Node* t) { return t != nullptr ? t->dist_sum : 0; }
+    static uint64_t rowsOf(const Node* t) { return t != nullptr ? t->rows_sum : 0; }
+
+    // Sums of the subtree from the ones of the children
+    void pull() {
+        count = 1 + countOf(left) + countOf(right);
+        dist_sum = dist + distOf(left) + distOf(right);
+        rows_sum = rows + rowsOf(left) + rowsOf(right);
+        if (left != nullptr) left->up = this;
+        if (right != nullptr) right->up = this;
+    }
+
+    // Position of the node among the statements
+    size_t rank() const {
+        size_t r = countOf(left);
+        for (const Node* t = this; t->up != nullptr; t = t->up) {
+            if (t == t->up->right) r += countOf(t->up->left) + 1;
+        }
+        return r;
+    }
+
+    // New lines from the '(' of the first statement to the '(' of this one
+    uint64_t rowsBefore() const {
+        uint64_t r = rowsOf(left);
+        for (const Node* t = this; t->up != nullptr; t = t->up) {
+            if (t == t->up->right) r += rowsOf(t->up->left) + t->up->rows;
+        }
+        return r;
+    }
+
+    // Next statement (nullptr for the last one)
+    Node* next() {
+        if (right != nullptr) {
+            Node* t = right;
+            while (t->left != nullptr) t = t->left;
+            return t;
+        }
+        Node* t = this;
+        while (t->up != nullptr && t == t->up->right) t = t->up;
+        return t->up;
+    }
+
+    // Change of the distance and of the new lines after the statement
+    void add(int64_t d, int64_t r) {
+        dist += static_cast<uint64_t>(d);
+        rows += static_cast<uint64_t>(r);
+        for (Node* t = this; t != nullptr; t = t->up) {
+            t->dist_sum += static_cast<uint64_t>(d);
+            t->rows_sum += static_cast<uint64_t>(r);
+        }
+    }
+
+    static Node* merge(Node* a, Node* b) {
+        if (a == nullptr) return b;
+        if (b == nullptr) return a;
+        if (a->priority > b->priority) {
+            a->right = merge(a->right, b);
+            a->pull();
+            return a;
+        }
+        b->left = merge(a, b->left);
+        b->pull();
+        return b;
+    }
+
+    // Split of "t" in its first "k" statements ("a") and the other ones ("b")
+    static void split(Node* t, size_t k, Node*& a, Node*& b) {
+        if (t == nullptr) {
+            a = b = nullptr;
+            return;
+        }
+        if (countOf(t->left) < k) {
+            split(t->right, k - countOf(t->left) - 1, t->right, b);
+            t->pull();
+            a = t;
+        } else {
+            split(t->left, k, a, t->left);
+            t->pull();
+            b = t;
+        }
+    }
+
+    /* Tree of "nodes" in their order, in a time linear in their number: a node taken from the stack
+    doesn't get other children, so its sums are final */
+    static Node* build(const std::vector<Node*>& nodes) {
+        std::vector<Node*> stack;
+        for (Node* s : nodes) {
+            s->priority = priorityOf(s);
+            s->left = s->right = s->up = nullptr;
+            Node* last = nullptr;
+            while (!stack.empty() && stack.back()->priority < s->priority) {
+                last = stack.back();
+                stack.pop_back();
+                last->pull();
+            }
+            s->left = last;
+            if (!stack.empty()) stack.back()->right = s;
+            stack.push_back(s);
+        }
+        while (!stack.empty()) {
+            stack.back()->pull();
+            if (stack.size() == 1) break;
+            stack.pop_back();
+        }
+        return stack.empty() ? nullptr : stack.front();
+    }
+
+    // Pseudo-random priority from the address of the node (mixing of MurmurHash3)
+    static uint32_t priorityOf(const Node* s) {
+        uint64_t h = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(s));
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33;
+        h *= 0xc4ceb9fe1a85ec53ULL;
+        h ^= h >> 33;
+        return static_cast<uint32_t>(h);
+    }
+};
+
+
+/* Positions and lines of the statements of a Block, from the '(' of the first one ("p0", on line "l0") */
+struct IncrementalParser::BlockSpans {
+    Block* blk = nullptr;
+    std::vector<Statement*> stmts;  // array of "blk"
+    Node* tree = nullptr;
+    BlockSpans* parent = nullptr;   // Block of the IF or WHILE statement around it, nullptr for the main Block
+    Node* owner = nullptr;          // node of that statement
+    int which = 0;                  // block of that statement
+
+    BlockSpans() = default;
+    BlockSpans(const BlockSpans& other) = delete;
+    BlockSpans& operator=(const BlockSpans& other) = delete;
+    ~BlockSpans() { release(tree); }
+
+    /* The nodes and the blocks inside them are released one at a time, without a recursion as deep
+    as their nesting */
+    static void release(Node* t) {
+        std::vector<Node*> todo{ t };
+        while (!todo.empty()) {
+            Node* s = todo.back();
+            todo.pop_back();
+            if (s == nullptr) continue;
+            todo.push_back(s->left);
+            todo.push_back(s->right);
+            for (std::unique_ptr<BlockSpans>& b : s->child.blocks) {
+                if (b == nullptr) continue;
+                todo.push_back(b->tree);
+                b->tree = nullptr;
+            }
+            delete s;
+        }
+    }
+
+    size_t size() const { return Node::countOf(tree); }
+
+    // k-th statement
+    Node* nth(size_t k) const {
+        Node* t = tree;
+        for (;;) {
+            size_t l = Node::countOf(t->left);
+            if (k == l) return t;
+            if (k < l) {
+                t = t->left;
+            } else {
+                k -= l + 1;
+                t = t->right;
+            }
+        }
+    }
+
+    // Distance and new lines from the '(' of the first statement to the '(' of the k-th one
+    void prefix(size_t k, uint64_t& dist, uint64_t& rows) const {
+        dist = rows = 0;
+        for (Node* t = tree; t != nullptr;) {
+            size_t l = Node::countOf(t->left);
+            if (k <= l) {
+                t = t->left;
+            } else {
+                dist += Node::distOf(t->left) + t->dist;
+                rows += Node::rowsOf(t->left) + t->rows;
+                k -= l + 1;
+                t = t->right;
+            }
+        }
+    }
+
+    size_t begin(size_t p0, size_t k) const {
+        uint64_t d, r;
+        prefix(k, d, r);
+        return p0 + d;
+    }
+    size_t end(size_t p0, size_t k) const { return begin(p0, k) + nth(k)->child.length; }
+    size_t end(size_t p0) const { return p0 + Node::distOf(tree); }
+
+    // Last statement starting at "pos" or before (the first one if none)
+    size_t at(size_t p0, size_t pos) const {
+        if (pos < p0) return 0;
+        uint64_t x = pos - p0;
+        size_t k = 0;
+        for (Node* t = tree; t != nullptr;) {
+            uint64_t d = Node::distOf(t->left) + t->dist;
+            if (d <= x) {
+                x -= d;
+                k += Node::countOf(t->left) + 1;
+                t = t->right;
+            } else {
+                t = t->left;
+            }
+        }
+        return std::min(k, size() - 1);
+    }
+
+    void update() { blk->set_stmts(stmts.data(), static_cast<unsigned int>(stmts.size())); }
+};
+
+
+/* Receiver of the positions of the statements read by a ParseProgram, which makes the BlockSpans of each Block.
+The statements of a source not written as the parser expects (e.g. the ones of an IF not between parentheses)
+can't be followed: then no BlockSpans is given */
+class IncrementalParser::Builder : public ParseListener {
+public:
+    Builder(std::string_view source, uint32_t gen) : base{ source.data() }, generation{ gen } {}
+
+    void statement(Statement* s, const Span& span) override {
+        Read r;
+        r.stmt = s;
+        r.begin = span.begin - base;
+        r.line = span.line;
+        Child& c = r.child;
+        c.length = static_cast<uint32_t>(span.end - span.begin);
+        c.lines = span.last_line - span.line;
+        c.head_lines = s->get_line() - span.line;
+        // the BLOCK statements of different parsings are told by the generation
+        if (span.block != nullptr) c.group = (static_cast<uint64_t>(generation) << 32) | static_cast<uint64_t>(span.block - base);
+        c.neg_before = span.neg_before;
+        c.neg_after = span.neg_after;
+
+        int n_blocks = 0;
+        Block* blocks[2] = { nullptr, nullptr };
+        if (s->get_kind() == Statement::IF) {
+            IfStmt* stmt = static_cast<IfStmt*> (s);
+            n_blocks = 2;
+            blocks[0] = stmt->get_stmt_block1();
+            blocks[1] = stmt->get_stmt_block2();
+        } else if (s->get_kind() == Statement::WHILE) {
+            n_blocks = 1;
+            blocks[0] = static_cast<WhileStmt*> (s)->get_stmt_block();
+        }
+        if (made.size() < static_cast<size_t>(n_blocks)) {
+            failed = true;
+            return;
+        }
+        for (int n = n_blocks; n-- > 0;) {
+            Made& m = made.back();
+            if (m.spans->blk != blocks[n] || m.begin < r.begin) failed = true;
+            c.block_offset[n] = static_cast<uint32_t>(m.begin - r.begin);
+            c.block_row[n] = m.line - r.line;
+            c.blocks[n] = std::move(m.spans);
+            made.pop_back();
+        }
+        reads.push_back(std::move(r));
+    }
+
+    void block(Block* b, size_t n) override {
+        if (n > reads.size()) {
+            failed = true;
+            return;
+        }
+        std::unique_ptr<BlockSpans> bs{ new BlockSpans() };
+        bs->blk = b;
+        size_t first = reads.size() - n;
+        StatementList list = b->get_stmts();
+        std::vector<Node*> nodes(n);
+        for (size_t k = 0; k < n; k++) {
+            Read& r = reads[first + k];
+            if (list[k] != r.stmt) failed = true;
+            Node* sp = new Node();
+            sp->stmt = r.stmt;
+            sp->dist = (k + 1 < n) ? reads[first + k + 1].begin - r.begin : r.child.length;
+            sp->rows = (k + 1 < n) ? reads[first + k + 1].line - r.line : r.child.lines;
+            sp->child = std::move(r.child);
+            for (int m = 0; m < 2; m++) {
+                BlockSpans* inner = sp->child.blocks[m].get();
+                if (inner == nullptr) continue;
+                inner->parent = bs.get();
+                inner->owner = sp;
+                inner->which = m;
+            }
+            nodes[k] = sp;
+        }
+        bs->stmts.assign(list.begin(), list.end());
+        bs->tree = Node::build(nodes);
+        all.push_back(bs.get());
+        made.push_back(Made{ std::move(bs), n > 0 ? reads[first].begin : 0, n > 0 ? reads[first].line : 0 });
+        reads.resize(first);
+    }
+
+    /* BlockSpans of the last Block made, with the position and the line of its first statement in "begin" and "line",
+    if the positions of all the statements are known: the Blocks take their arrays from the BlockSpans */
+    std::unique_ptr<BlockSpans> take(size_t& begin, uint32_t& line) {
+        if (failed || !reads.empty() || made.size() != 1) return nullptr;
+        for (BlockSpans* bs : all) bs->update();
+        begin = made.back().begin;
+        line = made.back().line;
+        return std::move(made.back().spans);
+    }
+
+private:
+    struct Read {
+        Statement* stmt;
+        size_t begin;
+        uint32_t line;
+        Child child;
+    };
+    struct Made {
+        std::unique_ptr<BlockSpans> spans;
+        size_t begin;
+        uint32_t line;
+    };
+
+    const char* base;
+    uint32_t generation;
+    bool failed = false;
+    std::vector<Read> reads;        // statements not yet in a Block
+    std::vector<Made> made;         // Blocks not yet in a statement
+    std::vector<BlockSpans*> all;
+};
+
+
+IncrementalParser::IncrementalParser() : nf{ new NodeFactory() }, spare{ new NodeFactory() } {}
+
+IncrementalParser::~IncrementalParser() = default;
+
+
+Program* IncrementalParser::parse(std::string_view source) {
+    size = source.size();
+    pending = Pending{ true, 0, valid_size, size };
+    return parseAll(source);
+}
+
+
+Program* IncrementalParser::edit(std::string_view source, const TextEdit& e) {
+    // an edit that doesn't match the source of the previous call is a new source
+    if (prg == nullptr || root == nullptr || e.offset + e.removed > size || source.size() != size - e.removed + e.inserted) {
+        return parse(source);
+    }
+
+    if (e.removed == 0 && e.inserted == 0 && !pending.any) {
+        stats = Stats{ false, 0, 0 };
+        return prg.get();
+    }
+
+    // the text changed since the last valid source: the union of the pending changes and of the edit
+    const bool was_valid = !pending.any;
+    if (!pending.any) {
+        pending = Pending{ true, e.offset, e.offset + e.removed, e.offset + e.inserted };
+    } else {
+        size_t end = std::max(pending.new_end, e.offset + e.removed);
+        pending.old_end += end - pending.new_end;
+        pending.new_end = end - e.removed + e.inserted;
+        pending.begin = std::min(pending.begin, e.offset);
+    }
+    size = source.size();
+
+    /* compaction: the nodes replaced by the edits are released by a parsing of the whole source, tried only after
+    a valid source so that the edits of an invalid one don't parse the whole source each time */
+    const unsigned int edit_nodes = nf->get_n_nodes() - full_nodes;
+    if (was_valid && edit_nodes > std::max(full_nodes, MIN_COMPACTION_NODES)) return parseAll(source);
+
+    if (!reparse(source, pending.begin, pending.old_end, pending.new_end - pending.begin)) return parseAll(source);
+    pending = Pending{};
+    valid_size = size;
+    return prg.get();
+}
+
+
+/* Parsing of the whole source: the nodes of the Program before the previous one are released,
+the ones of the current Program are kept until the new one is made */
+Program* IncrementalParser::parseAll(std::string_view source) {
+    stats = Stats{ true, source.size(), 0 };
+    spare->clear_memory();
+    ParseProgram parser{ *spare };
+    Builder builder{ source, ++generation };
+    // the positions are kept in 32 bits
+    bool positions = source.size() < std::numeric_limits<uint32_t>::max();
+    if (positions) parser.set_listener(&builder);
+    std::unique_ptr<Program> parsed{ parser(source) };
+
+    std::swap(nf, spare);
+    prg = std::move(parsed);
+    root = positions ? builder.take(root_offset, root_line) : nullptr;
+    places.clear();
+    indexed = false;
+    stats.stmts_read = nf->get_n_statements();
+    full_nodes = nf->get_n_nodes();
+    valid_size = source.size();
+    pending = Pending{};
+    return prg.get();
+}
+
+
+/* Parsing of the edit of [a, b) of the last valid source replaced by "inserted" characters of "source".
+The innermost Block around the edit is found from the main one, then the statements it touches are parsed again;
+if they can't be told apart from the rest (e.g. a BLOCK around them has been changed), the statement around
+the Block is parsed again, up to the main Block. It returns false if the whole source must be parsed again */
+bool IncrementalParser::reparse(std::string_view source, size_t a, size_t b, size_t inserted) {
+    const int64_t delta = static_cast<int64_t>(inserted) - static_cast<int64_t>(b - a);
+    struct Level {
+        BlockSpans* bs;
+        size_t p0;
+        uint32_t l0;
+        size_t k;   // statement around the edit
+        Node* sp;   // and its node
+        int n;      // its block around the edit
+    };
+    std::vector<Level> path;
+    BlockSpans* bs = root.get();
+    size_t p0 = root_offset;
+    uint32_t l0 = root_line;
+    if (bs->size() == 0 || a < p0 || b > bs->end(p0)) return false;
+
+    size_t k;
+    bool inside;
+    for (;;) {
+        k = bs->at(p0, a);
+        Node* sp = bs->nth(k);
+        uint64_t d, r;
+        bs->prefix(k, d, r);
+        size_t s = p0 + d;
+        inside = s < a && b < s + sp->child.length;
+        if (!inside) break;
+        Child& c = sp->child;
+        int n = -1;
+        for (int m = 0; m < 2 && c.blocks[m] != nullptr; m++) {
+            size_t pn = s + c.block_offset[m];
+            if (pn <= a && b <= c.blocks[m]->end(pn)) n = m;
+        }
+        if (n < 0) break;
+        path.push_back(Level{ bs, p0, l0, k, sp, n });
+        p0 = s + c.block_offset[n];
+        l0 = static_cast<uint32_t>(l0 + r + c.block_row[n]);
+        bs = c.blocks[n].get();
+    }
+
+    // statements to parse again: the one around the edit or the ones it touches, with the siblings around it if
+    // it starts or ends between two statements of the same BLOCK
+    size_t i = k;
+    size_t j = k;
+    bool found = inside;
+    if (!inside) {
+        auto group = [bs](size_t m) { return bs->nth(m)->child.group; };
+        const size_t n = bs->size();
+        j = bs->at(p0, b);
+        i = j;
+        if (bs->end(p0, j) < a) {
+            found = j + 1 < n && group(j) != 0 && group(j + 1) == group(j);
+            j++;
+        } else {
+            while (i > 0 && bs->end(p0, i - 1) >= a) i--;
+            found = true;
+            if (a < bs->begin(p0, i)) {
+                found = i > 0 && group(i) != 0 && group(i - 1) == group(i);
+                if (found) i--;
+            }
+            if (found && b > bs->end(p0, j)) {
+                found = j + 1 < n && group(j) != 0 && group(j + 1) == group(j);
+                if (found) j++;
+            }
+        }
+    }
+
+    int64_t line_delta = 0;
+    int64_t p0_delta = 0;
+    int64_t l0_delta = 0;
+    while (!found || !replace(source, *bs, p0, l0, i, j, delta, line_delta, p0_delta, l0_delta)) {
+        if (path.empty()) return false;
+        Level l = path.back();
+        path.pop_back();
+        bs = l.bs;
+        p0 = l.p0;
+        l0 = l.l0;
+        i = j = l.k;
+        found = true;
+    }
+
+    // the statements around the Block changed are longer by "delta" and "line_delta", the ones after them move
+    for (size_t l = path.size(); l-- > 0;) {
+        Level& lv = path[l];
+        Child& c = lv.sp->child;
+        c.length = static_cast<uint32_t>(c.length + delta);
+        c.lines = static_cast<uint32_t>(c.lines + line_delta);
+        lv.sp->add(delta, line_delta);
+        c.block_offset[lv.n] = static_cast<uint32_t>(c.block_offset[lv.n] + p0_delta);
+        c.block_row[lv.n] = static_cast<uint32_t>(c.block_row[lv.n] + l0_delta);
+        p0_delta = 0;
+        l0_delta = 0;
+        if (lv.n == 0 && c.blocks[1] != nullptr) {
+            c.block_offset[1] = static_cast<uint32_t>(c.block_offset[1] + delta);
+            c.block_row[1] = static_cast<uint32_t>(c.block_row[1] + line_delta);
+        }
+    }
+    root_offset += p0_delta;
+    root_line = static_cast<uint32_t>(root_line + l0_delta);
+    return true;
+}
+
+
+/* Parsing again of the statements from "i" to "j" of "bs" (whose first statement is at "p0", on line "l0"), changed
+by an edit that makes them longer by "delta", and replacement of their nodes and positions with the new ones.
+The statements must be sibling statements of a BLOCK, or the only statement of their stmt_block, which must
+be replaced by a single statement: the parser gives, and the Lexer reads, the same tokens from the first one as
+in the parsing of the whole source. It returns false if the new statements can't take the place of the old ones
+(e.g. the text after them isn't the one of a BLOCK, or the Lexer doesn't end in the same state); a LexicalError
+or a SyntaxError of the new statements is the one of the whole source and it's thrown.
+"line_delta" is set to the lines added, "p0_delta" and "l0_delta" to the move of the first statement of "bs" */
+bool IncrementalParser::replace(std::string_view source, BlockSpans& bs, size_t p0, uint32_t l0, size_t i, size_t j,
+                                int64_t delta, int64_t& line_delta, int64_t& p0_delta, int64_t& l0_delta) {
+    Node* first_old = bs.nth(i);
+    Node* last_old = first_old;
+    const uint64_t group = first_old->child.group;
+    for (size_t k = i + 1; k <= j; k++) {
+        last_old = last_old->next();
+        if (last_old->child.group != group || group == 0) return false;
+    }
+    const bool single = (group == 0);
+    uint64_t s_dist, s_rows, j_dist, j_rows;
+    bs.prefix(i, s_dist, s_rows);
+    bs.prefix(j, j_dist, j_rows);
+    const size_t s = p0 + s_dist;
+    const size_t e = p0 + j_dist + last_old->child.length;
+    const size_t limit = static_cast<size_t>(static_cast<int64_t>(e) + delta);
+    // a token before the first statement is read up to the character after it
+    if (s > 0 && (isAlpha(source[s - 1]) || isDigit(source[s - 1]))) return false;
+
+    const uint32_t line = static_cast<uint32_t>(l0 + s_rows);
+    Lexer::State state{ static_cast<int>(line), onlyAlphaAt(source, s), first_old->child.neg_before };
+    Lexer lex{ source.substr(s), state };
+    ParseProgram parser{ *nf };
+    Builder builder{ source, ++generation };
+    parser.set_listener(&builder);
+    const unsigned int made_before = nf->get_n_statements();
+    stats = Stats{ false, limit - s, 0 };
+
+    ParseProgram::Fragment f;
+    try {
+        f = parser.parseFragment(lex, source.data() + limit, single ? 1 : std::numeric_limits<size_t>::max(), i > 0);
+    } catch (SyntaxError&) {
+        /* Like the parser, the rest of the source is read for a LexicalError, which takes the precedence:
+        if the Lexer gets to the end of the new statements in the state it had at the end of the old ones,
+        the rest of the source is read as before, without errors */
+        Lexer statements{ source.substr(s, limit - s), state };
+        bool same = true;
+        try {
+            statements.drain();
+            Lexer::State end = statements.get_state();
+            same = end.onlyalpha && end.neg == last_old->child.neg_after;
+        } catch (LexicalError&) {
+            same = false;
+        }
+        if (!same) lex.drain();
+        throw;
+    }
+    stats.stmts_read = nf->get_n_statements() - made_before;
+    if (f.blk == nullptr) return false;
+    const size_t end = f.end - source.data();
+    stats.bytes_read = std::max(end, limit) - s;
+    if (end > limit || f.state.neg != last_old->child.neg_after) return false;
+    for (size_t p = end; p < limit; p++) {
+        if (!isSpace(source[p])) return false;
+    }
+
+    size_t new_begin = 0;
+    uint32_t new_line = 0;
+    std::unique_ptr<BlockSpans> frag = builder.take(new_begin, new_line);
+    if (frag == nullptr) return false;
+    const size_t n_old = j - i + 1;
+    const size_t n_new = frag->size();
+    Node* before = (i > 0) ? bs.nth(i - 1) : nullptr;
+    Node* after = last_old->next();
+    const bool sibling_left = before != nullptr && before->child.group == group;
+    const bool sibling_right = after != nullptr && after->child.group == group;
+    if (single ? f.n_read != 1 : (n_new == 0 && !sibling_left && !sibling_right)) return false;
+
+    // lines and positions of the new statements
+    const int64_t old_last_line = static_cast<int64_t>(l0 + j_rows) + last_old->child.lines;
+    const int64_t new_last_line = f.state.line + std::count(source.begin() + end, source.begin() + limit, '\n');
+    line_delta = new_last_line - old_last_line;
+    // '(' of the statement after them and its line
+    const size_t next = (after == nullptr) ? 0 : static_cast<size_t>(static_cast<int64_t>(p0 + j_dist + last_old->dist) + delta);
+    const int64_t next_line = (after == nullptr) ? 0 : static_cast<int64_t>(l0 + j_rows + last_old->rows) + line_delta;
+    const size_t first = (n_new > 0) ? new_begin : next;
+    const int64_t first_line = (n_new > 0) ? new_line : next_line;
+    if (i == 0) {
+        p0_delta = static_cast<int64_t>(first) - static_cast<int64_t>(s);
+        l0_delta = first_line - static_cast<int64_t>(line);
+    }
+    if (n_new > 0) {
+        // the last new statement is followed by the one after them, if any
+        Node* last_new = frag->nth(n_new - 1);
+        if (after != nullptr) {
+            uint64_t d, r;
+            frag->prefix(n_new - 1, d, r);
+            last_new->add(static_cast<int64_t>(next - (new_begin + d)) - static_cast<int64_t>(last_new->dist),
+                          next_line - static_cast<int64_t>(new_line + r) - static_cast<int64_t>(last_new->rows));
+        }
+        if (!single) {
+            for (Node* t = frag->nth(0); t != nullptr; t = t->next()) {
+                if (t->child.group == 0) t->child.group = group;
+            }
+        }
+    }
+    // the statement before them, if any, ends where it did and is followed by the first new one
+    if (before != nullptr) {
+        const bool followed = n_new > 0 || after != nullptr;
+        const uint64_t dist_before = followed ? first - (s - before->dist) : before->child.length;
+        const int64_t rows_before = followed ? first_line - static_cast<int64_t>(line - before->rows) : before->child.lines;
+        before->add(static_cast<int64_t>(dist_before) - static_cast<int64_t>(before->dist),
+                    rows_before - static_cast<int64_t>(before->rows));
+    }
+
+    // the nodes of the old statements are replaced by the new ones, the array of the Block moves only after them
+    for (Node* t = (n_new > 0) ? frag->nth(0) : nullptr; t != nullptr; t = t->next()) {
+        for (std::unique_ptr<BlockSpans>& inner : t->child.blocks) {
+            if (inner != nullptr) inner->parent = &bs;
+        }
+    }
+    Node* head;
+    Node* old;
+    Node* tail;
+    Node::split(bs.tree, i, head, old);
+    Node::split(old, n_old, old, tail);
+    if (indexed) {
+        index(nullptr, old, false);
+        index(&bs, frag->tree, true);
+    }
+    BlockSpans::release(old);
+    bs.tree = Node::merge(Node::merge(head, frag->tree), tail);
+    bs.tree->up = nullptr;
+    frag->tree = nullptr;
+
+    if (n_new > n_old) bs.stmts.insert(bs.stmts.begin() + j + 1, n_new - n_old, nullptr);
+    else if (n_new < n_old) bs.stmts.erase(bs.stmts.begin() + i + n_new, bs.stmts.begin() + j + 1);
+    std::copy(frag->stmts.begin(), frag->stmts.end(), bs.stmts.begin() + i);
+    bs.update();
+    return true;
+}
+
+
+/* Addition to "places" (or removal) of the statements of the nodes of "tree", in the Block "bs",
+and of the statements inside them */
+void IncrementalParser::index(BlockSpans* bs, Node* tree, bool add) {
+    std::vector<Place> todo{ { bs, tree } };
+    while (!todo.empty()) {
+        Place p = todo.back();
+        todo.pop_back();
+        if (p.node == nullptr) continue;
+        if (add) places[p.node->stmt] = p;
+        else places.erase(p.node->stmt);
+        todo.push_back(Place{ p.bs, p.node->left });
+        todo.push_back(Place{ p.bs, p.node->right });
+        for (std::unique_ptr<BlockSpans>& inner : p.node->child.blocks) {
+            if (inner != nullptr) todo.push_back(Place{ inner.get(), inner->tree });
+        }
+    }
+}
+
+
+uint32_t IncrementalParser::line(const Statement* s) {
+    if (root == nullptr) return s->get_line();
+    if (!indexed) {
+        places.reserve(nf->get_n_statements());
+        index(root.get(), root->tree, true);
+        indexed = true;
+    }
+    auto it = places.find(s);
+    if (it == places.end()) return s->get_line();
+    // from the '(' of the statement, up the Blocks around it
+    const Node* sp = it->second.node;
+    uint64_t line = sp->child.head_lines;
+    for (const BlockSpans* bs = it->second.bs; ; bs = bs->parent) {
+        line += sp->rowsBefore();
+        if (bs->parent == nullptr) break;
+        line += bs->owner->child.block_row[bs->which];
+        sp = bs->owner;
+    }
+    return static_cast<uint32_t>(root_line + line);
+}
+
+
+void IncrementalParser::update_lines() {
+    if (root == nullptr) return;
+    // Block and line of the '(' of its first statement
+    std::vector<std::pair<const BlockSpans*, uint64_t>> blocks{ { root.get(), root_line } };
+    std::vector<Node*> path;
+    while (!blocks.empty()) {
+        const BlockSpans* bs = blocks.back().first;
+        uint64_t line = blocks.back().second;
+        blocks.pop_back();
+        // statements in order
+        for (Node* t = bs->tree; t != nullptr || !path.empty();) {
+            if (t != nullptr) {
+                path.push_back(t);
+                t = t->left;
+                continue;
+            }
+            t = path.back();
+            path.pop_back();
+            t->stmt->set_line(static_cast<uint32_t>(line + t->child.head_lines));
+            for (int m = 0; m < 2; m++) {
+                if (t->child.blocks[m] != nullptr) blocks.push_back({ t->child.blocks[m].get(), line + t->child.block_row[m] });
+            }
+            line += t->rows;
+            t = t->right;
+        }
+    }
+}
+
+
+/* State "onlyalpha" of the Lexer before the character at "pos": set by the parentheses and by '-',
+cleared by a word followed by a character other than a terminator (see Lexer) */
+bool IncrementalParser::onlyAlphaAt(std::string_view source, size_t pos) {
+    while (pos > 0) {
+        char ch = source[pos - 1];
+        if (ch == '(' || ch == ')' || ch == '-') return true;
+        if (isAlpha(ch)) {
+            if (pos == source.size() || !isTerminator(source[pos])) return false;
+            while (pos > 0 && isAlpha(source[pos - 1])) pos--;
+            continue;
+        }
+        pos--;
+    }
+    return true;
+}
@@ -0,0 +1,144 @@
+#ifndef INCREMENTAL_PARSER_H
+#define INCREMENTAL_PARSER_H
+
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "Parser.h"
+#include "Program.h"
+#include "NodeFactory.h"
+#include "Exceptions.h"
+
+
+/* Edit of a source: "removed" characters from "offset" replaced by "inserted" characters */
+struct TextEdit {
+    size_t offset = 0;
+    size_t removed = 0;
+    size_t inserted = 0;
+};
+
+
+/* Parser of a source changed by many small edits (e.g. by an editor that runs the script again after each change).
+After a first parsing of the whole source, an edit is parsed reading again only the statements it touches:
+the innermost statement around it, or the sibling statements of a BLOCK it reaches, are parsed from the new
+text and take the place of the old ones in their Block; all the other nodes of the Program are kept.
+The position and the first line of each statement are kept relative to the previous statement of its Block, in a tree
+whose nodes sum the ones below them, so the statements touched are found, the ones made by the edit take the place
+of the old ones, and the positions and lines of the ones after them move, in a time logarithmic in the statements
+of the Blocks crossed: an edit costs the parsing of the statements it touches, whatever the size of the source, besides
+the move of the array of statements of its Block after them when their number changes (a Block keeps its statements
+in a contiguous array, read as such by all the engines).
+The line of a statement is then known from the tree (see line()): the line kept in a Statement node is the one of
+the parsing that made it, and isn't moved by the edits before it until update_lines().
+An edit that changes the structure around the statements (e.g. a parenthesis of a BLOCK or of an IF) is parsed
+reading again the statement around them, up to the whole source. The result, the Program or the LexicalError
+or SyntaxError, is always the one of a parsing of the whole new source.
+The nodes replaced by an edit stay in the NodeFactory until the next parsing of the whole source, which makes the
+Program in a second NodeFactory, reusing the memory of the one it emptied the time before. To keep them bounded, an edit
+is parsed with the whole source (a compaction) once the nodes made by the edits since the last parsing of the whole
+source exceed the nodes it made, and at least MIN_COMPACTION_NODES: the nodes of each NodeFactory stay within about
+twice the ones of the Program, and the parsing of the whole source, paid after as many nodes made by edits,
+at most doubles the amortized cost of an edit.
+The source isn't kept: the text after each edit is given by the caller, who owns it */
+class IncrementalParser {
+public:
+    // What the last parse() or edit() did
+    struct Stats {
+        bool full = true;        // whole source parsed again
+        size_t bytes_read = 0;   // characters parsed
+        size_t stmts_read = 0;   // statements made (the other ones are kept)
+    };
+
+    IncrementalParser();
+    ~IncrementalParser();
+
+    // Deletion of the copy constructor and the assignment operator to avoid pointers ownership errors
+    IncrementalParser(const IncrementalParser& other) = delete;
+    IncrementalParser& operator=(const IncrementalParser& other) = delete;
+
+    /* Parsing of the whole "source": it returns the Program, owned by the IncrementalParser, or throws the
+    LexicalError or the SyntaxError of the source */
+    Program* parse(std::string_view source);
+
+    /* Parsing of "source", the text of the previous call changed by "e": the Program of the previous call
+    is updated and returned, with the nodes of the statements not touched by the edit.
+    If the new source has an error, it's thrown and the edits are accumulated until the source is valid again;
+    the Program stays the one of the last valid source */
+    Program* edit(std::string_view source, const TextEdit& e);
+
+    // Nodes made by the edits before a compaction, whatever the size of the Program
+    static constexpr unsigned int MIN_COMPACTION_NODES = 1 << 14;
+
+    // Program of the last valid source (nullptr before the first one)
+    Program* get_program() const { return prg.get(); }
+    const Stats& get_stats() const { return stats; }
+    // Nodes kept in memory: the ones of the Program and the ones replaced by the edits since the last compaction
+    unsigned int get_n_nodes() const { return nf->get_n_nodes(); }
+
+    /* Line of the source where a statement of the Program starts, in the last valid source: the first call
+    after a parsing of the whole source indexes its statements, then the lookups and the edits take a time logarithmic
+    in the statements of the Blocks around it */
+    uint32_t line(const Statement* s);
+    /* Update of the line of all the statements of the Program (see Statement::get_line()), e.g. before running
+    it with the ProfilingVisitor or giving it to the optimizations: it takes a time linear in the statements */
+    void update_lines();
+
+private:
+    class Builder;
+    struct Node;
+    struct BlockSpans;
+
+    /* Position of a statement of a Block in the source and state of the Lexer around it (see ParseListener::Span).
+    An IF or a WHILE keeps the positions of the statements of its blocks too */
+    struct Child {
+        uint32_t length = 0;      // from the '(' to the ')' included
+        uint32_t lines = 0;       // new lines from the '(' to the ')'
+        uint32_t head_lines = 0;  // new lines from the '(' to the keyword
+        uint64_t group = 0;       // BLOCK statement around it, 0 if it's the only statement of its stmt_block
+        bool neg_before = false;
+        bool neg_after = false;
+        uint32_t block_offset[2] = { 0, 0 };   // first statement of each block from the '(' of the IF or WHILE
+        uint32_t block_row[2] = { 0, 0 };      // and its new lines
+        std::unique_ptr<BlockSpans> blocks[2];
+    };
+
+    // Statements of the source not matched yet by the Program: "begin" and "old_end" in the last valid source
+    struct Pending {
+        bool any = false;
+        size_t begin = 0;
+        size_t old_end = 0;
+        size_t new_end = 0;
+    };
+
+    std::unique_ptr<NodeFactory> nf;
+    std::unique_ptr<NodeFactory> spare;   // nodes of the Program before the last parsing of the whole source
+    std::unique_ptr<Program> prg;
+    std::unique_ptr<BlockSpans> root;     // nullptr if the positions of the statements are not known
+    size_t root_offset = 0;               // '(' of the first statement of the main Block
+    uint32_t root_line = 0;               // and its line
+    size_t valid_size = 0;                // size of the last valid source
+    size_t size = 0;                      // size of the source of the last call
+    uint32_t generation = 0;              // parsings made, to tell the BLOCK statements of each one
+    unsigned int full_nodes = 0;          // nodes made by the last parsing of the whole source
+    Pending pending;
+    Stats stats;
+    // Block and node of each statement of the Program, made by the first line() after a parsing of the whole source
+    struct Place {
+        BlockSpans* bs;
+        Node* node;
+    };
+    std::unordered_map<const Statement*, Place> places;
+    bool indexed = false;
+
+    Program* parseAll(std::string_view source);
+    bool reparse(std::string_view source, size_t a, size_t b, size_t inserted);
+    bool replace(std::string_view source, BlockSpans& bs, size_t p0, uint32_t l0, size_t i, size_t j, int64_t delta,
+                 int64_t& line_delta, int64_t& p0_delta, int64_t& l0_delta);
+    void index(BlockSpans* bs, Node* tree, bool add);
+    static bool onlyAlphaAt(std::string_view source, size_t pos);
+};
+
+#endif /* INCREMENTAL_PARSER_H */
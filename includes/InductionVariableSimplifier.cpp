@@ -0,0 +1,230 @@
+#include <algorithm>
+
+#include "InductionVariableSimplifier.h"
+
+
+void InductionVariableSimplifier::visitProgram(Program* prg) {
+    n_reduced = 0;
+    var_ids = prg->get_var_ids();
+    declared.assign(var_ids.size());
+    if (prg->get_is_not_empty()) {
+        prg->get_blk()->accept(this);
+        prg->set_blk(blk);
+        prg->set_var_ids(var_ids);
+    }
+}
+
+void InductionVariableSimplifier::visitBlock(Block* b) {
+    blk = blocks.rebuild(b, this);
+}
+
+
+/* STATEMENTS */
+void InductionVariableSimplifier::visitSet(SetStmt* s) {
+    declared.declare(s->get_var()->get_slot());
+    emit(s);
+}
+
+void InductionVariableSimplifier::visitInput(InputStmt* s) {
+    declared.declare(s->get_var()->get_slot());
+    emit(s);
+}
+
+void InductionVariableSimplifier::visitPrint(PrintStmt* s) {
+    emit(s);
+}
+
+void InductionVariableSimplifier::visitIf(IfStmt* s) {
+    Block* blk1 = nullptr;
+    Block* blk2 = nullptr;
+    declared.branches([&] { s->get_stmt_block1()->accept(this); blk1 = blk; },
+                      [&] { s->get_stmt_block2()->accept(this); blk2 = blk; });
+    emit(blocks.ifStmt(s, s->get_bexpr(), blk1, blk2));
+}
+
+void InductionVariableSimplifier::visitWhile(WhileStmt* s) {
+    // The nested loops are replaced first, the counting loop is matched with the variables declared before it
+    declared.mayNotRun([&] { s->get_stmt_block()->accept(this); });
+    WhileStmt* loop_stmt = static_cast<WhileStmt*>(blocks.whileStmt(s, s->get_bexpr(), blk));
+
+    CountingLoop loop;
+    if (matchLoop(loop_stmt, loop)) {
+        n_reduced++;
+        emit(closedForm(loop_stmt, loop));
+    } else emit(loop_stmt);
+}
+
+
+/* RECOGNITION OF THE COUNTING LOOPS */
+bool InductionVariableSimplifier::isVar(NumExpr* e, const Variable* v) const {
+    Variable* var = dynamic_cast<Variable*>(e);
+    return var != nullptr && var->get_slot() == v->get_slot();
+}
+
+bool InductionVariableSimplifier::matchLoop(WhileStmt* s, CountingLoop& loop) const {
+    RelOp* guard = dynamic_cast<RelOp*>(s->get_bexpr());
+    if (guard == nullptr || guard->get_r_opcode() == RelOp::EQ) return false;
+
+    // The body assigns each variable once, by SET statements only
+    StatementList body = s->get_stmt_block()->get_stmts();
+    std::vector<int> assigned; // slots assigned by the body, sorted
+    for (Statement* stmt : body) {
+        SetStmt* set = dynamic_cast<SetStmt*>(stmt);
+        if (set == nullptr) return false;
+        assigned.push_back(set->get_var()->get_slot());
+    }
+    std::sort(assigned.begin(), assigned.end());
+    if (std::adjacent_find(assigned.begin(), assigned.end()) != assigned.end()) return false;
+    auto isAssigned = [&assigned](const Variable* v) { return std::binary_search(assigned.begin(), assigned.end(), v->get_slot()); };
+
+    // i < b or i > b, with the bound not assigned by the body
+    Variable* first = dynamic_cast<Variable*>(guard->get_first_nexpr());
+    Variable* second = dynamic_cast<Variable*>(guard->get_second_nexpr());
+    bool less;
+    if (first != nullptr && isAssigned(first)) {
+        loop.iv = first;
+        loop.bound = guard->get_second_nexpr();
+        less = (guard->get_r_opcode() == RelOp::LT);
+    } else if (second != nullptr && isAssigned(second)) {
+        loop.iv = second;
+        loop.bound = guard->get_first_nexpr();
+        less = (guard->get_r_opcode() == RelOp::GT);
+    } else return false;
+    Variable* bound_var = dynamic_cast<Variable*>(loop.bound);
+    if (bound_var != nullptr) {
+        if (isAssigned(bound_var) || !declared[bound_var->get_slot()]) return false;
+    } else if (dynamic_cast<Number*>(loop.bound) == nullptr) return false;
+    if (!declared[loop.iv->get_slot()]) return false;
+
+    // Step of i by a constant, towards the bound
+    size_t step_index = body.size();
+    for (size_t k = 0; k < body.size(); k++) {
+        SetStmt* set = static_cast<SetStmt*>(body[k]);
+        if (set->get_var()->get_slot() != loop.iv->get_slot()) continue;
+        Operator* update = dynamic_cast<Operator*>(set->get_nexpr());
+        if (update == nullptr) return false;
+        Number* c = nullptr;
+        if (isVar(update->getFirst(), loop.iv)) c = dynamic_cast<Number*>(update->getSecond());
+        else if (update->getOp() == Operator::ADD && isVar(update->getSecond(), loop.iv)) c = dynamic_cast<Number*>(update->getFirst());
+        if (c == nullptr || c->get_value() == 0 || c->get_value() > MAX_STEP || c->get_value() < -MAX_STEP) return false;
+        if (update->getOp() == Operator::ADD) loop.step = c->get_value();
+        else if (update->getOp() == Operator::SUB) loop.step = -c->get_value();
+        else return false;
+        step_index = k;
+    }
+    if (less != (loop.step > 0)) return false;
+
+    // Reductions and assignments of the other variables
+    for (size_t k = 0; k < body.size(); k++) {
+        if (k == step_index) continue;
+        SetStmt* set = static_cast<SetStmt*>(body[k]);
+        Variable* x = set->get_var();
+        Update u{ x, Operator::NULL_VAL, Term{} };
+        Operator* e = dynamic_cast<Operator*>(set->get_nexpr());
+        NumExpr* term = set->get_nexpr();
+        if (e != nullptr && e->getOp() != Operator::MUL && e->getOp() != Operator::DIV) {
+            if (isVar(e->getFirst(), x)) term = e->getSecond();
+            else if (e->getOp() == Operator::ADD && isVar(e->getSecond(), x)) term = e->getFirst();
+            if (term != set->get_nexpr()) {
+                // x is read by the first iteration
+                if (!declared[x->get_slot()]) return false;
+                u.op = e->getOp();
+            }
+        }
+        if (!matchTerm(term, loop, assigned, u.term)) return false;
+        u.term.after_step = (k > step_index);
+        loop.updates.push_back(u);
+    }
+    return true;
+}
+
+bool InductionVariableSimplifier::matchTerm(NumExpr* e, const CountingLoop& loop, const std::vector<int>& assigned, Term& t) const {
+    if ((t.num = dynamic_cast<Number*>(e)) != nullptr) return true;
+    if (isVar(e, loop.iv)) {
+        t.induction = true;
+        return true;
+    }
+    if ((t.var = dynamic_cast<Variable*>(e)) != nullptr) return !std::binary_search(assigned.begin(), assigned.end(), t.var->get_slot()) && declared[t.var->get_slot()];
+
+    // i multiplied by a constant
+    Operator* mul = dynamic_cast<Operator*>(e);
+    if (mul == nullptr || mul->getOp() != Operator::MUL) return false;
+    Number* k = nullptr;
+    if (isVar(mul->getFirst(), loop.iv)) k = dynamic_cast<Number*>(mul->getSecond());
+    else if (isVar(mul->getSecond(), loop.iv)) k = dynamic_cast<Number*>(mul->getFirst());
+    if (k == nullptr) return false;
+    t.induction = true;
+    t.coef = k->get_value();
+    return true;
+}
+
+
+/* CLOSED FORM */
+int InductionVariableSimplifier::newTemporary(const char* prefix) {
+    var_ids.push_back(prefix + std::to_string(n_reduced));
+    return static_cast<int>(var_ids.size()) - 1;
+}
+
+Variable* InductionVariableSimplifier::var(int slot) {
+    Variable* v = static_cast<Variable*>(nf.makeVariable(var_ids[slot]));
+    v->set_slot(slot);
+    return v;
+}
+
+Statement* InductionVariableSimplifier::closedForm(WhileStmt* s, const CountingLoop& loop) {
+    Variable* i = loop.iv;
+    int64_t step = loop.step;
+    auto bound = [&]() -> NumExpr* {
+        Number* n = dynamic_cast<Number*>(loop.bound);
+        return (n != nullptr) ? num(n->get_value()) : var(static_cast<Variable*>(loop.bound));
+    };
+    std::vector<Statement*> stmts;
+
+    // Trip count T = ceil(|b - i| / |step|), i and b within +-MAX_BOUND
+    int n_slot = newTemporary("#n");
+    int64_t abs_step = (step > 0) ? step : -step;
+    NumExpr* span = (step > 0) ? op(Operator::SUB, bound(), var(i)) : op(Operator::SUB, var(i), bound());
+    NumExpr* trips = (abs_step == 1) ? span : op(Operator::DIV, op(Operator::ADD, span, num(abs_step - 1)), num(abs_step));
+    stmts.push_back(nf.makeSetStmt(trips, var(n_slot)));
+
+    // T*(T-1)/2 for the reductions of i, dividing the even factor to keep the exact value modulo 2^64
+    int s_slot = -1;
+    if (std::any_of(loop.updates.begin(), loop.updates.end(), [](const Update& u) { return u.op != Operator::NULL_VAL && u.term.induction; })) {
+        s_slot = newTemporary("#s");
+        Statement* even = nf.makeSetStmt(op(Operator::MUL, op(Operator::DIV, var(n_slot), num(2)), op(Operator::SUB, var(n_slot), num(1))), var(s_slot));
+        Statement* odd = nf.makeSetStmt(op(Operator::MUL, var(n_slot), op(Operator::DIV, op(Operator::SUB, var(n_slot), num(1)), num(2))), var(s_slot));
+        BoolExpr* is_even = nf.makeRelOp(RelOp::EQ, op(Operator::MUL, op(Operator::DIV, var(n_slot), num(2)), num(2)), var(n_slot));
+        stmts.push_back(nf.makeIfStmt(is_even, nf.makeBlock(&even, 1), nf.makeBlock(&odd, 1)));
+    }
+
+    for (const Update& u : loop.updates) {
+        const Term& t = u.term;
+        NumExpr* value;
+        if (t.induction) {
+            // values of i read by the statement: first, first + step, ..., first + (T-1)*step
+            NumExpr* first = t.after_step ? op(Operator::ADD, var(i), num(step)) : var(i);
+            if (u.op == Operator::NULL_VAL) value = op(Operator::ADD, first, op(Operator::MUL, op(Operator::SUB, var(n_slot), num(1)), num(step)));
+            else value = op(Operator::ADD, op(Operator::MUL, var(n_slot), first), op(Operator::MUL, var(s_slot), num(step)));
+            if (t.coef != 1) value = op(Operator::MUL, value, num(t.coef));
+        } else {
+            NumExpr* leaf = (t.num != nullptr) ? num(t.num->get_value()) : var(t.var);
+            value = (u.op == Operator::NULL_VAL) ? leaf : op(Operator::MUL, var(n_slot), leaf);
+        }
+        if (u.op != Operator::NULL_VAL) value = op(u.op, var(u.target), value);
+        stmts.push_back(nf.makeSetStmt(value, var(u.target)));
+    }
+    stmts.push_back(nf.makeSetStmt(op(Operator::ADD, var(i), op(Operator::MUL, var(n_slot), num(step))), var(i)));
+
+    // The loop runs at least once and its trip count can't overflow
+    BoolExpr* runs;
+    BoolExpr* bounded;
+    if (step > 0) {
+        runs = nf.makeRelOp(RelOp::LT, var(i), bound());
+        bounded = nf.makeBoolOp(BoolOp::AND, nf.makeRelOp(RelOp::GT, var(i), num(-MAX_BOUND)), nf.makeRelOp(RelOp::LT, bound(), num(MAX_BOUND)));
+    } else {
+        runs = nf.makeRelOp(RelOp::GT, var(i), bound());
+        bounded = nf.makeBoolOp(BoolOp::AND, nf.makeRelOp(RelOp::LT, var(i), num(MAX_BOUND)), nf.makeRelOp(RelOp::GT, bound(), num(-MAX_BOUND)));
+    }
+    Statement* loop_stmt = s;
+    return nf.makeIfStmt(nf.makeBoolOp(BoolOp::AND, runs, bounded), nf.makeBlock(stmts), nf.makeBlock(&loop_stmt, 1));
+}
@@ -0,0 +1,113 @@
+#ifndef INDUCTION_VARIABLE_SIMPLIFIER_H
+#define INDUCTION_VARIABLE_SIMPLIFIER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Visitor.h"
+#include "NodeFactory.h"
+#include "DeclaredSlots.h"
+#include "BlockRebuilder.h"
+
+
+/* Class that extends Visitor superclass to replace the counting loops of a resolved Program
+(see ResolveVisitor) by their closed form. A WHILE is a counting loop if:
+- its guard compares an induction variable i with a bound b that the body doesn't assign
+  ((LT i b) or (GT b i) for a positive step, (GT i b) or (LT b i) for a negative one);
+- its body is made only of SET statements, each assigning a different variable: one of them steps i
+  by a constant, (SET i (ADD i c)) or (SET i (SUB i c)), and each other one is a reduction
+  (SET x (ADD x t)), (SET x (SUB x t)) or an assignment (SET x t) of a term t that is a constant,
+  a variable not assigned by the body, i or i multiplied by a constant.
+The loop is replaced by (IF (AND (LT i b) <bounds of i and b>) <closed form> (BLOCK <loop>)):
+the closed form computes the trip count in a temporary #nN and updates each variable with
+the sum of its terms (the sum of the values of i, T*i + c*T*(T-1)/2, uses the temporary #sN),
+with the same wrap around of the int64_t arithmetic of the loop. The loop is kept for the
+values of i and b beyond +-2^61, whose trip count may overflow, and when it isn't run at all.
+Every variable read by the loop must be surely declared before it, so that the loop can't fail */
+class InductionVariableSimplifier : public Visitor {
+public:
+    InductionVariableSimplifier(NodeFactory& node_f) : nf{ node_f }, blocks{ node_f } {}
+    ~InductionVariableSimplifier() = default;
+
+    // Deletion of copy constructor and assignment operator: an InductionVariableSimplifier is used for a single Program
+    InductionVariableSimplifier(const InductionVariableSimplifier& other) = delete;
+    InductionVariableSimplifier& operator=(const InductionVariableSimplifier& other) = delete;
+
+    // Replacement of the counting loops of the Program, whose main Block and slot table are replaced
+    void operator()(Program* prg) { prg->accept(this); }
+
+    // Number of loops replaced by the last run
+    unsigned int get_n_reduced() const { return n_reduced; }
+
+    void visitProgram(Program* prg) override;
+    void visitBlock(Block* blk) override;
+
+    void visitSet(SetStmt* s) override;
+    void visitInput(InputStmt* s) override;
+    void visitPrint(PrintStmt* s) override;
+    void visitIf(IfStmt* s) override;
+    void visitWhile(WhileStmt* s) override;
+
+    // The expressions are kept as they are
+    void visitOperator(Operator*) override {}
+    void visitNumber(Number*) override {}
+    void visitVariable(Variable*) override {}
+
+    void visitRelOp(RelOp*) override {}
+    void visitBoolConst(BoolConst*) override {}
+    void visitBoolOp(BoolOp*) override {}
+
+    // Bound of the absolute values of i and b for the closed form, and of the absolute value of the step
+    static constexpr int64_t MAX_BOUND = int64_t{ 1 } << 61;
+    static constexpr int64_t MAX_STEP = int64_t{ 1 } << 30;
+
+private:
+    /* Term added (or assigned) by a statement of the body at each iteration:
+    "coef" * i if "var" is the induction variable (read before or after its step), "var" or "num" otherwise */
+    struct Term {
+        Variable* var = nullptr;
+        Number* num = nullptr;
+        int64_t coef = 1;
+        bool induction = false;
+        bool after_step = false;
+    };
+
+    // Statement of the body, other than the step of i: x = x op t (or x = t if op is NULL_VAL)
+    struct Update {
+        Variable* target;
+        Operator::OpCode op;
+        Term term;
+    };
+
+    // Counting loop recognized by matchLoop()
+    struct CountingLoop {
+        Variable* iv = nullptr;    // induction variable
+        NumExpr* bound = nullptr;  // Number or Variable not assigned by the body
+        int64_t step = 0;
+        std::vector<Update> updates;
+    };
+
+    NodeFactory& nf;
+    unsigned int n_reduced = 0;
+
+    std::vector<std::string> var_ids;             // slot table of the Program, extended with the temporaries
+    DeclaredSlots declared;                       // variables surely declared at the current point
+    BlockRebuilder blocks;
+    Block* blk = nullptr; // result of the last visit of a Block
+
+    bool matchLoop(WhileStmt* s, CountingLoop& loop) const;
+    bool matchTerm(NumExpr* e, const CountingLoop& loop, const std::vector<int>& assigned, Term& t) const;
+    Statement* closedForm(WhileStmt* s, const CountingLoop& loop);
+
+    bool isVar(NumExpr* e, const Variable* v) const;
+    int newTemporary(const char* prefix);
+    Variable* var(Variable* v) { return var(v->get_slot()); } // new node reading or writing the same slot
+    Variable* var(int slot);
+    NumExpr* num(int64_t val) { return nf.makeNumber(val); }
+    NumExpr* op(Operator::OpCode code, NumExpr* l, NumExpr* r) { return nf.makeOperator(code, l, r); }
+
+    void emit(Statement* s) { blocks.emit(s); }
+};
+
+#endif /* INDUCTION_VARIABLE_SIMPLIFIER_H */
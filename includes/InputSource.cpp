@@ -0,0 +1,122 @@
+#include <charconv>
+#include <iostream>
+#include <stdexcept>
+
+#include "InputSource.h"
+#include "Exceptions.h"
+
+
+// White spaces of the "C" locale, which separate the words read by std::cin
+static bool isSpace(char ch) { return ch == ' ' || (ch >= '\t' && ch <= '\r'); }
+
+static constexpr size_t READ_SIZE = 64 * 1024;
+
+
+InputSource::InputSource(std::FILE* f, bool o) : file{ f }, owned{ o } {}
+
+InputSource::InputSource(std::string_view text) : in_memory{ true }, buf{ text }, eof{ true } {}
+
+InputSource::~InputSource() {
+    if (owned) std::fclose(file);
+}
+
+
+int64_t InputSource::toValue(std::string_view word) {
+    bool valid_input = true; // flag to verify the correctness of the value given in input
+    if ((word.size() > 1 && word[0] == '0')
+            || (word.size() > 2 && word[0] == '-' && word[1] == '0')) {
+        // value not valid because is made of a 0 followed by other significant digits
+        // or a '-', followed by a 0, followed by significant digits
+        valid_input = false;
+    } else {
+        // analysis that each character given in input is a number
+        for (char c : word) {
+            if ((c < '0' || c > '9') && c != '-') {
+                valid_input = false;
+                break;
+            }
+        }
+    }
+    if (!valid_input) throw SemanticError(SemanticMessage::invalidInput(std::string{ word }));
+
+    // conversion of the leading NUM, with the errors of std::stoll
+    int64_t val = 0;
+    std::from_chars_result res = std::from_chars(word.data(), word.data() + word.size(), val);
+    if (res.ec == std::errc::invalid_argument) throw std::invalid_argument("stoll");
+    if (res.ec == std::errc::result_out_of_range) throw std::out_of_range("stoll");
+    return val;
+}
+
+
+// Read of the next block of the file at the end of the buffer: false at the end of the file
+bool InputSource::fill() {
+    if (eof) return false;
+    buf.erase(0, pos);
+    pos = 0;
+    size_t old_size = buf.size();
+    buf.resize(old_size + READ_SIZE);
+    size_t n = std::fread(&buf[old_size], 1, READ_SIZE, file);
+    buf.resize(old_size + n);
+    if (n == 0) eof = true;
+    return n > 0;
+}
+
+// Next word of a batch source (empty at the end of the input); it is valid until the next read
+std::string_view InputSource::nextWord() {
+    for (;;) {
+        while (pos < buf.size() && isSpace(buf[pos])) pos++;
+        if (pos < buf.size() || !fill()) break;
+    }
+    size_t end = pos;
+    for (;;) {
+        while (end < buf.size() && !isSpace(buf[end])) end++;
+        if (end < buf.size()) break;
+        // the word can continue in the next block (fill() moves it at the beginning of the buffer)
+        size_t len = end - pos;
+        bool more = fill();
+        end = pos + len;
+        if (!more) break;
+    }
+    std::string_view word{ buf.data() + pos, end - pos };
+    pos = end;
+    return word;
+}
+
+
+void InputSource::preload() {
+    if (is_interactive() || preloaded) return;
+    // the words are converted block by block, without keeping the whole text in memory
+    for (std::string_view word = nextWord(); !word.empty(); word = nextWord()) {
+        try {
+            values.push_back(toValue(word));
+        } catch (std::exception&) {
+            // the error is given by the INPUT reading this word
+            bad_word.reset(new std::string{ word });
+            break;
+        }
+    }
+    // the rest of the input is not used (the run stops at bad_word)
+    preloaded = true;
+    std::string{}.swap(buf);
+    pos = 0;
+}
+
+
+int64_t InputSource::next() {
+    if (is_interactive()) {
+        std::string tmp_input;
+        std::cin >> tmp_input;
+        return toValue(tmp_input);
+    }
+    if (preloaded) {
+        if (next_value < values.size()) return values[next_value++];
+        return toValue(bad_word ? std::string_view{ *bad_word } : std::string_view{});
+    }
+    return toValue(nextWord());
+}
+
+
+InputSource& InputSource::standard() {
+    static InputSource in;
+    return in;
+}
@@ -0,0 +1,68 @@
+#ifndef INPUT_SOURCE_H
+#define INPUT_SOURCE_H
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+
+/* Source of the values requested by INPUT.
+The console source reads one word at a time from std::cin after a prompt; a batch source reads
+the words, separated by white spaces, from a file (or stdin) through a buffer and without prompts.
+A batch source can preload all its values before the run, so that INPUT never waits for the I/O.
+Every word is validated by toValue() */
+class InputSource {
+public:
+    // Console source: std::cin with prompts
+    InputSource() = default;
+    // Batch source reading from "f" (closed by the destructor if "owned")
+    InputSource(std::FILE* f, bool owned);
+    // Batch source reading the words of "text", copied in its buffer
+    explicit InputSource(std::string_view text);
+    ~InputSource();
+
+    // Deletion of copy constructor and assignment operator: the file has a single owner
+    InputSource(const InputSource& other) = delete;
+    InputSource& operator=(const InputSource& other) = delete;
+
+    bool is_interactive() const { return file == nullptr && !in_memory; }
+
+    // Read of all the words of a batch source, which are converted up to the first invalid one (not included)
+    void preload();
+
+    /* Next value: a SemanticError is thrown if the word is not valid;
+    at the end of the input the error is the one of an empty word */
+    int64_t next();
+
+    /* Conversion of a word to a value: a SemanticError is thrown if it isn't made only of digits and '-'
+    or if it has a 0 followed by other digits; the other errors are the ones of std::stoll
+    (e.g. only the leading NUM of "5-3" is read) */
+    static int64_t toValue(std::string_view word);
+
+    // Console source
+    static InputSource& standard();
+
+private:
+    std::FILE* file = nullptr; // nullptr for the console
+    bool owned = false;
+    bool in_memory = false; // batch source without a file
+
+    // buffer of a batch source: the words not read yet are in [pos, buf.size())
+    std::string buf;
+    size_t pos = 0;
+    bool eof = false;
+
+    // preloaded values: values[next_value..] are returned before bad_word (nullptr if all the words are valid)
+    bool preloaded = false;
+    std::vector<int64_t> values;
+    size_t next_value = 0;
+    std::unique_ptr<std::string> bad_word;
+
+    std::string_view nextWord();
+    bool fill();
+};
+
+#endif /* INPUT_SOURCE_H */
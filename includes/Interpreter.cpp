@@ -0,0 +1,36 @@
+#include "Interpreter.h"
+#include "PreparedProgram.h"
+#include "ExecutionContext.h"
+#include "Exceptions.h"
+
+
+Interpreter::Result Interpreter::run(std::string_view source, std::string_view input) const {
+    return run(source, input, nullptr);
+}
+
+Interpreter::Result Interpreter::run(std::string_view source, std::string_view input, std::FILE* out) const {
+    Result result;
+    try {
+        PreparedProgram program{ source, opts };
+        if (out == nullptr) {
+            ExecutionContext ctx{ input };
+            ctx.run(program.get_engine());
+            result.output = std::move(ctx.get_output());
+            result.error = std::move(ctx.get_error());
+        } else {
+            ExecutionContext ctx{ input, out };
+            ctx.flushOnFatalSignal();
+            ctx.run(program.get_engine());
+            result.error = std::move(ctx.get_error());
+        }
+    } catch (LexicalError& le) {
+        result.error = std::string{ le.what() } + '\n';
+    } catch (SyntaxError& pe) {
+        result.error = std::string{ pe.what() } + '\n';
+    } catch (SemanticError& se) {
+        result.error = std::string{ se.what() } + '\n';
+    } catch (std::exception& exc) {
+        result.error = "(ERROR: generic error )\n" + std::string{ exc.what() } + '\n';
+    }
+    return result;
+}
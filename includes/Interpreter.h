@@ -0,0 +1,37 @@
+#ifndef INTERPRETER_H
+#define INTERPRETER_H
+
+#include <cstdio>
+#include <string>
+#include <string_view>
+
+#include "Options.h"
+
+
+/* Facade of the interpreter for the programs linking it as a library: a source and the values of its INPUT
+statements go in, the output of PRINT and the message of the error that stopped the program come out, as the
+command line interpreter writes them on stdout and stderr. The source is prepared (see PreparedProgram) and run
+in an ExecutionContext of its own at each call, and the Interpreter keeps only its Options, so many threads
+can use it at once */
+class Interpreter {
+public:
+    struct Result {
+        std::string output;
+        std::string error; // with its '\n', empty if the program ended normally
+        bool failed() const { return !error.empty(); }
+    };
+
+    Interpreter() = default;
+    explicit Interpreter(const Options& o) : opts{ o } {}
+
+    // Run of "source" reading the values of INPUT from "input" (separated by white spaces, without prompts)
+    Result run(std::string_view source, std::string_view input = "") const;
+    /* Run writing the output of PRINT on "out" while the program runs (the output of the Result stays empty):
+    the text written before a fatal signal that stops the process (e.g. the SIGFPE of INT64_MIN / -1) reaches it too */
+    Result run(std::string_view source, std::string_view input, std::FILE* out) const;
+
+private:
+    Options opts;
+};
+
+#endif /* INTERPRETER_H */
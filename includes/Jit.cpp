@@ -0,0 +1,461 @@
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+
+#include "Jit.h"
+
+#if (defined(__x86_64__) || defined(_M_X64)) && defined(__unix__)
+#define JIT_SUPPORTED 1
+#include <sys/mman.h>
+#endif
+
+
+/* RUNTIME HELPERS called by the native code.
+They never let an exception cross the native frames: it is stored in the JitContext
+and a value other than 0 tells the native code to leave */
+static int64_t jitPrint(JitContext* ctx, int64_t val) noexcept {
+    try {
+        ctx->rt->print(val);
+        return 0;
+    } catch (...) {
+        ctx->error = std::current_exception();
+        return 1;
+    }
+}
+
+static int64_t jitInput(JitContext* ctx, int64_t slot) noexcept {
+    try {
+        ctx->vars[slot] = ctx->rt->input((*ctx->var_ids)[slot]);
+        return 0;
+    } catch (...) {
+        ctx->error = std::current_exception();
+        return 1;
+    }
+}
+
+
+/* JIT PROGRAM */
+JitProgram::JitProgram(const std::vector<uint8_t>& code, std::vector<std::string> msgs, std::vector<std::string> ids)
+    : mem{ nullptr }, size{ code.size() }, messages{ std::move(msgs) }, var_ids{ std::move(ids) } {
+#ifdef JIT_SUPPORTED
+    // The memory is written while it is not executable and then made executable and read-only
+    mem = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (mem == MAP_FAILED) throw std::runtime_error("(ERROR: mmap of the native code failed )");
+    std::memcpy(mem, code.data(), size);
+    if (mprotect(mem, size, PROT_READ | PROT_EXEC) != 0) {
+        munmap(mem, size);
+        throw std::runtime_error("(ERROR: mprotect of the native code failed )");
+    }
+#else
+    throw std::runtime_error("(ERROR: native code generation not supported on this platform )");
+#endif
+}
+
+JitProgram::~JitProgram() {
+#ifdef JIT_SUPPORTED
+    if (mem != nullptr) munmap(mem, size);
+#endif
+}
+
+void JitProgram::run(Runtime* rt) {
+    // Values of the slots followed by the declared flags, all set to 0
+    unsigned int n = var_ids.size();
+    std::vector<int64_t> storage(n + (n + 7) / 8, 0);
+    JitContext ctx{ storage.data(), rt, &var_ids, nullptr };
+
+    int64_t result = reinterpret_cast<EntryPoint>(mem)(&ctx);
+    if (result == -1) std::rethrow_exception(ctx.error);
+    if (result > 0) throw SemanticError(messages[result - 1]);
+}
+
+
+/* USE COUNTER: weight of the uses of each slot, multiplied by 8 for each enclosing WHILE */
+class UseCounter : public Visitor {
+public:
+    UseCounter(unsigned int n_vars) : weights(n_vars, 0) {}
+
+    std::vector<uint64_t> weights;
+
+    void visitProgram(Program* prg) override { if (prg->get_is_not_empty()) prg->get_blk()->accept(this); }
+    void visitBlock(Block* blk) override { for (Statement* s : blk->get_stmts()) s->accept(this); }
+    void visitSet(SetStmt* s) override { s->get_var()->accept(this); s->get_nexpr()->accept(this); }
+    void visitInput(InputStmt* s) override { s->get_var()->accept(this); }
+    void visitPrint(PrintStmt* s) override { s->get_nexpr()->accept(this); }
+    void visitIf(IfStmt* s) override {
+        s->get_bexpr()->accept(this);
+        s->get_stmt_block1()->accept(this);
+        s->get_stmt_block2()->accept(this);
+    }
+    void visitWhile(WhileStmt* s) override {
+        uint64_t saved = weight;
+        if (weight < (uint64_t(1) << 40)) weight *= 8;
+        s->get_bexpr()->accept(this);
+        s->get_stmt_block()->accept(this);
+        weight = saved;
+    }
+    void visitOperator(Operator* opNode) override { opNode->getFirst()->accept(this); opNode->getSecond()->accept(this); }
+    void visitNumber(Number*) override {}
+    void visitVariable(Variable* varNode) override { weights[varNode->get_slot()] += weight; }
+    void visitRelOp(RelOp* rop) override { rop->get_first_nexpr()->accept(this); rop->get_second_nexpr()->accept(this); }
+    void visitBoolConst(BoolConst*) override {}
+    void visitBoolOp(BoolOp* bop) override {
+        bop->get_f_bexpr()->accept(this);
+        if (bop->get_b_opcode() != BoolOp::NOT) bop->get_s_bexpr()->accept(this);
+    }
+
+private:
+    uint64_t weight = 1;
+};
+
+
+/* JIT COMPILER */
+
+/* Registers available for the variables: the callee-saved ones survive the calls to the
+runtime helpers, the caller-saved ones are written back to memory around them.
+RAX, RCX and RDX are scratch registers, R15 holds the base address of the slots */
+static const X86Assembler::Reg CALLEE_SAVED[] = { X86Assembler::RBX, X86Assembler::R12, X86Assembler::R13, X86Assembler::R14 };
+static const X86Assembler::Reg CALLER_SAVED[] = { X86Assembler::R8, X86Assembler::R9, X86Assembler::R10, X86Assembler::R11 };
+// Position of the JitContext* saved in the stack frame
+static constexpr int8_t CTX_DISP = -48;
+
+static bool isCallerSaved(int r) {
+    return r >= X86Assembler::R8 && r <= X86Assembler::R11;
+}
+
+bool JitCompiler::isSupported() {
+#ifdef JIT_SUPPORTED
+    return true;
+#else
+    return false;
+#endif
+}
+
+JitProgram* JitCompiler::operator()(Program* prg) {
+    if (!isSupported()) throw std::runtime_error("(ERROR: native code generation not supported on this platform )");
+    prg->accept(this);
+    return new JitProgram(as.get_code(), messages, prg->get_var_ids());
+}
+
+void JitCompiler::chooseRegisters(Program* prg) {
+    UseCounter counter{ static_cast<unsigned int>(n_vars) };
+    prg->accept(&counter);
+    std::vector<int> order(n_vars);
+    for (int i = 0; i < n_vars; i++) order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return counter.weights[a] > counter.weights[b]; });
+
+    reg_of_slot.assign(n_vars, -1);
+    unsigned int next = 0;
+    for (int slot : order) {
+        if (next >= 8 || counter.weights[slot] == 0) break;
+        reg_of_slot[slot] = (next < 4) ? CALLEE_SAVED[next] : CALLER_SAVED[next - 4];
+        next++;
+    }
+}
+
+JitCompiler::ErrorStub* JitCompiler::newStub(std::string message) {
+    messages.push_back(std::move(message));
+    stubs.push_back(ErrorStub{ Label{}, static_cast<int>(messages.size()) });
+    return &stubs.back();
+}
+
+void JitCompiler::spillCallerSaved() {
+    for (int slot = 0; slot < n_vars; slot++)
+        if (isCallerSaved(reg_of_slot[slot])) as.store(X86Assembler::R15, slotDisp(slot), static_cast<Reg>(reg_of_slot[slot]));
+}
+
+void JitCompiler::reloadCallerSaved() {
+    for (int slot = 0; slot < n_vars; slot++)
+        if (isCallerSaved(reg_of_slot[slot])) as.load(static_cast<Reg>(reg_of_slot[slot]), X86Assembler::R15, slotDisp(slot));
+}
+
+void JitCompiler::loadChecked(Variable* var, Reg dst, std::string message) {
+    int slot = var->get_slot();
+    // A read proved to follow a declaration (see DefiniteAssignment) needs no check
+    if (dynamic_cast<CheckedVariable*> (var) != nullptr) {
+        ErrorStub* stub = newStub(std::move(message));
+        as.cmpByteImm(X86Assembler::R15, declaredDisp(slot), 0);
+        as.jcc(X86Assembler::EQUAL, stub->label);
+    }
+    if (reg_of_slot[slot] >= 0) {
+        if (dst != reg_of_slot[slot]) as.mov(dst, static_cast<Reg>(reg_of_slot[slot]));
+    } else {
+        as.load(dst, X86Assembler::R15, slotDisp(slot));
+    }
+}
+
+void JitCompiler::storeVar(int slot, Reg src) {
+    if (reg_of_slot[slot] >= 0) as.mov(static_cast<Reg>(reg_of_slot[slot]), src);
+    else as.store(X86Assembler::R15, slotDisp(slot), src);
+    as.storeByte(X86Assembler::R15, declaredDisp(slot), 1);
+}
+
+JitCompiler::Operand JitCompiler::loadOperands(NumExpr* first, NumExpr* second, const std::string& op_name, bool rel_op) {
+    auto message = [&](Variable* v) {
+        return rel_op ? SemanticMessage::undeclaredRelOperand(op_name, v->get_id())
+                      : SemanticMessage::undeclaredOperand(op_name, v->get_id());
+    };
+
+    Variable* v = dynamic_cast<Variable*> (first);
+    if (v != nullptr) loadChecked(v, X86Assembler::RAX, message(v));
+    else first->accept(this);
+
+    v = dynamic_cast<Variable*> (second);
+    Number* n = dynamic_cast<Number*> (second);
+    if (v != nullptr) {
+        // The check doesn't modify RAX: the variable is used where it lives
+        int slot = v->get_slot();
+        if (dynamic_cast<CheckedVariable*> (v) != nullptr) {
+            ErrorStub* stub = newStub(message(v));
+            as.cmpByteImm(X86Assembler::R15, declaredDisp(slot), 0);
+            as.jcc(X86Assembler::EQUAL, stub->label);
+        }
+        if (reg_of_slot[slot] >= 0) return Operand{ Operand::REG, static_cast<Reg>(reg_of_slot[slot]), 0, 0 };
+        return Operand{ Operand::MEM, X86Assembler::R15, slotDisp(slot), 0 };
+    }
+    if (n != nullptr) return Operand{ Operand::IMM, X86Assembler::RCX, 0, n->get_value() };
+
+    // Complex 2nd operand: the 1st one waits on the machine stack
+    as.push(X86Assembler::RAX);
+    second->accept(this);
+    as.mov(X86Assembler::RCX, X86Assembler::RAX);
+    as.pop(X86Assembler::RAX);
+    return Operand{ Operand::REG, X86Assembler::RCX, 0, 0 };
+}
+
+void JitCompiler::branch(BoolExpr* bexpr, Label& target, bool jump_if) {
+    Label* saved_target = branch_target;
+    bool saved_if = branch_if;
+    branch_target = &target;
+    branch_if = jump_if;
+    bexpr->accept(this);
+    branch_target = saved_target;
+    branch_if = saved_if;
+}
+
+
+void JitCompiler::visitProgram(Program* prg) {
+    n_vars = prg->get_n_vars();
+    chooseRegisters(prg);
+    div_by_zero = newStub(SemanticMessage::divisionByZero());
+
+    /* PROLOGUE: frame pointer, callee-saved registers and JitContext* in [rbp - 48]
+    (its push also keeps the stack aligned to 16 bytes for the calls) */
+    as.push(X86Assembler::RBP);
+    as.mov(X86Assembler::RBP, X86Assembler::RSP);
+    for (Reg r : { X86Assembler::RBX, X86Assembler::R12, X86Assembler::R13, X86Assembler::R14, X86Assembler::R15 }) as.push(r);
+    as.push(X86Assembler::RDI);
+    as.load(X86Assembler::R15, X86Assembler::RDI, static_cast<int32_t>(offsetof(JitContext, vars)));
+    for (int slot = 0; slot < n_vars; slot++)
+        if (reg_of_slot[slot] >= 0) as.xor32(static_cast<Reg>(reg_of_slot[slot]), static_cast<Reg>(reg_of_slot[slot]));
+
+    if (prg->get_is_not_empty()) {
+        prg->get_blk()->accept(this);
+    }
+    as.xor32(X86Assembler::RAX, X86Assembler::RAX);
+
+    /* EPILOGUE: RAX holds the result (0 success, k > 0 message k - 1, -1 exception in the context) */
+    as.bind(exit_label);
+    as.leaRspFromRbp(-40);
+    for (Reg r : { X86Assembler::R15, X86Assembler::R14, X86Assembler::R13, X86Assembler::R12, X86Assembler::RBX }) as.pop(r);
+    as.pop(X86Assembler::RBP);
+    as.ret();
+
+    as.bind(exception_label);
+    as.movImm(X86Assembler::RAX, -1);
+    as.jmp(exit_label);
+    for (ErrorStub& stub : stubs) {
+        if (stub.label.fixups.empty()) continue; // stub never used
+        as.bind(stub.label);
+        as.movImm(X86Assembler::RAX, stub.message);
+        as.jmp(exit_label);
+    }
+}
+
+void JitCompiler::visitBlock(Block* blk) {
+    StatementList stmts = blk->get_stmts();
+    // An empty Block is an error only if it gets executed, like in the EvaluationVisitor
+    if (stmts.size() == 0) as.jmp(newStub(SemanticMessage::emptyBlock())->label);
+    for (Statement* s : stmts)
+        s->accept(this);
+}
+
+
+/* STATEMENTS */
+void JitCompiler::visitSet(SetStmt* s) {
+    s->get_nexpr()->accept(this);
+    storeVar(s->get_var()->get_slot(), X86Assembler::RAX);
+}
+
+void JitCompiler::visitInput(InputStmt* s) {
+    int slot = s->get_var()->get_slot();
+    spillCallerSaved();
+    as.load(X86Assembler::RDI, X86Assembler::RBP, CTX_DISP);
+    as.movImm(X86Assembler::RSI, slot);
+    as.call(reinterpret_cast<const void*>(&jitInput));
+    as.test(X86Assembler::RAX, X86Assembler::RAX);
+    as.jcc(X86Assembler::NOT_EQUAL, exception_label);
+    reloadCallerSaved();
+    // The helper wrote the value in memory
+    if (reg_of_slot[slot] >= 0 && !isCallerSaved(reg_of_slot[slot]))
+        as.load(static_cast<Reg>(reg_of_slot[slot]), X86Assembler::R15, slotDisp(slot));
+    as.storeByte(X86Assembler::R15, declaredDisp(slot), 1);
+}
+
+void JitCompiler::visitPrint(PrintStmt* s) {
+    Variable* v = dynamic_cast<Variable*> (s->get_nexpr());
+    if (v != nullptr) loadChecked(v, X86Assembler::RAX, SemanticMessage::undeclaredPrint(v->get_id()));
+    else s->get_nexpr()->accept(this);
+
+    spillCallerSaved();
+    as.mov(X86Assembler::RSI, X86Assembler::RAX);
+    as.load(X86Assembler::RDI, X86Assembler::RBP, CTX_DISP);
+    as.call(reinterpret_cast<const void*>(&jitPrint));
+    as.test(X86Assembler::RAX, X86Assembler::RAX);
+    as.jcc(X86Assembler::NOT_EQUAL, exception_label);
+    reloadCallerSaved();
+}
+
+void JitCompiler::visitIf(IfStmt* s) {
+    Label else_label, end_label;
+    branch(s->get_bexpr(), else_label, false);
+    s->get_stmt_block1()->accept(this);
+    as.jmp(end_label);
+    as.bind(else_label);
+    s->get_stmt_block2()->accept(this);
+    as.bind(end_label);
+}
+
+void JitCompiler::visitWhile(WhileStmt* s) {
+    // The guard is placed after the body: a single conditional jump for each iteration
+    Label body_label, guard_label;
+    as.jmp(guard_label);
+    as.bind(body_label);
+    s->get_stmt_block()->accept(this);
+    as.bind(guard_label);
+    branch(s->get_bexpr(), body_label, true);
+}
+
+
+/* NUM_EXPR */
+void JitCompiler::visitOperator(Operator* opNode) {
+    Operand second = loadOperands(opNode->getFirst(), opNode->getSecond(), Operator::opCode2String(opNode->getOp()), false);
+    bool imm32 = second.kind == Operand::IMM && second.imm >= INT32_MIN && second.imm <= INT32_MAX;
+    // Immediate values that don't fit in 32 bits are loaded in RCX
+    if (second.kind == Operand::IMM && (!imm32 || opNode->getOp() == Operator::DIV)) {
+        as.movImm(X86Assembler::RCX, second.imm);
+        second = Operand{ Operand::REG, X86Assembler::RCX, 0, second.imm };
+        if (opNode->getOp() == Operator::DIV && second.imm == 0) {
+            as.jmp(div_by_zero->label);
+            return;
+        }
+        if (opNode->getOp() == Operator::DIV) {
+            // Divisor known and not 0: no check needed
+            as.cqo();
+            as.idiv(X86Assembler::RCX);
+            return;
+        }
+    }
+
+    switch (opNode->getOp()) {
+        case Operator::ADD:
+            if (second.kind == Operand::REG) as.add(X86Assembler::RAX, second.reg);
+            else if (second.kind == Operand::MEM) as.addMem(X86Assembler::RAX, second.reg, second.disp);
+            else as.addImm(X86Assembler::RAX, static_cast<int32_t>(second.imm));
+            break;
+        case Operator::SUB:
+            if (second.kind == Operand::REG) as.sub(X86Assembler::RAX, second.reg);
+            else if (second.kind == Operand::MEM) as.subMem(X86Assembler::RAX, second.reg, second.disp);
+            else as.subImm(X86Assembler::RAX, static_cast<int32_t>(second.imm));
+            break;
+        case Operator::MUL:
+            if (second.kind == Operand::REG) as.imul(X86Assembler::RAX, second.reg);
+            else if (second.kind == Operand::MEM) as.imulMem(X86Assembler::RAX, second.reg, second.disp);
+            else as.imulImm(X86Assembler::RAX, X86Assembler::RAX, static_cast<int32_t>(second.imm));
+            break;
+        case Operator::DIV:
+            // The divisor can't stay in RDX, which is overwritten by CQO
+            if (second.kind == Operand::MEM) {
+                as.load(X86Assembler::RCX, second.reg, second.disp);
+                second = Operand{ Operand::REG, X86Assembler::RCX, 0, 0 };
+            }
+            as.test(second.reg, second.reg);
+            as.jcc(X86Assembler::EQUAL, div_by_zero->label);
+            as.cqo();
+            as.idiv(second.reg);
+            break;
+        default: break;
+    }
+}
+
+void JitCompiler::visitNumber(Number* numNode) {
+    as.movImm(X86Assembler::RAX, numNode->get_value());
+}
+
+void JitCompiler::visitVariable(Variable* varNode) {
+    // A variable visited directly is the whole NUM_EXPR of a SET statement
+    loadChecked(varNode, X86Assembler::RAX, SemanticMessage::undeclaredVariable(varNode->get_id()));
+}
+
+
+/* BOOL_EXPR */
+void JitCompiler::visitRelOp(RelOp* rop) {
+    Label& target = *branch_target;
+    bool jump_if = branch_if;
+    Operand second = loadOperands(rop->get_first_nexpr(), rop->get_second_nexpr(), RelOp::relOpCode2String(rop->get_r_opcode()), true);
+
+    if (second.kind == Operand::REG) as.cmp(X86Assembler::RAX, second.reg);
+    else if (second.kind == Operand::MEM) as.cmpMem(X86Assembler::RAX, second.reg, second.disp);
+    else if (second.imm >= INT32_MIN && second.imm <= INT32_MAX) as.cmpImm(X86Assembler::RAX, static_cast<int32_t>(second.imm));
+    else {
+        as.movImm(X86Assembler::RCX, second.imm);
+        as.cmp(X86Assembler::RAX, X86Assembler::RCX);
+    }
+
+    X86Assembler::Cond cond;
+    switch (rop->get_r_opcode()) {
+        case RelOp::LT: cond = X86Assembler::LESS; break;
+        case RelOp::GT: cond = X86Assembler::GREATER; break;
+        default: cond = X86Assembler::EQUAL; break;
+    }
+    as.jcc(jump_if ? cond : X86Assembler::negate(cond), target);
+}
+
+void JitCompiler::visitBoolConst(BoolConst* bconst) {
+    if ((bconst->get_bconst() == BoolConst::TRUE) == branch_if) as.jmp(*branch_target);
+}
+
+void JitCompiler::visitBoolOp(BoolOp* bop) {
+    Label& target = *branch_target;
+    bool jump_if = branch_if;
+    switch (bop->get_b_opcode()) {
+        case BoolOp::NOT:
+            branch(bop->get_f_bexpr(), target, !jump_if);
+            return;
+        case BoolOp::AND:
+            if (!jump_if) {
+                // FALSE if any of the two is FALSE
+                branch(bop->get_f_bexpr(), target, false);
+                branch(bop->get_s_bexpr(), target, false);
+            } else {
+                // TRUE only if both are TRUE: a FALSE 1st operand skips the 2nd one
+                Label skip;
+                branch(bop->get_f_bexpr(), skip, false);
+                branch(bop->get_s_bexpr(), target, true);
+                as.bind(skip);
+            }
+            return;
+        case BoolOp::OR:
+            if (jump_if) {
+                branch(bop->get_f_bexpr(), target, true);
+                branch(bop->get_s_bexpr(), target, true);
+            } else {
+                Label skip;
+                branch(bop->get_f_bexpr(), skip, true);
+                branch(bop->get_s_bexpr(), target, false);
+                as.bind(skip);
+            }
+            return;
+        default: return;
+    }
+}
@@ -0,0 +1,136 @@
+#ifndef JIT_H
+#define JIT_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <deque>
+#include <exception>
+
+#include "Visitor.h"
+#include "Runtime.h"
+#include "X86Assembler.h"
+
+
+/* State shared between the native code and the runtime helpers it calls */
+struct JitContext {
+    int64_t* vars;                          // values of the slots, followed by one declared flag (byte) for each slot
+    Runtime* rt;                            // services used by INPUT and PRINT
+    const std::vector<std::string>* var_ids;
+    std::exception_ptr error;               // exception caught by a runtime helper
+};
+
+
+/* Native x86-64 code of a Program, stored in executable memory obtained with mmap */
+class JitProgram {
+public:
+    // Signature of the generated code: 0 on success, k > 0 for messages[k - 1], -1 for JitContext::error
+    using EntryPoint = int64_t (*)(JitContext*);
+
+    JitProgram(const std::vector<uint8_t>& code, std::vector<std::string> msgs, std::vector<std::string> ids);
+    ~JitProgram();
+
+    // Deletion of copy constructor and assignment operator: the executable memory has a single owner
+    JitProgram(const JitProgram& other) = delete;
+    JitProgram& operator=(const JitProgram& other) = delete;
+
+    // Execution of the native code; errors are thrown as by the EvaluationVisitor
+    void run(Runtime* rt);
+    void run() { run(&Runtime::standard()); }
+
+    size_t get_code_size() const { return size; }
+
+private:
+    void* mem;
+    size_t size;
+    std::vector<std::string> messages; // texts of the SemanticErrors raised by the native code
+    std::vector<std::string> var_ids;  // slot -> VARIABLE_ID
+};
+
+
+/* Class that extends Visitor superclass to translate a resolved Program (see ResolveVisitor)
+into native x86-64 code.
+The most used variables (uses weighted by the WHILE nesting level) live in machine registers
+for the whole run, the others in memory; INPUT and PRINT call runtime helpers and every error
+leaves the native code through a stub returning the index of its message */
+class JitCompiler : public Visitor {
+public:
+    JitCompiler() = default;
+    ~JitCompiler() = default;
+
+    // Deletion of copy constructor and assignment operator: a compiler is used for a single Program
+    JitCompiler(const JitCompiler& other) = delete;
+    JitCompiler& operator=(const JitCompiler& other) = delete;
+
+    // true if native code can be generated and executed on this platform
+    static bool isSupported();
+
+    JitProgram* operator()(Program* prg);
+
+    void visitProgram(Program* prg) override;
+    void visitBlock(Block* blk) override;
+
+    void visitSet(SetStmt* s) override;
+    void visitInput(InputStmt* s) override;
+    void visitPrint(PrintStmt* s) override;
+    void visitIf(IfStmt* s) override;
+    void visitWhile(WhileStmt* s) override;
+
+    // NUM_EXPR: the value is left in RAX
+    void visitOperator(Operator* opNode) override;
+    void visitNumber(Number* numNode) override;
+    void visitVariable(Variable* varNode) override;
+
+    // BOOL_EXPR: jump to *branch_target if the value is equal to branch_if, otherwise fall through
+    void visitRelOp(RelOp* rop) override;
+    void visitBoolConst(BoolConst* bconst) override;
+    void visitBoolOp(BoolOp* bop) override;
+
+private:
+    using Reg = X86Assembler::Reg;
+    using Label = X86Assembler::Label;
+
+    // Stub that leaves the native code with the index of an error message
+    struct ErrorStub {
+        Label label;
+        int message;
+    };
+
+    X86Assembler as;
+    std::vector<std::string> messages;
+    std::deque<ErrorStub> stubs; // std::deque keeps the address of the stubs stable
+    std::vector<int> reg_of_slot; // register holding each slot, -1 if it lives in memory
+    int n_vars = 0;
+    Label exit_label;
+    Label exception_label;
+    ErrorStub* div_by_zero = nullptr;
+
+    Label* branch_target = nullptr;
+    bool branch_if = true;
+
+    int32_t slotDisp(int slot) const { return slot * 8; }
+    int32_t declaredDisp(int slot) const { return n_vars * 8 + slot; }
+
+    ErrorStub* newStub(std::string message);
+    // Check that the variable has been declared (jump to a stub with "message" otherwise) and read it in "dst"
+    void loadChecked(Variable* var, Reg dst, std::string message);
+    void storeVar(int slot, Reg src);
+    /* Second operand of a binary operation: a pinned register, a memory slot, an immediate value
+    or RCX holding the value of a complex NUM_EXPR */
+    struct Operand {
+        enum Kind { REG, MEM, IMM } kind;
+        Reg reg;
+        int32_t disp;
+        int64_t imm;
+    };
+    /* Evaluation of the operands of an operator in their order: the first one is left in RAX;
+    a VARIABLE_ID operand is checked and fails with the message of "op_name" */
+    Operand loadOperands(NumExpr* first, NumExpr* second, const std::string& op_name, bool rel_op);
+    void branch(BoolExpr* bexpr, Label& target, bool jump_if);
+    // Save (before) and reload (after) of the variables held in caller-saved registers around a call
+    void spillCallerSaved();
+    void reloadCallerSaved();
+    void chooseRegisters(Program* prg);
+};
+
+#endif /* JIT_H */
@@ -0,0 +1,144 @@
+#include <cstring>
+#include <limits>
+#include <sstream>
+
+#include "Lexer.h"
+#include "Exceptions.h"
+
+
+// Character classes of the "C" locale used by the Tokenizer
+static bool isAlpha(char ch) { return (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z'); }
+static bool isDigit(char ch) { return ch >= '0' && ch <= '9'; }
+static bool isSpace(char ch) { return ch == ' ' || (ch >= '\t' && ch <= '\r'); }
+
+
+int Lexer::keyword(std::string_view w) {
+    auto is = [&](int tag) { return std::memcmp(w.data(), Token::id2word[tag], w.size()) == 0; };
+    switch (w.size()) {
+        case 2:
+            switch (w[0]) {
+                case 'I': if (is(Token::IF)) return Token::IF; break;
+                case 'L': if (is(Token::LT)) return Token::LT; break;
+                case 'G': if (is(Token::GT)) return Token::GT; break;
+                case 'E': if (is(Token::EQ)) return Token::EQ; break;
+                case 'O': if (is(Token::OR)) return Token::OR; break;
+            }
+            break;
+        case 3:
+            switch (w[0]) {
+                case 'S':
+                    if (is(Token::SET)) return Token::SET;
+                    if (is(Token::SUB)) return Token::SUB;
+                    break;
+                case 'A':
+                    if (is(Token::ADD)) return Token::ADD;
+                    if (is(Token::AND)) return Token::AND;
+                    break;
+                case 'M': if (is(Token::MUL)) return Token::MUL; break;
+                case 'D': if (is(Token::DIV)) return Token::DIV; break;
+                case 'N': if (is(Token::NOT)) return Token::NOT; break;
+            }
+            break;
+        case 4:
+            if (is(Token::TRUE)) return Token::TRUE;
+            break;
+        case 5:
+            switch (w[0]) {
+                case 'B': if (is(Token::BLOCK)) return Token::BLOCK; break;
+                case 'P': if (is(Token::PRINT)) return Token::PRINT; break;
+                case 'I': if (is(Token::INPUT)) return Token::INPUT; break;
+                case 'W': if (is(Token::WHILE)) return Token::WHILE; break;
+                case 'F': if (is(Token::FALSE)) return Token::FALSE; break;
+            }
+            break;
+    }
+    return Token::VARIABLE_ID;
+}
+
+
+/* Conversion of the digits of a NUM with the result of std::stringstream >> int64_t:
+the values out of range are saturated to the limits of int64_t */
+int64_t Lexer::toInt64(std::string_view digits, bool negative) {
+    constexpr uint64_t LIMIT = static_cast<uint64_t>(std::numeric_limits<int64_t>::max()) + 1; // |INT64_MIN|
+    uint64_t magnitude = 0;
+    for (char d : digits) {
+        uint64_t digit = d - '0';
+        if (magnitude > (LIMIT - digit) / 10) {
+            magnitude = LIMIT + 1; // out of range whatever the sign
+            break;
+        }
+        magnitude = magnitude * 10 + digit;
+    }
+    if (negative) return (magnitude >= LIMIT) ? std::numeric_limits<int64_t>::min() : -static_cast<int64_t>(magnitude);
+    return (magnitude >= LIMIT) ? std::numeric_limits<int64_t>::max() : static_cast<int64_t>(magnitude);
+}
+
+
+bool Lexer::next(LexToken& tok) {
+    while (cur < end) {
+        char ch = *cur;
+        if (ch == '\n') line_number++;
+        if (isSpace(ch)) { // spaces are skipped
+            cur++;
+            continue;
+        }
+
+        if (ch == '(' || ch == ')') {
+            tok.tag = (ch == '(') ? Token::LP : Token::RP;
+            tok.word = std::string_view{ cur, 1 };
+            tok.neg = false;
+            isonlyalpha = true;
+            cur++;
+            return true;
+
+        } else if (isAlpha(ch)) {
+            const char* begin = cur;
+            do cur++; while (cur < end && isAlpha(*cur));
+            if (!isTerminator(charAt(cur))) isonlyalpha = false;
+
+            tok.word = std::string_view{ begin, static_cast<size_t>(cur - begin) };
+            tok.tag = keyword(tok.word);
+            tok.neg = false;
+            if (tok.tag == Token::VARIABLE_ID && !isonlyalpha) {
+                std::stringstream tmp{};
+                tmp << "(ERROR (lexical) in tokenizer: non-alpha character in VARIABLE_ID at line " << line_number << " )";
+                throw LexicalError(tmp.str());
+            }
+            return true;
+
+        } else if (ch == '-') {
+            // the sign is kept until the next NUM
+            neg = true;
+            isonlyalpha = true;
+            cur++;
+
+        } else if (isDigit(ch)) {
+            const char* begin = cur;
+            bool zero_as_first = (ch == '0'); // a number starting with 0 can't have other digits
+            cur++;
+            while (cur < end && isDigit(*cur)) {
+                if (zero_as_first) throw LexicalError("(ERROR (lexical): numbers can't have a sequence of zeros as first digits )");
+                cur++;
+            }
+            if (!isTerminator(charAt(cur))) {
+                std::stringstream tmp{};
+                tmp << "(ERROR (lexical): numbers have to be made of only NUMBERS; '" << charAt(cur) << "' given at line number " << line_number << " )";
+                throw LexicalError(tmp.str());
+            }
+
+            tok.tag = Token::NUM;
+            tok.word = std::string_view{ begin, static_cast<size_t>(cur - begin) };
+            tok.neg = neg;
+            tok.value = toInt64(tok.word, neg);
+            neg = false;
+            return true;
+
+        } else {
+            // Not recognized symbol
+            std::stringstream tmp{};
+            tmp << "(ERROR (lexical) in tokenizer: Stray character '" << ch << "' in input at line " << line_number << " )";
+            throw LexicalError(tmp.str());
+        }
+    }
+    return false;
+}
@@ -0,0 +1,73 @@
+#ifndef LEXER_H
+#define LEXER_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "Token.h"
+
+
+/* Token read by the Lexer, without copies of the source text:
+"word" points into the source (for a NUM only to its digits, see text()) */
+struct LexToken {
+    int tag = Token::LP;
+    std::string_view word;
+    int64_t value = 0;  // value of a NUM
+    bool neg = false;   // NUM preceded by '-'
+
+    // Text of the token as written by the Tokenizer (with the sign of a negative NUM)
+    std::string text() const { return (neg ? "-" : "") + std::string{ word }; }
+};
+
+
+/* Single pass lexer over a source kept in memory (e.g. a SourceFile): the tokens are produced
+one at a time on request of the parser, keywords are recognized with a switch on their length
+and the numbers are converted while they are read.
+The lexical rules and the error messages are the ones of the Tokenizer */
+class Lexer {
+public:
+    /* State of the Lexer between two tokens: a source can be read from a point in its middle
+    (e.g. by the IncrementalParser) giving the state the Lexer had there */
+    struct State {
+        int line = 1;
+        bool onlyalpha = true;
+        bool neg = false;
+    };
+
+    Lexer(std::string_view source) : cur{ source.data() }, end{ source.data() + source.size() } {}
+    Lexer(std::string_view source, const State& s)
+        : cur{ source.data() }, end{ source.data() + source.size() }, line_number{ s.line }, isonlyalpha{ s.onlyalpha }, neg{ s.neg } {}
+
+    /* Read of the next token in "tok": it returns false at the end of the source
+    and throws a LexicalError on an invalid token */
+    bool next(LexToken& tok);
+
+    // Read of all the remaining tokens: only a LexicalError can come out of it
+    void drain() {
+        LexToken tok;
+        while (next(tok)) {}
+    }
+
+    static int keyword(std::string_view word);
+
+    // Line of the last token read
+    int get_line() const { return line_number; }
+    State get_state() const { return State{ line_number, isonlyalpha, neg }; }
+    // First character not read yet
+    const char* get_position() const { return cur; }
+
+private:
+    const char* cur;
+    const char* end;
+    int line_number = 1;
+    bool isonlyalpha = true; // reset only by '(', ')' and '-' like in the Tokenizer
+    bool neg = false;        // '-' read and not yet used by a NUM
+
+    // Character at "p" as returned by std::ifstream::get() (EOF at the end of the source)
+    char charAt(const char* p) const { return p < end ? *p : static_cast<char>(std::char_traits<char>::eof()); }
+    static bool isTerminator(char ch) { return ch == ' ' || ch == '(' || ch == ')' || ch == '\n'; }
+    static int64_t toInt64(std::string_view digits, bool negative);
+};
+
+#endif /* LEXER_H */
@@ -0,0 +1,248 @@
+#include <algorithm>
+
+#include "LoopInvariantHoister.h"
+
+
+/* Collection of the slots assigned (by SET or INPUT) by the statements of a WHILE body, nested ones included */
+class AssignedVariables : public Visitor {
+public:
+    // "flags" has a 0 for each slot of the Program, restored once the slots are collected
+    AssignedVariables(std::vector<unsigned char>& flags) : assigned{ flags } {}
+
+    std::vector<int> slots; // each slot assigned, once
+
+    void collect(Block* b) {
+        b->accept(this);
+        for (int slot : slots) assigned[slot] = 0;
+    }
+
+    void visitProgram(Program*) override {}
+
+    void visitBlock(Block* b) override {
+        for (Statement* s : b->get_stmts())
+            s->accept(this);
+    }
+
+    void visitSet(SetStmt* s) override { add(s->get_var()->get_slot()); }
+    void visitInput(InputStmt* s) override { add(s->get_var()->get_slot()); }
+    void visitPrint(PrintStmt*) override {}
+
+    void visitIf(IfStmt* s) override {
+        s->get_stmt_block1()->accept(this);
+        s->get_stmt_block2()->accept(this);
+    }
+
+    void visitWhile(WhileStmt* s) override { s->get_stmt_block()->accept(this); }
+
+    // The expressions don't assign variables
+    void visitOperator(Operator*) override {}
+    void visitNumber(Number*) override {}
+    void visitVariable(Variable*) override {}
+    void visitRelOp(RelOp*) override {}
+    void visitBoolConst(BoolConst*) override {}
+    void visitBoolOp(BoolOp*) override {}
+
+private:
+    std::vector<unsigned char>& assigned;
+
+    void add(int slot) {
+        if (!assigned[slot]) {
+            assigned[slot] = 1;
+            slots.push_back(slot);
+        }
+    }
+};
+
+
+void LoopInvariantHoister::visitProgram(Program* prg) {
+    n_hoisted = 0;
+    var_ids = prg->get_var_ids();
+    declared.assign(var_ids.size());
+    n_modifying.assign(var_ids.size(), 0);
+    assigned_flags.assign(var_ids.size(), 0);
+    if (prg->get_is_not_empty()) {
+        prg->get_blk()->accept(this);
+        prg->set_blk(blk);
+        prg->set_var_ids(var_ids);
+    }
+}
+
+void LoopInvariantHoister::visitBlock(Block* b) {
+    blk = blocks.rebuild(b, this);
+}
+
+
+Variable* LoopInvariantHoister::temporary(int& slot) {
+    if (slot < 0) {
+        slot = static_cast<int>(var_ids.size());
+        var_ids.push_back("#t" + std::to_string(n_hoisted));
+        n_hoisted++;
+    }
+    Variable* v = static_cast<Variable*>(nf.makeVariable(var_ids[slot]));
+    v->set_slot(slot);
+    return v;
+}
+
+NumExpr* LoopInvariantHoister::hoist(NumExpr* e, size_t lvl) {
+    int slot = -1;
+    loops[lvl].push_back(nf.makeSetStmt(e, temporary(slot)));
+    return temporary(slot);
+}
+
+BoolExpr* LoopInvariantHoister::hoist(BoolExpr* e, size_t lvl) {
+    int slot = -1;
+    Statement* set_true = nf.makeSetStmt(nf.makeNumber(1), temporary(slot));
+    Statement* set_false = nf.makeSetStmt(nf.makeNumber(0), temporary(slot));
+    loops[lvl].push_back(nf.makeIfStmt(e, nf.makeBlock(&set_true, 1), nf.makeBlock(&set_false, 1)));
+    return nf.makeRelOp(RelOp::EQ, temporary(slot), nf.makeNumber(1));
+}
+
+NumExpr* LoopInvariantHoister::rootNum(NumExpr* e) {
+    e->accept(this);
+    return (invariant() && worth) ? hoist(nexpr, level) : nexpr;
+}
+
+BoolExpr* LoopInvariantHoister::rootBool(BoolExpr* e) {
+    e->accept(this);
+    return (invariant() && worth) ? hoist(bexpr, level) : bexpr;
+}
+
+
+/* STATEMENTS */
+void LoopInvariantHoister::visitSet(SetStmt* s) {
+    NumExpr* e = rootNum(s->get_nexpr());
+    declared.declare(s->get_var()->get_slot());
+    emit((e == s->get_nexpr()) ? s : nf.makeSetStmt(e, s->get_var()));
+}
+
+void LoopInvariantHoister::visitInput(InputStmt* s) {
+    declared.declare(s->get_var()->get_slot());
+    emit(s);
+}
+
+void LoopInvariantHoister::visitPrint(PrintStmt* s) {
+    NumExpr* e = rootNum(s->get_nexpr());
+    emit((e == s->get_nexpr()) ? s : nf.makePrintStmt(e));
+}
+
+void LoopInvariantHoister::visitIf(IfStmt* s) {
+    BoolExpr* cond = rootBool(s->get_bexpr());
+
+    Block* blk1 = nullptr;
+    Block* blk2 = nullptr;
+    declared.branches([&] { s->get_stmt_block1()->accept(this); blk1 = blk; },
+                      [&] { s->get_stmt_block2()->accept(this); blk2 = blk; });
+    emit(blocks.ifStmt(s, cond, blk1, blk2));
+}
+
+void LoopInvariantHoister::visitWhile(WhileStmt* s) {
+    // The loop becomes the innermost one: the variables assigned by its body are not invariant
+    AssignedVariables assigned{ assigned_flags };
+    assigned.collect(s->get_stmt_block());
+    for (int slot : assigned.slots) n_modifying[slot]++;
+    size_t index = loops.size();
+    loops.emplace_back();
+
+    BoolExpr* cond = rootBool(s->get_bexpr());
+    declared.mayNotRun([&] { s->get_stmt_block()->accept(this); });
+
+    for (int slot : assigned.slots) n_modifying[slot]--;
+    std::vector<Statement*> hoisted = std::move(loops[index]);
+    loops.pop_back();
+    for (Statement* h : hoisted) emit(h);
+    emit(blocks.whileStmt(s, cond, blk));
+}
+
+
+/* NUM_EXPR */
+void LoopInvariantHoister::visitOperator(Operator* opNode) {
+    opNode->getFirst()->accept(this);
+    NumExpr* first = nexpr;
+    size_t f_level = level;
+    bool f_inv = invariant(), f_worth = worth, f_fails = may_fail;
+    opNode->getSecond()->accept(this);
+    NumExpr* second = nexpr;
+    size_t s_level = level;
+    bool s_inv = invariant(), s_worth = worth;
+
+    level = std::max(f_level, s_level);
+    may_fail = may_fail || f_fails;
+    if (opNode->getOp() == Operator::DIV) {
+        // DIV by 0 gives an error, INT64_MIN / -1 stops the program
+        Number* divisor = dynamic_cast<Number*>(second);
+        if (divisor == nullptr || divisor->get_value() == 0 || divisor->get_value() == -1) may_fail = true;
+    }
+    worth = true;
+
+    if (hoistChild(f_inv, f_worth, f_level)) first = hoist(first, f_level);
+    if (hoistChild(s_inv, s_worth, s_level)) second = hoist(second, s_level);
+    nexpr = (first == opNode->getFirst() && second == opNode->getSecond()) ? opNode : nf.makeOperator(opNode->getOp(), first, second);
+}
+
+void LoopInvariantHoister::visitNumber(Number* numNode) {
+    nexpr = numNode;
+    level = 0;
+    may_fail = false;
+    worth = false;
+}
+
+void LoopInvariantHoister::visitVariable(Variable* varNode) {
+    nexpr = varNode;
+    // the enclosing loops that assign the variable are the outermost ones (the inner bodies are part of their body)
+    level = n_modifying[varNode->get_slot()];
+    may_fail = !declared[varNode->get_slot()];
+    worth = false;
+}
+
+
+/* BOOL_EXPR */
+void LoopInvariantHoister::visitRelOp(RelOp* rop) {
+    rop->get_first_nexpr()->accept(this);
+    NumExpr* first = nexpr;
+    size_t f_level = level;
+    bool f_inv = invariant(), f_worth = worth, f_fails = may_fail;
+    rop->get_second_nexpr()->accept(this);
+    NumExpr* second = nexpr;
+    size_t s_level = level;
+    bool s_inv = invariant(), s_worth = worth;
+
+    level = std::max(f_level, s_level);
+    may_fail = may_fail || f_fails;
+    // a comparison of two operands without computations costs as much as the read of a temporary
+    worth = f_worth || s_worth;
+
+    if (hoistChild(f_inv, f_worth, f_level)) first = hoist(first, f_level);
+    if (hoistChild(s_inv, s_worth, s_level)) second = hoist(second, s_level);
+    bexpr = (first == rop->get_first_nexpr() && second == rop->get_second_nexpr()) ? rop : nf.makeRelOp(rop->get_r_opcode(), first, second);
+}
+
+void LoopInvariantHoister::visitBoolConst(BoolConst* bconst) {
+    bexpr = bconst;
+    level = 0;
+    may_fail = false;
+    worth = false;
+}
+
+void LoopInvariantHoister::visitBoolOp(BoolOp* bop) {
+    bop->get_f_bexpr()->accept(this);
+    BoolExpr* first = bexpr;
+    if (bop->get_b_opcode() == BoolOp::NOT) {
+        worth = true;
+        bexpr = (first == bop->get_f_bexpr()) ? bop : nf.makeBoolOp(BoolOp::NOT, first, nullptr);
+        return;
+    }
+    size_t f_level = level;
+    bool f_inv = invariant(), f_worth = worth, f_fails = may_fail;
+    bop->get_s_bexpr()->accept(this);
+    BoolExpr* second = bexpr;
+    size_t s_level = level;
+    bool s_inv = invariant(), s_worth = worth;
+
+    level = std::max(f_level, s_level);
+    may_fail = may_fail || f_fails;
+    worth = true;
+
+    if (hoistChild(f_inv, f_worth, f_level)) first = hoist(first, f_level);
+    if (hoistChild(s_inv, s_worth, s_level)) second = hoist(second, s_level);
+    bexpr = (first == bop->get_f_bexpr() && second == bop->get_s_bexpr()) ? bop : nf.makeBoolOp(bop->get_b_opcode(), first, second);
+}
@@ -0,0 +1,92 @@
+#ifndef LOOP_INVARIANT_HOISTER_H
+#define LOOP_INVARIANT_HOISTER_H
+
+#include <string>
+#include <vector>
+
+#include "Visitor.h"
+#include "NodeFactory.h"
+#include "DeclaredSlots.h"
+#include "BlockRebuilder.h"
+
+
+/* Class that extends Visitor superclass to move the loop invariant computations of a resolved Program
+(see ResolveVisitor) out of the WHILE statements. For each WHILE the variables assigned by its body
+(SET and INPUT, nested statements included) are collected: a NUM_EXPR or BOOL_EXPR of the guard or of
+the body that reads none of them is computed once in a temporary variable before the loop.
+A NUM_EXPR is stored by (SET #tN expr) and read back as #tN, a BOOL_EXPR is stored by
+(IF expr (SET #tN 1) (SET #tN 0)) and read back as (EQ #tN 1); the temporaries ("#" can't start
+a VARIABLE_ID of the source) take new slots at the end of the slot table of the Program.
+Each subtree is moved in front of the outermost loop it is invariant for. Only the subtrees whose
+evaluation can't throw an error are moved (surely declared variables, DIV by a constant other than 0
+and -1): a failing computation stays where it is and fails only if the loop reaches it */
+class LoopInvariantHoister : public Visitor {
+public:
+    LoopInvariantHoister(NodeFactory& node_f) : nf{ node_f }, blocks{ node_f } {}
+    ~LoopInvariantHoister() = default;
+
+    // Deletion of copy constructor and assignment operator: a LoopInvariantHoister is used for a single Program
+    LoopInvariantHoister(const LoopInvariantHoister& other) = delete;
+    LoopInvariantHoister& operator=(const LoopInvariantHoister& other) = delete;
+
+    // Hoisting of the invariant expressions of the Program, whose main Block and slot table are replaced
+    void operator()(Program* prg) { prg->accept(this); }
+
+    // Number of expressions moved out of the loops by the last run
+    unsigned int get_n_hoisted() const { return n_hoisted; }
+
+    void visitProgram(Program* prg) override;
+    void visitBlock(Block* blk) override;
+
+    void visitSet(SetStmt* s) override;
+    void visitInput(InputStmt* s) override;
+    void visitPrint(PrintStmt* s) override;
+    void visitIf(IfStmt* s) override;
+    void visitWhile(WhileStmt* s) override;
+
+    void visitOperator(Operator* opNode) override;
+    void visitNumber(Number* numNode) override;
+    void visitVariable(Variable* varNode) override;
+
+    void visitRelOp(RelOp* rop) override;
+    void visitBoolConst(BoolConst* bconst) override;
+    void visitBoolOp(BoolOp* bop) override;
+
+private:
+    NodeFactory& nf;
+    unsigned int n_hoisted = 0;
+
+    std::vector<std::string> var_ids;             // slot table of the Program, extended with the temporaries
+    DeclaredSlots declared;                       // variables surely declared at the current point
+    std::vector<unsigned int> n_modifying;        // for each slot, number of enclosing loops that assign it
+    std::vector<unsigned char> assigned_flags;    // scratch of the slots assigned by a WHILE body, all 0 between two WHILE
+    std::vector<std::vector<Statement*>> loops;   // statements hoisted in front of each enclosing WHILE, outermost first
+    BlockRebuilder blocks;
+
+    /* Result of the last visit of an expression: the rewritten node, the index of the outermost enclosing
+    loop it is invariant for ("level", equal to loops.size() if it isn't invariant for the innermost one),
+    if its evaluation can throw an error and if it is worth a temporary (it computes something) */
+    NumExpr* nexpr = nullptr;
+    BoolExpr* bexpr = nullptr;
+    size_t level = 0;
+    bool may_fail = false;
+    bool worth = false;
+    Block* blk = nullptr; // result of the last visit of a Block
+
+    bool invariant() const { return level < loops.size() && !may_fail; }
+    // A child moves alone if its parent stays in the loop or can leave a loop further out
+    bool hoistChild(bool child_inv, bool child_worth, size_t child_level) const {
+        return child_inv && child_worth && (!invariant() || child_level < level);
+    }
+    // Hoisting in front of the loop at index "lvl": the expression is replaced by the read of a new temporary
+    NumExpr* hoist(NumExpr* e, size_t lvl);
+    BoolExpr* hoist(BoolExpr* e, size_t lvl);
+    Variable* temporary(int& slot); // read or write of the temporary of "slot", a new one if "slot" is -1
+    // Rewriting of the root expression of a statement
+    NumExpr* rootNum(NumExpr* e);
+    BoolExpr* rootBool(BoolExpr* e);
+
+    void emit(Statement* s) { blocks.emit(s); }
+};
+
+#endif /* LOOP_INVARIANT_HOISTER_H */
@@ -0,0 +1,100 @@
+#ifndef NODE_ARENA_H
+#define NODE_ARENA_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+
+/* Bump allocator used for the nodes of the syntax tree.
+The memory is requested to the system in large chunks and the objects are placed one after
+the other; nothing is released one object at a time: reset() makes all the chunks available
+again and the destructor gives them back to the system.
+The destructors of the objects are never called, so only trivially destructible types can be created */
+class NodeArena {
+public:
+    // Size of a chunk: bigger requests get a chunk of their own
+    static constexpr size_t CHUNK_SIZE = 64 * 1024;
+
+    NodeArena() = default;
+    ~NodeArena() = default;
+
+    /* Deletion of the copy constructor and the assignment operator to avoid pointers ownership errors */
+    NodeArena(const NodeArena& other) = delete;
+    NodeArena& operator=(const NodeArena& other) = delete;
+
+    void* allocate(size_t size, size_t align) {
+        uintptr_t p = (cur + align - 1) & ~static_cast<uintptr_t>(align - 1);
+        if (p + size > end) p = nextChunk(size, align);
+        cur = p + size;
+        used += size;
+        return reinterpret_cast<void*>(p);
+    }
+
+    template <typename T, typename... Args>
+    T* make(Args&&... args) {
+        static_assert(std::is_trivially_destructible<T>::value, "NodeArena objects are never destroyed");
+        return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    // Copy of "n" values in a contiguous array of the arena
+    template <typename T>
+    T* copyArray(const T* src, size_t n) {
+        static_assert(std::is_trivially_copyable<T>::value, "NodeArena arrays are copied with memcpy");
+        T* dst = static_cast<T*>(allocate(sizeof(T) * n, alignof(T)));
+        if (n > 0) std::memcpy(dst, src, sizeof(T) * n);
+        return dst;
+    }
+
+    std::string_view copyString(std::string_view s) {
+        return std::string_view{ copyArray(s.data(), s.size()), s.size() };
+    }
+
+    /* All the objects are discarded at once; the chunks are kept and reused by the next allocations */
+    void reset() {
+        current = -1;
+        cur = end = 0;
+        used = 0;
+    }
+
+    size_t get_bytes_used() const { return used; }
+    size_t get_bytes_reserved() const { return reserved; }
+    unsigned int get_n_chunks() const { return chunks.size(); }
+
+private:
+    struct Chunk {
+        std::unique_ptr<unsigned char[]> mem;
+        size_t size;
+    };
+
+    std::vector<Chunk> chunks;
+    int current = -1;   // index of the chunk in use (-1 before the first allocation)
+    uintptr_t cur = 0;  // first free byte of the chunk in use
+    uintptr_t end = 0;  // end of the chunk in use
+    size_t used = 0;
+    size_t reserved = 0;
+
+    // Switch to the next chunk (reused after a reset() or allocated) that can hold "size" bytes
+    uintptr_t nextChunk(size_t size, size_t align) {
+        size_t need = size + align;
+        while (++current < static_cast<int>(chunks.size()) && chunks[current].size < need) {}
+        if (current == static_cast<int>(chunks.size())) {
+            size_t chunk_size = std::max(CHUNK_SIZE, need);
+            chunks.push_back(Chunk{ std::unique_ptr<unsigned char[]>(new unsigned char[chunk_size]), chunk_size });
+            reserved += chunk_size;
+        }
+        cur = reinterpret_cast<uintptr_t>(chunks[current].mem.get());
+        end = cur + chunks[current].size;
+        return (cur + align - 1) & ~static_cast<uintptr_t>(align - 1);
+    }
+};
+
+
+#endif /* NODE_ARENA_H */
@@ -0,0 +1,112 @@
+#ifndef NODE_FACTORY_H
+#define NODE_FACTORY_H
+
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "NodeArena.h"
+#include "Block.h"
+#include "Statement.h"
+#include "NumExpr.h"
+#include "BoolExpr.h"
+
+
+/* Class NodeFactory used to create all the nodes of a Program (Block, Statement, NumExpr and BoolExpr objects).
+The nodes are stored contiguously in a NodeArena and are released all together by clear_memory(),
+which keeps the memory for the next Program, or by the destructor */
+class NodeFactory {
+public:
+    NodeFactory() = default;
+    ~NodeFactory() = default;
+
+    /* Deletion of the copy constructor and the assignment operator to avoid pointers ownership errors */
+    NodeFactory(const NodeFactory& other) = delete;
+    NodeFactory& operator=(const NodeFactory& other) = delete;
+
+    /* BLOCK */
+    Block* makeBlock(const std::vector<Statement*>& stmts) { return makeBlock(stmts.data(), stmts.size()); }
+    // Block of the "n" statements starting at "stmts" (copied in the arena)
+    Block* makeBlock(Statement* const* stmts, size_t n) {
+        Statement** copy = arena.copyArray(stmts, n);
+        return node<Block>(copy, static_cast<unsigned int>(n));
+    }
+
+    /* STATEMENT */
+    // the statements get the current line (see set_line())
+    Statement* makeSetStmt(NumExpr* nexpr, Variable* var) { return stmt(node<SetStmt>(nexpr, var)); }
+    Statement* makeInputStmt(Variable* v) { return stmt(node<InputStmt>(v)); }
+    Statement* makePrintStmt(NumExpr* nexpr) { return stmt(node<PrintStmt>(nexpr)); }
+    Statement* makeIfStmt(BoolExpr* bexpr, Block* stmt_blk1, Block* stmt_blk2) { return stmt(node<IfStmt>(bexpr, stmt_blk1, stmt_blk2)); }
+    Statement* makeWhileStmt(BoolExpr* bexpr, Block* stmt_blk) { return stmt(node<WhileStmt>(bexpr, stmt_blk)); }
+
+    /* NUM_EXPR */
+    NumExpr* makeOperator(Operator::OpCode op, NumExpr* l, NumExpr* r) { return node<Operator>(op, l, r); }
+    NumExpr* makeNumber(int64_t v) { return node<Number>(v); }
+    // the characters of the VARIABLE_ID are copied in the arena too
+    NumExpr* makeVariable(std::string_view id) { return node<Variable>(arena.copyString(id)); }
+    NumExpr* makeCheckedVariable(std::string_view id) { return node<CheckedVariable>(arena.copyString(id)); }
+
+    /* BOOL_EXPR */
+    BoolExpr* makeRelOp(RelOp::RelOpCode rop, NumExpr* f_expr, NumExpr* s_expr) { return node<RelOp>(rop, f_expr, s_expr); }
+    BoolExpr* makeBoolConst(BoolConst::BoolCode bcode) { return node<BoolConst>(bcode); }
+    BoolExpr* makeBoolOp(BoolOp::BopCode bcode, BoolExpr* f_bexpr, BoolExpr* s_bexpr) { return node<BoolOp>(bcode, f_bexpr, s_bexpr); }
+
+    /* LINE: line of the source of the statements made from now on (see Statement::get_line()).
+    The parser sets the line of each statement it reads; the optimizations make their statements
+    in a LineScope of the statement they replace, so a statement rebuilt, hoisted out of a loop
+    or put in closed form keeps the line it comes from */
+    void set_line(uint32_t l) { line = l; }
+    uint32_t get_line() const { return line; }
+
+    class LineScope {
+    public:
+        LineScope(NodeFactory& f, uint32_t l) : nf{ f }, saved{ f.line } { nf.line = l; }
+        ~LineScope() { nf.line = saved; }
+        LineScope(const LineScope& other) = delete;
+        LineScope& operator=(const LineScope& other) = delete;
+
+    private:
+        NodeFactory& nf;
+        uint32_t saved;
+    };
+
+    void clear_memory() {
+        arena.reset();
+        n_nodes = n_blocks = n_statements = n_bool_exprs = 0;
+        line = 0;
+    }
+
+    unsigned int get_n_nodes() const { return n_nodes; }
+    // Nodes made of each kind, also the ones replaced by the optimizations
+    unsigned int get_n_blocks() const { return n_blocks; }
+    unsigned int get_n_statements() const { return n_statements; }
+    unsigned int get_n_num_exprs() const { return n_nodes - n_blocks - n_statements - n_bool_exprs; }
+    unsigned int get_n_bool_exprs() const { return n_bool_exprs; }
+    const NodeArena& get_arena() const { return arena; }
+
+private:
+    NodeArena arena;
+    unsigned int n_nodes = 0;
+    unsigned int n_blocks = 0;
+    unsigned int n_statements = 0;
+    unsigned int n_bool_exprs = 0;
+    uint32_t line = 0;
+
+    template <typename T, typename... Args>
+    T* node(Args&&... args) {
+        n_nodes++;
+        if constexpr (std::is_same<T, Block>::value) n_blocks++;
+        else if constexpr (std::is_base_of<Statement, T>::value) n_statements++;
+        else if constexpr (std::is_base_of<BoolExpr, T>::value) n_bool_exprs++;
+        return arena.make<T>(std::forward<Args>(args)...);
+    }
+
+    Statement* stmt(Statement* s) {
+        s->set_line(line);
+        return s;
+    }
+};
+
+
+#endif /* NODE_FACTORY_H */
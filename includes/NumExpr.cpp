@@ -1,5 +1,6 @@
 #include "NumExpr.h"
 #include "Visitor.h"
+#include "Exceptions.h"
 
 void Operator::accept(Visitor* v) {
     v->visitOperator(this);
@@ -11,4 +12,16 @@ void Number::accept(Visitor* v) {
 
 void Variable::accept(Visitor* v) {
     v->visitVariable(this);
-}
\ No newline at end of file
+}
+void CheckedVariable::accept(Visitor* v) {
+    v->visitCheckedVariable(this);
+}
+
+std::string CheckedVariable::undeclaredMessage() const {
+    switch (use) {
+        case OPERAND: return SemanticMessage::undeclaredOperand(Operator::opCode2String(static_cast<Operator::OpCode>(op_code)), get_id());
+        case REL_OPERAND: return SemanticMessage::undeclaredRelOperand(RelOp::relOpCode2String(static_cast<RelOp::RelOpCode>(op_code)), get_id());
+        case PRINT: return SemanticMessage::undeclaredPrint(get_id());
+        default: return SemanticMessage::undeclaredVariable(get_id());
+    }
+}
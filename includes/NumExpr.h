@@ -1,7 +1,9 @@
 #ifndef NUM_EXPR_H
 #define NUM_EXPR_H
 
+#include <cstdint>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "Token.h"
@@ -10,11 +12,26 @@ class Visitor;
 class Operator;
 
 
-/* Superclass used to identify the numerical expression */
+/* Superclass used to identify the numerical expression.
+The nodes live in the NodeArena of a NodeFactory and are never deleted through the superclass */
 class NumExpr {
 public:
-    virtual ~NumExpr() {};
+    /* Enumeration to identify the class of the node: the set of the NUM_EXPR is closed,
+    so an evaluator can switch on it instead of calling accept() (see SwitchEvaluator) */
+    enum Kind : uint8_t { OPERATOR, NUMBER, VARIABLE, CHECKED_VARIABLE };
+
+    Kind get_kind() const { return kind; }
+
     virtual void accept(Visitor* v) = 0;
+
+protected:
+    NumExpr(Kind k) : kind{ k } {}
+    NumExpr(const NumExpr& other) = default;
+    NumExpr& operator=(const NumExpr& other) = default;
+    ~NumExpr() = default;
+
+private:
+    Kind kind;
 };
 
 /* Class that extends NumExpr to represent the arithmetic operations between two NumExpr operands */
@@ -24,7 +41,7 @@ public:
     enum OpCode { ADD, SUB, MUL, DIV, NULL_VAL };
 
     Operator(OpCode o, NumExpr* fop, NumExpr* sop) :
-        op{ o }, first{ fop }, second{ sop } {}
+        NumExpr(OPERATOR), op{ o }, first{ fop }, second{ sop } {}
     Operator(const Operator& other) = default;
     ~Operator() = default;
     Operator& operator=(const Operator& other) = default;
@@ -66,7 +83,7 @@ private:
 /* Class that extends NumExpr to represent integer numerical values in 64bit registers (c++ int64_t) */
 class Number : public NumExpr {
 public:
-    Number(int64_t v) : value{ v } {};
+    Number(int64_t v) : NumExpr(NUMBER), value{ v } {};
     Number(const Number& other) = default;
     ~Number() = default;
     Number& operator=(const Number& other) = default;
@@ -80,28 +97,62 @@ private:
 };
 
 
-/* Class that extends NumExpr to represent variables */
+/* Class that extends NumExpr to represent variables.
+The value of a variable is not stored in the node, which is never written by the evaluators:
+each run keeps the values in its own storage, indexed by the slot, so a Program can be run by many threads at once */
 class Variable : public NumExpr { 
-
-// default value for variables created with just the std::string parameter (VARIABLE_ID)
-static constexpr int64_t DEFAULT_VAL = 0;
-
 public:
-    Variable(std::string i) : Variable(i, DEFAULT_VAL) {}
-    Variable(std::string i, int64_t v) : id{ i }, value{ v } {}
+    // slot value of a Variable not yet processed by the ResolveVisitor
+    static constexpr int UNRESOLVED_SLOT = -1;
+
+    // the characters of the VARIABLE_ID are not copied: they must live as long as the Variable (see NodeFactory)
+    Variable(std::string_view i) : Variable(VARIABLE, i) {}
     Variable(const Variable& other) = default;
     ~Variable() = default;
     Variable& operator=(const Variable& other) = default;
 
-    std::string get_id() const { return id; }
-    int64_t get_value() const { return value; }
-    void set_value(int64_t val) { value = val; }
+    std::string get_id() const { return std::string{ id }; }
+    int get_slot() const { return slot; }
+    void set_slot(int s) { slot = s; }
 
     void accept(Visitor* v) override;
 
+protected:
+    Variable(Kind k, std::string_view i) : NumExpr(k), id{ i }, slot{ UNRESOLVED_SLOT } {}
+
 private:
-    std::string id;
-    int64_t value;
+    std::string_view id;
+    int slot; // dense index of the variable in the evaluator storage, assigned by the ResolveVisitor
+};
+
+
+/* Class that extends Variable to represent a read of a variable that may not be declared yet.
+The parser creates every read as a CheckedVariable, which records where the variable is used
+to give the right SemanticError; the reads proved to follow a declaration on every path
+(see DefiniteAssignment) become plain Variable nodes, read without any check */
+class CheckedVariable : public Variable {
+public:
+    /* Enumeration to identify the use of the read: whole NUM_EXPR of a SET, operand of an Operator or a RelOp,
+    NUM_EXPR of a PRINT (NULL_VAL is useful to identify a invalid value) */
+    enum Use { VALUE, OPERAND, REL_OPERAND, PRINT, NULL_VAL };
+
+    CheckedVariable(std::string_view i) : Variable(CHECKED_VARIABLE, i), use{ VALUE }, op_code{ 0 } {}
+    CheckedVariable(const CheckedVariable& other) = default;
+    ~CheckedVariable() = default;
+    CheckedVariable& operator=(const CheckedVariable& other) = default;
+
+    Use get_use() const { return use; }
+    // "code" is the Operator::OpCode or the RelOp::RelOpCode of an OPERAND or REL_OPERAND
+    void set_use(Use u, int code) { use = u; op_code = code; }
+
+    // Text of the SemanticError given if the variable is not declared when it is read
+    std::string undeclaredMessage() const;
+
+    void accept(Visitor* v) override;
+
+private:
+    Use use;
+    int op_code;
 };
 
 
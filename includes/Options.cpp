@@ -0,0 +1,143 @@
+#include "Options.h"
+
+
+Options ParseOptions::operator()(int argc, char* argv[]) {
+    Options opts;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg.rfind("--engine=", 0) == 0) {
+            opts.engine = Options::string2Engine(arg.substr(9));
+            if (opts.engine == Options::NULL_VAL) throw std::invalid_argument("unknown engine \"" + arg.substr(9) + "\"");
+        } else if (arg.rfind("--flush=", 0) == 0) {
+            opts.flush = OutputSink::string2FlushPolicy(arg.substr(8));
+            if (opts.flush == OutputSink::NULL_VAL) throw std::invalid_argument("unknown flush policy \"" + arg.substr(8) + "\"");
+        } else if (arg == "--async-output") {
+            opts.async_output = true;
+        } else if (arg.rfind("--input=", 0) == 0) {
+            opts.input_file = arg.substr(8);
+            if (opts.input_file.empty()) throw std::invalid_argument("missing input file");
+        } else if (arg.rfind("--batch=", 0) == 0) {
+            opts.batch_file = arg.substr(8);
+            if (opts.batch_file.empty()) throw std::invalid_argument("missing batch file");
+        } else if (arg.rfind("--jobs=", 0) == 0) {
+            std::string n = arg.substr(7);
+            if (n.empty() || n.size() > 4 || n.find_first_not_of("0123456789") != std::string::npos || std::stoi(n) == 0)
+                throw std::invalid_argument("invalid number of jobs \"" + n + "\"");
+            opts.jobs = std::stoi(n);
+        } else if (arg.rfind("--serve=", 0) == 0) {
+            opts.serve_path = arg.substr(8);
+            if (opts.serve_path.empty()) throw std::invalid_argument("missing socket path");
+        } else if (arg.rfind("--cache-size=", 0) == 0) {
+            std::string n = arg.substr(13);
+            if (n.empty() || n.size() > 6 || n.find_first_not_of("0123456789") != std::string::npos || std::stoi(n) == 0)
+                throw std::invalid_argument("invalid cache size \"" + n + "\"");
+            opts.cache_size = std::stoi(n);
+        } else if (arg.rfind("--cache-dir=", 0) == 0) {
+            opts.cache_dir = arg.substr(12);
+            if (opts.cache_dir.empty()) throw std::invalid_argument("missing cache directory");
+        } else if (arg.rfind("--precompile=", 0) == 0) {
+            opts.precompile_dir = arg.substr(13);
+            if (opts.precompile_dir.empty()) throw std::invalid_argument("missing directory to precompile");
+        } else if (arg == "--preload-input") {
+            opts.preload_input = true;
+        } else if (arg == "--no-fold") {
+            opts.fold = false;
+        } else if (arg == "--no-dce") {
+            opts.dce = false;
+        } else if (arg == "--no-licm") {
+            opts.licm = false;
+        } else if (arg == "--no-indvars") {
+            opts.indvars = false;
+        } else if (arg == "--no-definite-assignment") {
+            opts.definite_assignment = false;
+        } else if (arg == "--opt-report") {
+            opts.opt_report = true;
+        } else if (arg == "--profile") {
+            opts.profile = true;
+        } else if (arg.rfind("--stats=", 0) == 0) {
+            if (arg.substr(8) != "json") throw std::invalid_argument("unknown statistics format \"" + arg.substr(8) + "\"");
+            opts.stats = true;
+        } else if (arg.rfind("--stats-file=", 0) == 0) {
+            opts.stats_file = arg.substr(13);
+            if (opts.stats_file.empty()) throw std::invalid_argument("missing statistics file");
+            opts.stats = true;
+        } else if (arg == "--stats-counters") {
+            opts.stats_counters = true;
+        } else if (arg == "--emit-cpp") {
+            opts.emit_cpp = true;
+        } else if (arg.rfind("--compile=", 0) == 0) {
+            opts.compile_output = arg.substr(10);
+            if (opts.compile_output.empty()) throw std::invalid_argument("missing executable file");
+        } else if (arg == "--dump-bytecode") {
+            opts.dump_bytecode = true;
+        } else if (arg.size() > 1 && arg[0] == '-') {
+            throw std::invalid_argument("unknown option \"" + arg + "\"");
+        } else if (opts.file.empty()) {
+            opts.file = arg;
+        } else {
+            throw std::invalid_argument("more than one file given");
+        }
+    }
+    // the Daemon receives the programs from its clients
+    if (!opts.serve_path.empty()) {
+        if (!opts.file.empty()) throw std::invalid_argument("the programs of --serve are sent by the clients");
+        return opts;
+    }
+    // the sources of --precompile are the files of its directory
+    if (!opts.precompile_dir.empty()) {
+        if (opts.cache_dir.empty()) throw std::invalid_argument("--precompile needs --cache-dir");
+        if (!opts.file.empty()) throw std::invalid_argument("the programs of --precompile are the files of its directory");
+        return opts;
+    }
+    if (opts.file.empty()) throw std::invalid_argument("File not specified!");
+    if (!opts.batch_file.empty() && (!opts.input_file.empty() || opts.preload_input))
+        throw std::invalid_argument("the values of INPUT of a batch are given by its rows");
+    if (opts.preload_input && opts.input_file.empty()) opts.input_file = "-";
+    if (opts.stats_counters && !opts.stats) throw std::invalid_argument("--stats-counters needs --stats=json");
+    if ((opts.profile || opts.stats) && !opts.batch_file.empty())
+        throw std::invalid_argument("--profile and --stats measure a single run, not a batch");
+    // the ProfilingVisitor counts a single run of the syntax tree, the other engines are measured as they are
+    if (opts.profile || opts.stats_counters) opts.engine = Options::TREE;
+    return opts;
+}
+
+const char* ParseOptions::help() {
+    return
+        "OPTIONS:\n"
+        "  --engine=tree     evaluate the syntax tree with the EvaluationVisitor (default)\n"
+        "  --engine=vm       compile to bytecode and run it on the stack based virtual machine\n"
+        "  --engine=jit      compile to native x86-64 code and run it (falls back to tree elsewhere)\n"
+        "  --engine=flat     run the program on its compact flat (struct-of-arrays) layout\n"
+        "  --engine=switch   evaluate the syntax tree switching on the kind of the nodes, without the Visitor\n"
+        "  --no-fold         run the program without the constant folding\n"
+        "  --no-dce          run the program without the dead code elimination\n"
+        "  --no-licm         run the program without moving the loop invariant expressions out of the loops\n"
+        "  --no-indvars      run the program without replacing the counting loops by their closed form\n"
+        "  --no-definite-assignment\n"
+        "                    check at run time the declaration of the variable at each read\n"
+        "  --opt-report      print on stderr what the optimizations changed before the run\n"
+        "  --profile         run the syntax tree counting and timing each statement, loop, expression kind and variable,\n"
+        "                    with a report on stderr at the end (--engine is ignored)\n"
+        "  --stats=json      write on stderr at the end the wall and CPU time of each phase (the run on the engine given by\n"
+        "                    --engine), the tokens, the nodes and the memory\n"
+        "  --stats-counters  add to --stats=json the statements, expressions, loop iterations and variable accesses of the run,\n"
+        "                    counted on the syntax tree by the ProfilingVisitor (--engine is ignored)\n"
+        "  --stats-file=FILE write the statistics of --stats=json in FILE instead\n"
+        "  --emit-cpp        write the program translated to C++ on stdout instead of running it\n"
+        "  --compile=FILE    build the C++ translation into the executable FILE ($CXX, c++ by default) instead of running it\n"
+        "  --dump-bytecode   print the compiled bytecode on stderr before running it (--engine=vm)\n"
+        "  --flush=line      write the output of PRINT after each value (default on a terminal)\n"
+        "  --flush=size      write the output of PRINT in blocks of 64KiB (default otherwise)\n"
+        "  --flush=end       write the output of PRINT only at the end of the run or before an INPUT\n"
+        "  --async-output    write the output of PRINT from a background thread\n"
+        "  --input=FILE      read the values of INPUT from FILE (\"-\" for stdin) without prompts\n"
+        "  --preload-input   read all the values of INPUT before the run (from stdin without --input)\n"
+        "  --batch=FILE      run the program once for each line of FILE, which gives the values of INPUT of the run;\n"
+        "                    the runs share the parsed program and their outputs are written in the order of the lines\n"
+        "  --jobs=N          threads running the lines of --batch (default: one for each hardware thread)\n"
+        "  --serve=PATH      run as a daemon on the Unix domain socket PATH, running the programs sent by the clients\n"
+        "                    (see includes/DaemonProtocol.h); no FILE_PATH is given\n"
+        "  --cache-size=N    programs kept parsed and compiled by --serve (default 64)\n"
+        "  --cache-dir=DIR   keep the optimized programs in DIR and load them from there, without parsing, at the next runs\n"
+        "  --precompile=SRC  store in --cache-dir the optimized programs of all the files of the directory SRC; no FILE_PATH is given\n";
+}
@@ -0,0 +1,73 @@
+#ifndef OPTIONS_H
+#define OPTIONS_H
+
+#include <string>
+#include <stdexcept>
+
+#include "OutputSink.h"
+
+
+/* Settings of a run of the interpreter given on the command line */
+struct Options {
+    /* Enumeration to identify the execution engines (NULL_VAL is useful to identify an invalid value) */
+    enum Engine { TREE, VM, JIT, FLAT, SWITCH, NULL_VAL };
+
+    std::string file;       // path of the file with the lisp code
+    Engine engine = TREE;   // TREE: EvaluationVisitor, VM: bytecode VirtualMachine, JIT: native x86-64 code, FLAT: FlatEvaluator, SWITCH: SwitchEvaluator
+    bool dump_bytecode = false;
+    bool fold = true;       // simplification of the Program by the ConstantFolder before the run
+    bool dce = true;        // removal of the dead code by the DeadCodeEliminator before the run
+    bool licm = true;       // hoisting of the loop invariant expressions by the LoopInvariantHoister before the run
+    bool indvars = true;    // replacement of the counting loops by the InductionVariableSimplifier before the run
+    bool definite_assignment = true; // removal of the checks of the reads that surely follow a declaration (DefiniteAssignment)
+    bool opt_report = false;
+    bool profile = false;        // run measured by the ProfilingVisitor, with its report on stderr at the end
+    bool stats = false;          // time of the phases, with the run of the engine, written as JSON at the end (RunStats)
+    bool stats_counters = false; // run counted by the ProfilingVisitor on the syntax tree instead of the engine (--stats-counters)
+    std::string stats_file;      // file of the JSON statistics (stderr if empty)
+    bool emit_cpp = false;       // C++ translation of the program written on stdout instead of the run (CppEmitter)
+    std::string compile_output;  // native executable built from the C++ translation instead of the run
+    OutputSink::FlushPolicy flush = OutputSink::AUTO; // when the PRINT output is written
+    bool async_output = false;                        // PRINT output written by a background thread
+    std::string input_file;                           // values of INPUT read without prompts ("-" for stdin)
+    bool preload_input = false;                       // all the values of INPUT read before the run
+    std::string batch_file;                           // rows of INPUT values, one run of the program for each row (BatchRunner)
+    unsigned int jobs = 0;                            // threads running the rows of a batch (0: one for each hardware thread)
+    std::string serve_path;                           // Unix domain socket of the Daemon running the programs of its clients
+    size_t cache_size = 64;                           // programs kept prepared by the Daemon (ProgramCache)
+    std::string cache_dir;                            // directory of the images of the optimized programs (ProgramStore)
+    std::string precompile_dir;                       // directory of sources whose images are stored in cache_dir, without running them
+
+    static Engine string2Engine(const std::string& s) {
+        if (s == "tree") return TREE;
+        if (s == "vm") return VM;
+        if (s == "jit") return JIT;
+        if (s == "flat") return FLAT;
+        if (s == "switch") return SWITCH;
+        return NULL_VAL;
+    }
+
+    static const char* engine2String(Engine e) {
+        switch (e) {
+            case TREE: return "tree";
+            case VM: return "vm";
+            case JIT: return "jit";
+            case FLAT: return "flat";
+            case SWITCH: return "switch";
+            default: return "";
+        }
+    }
+};
+
+
+/* Function object to read the Options from the command line arguments.
+It throws std::invalid_argument if an argument is not recognized */
+class ParseOptions {
+public:
+    Options operator()(int argc, char* argv[]);
+
+    // Description of the options shown together with the USAGE message
+    static const char* help();
+};
+
+#endif /* OPTIONS_H */
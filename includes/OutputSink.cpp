@@ -0,0 +1,199 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <thread>
+
+#include "OutputSink.h"
+#include "SpscRing.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define OUTPUT_SINK_POSIX 1
+#include <csignal>
+#include <time.h>
+#include <unistd.h>
+static bool isTerminal(std::FILE* f) { return isatty(fileno(f)) != 0; }
+
+// Sink written by OutputSink::onFatalSignal(), and its file descriptor
+static std::atomic<OutputSink*> fatal_sink{ nullptr };
+static int fatal_fd = -1;
+#else
+static bool isTerminal(std::FILE*) { return true; }
+#endif
+
+
+/* Background thread writing on the file the text pushed in a SpscRing by an OutputSink.
+The stdio buffer of the file is flushed every time the writer has caught up with the sink
+and on request of sync() */
+class AsyncWriter {
+public:
+    static constexpr size_t RING_SIZE = 1 << 20;
+
+    AsyncWriter(std::FILE* f) : file{ f }, ring{ RING_SIZE }, thread{ &AsyncWriter::loop, this } {}
+
+    // The text pushed so far is written before the thread ends
+    ~AsyncWriter() {
+        stop.store(true, std::memory_order_release);
+        thread.join();
+    }
+
+    // Copy of the text in the ring, waiting for the writer when the ring is full
+    void push(const char* p, size_t n) {
+        while (n > 0) {
+            size_t k = ring.push(p, n);
+            if (k == 0) std::this_thread::yield();
+            p += k;
+            n -= k;
+        }
+    }
+
+    // Wait until the text pushed so far is written and flushed
+    void sync() {
+        uint64_t req = flush_req.fetch_add(1, std::memory_order_acq_rel) + 1;
+        while (flush_done.load(std::memory_order_acquire) < req) std::this_thread::yield();
+    }
+
+#ifdef OUTPUT_SINK_POSIX
+    /* sync() from a signal handler, waiting at most about 100ms: the writer thread may be the one stopped
+    by the signal. False if the text pushed so far isn't surely written */
+    bool syncFromSignal() {
+        uint64_t req = flush_req.fetch_add(1, std::memory_order_acq_rel) + 1;
+        for (int i = 0; i < 1000; i++) {
+            if (flush_done.load(std::memory_order_acquire) >= req) return true;
+            struct timespec pause { 0, 100 * 1000 };
+            nanosleep(&pause, nullptr);
+        }
+        return false;
+    }
+#endif
+
+private:
+    std::FILE* file;
+    SpscRing ring;
+    std::atomic<bool> stop{ false };
+    std::atomic<uint64_t> flush_req{ 0 };
+    std::atomic<uint64_t> flush_done{ 0 };
+    std::thread thread;
+
+    void loop() {
+        uint64_t done = 0;
+        unsigned idle = 0;
+        for (;;) {
+            // read before the ring: the text pushed before a request or the stop is drained below
+            uint64_t req = flush_req.load(std::memory_order_acquire);
+            bool stopping = stop.load(std::memory_order_acquire);
+
+            bool wrote = false;
+            const char* p;
+            size_t n;
+            while ((n = ring.peek(p)) > 0) {
+                std::fwrite(p, 1, n, file);
+                ring.consume(n);
+                wrote = true;
+            }
+            if (wrote || req != done) std::fflush(file);
+            if (req != done) {
+                done = req;
+                flush_done.store(req, std::memory_order_release);
+            }
+            if (stopping) return;
+
+            // Nothing to do: the thread spins for a while, then sleeps for growing intervals (up to 1ms)
+            if (wrote) idle = 0;
+            else if (++idle < 64) std::this_thread::yield();
+            else std::this_thread::sleep_for(std::chrono::microseconds(std::min(idle, 1000u)));
+        }
+    }
+};
+
+
+OutputSink::OutputSink(std::FILE* f, FlushPolicy p, bool async) : file{ f }, policy{ p }, buf{ new char[BUFFER_SIZE] } {
+    if (policy == AUTO || policy == NULL_VAL) policy = isTerminal(f) ? LINE : SIZE;
+    if (async) writer.reset(new AsyncWriter(f));
+}
+
+OutputSink::OutputSink(std::string& text) :
+    file{ nullptr }, policy{ SIZE }, buf{ new char[MEMORY_BUFFER_SIZE] }, cap{ MEMORY_BUFFER_SIZE }, target{ &text } {}
+
+OutputSink::~OutputSink() {
+#ifdef OUTPUT_SINK_POSIX
+    OutputSink* self = this;
+    fatal_sink.compare_exchange_strong(self, nullptr);
+#endif
+    flush();
+    writer.reset();
+}
+
+void OutputSink::write(std::string_view s) {
+    reserve(s.size());
+    std::memcpy(buf.get() + len, s.data(), s.size());
+    len += s.size();
+    if (policy == LINE && s.find('\n') != std::string_view::npos) commit();
+}
+
+void OutputSink::flush() {
+    commit();
+    if (writer) writer->sync();
+}
+
+void OutputSink::flushOnFatalSignal() {
+#ifdef OUTPUT_SINK_POSIX
+    if (file == nullptr) return;
+    fatal_fd = fileno(file);
+    fatal_sink.store(this);
+    struct sigaction sa {};
+    sa.sa_handler = &OutputSink::onFatalSignal;
+    sigemptyset(&sa.sa_mask);
+    sa.sa_flags = SA_RESETHAND; // the handler runs once, then the signal takes its default action
+    for (int sig : { SIGFPE, SIGSEGV, SIGBUS, SIGILL, SIGABRT }) sigaction(sig, &sa, nullptr);
+#endif
+}
+
+#ifdef OUTPUT_SINK_POSIX
+void OutputSink::onFatalSignal(int sig) {
+    // only write(2) here: the stdio buffer of the file is empty between two commit(), and stdio isn't async-signal-safe
+    OutputSink* sink = fatal_sink.load();
+    // the text pushed to the background writer comes first: the buffer is written only after it
+    if (sink != nullptr && (sink->writer == nullptr || sink->writer->syncFromSignal())) {
+        const char* p = sink->buf.get();
+        size_t n = sink->len;
+        while (n > 0) {
+            ssize_t k = ::write(fatal_fd, p, n);
+            if (k <= 0) break;
+            p += k;
+            n -= static_cast<size_t>(k);
+        }
+    }
+    // delivered with its default action once the handler returns
+    std::raise(sig);
+}
+#endif
+
+void OutputSink::makeRoom(size_t n) {
+    if (policy != END) commit();
+    if (cap - len >= n) return;
+    // END policy (or a text longer than the buffer): the buffer grows
+    size_t new_cap = std::max(cap * 2, len + n);
+    std::unique_ptr<char[]> bigger{ new char[new_cap] };
+    std::memcpy(bigger.get(), buf.get(), len);
+    buf.swap(bigger);
+    cap = new_cap;
+}
+
+void OutputSink::commit() {
+    if (len == 0) return;
+    if (target) {
+        target->append(buf.get(), len);
+    } else if (writer) {
+        writer->push(buf.get(), len);
+    } else {
+        std::fwrite(buf.get(), 1, len, file);
+        std::fflush(file);
+    }
+    len = 0;
+}
+
+OutputSink& OutputSink::standard() {
+    static OutputSink out;
+    return out;
+}
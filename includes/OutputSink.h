@@ -0,0 +1,91 @@
+#ifndef OUTPUT_SINK_H
+#define OUTPUT_SINK_H
+
+#include <charconv>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <string_view>
+
+
+class AsyncWriter;
+
+
+/* Buffered destination of the text written by the program (the values given by PRINT and the INPUT prompts).
+The text is collected in a buffer and handed over to the file according to the FlushPolicy,
+either directly or through a background writer thread (async), so that the evaluation
+doesn't wait for the I/O. flush() must be called before reading the user input
+and before writing on another stream (e.g. the error messages on std::cerr) */
+class OutputSink {
+public:
+    /* Enumeration of the moments when the buffer is handed over to the file:
+    LINE after each line, SIZE when the buffer is full, END only by flush() (and at the end of the run),
+    AUTO is LINE on a terminal and SIZE otherwise (NULL_VAL is useful to identify an invalid value) */
+    enum FlushPolicy { LINE, SIZE, END, AUTO, NULL_VAL };
+
+    static FlushPolicy string2FlushPolicy(const std::string& s) {
+        if (s == "line") return LINE;
+        if (s == "size") return SIZE;
+        if (s == "end") return END;
+        if (s == "auto") return AUTO;
+        return NULL_VAL;
+    }
+
+    static constexpr size_t BUFFER_SIZE = 64 * 1024;
+    static constexpr size_t MEMORY_BUFFER_SIZE = 4 * 1024;
+
+    OutputSink(std::FILE* f = stdout, FlushPolicy p = AUTO, bool async = false);
+    // Sink appending the text to "text" (when the buffer is full and on flush()) instead of writing on a file
+    explicit OutputSink(std::string& text);
+    ~OutputSink();
+
+    // Deletion of copy constructor and assignment operator: the buffered text has a single owner
+    OutputSink(const OutputSink& other) = delete;
+    OutputSink& operator=(const OutputSink& other) = delete;
+
+    // Line with the decimal value of "val"
+    void print(int64_t val) {
+        reserve(24);
+        char* end = std::to_chars(buf.get() + len, buf.get() + cap, val).ptr;
+        *end++ = '\n';
+        len = end - buf.get();
+        if (policy == LINE) commit();
+    }
+
+    void write(std::string_view s);
+
+    // All the text written so far reaches the file (and its stdio buffer is flushed)
+    void flush();
+
+    /* The text still in the buffer is written on the file also when the process is stopped by a fatal signal
+    (the SIGFPE of INT64_MIN / -1, SIGSEGV...), before the default action of the signal. A single sink at a time,
+    the last one calling it; with the background writer (async) the buffer is written only if the writer catches up in time */
+    void flushOnFatalSignal();
+
+    FlushPolicy get_policy() const { return policy; }
+    bool is_async() const { return writer != nullptr; }
+
+    // Sink writing on stdout
+    static OutputSink& standard();
+
+private:
+    std::FILE* file;
+    FlushPolicy policy;
+    std::unique_ptr<char[]> buf;
+    size_t cap = BUFFER_SIZE;
+    size_t len = 0;
+    std::unique_ptr<AsyncWriter> writer; // nullptr if the text is written by the caller thread
+    std::string* target = nullptr;       // destination of the text of a sink in memory (file is nullptr)
+
+    // Room for n more bytes: the buffer is handed over when full, or grown with the END policy
+    void reserve(size_t n) {
+        if (cap - len < n) makeRoom(n);
+    }
+    void makeRoom(size_t n);
+    // The buffered text is handed over to the file (or to the writer)
+    void commit();
+    static void onFatalSignal(int sig);
+};
+
+#endif /* OUTPUT_SINK_H */
@@ -9,37 +9,37 @@
 
 /* Recursive method used to parse numerical expressions (NumExpr).
 It returns a pointer to a NumExpr object */
-NumExpr* ParseProgram::parseNumExpr(std::vector<Token>::const_iterator& itr) {
-    if (itr->tag == Token::LP) {
+NumExpr* ParseProgram::parseNumExpr() {
+    if (tok.tag == Token::LP) {
 
-        safe_next(itr);
-        NumExpr* nexpr = parseNumExpr(itr);
-        safe_next(itr);
-        if (itr->tag != Token::RP) {
+        safe_next();
+        NumExpr* nexpr = parseNumExpr();
+        safe_next();
+        if (tok.tag != Token::RP) {
             throw SyntaxError("(ERROR (syntax): Mismatched parenthesis )");
         }
         return nexpr;
 
-    } else if (itr->tag == Token::NUM) {
-        std::stringstream tmp{};
-        tmp << itr->word;
-        int64_t val;
-        tmp >> val;
-        return nem.makeNumber(val);
-
-    } else if (itr->tag == Token::VARIABLE_ID) {
-        return nem.makeVariable(itr->word); 
-
-    } else if (isOperator(itr->tag)) {
-        Operator::OpCode op = Operator::string2OpCode(itr->word);
-        safe_next(itr);
-        NumExpr* first = parseNumExpr(itr);
-        safe_next(itr);
-        NumExpr* second = parseNumExpr(itr);
-        return nem.makeOperator(op, first, second);
+    } else if (tok.tag == Token::NUM) {
+        // value converted by the Lexer
+        return nf.makeNumber(tok.value);
+
+    } else if (tok.tag == Token::VARIABLE_ID) {
+        // read of a variable, checked at run time unless the DefiniteAssignment proves it declared
+        return nf.makeCheckedVariable(tok.word);
+
+    } else if (isOperator(tok.tag)) {
+        Operator::OpCode op = Operator::string2OpCode(std::string{ tok.word });
+        safe_next();
+        NumExpr* first = parseNumExpr();
+        safe_next();
+        NumExpr* second = parseNumExpr();
+        markUse(first, CheckedVariable::OPERAND, op);
+        markUse(second, CheckedVariable::OPERAND, op);
+        return nf.makeOperator(op, first, second);
     } else {
         std::stringstream tmp{};
-        tmp << "(ERROR (syntax): unexpected token, \"" << itr->word << "\" given )";
+        tmp << "(ERROR (syntax): unexpected token, \"" << tok.text() << "\" given )";
         throw SyntaxError(tmp.str());
     }
 }
@@ -47,231 +47,290 @@ NumExpr* ParseProgram::parseNumExpr(std::vector<Token>::const_iterator& itr) {
 
 /* Recursive method used to parse boolean expressions (BoolExpr).
 It returns a pointer to a BoolExpr object */
-BoolExpr* ParseProgram::parseBoolExpr(std::vector<Token>::const_iterator& itr) {
-    if (itr->tag == Token::LP) {
-        safe_next(itr);
-        BoolExpr* bexpr = parseBoolExpr(itr);
-        safe_next(itr);
+BoolExpr* ParseProgram::parseBoolExpr() {
+    if (tok.tag == Token::LP) {
+        safe_next();
+        BoolExpr* bexpr = parseBoolExpr();
+        safe_next();
 
-        if (itr->tag != Token::RP) {
+        if (tok.tag != Token::RP) {
             throw SyntaxError("(ERROR (syntax): Mismatched parenthesis )");
         }
         return bexpr;
 
-    } else if (isRelOp(itr->tag)) {
+    } else if (isRelOp(tok.tag)) {
         // GT, LT, EQ
-        RelOp::RelOpCode bop = RelOp::string2RelOpCode(itr->word);
-        safe_next(itr);
-        NumExpr* f_nexpr = parseNumExpr(itr);
-        
-        safe_next(itr);
-        NumExpr* s_nexpr = parseNumExpr(itr);
+        RelOp::RelOpCode bop = RelOp::string2RelOpCode(std::string{ tok.word });
+        safe_next();
+        NumExpr* f_nexpr = parseNumExpr();
         
-        return bem.makeRelOp(bop, f_nexpr, s_nexpr);
+        safe_next();
+        NumExpr* s_nexpr = parseNumExpr();
+        markUse(f_nexpr, CheckedVariable::REL_OPERAND, bop);
+        markUse(s_nexpr, CheckedVariable::REL_OPERAND, bop);
+        return nf.makeRelOp(bop, f_nexpr, s_nexpr);
 
-    } else if (isBoolOperator(itr->tag)) {
+    } else if (isBoolOperator(tok.tag)) {
         // AND, OR, NOT
-        BoolOp::BopCode b_opcode = BoolOp::string2BopCode(itr->word);
-        safe_next(itr);
-        BoolExpr* f_bexpr = parseBoolExpr(itr);
+        BoolOp::BopCode b_opcode = BoolOp::string2BopCode(std::string{ tok.word });
+        safe_next();
+        BoolExpr* f_bexpr = parseBoolExpr();
         BoolExpr* s_bexpr;
         if (b_opcode != BoolOp::NOT) {
-            safe_next(itr);
-            s_bexpr = parseBoolExpr(itr);
+            safe_next();
+            s_bexpr = parseBoolExpr();
         } else s_bexpr = nullptr; // nullptr assignment to the 2nd BoolExpr in case of a NOT clause
-        return bem.makeBoolOp(b_opcode, f_bexpr, s_bexpr);
+        return nf.makeBoolOp(b_opcode, f_bexpr, s_bexpr);
 
-    } else if (isBoolConst(itr->tag)) {
+    } else if (isBoolConst(tok.tag)) {
         // TRUE, FALSE
-        return bem.makeBoolConst(BoolConst::string2BoolCode(itr->word));
+        return nf.makeBoolConst(BoolConst::string2BoolCode(std::string{ tok.word }));
     } else {
         std::stringstream tmp{};
-        tmp << "(ERROR (syntax): unexpected token, \"" << itr->word << "\" given )";
+        tmp << "(ERROR (syntax): unexpected token, \"" << tok.text() << "\" given )";
         throw SyntaxError(tmp.str());
     }
 }
 
 
-/* Recursive method used to parse a Block.
+/* Method used to parse a stmt_block.
 It returns a pointer to a Block object */
-Block* ParseProgram::recursiveParse(std::vector<Token>::const_iterator& itr) {
-    
-    if (itr->tag == Token::LP) {
-        safe_next(itr);  
-        Block* blk = recursiveParse(itr);
-        if (stmts_accumulator.size() == 0) throw SyntaxError("(ERROR (syntax): empty BLOCK statement )");
-        if (itr->tag != Token::RP) {
-            throw SyntaxError("(ERROR (syntax): Mismatched parenthesis )");
-        }
+Block* ParseProgram::parseStmtBlock() {
+    parseStatements();
+    return popBlock();
+}
 
-        return blk;
 
-    } else if (itr->tag == Token::BLOCK) {
+/* Creation of the Block of the innermost stmt_block, whose statements are removed from stmts_accumulator */
+Block* ParseProgram::popBlock() {
+    Block* blk = nf.makeBlock(stmts_accumulator.data() + block_base, stmts_accumulator.size() - block_base);
+    if (listener != nullptr) listener->block(blk, stmts_accumulator.size() - block_base);
+    stmts_accumulator.resize(block_base);
+    return blk;
+}
 
-        safe_next(itr);
-        /* Counter of the statements in a block.
-        If the block is empty, a runtime error is thrown */
-        int cnt = 0; 
-        // recursive call for each '(' to analyse the inner statements
-        while (itr->tag == Token::LP) {
-            recursiveParse(itr);
-            cnt++;
-            if (itr->tag != Token::RP) {
-                throw SyntaxError("(ERROR (syntax): Mismatched parenthesis )");
-            }
-            safe_next(itr);
+
+/* Position of the statement of the top PAREN Frame, complete at the current ')', given to the listener
+(a BLOCK gives its statements one by one) */
+void ParseProgram::notifyStatement() {
+    const Frame& f = frames.back();
+    if (f.block || tok.tag != Token::RP || stmts_accumulator.size() == f.first) return;
+    const Frame* outer = (frames.size() > 1) ? &frames[frames.size() - 2] : nullptr;
+    const char* block = (outer != nullptr && outer->kind == Frame::BLOCK) ? outer->begin : nullptr;
+    Lexer::State state = lexer->get_state();
+    ParseListener::Span span{ f.begin, tok.word.data() + 1, f.line, static_cast<uint32_t>(state.line), block, f.neg, state.neg };
+    listener->statement(stmts_accumulator.back(), span);
+}
+
+
+/* Method used to parse the statement starting at the current token, whose statements are collected
+in stmts_accumulator. The inner statements of BLOCK, IF and WHILE are parsed in the same loop,
+suspending the outer statement in a Frame until they are complete */
+void ParseProgram::parseStatements() {
+    const size_t depth = frames.size();
+    for (;;) {
+        while (!beginStatement()) {}
+        do {
+            if (frames.size() == depth) return;
+        } while (resumeStatement());
+    }
+}
+
+
+/* Parsing of the beginning of a statement.
+It returns true if the statement is complete, false if a Frame has been pushed
+and its inner statement starts at the current token */
+bool ParseProgram::beginStatement() {
+    // line of the keyword, for the statements made before the next one is read
+    const uint32_t line = static_cast<uint32_t>(lexer->get_line());
+
+    if (tok.tag == Token::LP) {
+        Frame f{ Frame::PAREN };
+        if (listener != nullptr) {
+            f.begin = tok.word.data();
+            f.line = line;
+            f.neg = lexer->get_state().neg;
+            f.first = stmts_accumulator.size();
+        }
+        safe_next();
+        frames.push_back(f);
+        return false;
+
+    } else if (tok.tag == Token::BLOCK) {
+
+        if (!frames.empty() && frames.back().kind == Frame::PAREN) frames.back().block = true;
+        Frame f{ Frame::BLOCK };
+        f.begin = tok.word.data();
+        safe_next();
+        // inner statement for each '('
+        if (tok.tag == Token::LP) {
+            frames.push_back(f);
+            return false;
         }
-        if (itr->tag != Token::RP) {
+        if (tok.tag != Token::RP) {
             throw SyntaxError("(ERROR (syntax): Mismatched parenthesis )");
         }
-        if (cnt == 0) throw SyntaxError("(ERROR (syntax): empty block statement )");
-      
-        return bm.makeBlock(stmts_accumulator);
+        throw SyntaxError("(ERROR (syntax): empty block statement )");
 
-
-    } else if (itr->tag == Token::SET) {
+    } else if (tok.tag == Token::SET) {
 
         // Parsing of a SET intruction
-        safe_next(itr);
-        if (itr->tag == Token::VARIABLE_ID) {
-            NumExpr* v = parseNumExpr(itr); // VARIABLE
-            safe_next(itr);
+        safe_next();
+        if (tok.tag == Token::VARIABLE_ID) {
+            NumExpr* v = nf.makeVariable(tok.word); // VARIABLE (written, not read)
+            safe_next();
 
-            NumExpr* nexpr = parseNumExpr(itr); // NEXPR
+            NumExpr* nexpr = parseNumExpr(); // NEXPR
             
-            Statement* stmt = sm.makeSetStmt(nexpr, dynamic_cast<Variable*> (v));
+            nf.set_line(line);
+            Statement* stmt = nf.makeSetStmt(nexpr, static_cast<Variable*> (v));
             stmts_accumulator.push_back(stmt);
 
-
-            recursiveParse(itr);
-            safe_next(itr);
+            safe_next();
             
-            if (itr->tag != Token::RP) {
+            if (tok.tag != Token::RP) {
                 throw SyntaxError("(ERROR (syntax): Mismatched parenthesis )");
             } 
 
-            return bm.makeBlock(stmts_accumulator);
-
         } else {
             std::stringstream tmp{};
-            tmp << "(ERROR (syntax): VARIABLE_ID expected, \"" << itr->tag << ";" << itr->word << "\" given )";
+            tmp << "(ERROR (syntax): VARIABLE_ID expected, \"" << tok.tag << ";" << tok.text() << "\" given )";
             throw SyntaxError(tmp.str());
         } 
 
-    } else if (itr->tag == Token::INPUT) {
+    } else if (tok.tag == Token::INPUT) {
 
         // Parsing of an INPUT instruction
-        safe_next(itr);
-        if (itr->tag == Token::VARIABLE_ID) {
-            NumExpr* v = parseNumExpr(itr); // VARIABLE
-            safe_next(itr);
+        safe_next();
+        if (tok.tag == Token::VARIABLE_ID) {
+            NumExpr* v = nf.makeVariable(tok.word); // VARIABLE (written, not read)
+            safe_next();
 
-            if (itr->tag != Token::RP) {
+            if (tok.tag != Token::RP) {
                 throw SyntaxError("(ERROR (syntax): Mismatched parenthesis )");
             }
 
-            Statement* stmt = sm.makeInputStmt((Variable*) v);
+            nf.set_line(line);
+            Statement* stmt = nf.makeInputStmt((Variable*) v);
             stmts_accumulator.push_back(stmt);
-
-            recursiveParse(itr);
         }
 
-        return bm.makeBlock(stmts_accumulator);
-            
-
-    } else if (itr->tag == Token::PRINT) {
+    } else if (tok.tag == Token::PRINT) {
         // Parsing of a PRINT instruction
-        safe_next(itr);
-        NumExpr* v = parseNumExpr(itr);
+        safe_next();
+        NumExpr* v = parseNumExpr();
+        markUse(v, CheckedVariable::PRINT, 0);
 
-        Statement* stmt = sm.makePrintStmt(v);
+        nf.set_line(line);
+        Statement* stmt = nf.makePrintStmt(v);
         stmts_accumulator.push_back(stmt);
 
-        
-        recursiveParse(itr);
-        safe_next(itr);
+        safe_next();
 
-        if (itr->tag != Token::RP) {
+        if (tok.tag != Token::RP) {
             throw SyntaxError("(ERROR (syntax): Mismatched parenthesis )");
         }
 
-        return bm.makeBlock(stmts_accumulator);
+    } else if (tok.tag == Token::IF || tok.tag == Token::WHILE) {
+        // Parsing of an IF or WHILE instruction
+        Frame f{ tok.tag == Token::IF ? Frame::IF_THEN : Frame::WHILE_BODY };
+        f.line = line;
+        safe_next();
+        f.bexpr = parseBoolExpr();
+
+        // The statements of the (1st) block are collected above the ones of the enclosing block
+        f.saved_base = block_base;
+        block_base = stmts_accumulator.size();
+        frames.push_back(f);
+        safe_next();
+        return false;
+    }
+    return true;
+}
 
 
-    } else if (itr->tag == Token::IF) {
-        // Parsing of an IF instruction
-        safe_next(itr);
-        BoolExpr* bexpr = parseBoolExpr(itr);
-    
-        // Temporary save of the statements accumulator
-        std::vector<Statement*> tmp = stmts_accumulator;
-        stmts_accumulator = {};
-
-        /* 1st block */
-        safe_next(itr);
-        Block* stmt_block1 = recursiveParse(itr);
-
-        /* 2nd block */
-        stmts_accumulator = {};
-        safe_next(itr);
-        if (itr->tag != Token::LP) throw SyntaxError("(ERROR (syntax): missing ELSE in IF_STATEMENT )");
-        Block* stmt_block2 = recursiveParse(itr);
-    
-        // restore of statements accumulator
-        stmts_accumulator = tmp;
-
+/* Parsing of the rest of the statement of the top Frame, whose inner statement is complete.
+It returns true if the statement is complete too (and its Frame is popped), false if
+another inner statement starts at the current token */
+bool ParseProgram::resumeStatement() {
+    Frame& f = frames.back();
+    switch (f.kind) {
+        case Frame::PAREN:
+            if (listener != nullptr) notifyStatement();
+            frames.pop_back();
+            if (stmts_accumulator.size() == block_base) throw SyntaxError("(ERROR (syntax): empty BLOCK statement )");
+            if (tok.tag != Token::RP) {
+                throw SyntaxError("(ERROR (syntax): Mismatched parenthesis )");
+            }
+            return true;
 
-        Statement* stmt = sm.makeIfStmt(bexpr, stmt_block1, stmt_block2);
-        stmts_accumulator.push_back(stmt);
+        case Frame::BLOCK:
+            /* Counter of the statements in a block.
+            If the block is empty, a runtime error is thrown */
+            f.cnt++;
+            if (tok.tag != Token::RP) {
+                throw SyntaxError("(ERROR (syntax): Mismatched parenthesis )");
+            }
+            safe_next();
+            if (tok.tag == Token::LP) return false;
 
+            frames.pop_back();
+            if (tok.tag != Token::RP) {
+                throw SyntaxError("(ERROR (syntax): Mismatched parenthesis )");
+            }
+            return true;
+
+        case Frame::IF_THEN:
+            /* 2nd block */
+            f.stmt_block1 = popBlock();
+            f.kind = Frame::IF_ELSE;
+            safe_next();
+            if (tok.tag != Token::LP) throw SyntaxError("(ERROR (syntax): missing ELSE in IF_STATEMENT )");
+            return false;
+
+        case Frame::IF_ELSE: {
+            Block* stmt_block2 = popBlock();
+            // restore of the enclosing block
+            block_base = f.saved_base;
+            nf.set_line(f.line);
+            Statement* stmt = nf.makeIfStmt(f.bexpr, f.stmt_block1, stmt_block2);
+            frames.pop_back();
+            stmts_accumulator.push_back(stmt);
 
-        if (itr->tag != Token::RP) {
-            throw SyntaxError("(ERROR (syntax): Mismatched parenthesis )");
+            if (tok.tag != Token::RP) {
+                throw SyntaxError("(ERROR (syntax): Mismatched parenthesis )");
+            }
+            safe_next();
+            return true;
         }
-    
-        recursiveParse(itr);
-        safe_next(itr);
-
-        return bm.makeBlock(stmts_accumulator);
-        
-    } else if (itr->tag == Token::WHILE) {
-        // Parsing of a WHILE instruction
-        safe_next(itr);
-        BoolExpr* bexpr = parseBoolExpr(itr);
-
-        // Temporary save of the statements accumulator
-        std::vector<Statement*> tmp = stmts_accumulator;
-        stmts_accumulator = {};
-        safe_next(itr);
-        Block* stmt_blk = recursiveParse(itr);
 
-        // Restore of the statements accumulator
-        stmts_accumulator = tmp;
+        case Frame::WHILE_BODY: {
+            Block* stmt_blk = popBlock();
+            // restore of the enclosing block
+            block_base = f.saved_base;
+            BoolExpr* bexpr = f.bexpr;
+            nf.set_line(f.line);
+            frames.pop_back();
 
+            if (tok.tag != Token::RP) {
+                throw SyntaxError("(ERROR (syntax): Mismatched parenthesis )");
+            }
 
-        if (itr->tag != Token::RP) {
-            throw SyntaxError("(ERROR (syntax): Mismatched parenthesis )");
+            Statement* stmt = nf.makeWhileStmt(bexpr, stmt_blk);
+            stmts_accumulator.push_back(stmt);
+            safe_next();
+            return true;
         }
-
-        Statement* stmt = sm.makeWhileStmt(bexpr, stmt_blk);
-        stmts_accumulator.push_back(stmt);
-
-
-        recursiveParse(itr);
-        safe_next(itr);
-
-        return bm.makeBlock(stmts_accumulator);
-    } 
-
-    return bm.makeBlock(stmts_accumulator);
+    }
+    return true;
 }
 
 
 /* Method used to perform the parsing of a Program.
 It returns a pointer to a Program object */
-Program* ParseProgram::parse(std::vector<Token>::const_iterator& itr, std::vector<Token>::const_iterator& end) {
-    // verify if there are no read tokens (empty program)
-    if (end - itr == 0) {
+Program* ParseProgram::parse() {
+    // verify if there are no tokens (empty program)
+    if (!lexer->next(tok)) {
         /* There are TWO ways to notify if a program is empty:
             1st) returning an empy Program object and then evaluating it
             2nd) throwing a SyntaxError because the grammar doesn't allow it
@@ -279,9 +338,38 @@ Program* ParseProgram::parse(std::vector<Token>::const_iterator& itr, std::vecto
         //return new Program(); 
         throw SyntaxError("(ERROR (syntax): empty program )");
     } 
-    Block* blk = recursiveParse(itr);
+    Block* blk = parseStmtBlock();
     
     // Error given if there is an overflow of tokens (other instructions outside the main block)
-    if (end - itr > 1) throw SyntaxError("(ERROR (syntax): token overflow detected )");
+    LexToken extra;
+    if (lexer->next(extra)) throw SyntaxError("(ERROR (syntax): token overflow detected )");
     return new Program(blk);
-}
\ No newline at end of file
+}
+
+
+/* Method used to parse the statements of a part of a source (see IncrementalParser).
+It returns the Block of the statements read, whose number is at most "max_stmts" */
+ParseProgram::Fragment ParseProgram::parseFragment(Lexer& lex, const char* limit, size_t max_stmts, bool preceded) {
+    lexer = &lex;
+    stmts_accumulator.clear();
+    frames.clear();
+    block_base = 0;
+    // place of the statements before them, taken out of the Block at the end
+    if (preceded) stmts_accumulator.push_back(nullptr);
+
+    Fragment fragment;
+    fragment.end = lex.get_position();
+    fragment.state = lex.get_state();
+    bool more = lexer->next(tok);
+    while (more && tok.word.data() < limit && fragment.n_read < max_stmts) {
+        if (tok.tag != Token::LP) return Fragment{};
+        parseStatements();
+        fragment.n_read++;
+        fragment.end = lexer->get_position();
+        fragment.state = lexer->get_state();
+        more = lexer->next(tok);
+    }
+    block_base = preceded ? 1 : 0;
+    fragment.blk = popBlock();
+    return fragment;
+}
@@ -6,47 +6,134 @@
 #include <vector>
 
 #include "Token.h"
+#include "Lexer.h"
 #include "Program.h"
 #include "Block.h"
-#include "BlockManager.h"
-#include "StatementManager.h"
-#include "NumExprManager.h"
-#include "BoolExprManager.h"
+#include "NodeFactory.h"
 #include "Exceptions.h"
 
 
-/* Function object used to manage the parsing of a token stream in a Program object */
+/* Receiver of the position in the source of each statement read by a ParseProgram (see set_listener()),
+e.g. the IncrementalParser, which reads again only the statements changed by an edit */
+class ParseListener {
+public:
+    // Statement from its '(' to its ')' included
+    struct Span {
+        const char* begin;
+        const char* end;     // character after the ')'
+        uint32_t line;       // line of the '('
+        uint32_t last_line;  // line of the ')'
+        const char* block;   // keyword of the innermost BLOCK statement around it, nullptr for the only statement of a stmt_block
+        bool neg_before;     // '-' read and not yet used by a NUM before the '(' (see Lexer)
+        bool neg_after;      // the same after the ')'
+    };
+
+    // Statement read (the ones of a BLOCK statement are given one by one, not the BLOCK)
+    virtual void statement(Statement* s, const Span& span) = 0;
+    // Block made with the last "n" statements read and not yet in a Block
+    virtual void block(Block* b, size_t n) = 0;
+
+protected:
+    ~ParseListener() = default;
+};
+
+
+/* Function object used to manage the parsing of the token stream of a Lexer in a Program object */
 class ParseProgram { 
 public:
-    ParseProgram(BlockManager& block_m, StatementManager& stmt_m, NumExprManager& nexpr_m, BoolExprManager& bexpr_m) : bm{ block_m }, sm{ stmt_m }, nem{ nexpr_m }, bem{ bexpr_m }, stmts_accumulator{ } {};
+    ParseProgram(NodeFactory& node_f) : nf{ node_f }, stmts_accumulator{ } {};
     ~ParseProgram() = default;  
     
-    // Deletion of default constructor because specifying BlockManager, StatementManager, NumExprManager and BoolExprManager as parameters is required
+    // Deletion of default constructor because specifying the NodeFactory as parameter is required
     ParseProgram() = delete;
     // Deletion of copy constructor and the assignment operator to avoid pointers ownership errors
     ParseProgram(const ParseProgram& other) = delete;
     ParseProgram& operator=(const ParseProgram& other) = delete;
 
-    Program* operator()(const std::vector<Token>& tokenStream) {
-        auto tokenItr = tokenStream.begin();
-        auto tokenEnd = tokenStream.end();
-        Program* prg =  parse(tokenItr, tokenEnd);
-        return prg;
+    /* Parsing of the tokens produced by "lexer", read one at a time.
+    As the whole source is read before any SyntaxError is given, a LexicalError found after
+    the point where the parsing stopped takes the precedence */
+    Program* operator()(Lexer& lex) {
+        lexer = &lex;
+        stmts_accumulator.clear();
+        frames.clear();
+        block_base = 0;
+        try {
+            return parse();
+        } catch (SyntaxError&) {
+            lex.drain();
+            throw;
+        }
     }
 
+    Program* operator()(std::string_view source) {
+        Lexer lex{ source };
+        return (*this)(lex);
+    }
+
+    // Statements read by parseFragment()
+    struct Fragment {
+        Block* blk = nullptr;       // nullptr if a token other than '(' follows a statement before the limit
+        size_t n_read = 0;          // statements read, a BLOCK counting as one
+        const char* end = nullptr;  // character after the ')' of the last statement
+        Lexer::State state;         // state of the Lexer at "end"
+    };
+
+    /* Parsing of the statements of "lex" starting before "limit", at most "max_stmts", as the statements of a BLOCK,
+    in a Block of their own: the token after each statement is read, like the parser does, and the parsing stops at
+    the first one that is not a '(' or that starts at "limit" or later. The statements can end after "limit".
+    "preceded" tells if other statements of the same stmt_block come before them, as the error of a statement that
+    makes no node depends on it. The errors are the ones of the parsing of a Program, but the rest of the source
+    isn't read for a LexicalError */
+    Fragment parseFragment(Lexer& lex, const char* limit, size_t max_stmts, bool preceded);
+
+    void set_listener(ParseListener* l) { listener = l; }
+
 
 private:
-    std::vector<Token>::const_iterator streamEnd;
-    BlockManager& bm;
-    StatementManager& sm;
-    NumExprManager& nem;
-    BoolExprManager& bem;
-    std::vector<Statement*> stmts_accumulator; // the deallocation of this std::vector<Statement*> is performed by the BlockManager destructor 
+    /* Statement whose parsing is suspended while one of its inner statements is parsed:
+    the frames take the place of the recursive calls, so the depth of the C++ stack
+    depends neither on the number of statements nor on their nesting */
+    struct Frame {
+        enum Kind { PAREN, BLOCK, IF_THEN, IF_ELSE, WHILE_BODY };
+        Kind kind;
+        size_t saved_base = 0;        // block_base of the enclosing stmt_block (IF and WHILE)
+        int cnt = 0;                  // statements read by a BLOCK
+        BoolExpr* bexpr = nullptr;    // condition of IF and WHILE
+        Block* stmt_block1 = nullptr; // 1st block of an IF
+        uint32_t line = 0;            // line of IF and WHILE, made after their blocks, and of the '(' of PAREN
+        const char* begin = nullptr;  // '(' of PAREN and keyword of BLOCK, for the ParseListener
+        bool neg = false;             // state of the Lexer before the '(' of PAREN
+        size_t first = 0;             // statements collected before the '(' of PAREN
+        bool block = false;           // PAREN of a BLOCK statement
+    };
+
+    Lexer* lexer = nullptr;
+    ParseListener* listener = nullptr;
+    LexToken tok; // current token
+    NodeFactory& nf;
+    /* Statements of all the open stmt_blocks, the innermost one at the top starting from block_base
+    (the nodes are owned by the NodeFactory) */
+    std::vector<Statement*> stmts_accumulator;
+    size_t block_base = 0;
+    std::vector<Frame> frames;
     
-    Program* parse(std::vector<Token>::const_iterator& tokenItr, std::vector<Token>::const_iterator& tokenEnd);
-    Block* recursiveParse(std::vector<Token>::const_iterator& tokenItr);
-    NumExpr* parseNumExpr(std::vector<Token>::const_iterator& tokenItr);
-    BoolExpr* parseBoolExpr(std::vector<Token>::const_iterator& tokenItr);
+    Program* parse();
+    // Parsing of a stmt_block: the Block is created once, with the statements at the top of stmts_accumulator
+    Block* parseStmtBlock();
+    Block* popBlock();
+    void notifyStatement();
+    void parseStatements();
+    bool beginStatement();
+    bool resumeStatement();
+    NumExpr* parseNumExpr();
+    BoolExpr* parseBoolExpr();
+
+    // Record of the use of a variable read as a direct operand (for the message of its SemanticError)
+    static void markUse(NumExpr* e, CheckedVariable::Use use, int code) {
+        CheckedVariable* v = dynamic_cast<CheckedVariable*> (e);
+        if (v != nullptr) v->set_use(use, code);
+    }
 
     // util methods used to evaluate the identity of characters or TOKEN_ID (int)
     bool isOperator(int t) const { return t == Token::ADD || t == Token::SUB || t == Token::MUL || t == Token::DIV; }
@@ -54,12 +141,11 @@ private:
     bool isBoolConst(int b) const { return b == Token::TRUE || b == Token::FALSE; }
     bool isBoolOperator(int r) const { return r == Token::AND || r == Token::OR || r == Token::NOT; }
  
-    // method used to progress an iterator passed as parameter
-    void safe_next(std::vector<Token>::const_iterator& itr) {
-        if (itr == streamEnd) {
+    // method used to read the next token
+    void safe_next() {
+        if (!lexer->next(tok)) {
             throw SyntaxError("(ERROR (syntax): unexpected end of input )");
         }
-        ++itr;
     }
 };
 
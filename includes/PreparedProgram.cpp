@@ -0,0 +1,129 @@
+#include <sstream>
+
+#include "PreparedProgram.h"
+#include "Parser.h"
+#include "Resolver.h"
+#include "Visitor.h"
+#include "ConstantFolder.h"
+#include "DeadCodeEliminator.h"
+#include "LoopInvariantHoister.h"
+#include "InductionVariableSimplifier.h"
+#include "DefiniteAssignment.h"
+#include "Compiler.h"
+#include "VM.h"
+#include "Flattener.h"
+#include "FlatEvaluator.h"
+#include "SwitchEvaluator.h"
+
+
+PreparedProgram::PreparedProgram(std::string_view source, const Options& opts, RunStats* stats) : engine_kind{ opts.engine } {
+    if (stats != nullptr) {
+        // TOKENIZATION, only measured: the parser reads the tokens from a Lexer of its own (a LexicalError is thrown by the parsing)
+        RunStats::Phase phase{ stats, "tokenize" };
+        Lexer lex{ source };
+        LexToken tok;
+        try {
+            while (lex.next(tok)) stats->n_tokens++;
+        } catch (LexicalError&) {}
+    }
+
+    // PARSING
+    {
+        RunStats::Phase phase{ stats, "parse" };
+        ParseProgram parse{ nf };
+        prg.reset(parse(source));
+    }
+    if (stats != nullptr) stats->parsed = RunStats::NodeCounts::of(nf);
+
+    // RESOLUTION of the VARIABLE_IDs to dense slots
+    {
+        RunStats::Phase phase{ stats, "resolve" };
+        ResolveVisitor resolve;
+        prg->accept(&resolve);
+    }
+
+    // SIMPLIFICATION of the constant expressions, removal of the dead code, hoisting of the loop invariants and closed form of the counting loops (the run time errors are kept)
+    ConstantFolder fold{ nf };
+    if (opts.fold) {
+        RunStats::Phase phase{ stats, "fold" };
+        fold(prg.get());
+    }
+    DeadCodeEliminator dce{ nf };
+    if (opts.dce) {
+        RunStats::Phase phase{ stats, "dce" };
+        dce(prg.get());
+    }
+    LoopInvariantHoister licm{ nf };
+    if (opts.licm) {
+        RunStats::Phase phase{ stats, "licm" };
+        licm(prg.get());
+    }
+    InductionVariableSimplifier indvars{ nf };
+    if (opts.indvars) {
+        RunStats::Phase phase{ stats, "indvars" };
+        indvars(prg.get());
+    }
+    // Only the reads of variables that may not be declared yet are checked at run time
+    DefiniteAssignment assignment{ nf };
+    if (opts.definite_assignment) {
+        RunStats::Phase phase{ stats, "definite_assignment" };
+        assignment(prg.get());
+    }
+
+    std::ostringstream text;
+    text << "(REPORT: " << fold.get_n_folded() << " expressions or statements folded, "
+        << dce.get_n_dead_stores() << " dead stores and " << dce.get_n_unreachable() << " unreachable statements removed ("
+        << dce.get_n_removed_nodes() << " nodes), " << licm.get_n_hoisted() << " invariant expressions hoisted out of the loops, "
+        << indvars.get_n_reduced() << " counting loops replaced by their closed form, "
+        << assignment.get_n_unchecked() << " variable reads without check and " << assignment.get_n_checked() << " checked )";
+    report = text.str();
+
+    {
+        RunStats::Phase phase{ stats, "translate" };
+        translate();
+    }
+    if (stats != nullptr) stats->prepared = RunStats::NodeCounts::of(nf);
+}
+
+PreparedProgram::PreparedProgram(std::unique_ptr<FlatImage> img, const Options& opts) :
+    engine_kind{ opts.engine }, report{ img->get_report() }, image{ std::move(img) } {
+    if (engine_kind != Options::FLAT || opts.emit_cpp || !opts.compile_output.empty()) {
+        UnflattenProgram unflatten{ nf };
+        prg.reset(unflatten(image->view()));
+    }
+    translate();
+}
+
+FlatAst PreparedProgram::flatten() const {
+    FlattenVisitor flatten;
+    return flatten(prg.get());
+}
+
+void PreparedProgram::translate() {
+    // TRANSLATION for the engine
+    if (engine_kind == Options::JIT && !JitCompiler::isSupported()) engine_kind = Options::TREE;
+    Program* p = prg.get();
+    if (engine_kind == Options::JIT) {
+        // Compilation to native code
+        JitCompiler compile;
+        native.reset(compile(p));
+        JitProgram* code = native.get();
+        engine = [code](Runtime* r) { code->run(r); };
+    } else if (engine_kind == Options::VM) {
+        // Compilation to bytecode, executed on the virtual machine
+        BytecodeCompiler compile;
+        chunk = compile(p);
+        const Chunk* c = &chunk;
+        engine = [c](Runtime* r) { VirtualMachine vm{ r }; vm.run(*c); };
+    } else if (engine_kind == Options::FLAT) {
+        // Copy to the flat layout, unless the mapped image is run in place
+        if (!image) ast = flatten();
+        FlatView v = image ? image->view() : ast.view();
+        engine = [v](Runtime* r) { FlatEvaluator eval{ r }; eval.run(v); };
+    } else if (engine_kind == Options::SWITCH) {
+        // Evaluation of the syntax tree by kind of node
+        engine = [p](Runtime* r) { SwitchEvaluator eval{ r }; eval.run(p); };
+    } else {
+        engine = [p](Runtime* r) { EvaluationVisitor eval{ r }; p->accept(&eval); };
+    }
+}
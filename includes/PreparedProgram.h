@@ -0,0 +1,69 @@
+#ifndef PREPARED_PROGRAM_H
+#define PREPARED_PROGRAM_H
+
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "NodeFactory.h"
+#include "Program.h"
+#include "Options.h"
+#include "Bytecode.h"
+#include "FlatAst.h"
+#include "FlatImage.h"
+#include "Jit.h"
+#include "ExecutionContext.h"
+#include "RunStats.h"
+
+
+/* Program made ready to run once for all: the source is parsed, its VARIABLE_IDs are resolved,
+the optimizations enabled by the Options are applied and the Program is translated for the engine
+of the Options (bytecode, native code or flat layout); a Program of the cache on disk is loaded from its
+FlatImage instead (see ProgramStore). The PreparedProgram is never written after
+its construction, so it can be run any number of times, also by many threads at once,
+each run with its own Runtime. The LexicalErrors and SyntaxErrors of the source are thrown by the constructor,
+which records the time of each phase in "stats", if given */
+class PreparedProgram {
+public:
+    PreparedProgram(std::string_view source, const Options& opts, RunStats* stats = nullptr);
+    /* Program optimized in a previous run, loaded from its image without parsing: the flat engine runs
+    the mapped image in place, the other engines rebuild the syntax tree from it */
+    PreparedProgram(std::unique_ptr<FlatImage> img, const Options& opts);
+    ~PreparedProgram() = default;
+
+    // Deletion of copy constructor and assignment operator: the engine refers to the members
+    PreparedProgram(const PreparedProgram& other) = delete;
+    PreparedProgram& operator=(const PreparedProgram& other) = delete;
+
+    void run(Runtime* rt) const { engine(rt); }
+    const ExecutionContext::Engine& get_engine() const { return engine; }
+
+    // Engine actually used: TREE if native code generation is not supported on this platform
+    Options::Engine get_engine_kind() const { return engine_kind; }
+    // nullptr for the flat engine with a Program loaded from its image (and neither --emit-cpp nor --compile)
+    Program* get_program() const { return prg.get(); }
+    const Chunk& get_chunk() const { return chunk; }
+    // Text of --opt-report: what the optimizations changed
+    const std::string& get_report() const { return report; }
+    bool is_from_image() const { return image != nullptr; }
+
+    // Optimized Program in the FlatAst layout, as stored in the cache on disk (not for a Program loaded from its image)
+    FlatAst flatten() const;
+
+private:
+    NodeFactory nf;
+    std::unique_ptr<Program> prg;
+    Options::Engine engine_kind;
+    std::string report;
+    std::unique_ptr<FlatImage> image; // nullptr if the Program was parsed
+
+    // Translations of the Program (only the one of the engine is made)
+    Chunk chunk;
+    std::unique_ptr<JitProgram> native;
+    FlatAst ast;
+    ExecutionContext::Engine engine;
+
+    void translate();
+};
+
+#endif /* PREPARED_PROGRAM_H */
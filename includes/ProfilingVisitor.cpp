@@ -0,0 +1,305 @@
+#include <algorithm>
+#include <iomanip>
+
+#include "ProfilingVisitor.h"
+
+
+// Rows of each section of the report, the others are only counted
+static constexpr size_t MAX_ROWS = 20;
+// Characters of the source line shown next to a statement
+static constexpr size_t MAX_SOURCE = 48;
+
+
+/* Measure of a statement from its start to the end of its visit, also when an error stops the run:
+its time is added to the statement and to the nested time of the enclosing one */
+class ProfilingVisitor::Measure {
+public:
+    Measure(ProfilingVisitor& p, const Statement* s) : pv{ p } {
+        pv.n_statements++;
+        if (!pv.timed) return;
+        size_t index = pv.indexOf(s);
+        pv.stats[index].count++;
+        pv.running.push_back(Running{ index, Clock::now() });
+    }
+
+    ~Measure() {
+        if (!pv.timed) return;
+        Running r = pv.running.back();
+        pv.running.pop_back();
+        Clock::duration elapsed = Clock::now() - r.start;
+        StatementStats& st = pv.stats[r.index];
+        st.total += elapsed;
+        st.self += elapsed - r.nested;
+        if (!pv.running.empty()) pv.running.back().nested += elapsed;
+    }
+
+    Measure(const Measure& other) = delete;
+    Measure& operator=(const Measure& other) = delete;
+
+private:
+    ProfilingVisitor& pv;
+};
+
+
+size_t ProfilingVisitor::indexOf(const Statement* s) {
+    auto it = index_of.find(s);
+    if (it != index_of.end()) return it->second;
+    index_of.emplace(s, stats.size());
+    stats.push_back(StatementStats{ s });
+    return stats.size() - 1;
+}
+
+
+void ProfilingVisitor::visitProgram(Program* prg) {
+    reads.assign(prg->get_n_vars(), 0);
+    writes.assign(prg->get_n_vars(), 0);
+    var_ids = prg->get_var_ids();
+    Clock::time_point start = Clock::now();
+    try {
+        EvaluationVisitor::visitProgram(prg);
+    } catch (...) {
+        run_time = Clock::now() - start;
+        throw;
+    }
+    run_time = Clock::now() - start;
+}
+
+void ProfilingVisitor::visitBlock(Block* blk) {
+    // a visit of the body of the innermost running WHILE is one of its iterations
+    if (!loops.empty() && loops.back().body == blk) {
+        n_iterations++;
+        if (timed) stats[loops.back().index].iterations++;
+    }
+    EvaluationVisitor::visitBlock(blk);
+}
+
+
+/* STATEMENTS */
+void ProfilingVisitor::visitSet(SetStmt* s) {
+    Measure m{ *this, s };
+    EvaluationVisitor::visitSet(s);
+    writes[s->get_var()->get_slot()]++;
+}
+
+void ProfilingVisitor::visitInput(InputStmt* s) {
+    Measure m{ *this, s };
+    EvaluationVisitor::visitInput(s);
+    writes[s->get_var()->get_slot()]++;
+}
+
+void ProfilingVisitor::visitPrint(PrintStmt* s) {
+    Measure m{ *this, s };
+    EvaluationVisitor::visitPrint(s);
+}
+
+void ProfilingVisitor::visitIf(IfStmt* s) {
+    Measure m{ *this, s };
+    EvaluationVisitor::visitIf(s);
+}
+
+void ProfilingVisitor::visitWhile(WhileStmt* s) {
+    Measure m{ *this, s };
+    loops.push_back(Loop{ s->get_stmt_block(), timed ? running.back().index : 0 });
+    try {
+        EvaluationVisitor::visitWhile(s);
+    } catch (...) {
+        loops.pop_back();
+        throw;
+    }
+    loops.pop_back();
+}
+
+
+/* NUM_EXPR */
+void ProfilingVisitor::visitOperator(Operator* opNode) {
+    switch (opNode->getOp()) {
+        case Operator::ADD: expr_counts[ADD]++; break;
+        case Operator::SUB: expr_counts[SUB]++; break;
+        case Operator::MUL: expr_counts[MUL]++; break;
+        case Operator::DIV: expr_counts[DIV]++; break;
+        default: break;
+    }
+    EvaluationVisitor::visitOperator(opNode);
+}
+
+void ProfilingVisitor::visitNumber(Number* numNode) {
+    expr_counts[NUMBER]++;
+    EvaluationVisitor::visitNumber(numNode);
+    pushed();
+}
+
+void ProfilingVisitor::visitVariable(Variable* varNode) {
+    expr_counts[VARIABLE]++;
+    reads[varNode->get_slot()]++;
+    EvaluationVisitor::visitVariable(varNode);
+    pushed();
+}
+
+void ProfilingVisitor::visitCheckedVariable(CheckedVariable* varNode) {
+    expr_counts[VARIABLE]++;
+    reads[varNode->get_slot()]++;
+    EvaluationVisitor::visitCheckedVariable(varNode);
+    pushed();
+}
+
+
+/* BOOL_EXPR */
+void ProfilingVisitor::visitRelOp(RelOp* rop) {
+    switch (rop->get_r_opcode()) {
+        case RelOp::LT: expr_counts[LT]++; break;
+        case RelOp::GT: expr_counts[GT]++; break;
+        case RelOp::EQ: expr_counts[EQ]++; break;
+        default: break;
+    }
+    EvaluationVisitor::visitRelOp(rop);
+}
+
+void ProfilingVisitor::visitBoolConst(BoolConst* bconst) {
+    expr_counts[BOOL_CONST]++;
+    EvaluationVisitor::visitBoolConst(bconst);
+    pushed();
+}
+
+void ProfilingVisitor::visitBoolOp(BoolOp* bop) {
+    switch (bop->get_b_opcode()) {
+        case BoolOp::AND: expr_counts[AND]++; break;
+        case BoolOp::OR: expr_counts[OR]++; break;
+        case BoolOp::NOT: expr_counts[NOT]++; break;
+        default: break;
+    }
+    EvaluationVisitor::visitBoolOp(bop);
+}
+
+
+uint64_t ProfilingVisitor::get_n_expressions() const {
+    uint64_t n = 0;
+    for (uint64_t c : expr_counts) n += c;
+    return n;
+}
+
+uint64_t ProfilingVisitor::get_n_reads() const {
+    uint64_t n = 0;
+    for (uint64_t c : reads) n += c;
+    return n;
+}
+
+uint64_t ProfilingVisitor::get_n_writes() const {
+    uint64_t n = 0;
+    for (uint64_t c : writes) n += c;
+    return n;
+}
+
+
+const char* ProfilingVisitor::exprKind2String(ExprKind k) {
+    static const char* names[] = { "ADD", "SUB", "MUL", "DIV", "NUMBER", "VARIABLE", "LT", "GT", "EQ", "AND", "OR", "NOT", "TRUE/FALSE" };
+    return (k >= ADD && k < NULL_VAL) ? names[k] : "";
+}
+
+static const char* statementKind2String(Statement::Kind k) {
+    switch (k) {
+        case Statement::SET: return "SET";
+        case Statement::INPUT: return "INPUT";
+        case Statement::PRINT: return "PRINT";
+        case Statement::IF: return "IF";
+        case Statement::WHILE: return "WHILE";
+    }
+    return "";
+}
+
+static double millis(std::chrono::steady_clock::duration d) {
+    return std::chrono::duration<double, std::milli>(d).count();
+}
+
+// Line "n" (starting from 1) of the source, without the indentation and cut to MAX_SOURCE characters
+static std::string sourceLine(const std::vector<std::string_view>& lines, uint32_t n) {
+    if (n == 0 || n > lines.size()) return "";
+    std::string_view line = lines[n - 1];
+    size_t first = line.find_first_not_of(" \t\r");
+    if (first == std::string_view::npos) return "";
+    line = line.substr(first);
+    while (!line.empty() && (line.back() == '\r' || line.back() == ' ' || line.back() == '\t')) line.remove_suffix(1);
+    std::string text{ line.substr(0, MAX_SOURCE) };
+    if (line.size() > MAX_SOURCE) text += "...";
+    std::replace(text.begin(), text.end(), '\t', ' ');
+    return text;
+}
+
+static void moreRows(std::ostream& out, size_t n, const char* what) {
+    if (n > MAX_ROWS) out << "  (... " << (n - MAX_ROWS) << " more " << what << " )" << std::endl;
+}
+
+void ProfilingVisitor::report(std::ostream& out, std::string_view source) const {
+    std::vector<std::string_view> lines;
+    for (size_t pos = 0; pos <= source.size();) {
+        size_t end = std::min(source.find('\n', pos), source.size());
+        lines.push_back(source.substr(pos, end - pos));
+        pos = end + 1;
+    }
+
+    std::ios::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+    out << std::fixed << std::setprecision(3);
+    out << "(PROFILE: " << n_statements << " statements executed in " << millis(run_time) << " ms )" << std::endl;
+
+    // Statements by their own time
+    std::vector<const StatementStats*> rows;
+    for (const StatementStats& st : stats) rows.push_back(&st);
+    std::stable_sort(rows.begin(), rows.end(), [](const StatementStats* a, const StatementStats* b) { return a->self > b->self; });
+    const double run_ms = millis(run_time);
+    out << "STATEMENTS (by own time)" << std::endl;
+    out << std::setw(8) << "line" << "  " << std::left << std::setw(6) << "kind" << std::right << std::setw(14) << "count"
+        << std::setw(12) << "total ms" << std::setw(12) << "own ms" << std::setw(8) << "own %" << "  source" << std::endl;
+    for (size_t i = 0; i < rows.size() && i < MAX_ROWS; i++) {
+        const StatementStats& st = *rows[i];
+        out << std::setw(8) << st.stmt->get_line() << "  " << std::left << std::setw(6) << statementKind2String(st.stmt->get_kind())
+            << std::right << std::setw(14) << st.count << std::setw(12) << millis(st.total) << std::setw(12) << millis(st.self)
+            << std::setprecision(1) << std::setw(7) << (run_ms > 0 ? 100 * millis(st.self) / run_ms : 0.0) << "%" << std::setprecision(3)
+            << "  " << sourceLine(lines, st.stmt->get_line()) << std::endl;
+    }
+    moreRows(out, rows.size(), "statements");
+
+    // Loops by their time
+    rows.erase(std::remove_if(rows.begin(), rows.end(), [](const StatementStats* st) { return st->stmt->get_kind() != Statement::WHILE; }), rows.end());
+    std::stable_sort(rows.begin(), rows.end(), [](const StatementStats* a, const StatementStats* b) { return a->total > b->total; });
+    if (!rows.empty()) {
+        out << "LOOPS (by total time)" << std::endl;
+        out << std::setw(8) << "line" << std::setw(14) << "runs" << std::setw(14) << "iterations" << std::setw(12) << "total ms"
+            << std::setw(16) << "us/iteration" << std::endl;
+        for (size_t i = 0; i < rows.size() && i < MAX_ROWS; i++) {
+            const StatementStats& st = *rows[i];
+            out << std::setw(8) << st.stmt->get_line() << std::setw(14) << st.count << std::setw(14) << st.iterations
+                << std::setw(12) << millis(st.total) << std::setw(16)
+                << (st.iterations > 0 ? 1000 * millis(st.total) / st.iterations : 0.0) << std::endl;
+        }
+        moreRows(out, rows.size(), "loops");
+    }
+
+    // Expressions by their count
+    std::vector<ExprKind> kinds;
+    for (int k = ADD; k < NULL_VAL; k++) {
+        if (expr_counts[k] > 0) kinds.push_back(static_cast<ExprKind>(k));
+    }
+    std::stable_sort(kinds.begin(), kinds.end(), [this](ExprKind a, ExprKind b) { return expr_counts[a] > expr_counts[b]; });
+    if (!kinds.empty()) {
+        out << "EXPRESSIONS (by evaluations)" << std::endl;
+        for (ExprKind k : kinds)
+            out << "  " << std::left << std::setw(12) << exprKind2String(k) << std::right << std::setw(14) << expr_counts[k] << std::endl;
+    }
+
+    // Variables by their reads and writes
+    std::vector<size_t> slots;
+    for (size_t v = 0; v < var_ids.size(); v++) {
+        if (reads[v] + writes[v] > 0) slots.push_back(v);
+    }
+    std::stable_sort(slots.begin(), slots.end(), [this](size_t a, size_t b) { return reads[a] + writes[a] > reads[b] + writes[b]; });
+    if (!slots.empty()) {
+        out << "VARIABLES (by accesses)" << std::endl;
+        out << "  " << std::left << std::setw(20) << "variable" << std::right << std::setw(14) << "reads" << std::setw(14) << "writes" << std::endl;
+        for (size_t i = 0; i < slots.size() && i < MAX_ROWS; i++)
+            out << "  " << std::left << std::setw(20) << var_ids[slots[i]] << std::right << std::setw(14) << reads[slots[i]]
+                << std::setw(14) << writes[slots[i]] << std::endl;
+        moreRows(out, slots.size(), "variables");
+    }
+    out.flags(flags);
+    out.precision(precision);
+}
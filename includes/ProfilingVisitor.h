@@ -0,0 +1,109 @@
+#ifndef PROFILING_VISITOR_H
+#define PROFILING_VISITOR_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "Visitor.h"
+
+
+/* Class that extends EvaluationVisitor to measure a run of a Program (see --profile): the executions
+and the time of each Statement, with and without the statements nested in it, the iterations of each WHILE,
+the evaluations of each kind of NUM_EXPR and BOOL_EXPR, the reads and writes of each variable and the
+peak depth of the accumulator. The counts are exact; the times are taken with the steady clock around
+each statement, so they include part of the cost of the measure itself. Without "timed" only the totals
+are counted (see --stats), with no clock and no lookup by statement.
+The engines are not instrumented: without --profile and --stats nothing is measured */
+class ProfilingVisitor : public EvaluationVisitor {
+public:
+    // Kinds of the expressions counted (the TRUE and FALSE constants are counted together)
+    enum ExprKind { ADD, SUB, MUL, DIV, NUMBER, VARIABLE, LT, GT, EQ, AND, OR, NOT, BOOL_CONST, NULL_VAL };
+
+    ProfilingVisitor(Runtime* r, bool t = true) : EvaluationVisitor(r), timed{ t } {}
+
+    // Deletion of copy constructor and assignment operator: the counters refer to the nodes of one Program
+    ProfilingVisitor(const ProfilingVisitor& other) = delete;
+    ProfilingVisitor& operator=(const ProfilingVisitor& other) = delete;
+
+    void visitProgram(Program* prg) override;
+    void visitBlock(Block* blk) override;
+
+    void visitSet(SetStmt* s) override;
+    void visitInput(InputStmt* s) override;
+    void visitPrint(PrintStmt* s) override;
+    void visitIf(IfStmt* s) override;
+    void visitWhile(WhileStmt* s) override;
+
+    void visitOperator(Operator* opNode) override;
+    void visitNumber(Number* numNode) override;
+    void visitVariable(Variable* varNode) override;
+    void visitCheckedVariable(CheckedVariable* varNode) override;
+
+    void visitRelOp(RelOp* rop) override;
+    void visitBoolConst(BoolConst* bconst) override;
+    void visitBoolOp(BoolOp* bop) override;
+
+    /* Report of the run (also of a run stopped by an error), the most costly entries first:
+    the statements by their own time, identified by their line and kind and by the text of that line
+    of "source", the loops by their time, the expressions and the variables by their counts */
+    void report(std::ostream& out, std::string_view source) const;
+
+    static const char* exprKind2String(ExprKind k);
+
+    uint64_t get_n_statements() const { return n_statements; }
+    uint64_t get_n_iterations() const { return n_iterations; }
+    uint64_t get_n_evaluations(ExprKind k) const { return expr_counts[k]; }
+    uint64_t get_n_expressions() const;
+    uint64_t get_n_reads() const;
+    uint64_t get_n_writes() const;
+    size_t get_peak_depth() const { return peak_depth; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct StatementStats {
+        const Statement* stmt;
+        uint64_t count = 0;
+        Clock::duration total{ 0 }; // with the nested statements
+        Clock::duration self{ 0 };  // without the nested statements
+        uint64_t iterations = 0;    // WHILE only
+    };
+    // Measure of the running statement, in a stack like the statements
+    struct Running {
+        size_t index;             // in "stats"
+        Clock::time_point start;
+        Clock::duration nested{ 0 };
+    };
+    // WHILE whose body is running, to count its iterations
+    struct Loop {
+        const Block* body;
+        size_t index;
+    };
+    class Measure;
+
+    bool timed;
+    uint64_t n_statements = 0;
+    uint64_t n_iterations = 0;
+    size_t peak_depth = 0;
+    std::vector<StatementStats> stats;
+    std::unordered_map<const Statement*, size_t> index_of;
+    std::vector<Running> running;
+    std::vector<Loop> loops;
+    uint64_t expr_counts[NULL_VAL] = {};
+    std::vector<uint64_t> reads;
+    std::vector<uint64_t> writes;
+    std::vector<std::string> var_ids;
+    Clock::duration run_time{ 0 };
+
+    size_t indexOf(const Statement* s);
+    // after each value pushed by a leaf: an operator never makes the accumulator deeper than its operands
+    void pushed() { peak_depth = std::max(peak_depth, get_accumulator_depth()); }
+};
+
+#endif /* PROFILING_VISITOR_H */
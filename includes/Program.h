@@ -3,6 +3,8 @@
 
 
 #include <iostream>
+#include <string>
+#include <vector>
 
 #include "Block.h"
 #include "Statement.h"
@@ -18,16 +20,25 @@ static constexpr int EMPTY_VAL = 0;
 public:
     Program() : is_not_empty{ EMPTY_VAL } {}
     Program(Block* block) : blk{ block }, is_not_empty{ NOT_EMPTY_VAL } {}
-    ~Program() { delete(blk); }
+    // The main Block is owned (and released) by the NodeFactory that created it
+    ~Program() = default;
 
     Block* get_blk() const { return blk; }
+    // Replacement of the main Block by a rewritten one (e.g. by the ConstantFolder)
+    void set_blk(Block* block) { blk = block; }
     int get_is_not_empty() const { return is_not_empty; }
 
+    /* Symbol table filled by the ResolveVisitor: position i holds the VARIABLE_ID bound to slot i */
+    const std::vector<std::string>& get_var_ids() const { return var_ids; }
+    void set_var_ids(std::vector<std::string> ids) { var_ids = std::move(ids); }
+    unsigned int get_n_vars() const { return var_ids.size(); }
+
     void accept(Visitor* v);
 
 private:
-    Block* blk;
+    Block* blk = nullptr;
     int is_not_empty; // flag used to notify if the Program is empty or not
+    std::vector<std::string> var_ids; // dense slot index -> VARIABLE_ID
 };
 
 #endif /* PROGRAM_H */
\ No newline at end of file
@@ -0,0 +1,48 @@
+#include "ProgramCache.h"
+#include "DaemonProtocol.h"
+
+
+std::shared_ptr<const PreparedProgram> ProgramCache::find(uint64_t hash) {
+    std::lock_guard<std::mutex> lock{ m };
+    auto it = index.find(hash);
+    if (it == index.end()) return nullptr;
+    n_hits++;
+    entries.splice(entries.begin(), entries, it->second);
+    return it->second->program;
+}
+
+std::shared_ptr<const PreparedProgram> ProgramCache::get(std::string_view source) {
+    uint64_t hash = DaemonProtocol::hashSource(source);
+    {
+        std::lock_guard<std::mutex> lock{ m };
+        auto it = index.find(hash);
+        if (it != index.end() && it->second->source == source) {
+            n_hits++;
+            entries.splice(entries.begin(), entries, it->second);
+            return it->second->program;
+        }
+        n_misses++;
+    }
+
+    // Two threads missing the same source both prepare it: the last one replaces the other in the cache
+    std::shared_ptr<const PreparedProgram> program = std::make_shared<const PreparedProgram>(source, opts);
+
+    std::lock_guard<std::mutex> lock{ m };
+    auto it = index.find(hash);
+    if (it != index.end()) {
+        entries.erase(it->second);
+        index.erase(it);
+    }
+    entries.push_front(Entry{ hash, std::string{ source }, program });
+    index[hash] = entries.begin();
+    if (entries.size() > capacity) {
+        index.erase(entries.back().hash);
+        entries.pop_back();
+    }
+    return program;
+}
+
+size_t ProgramCache::size() {
+    std::lock_guard<std::mutex> lock{ m };
+    return entries.size();
+}
@@ -0,0 +1,49 @@
+#ifndef PROGRAM_CACHE_H
+#define PROGRAM_CACHE_H
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "Options.h"
+#include "PreparedProgram.h"
+
+
+/* Least recently used PreparedPrograms, by hash of their source, shared by the threads of a Daemon.
+A program is prepared outside of the lock, so the other threads are not stopped by a long parsing;
+the programs are handed out as shared_ptr, so one evicted while it runs is released at the end of the run */
+class ProgramCache {
+public:
+    ProgramCache(size_t cap, const Options& o) : capacity{ cap == 0 ? 1 : cap }, opts{ o } {}
+
+    // Program with "hash", nullptr if not in the cache
+    std::shared_ptr<const PreparedProgram> find(uint64_t hash);
+    // Program of "source", prepared if not in the cache (the LexicalErrors and SyntaxErrors are thrown)
+    std::shared_ptr<const PreparedProgram> get(std::string_view source);
+
+    size_t get_n_hits() const { return n_hits; }
+    size_t get_n_misses() const { return n_misses; }
+    size_t size();
+
+private:
+    struct Entry {
+        uint64_t hash;
+        std::string source; // to tell apart two sources with the same hash
+        std::shared_ptr<const PreparedProgram> program;
+    };
+
+    size_t capacity;
+    Options opts;
+    std::mutex m;
+    std::list<Entry> entries; // from the most recently used
+    std::unordered_map<uint64_t, std::list<Entry>::iterator> index;
+    std::atomic<size_t> n_hits{ 0 };
+    std::atomic<size_t> n_misses{ 0 };
+};
+
+#endif /* PROGRAM_CACHE_H */
@@ -0,0 +1,106 @@
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+#include <vector>
+
+#include "ProgramStore.h"
+#include "SourceFile.h"
+#include "Exceptions.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <unistd.h>
+static long processId() { return static_cast<long>(getpid()); }
+#else
+static long processId() { return 0; }
+#endif
+
+
+uint32_t ProgramStore::optionBits(const Options& opts) {
+    return (opts.fold ? 1u : 0u) | (opts.dce ? 2u : 0u) | (opts.licm ? 4u : 0u)
+        | (opts.indvars ? 8u : 0u) | (opts.definite_assignment ? 16u : 0u);
+}
+
+std::string ProgramStore::path(std::string_view source) const {
+    char name[64];
+    std::snprintf(name, sizeof(name), "%016llx-%02x-v%u-%08llx.flat",
+        static_cast<unsigned long long>(SourceFile::hash(source)), optionBits(opts), FlatImage::VERSION,
+        static_cast<unsigned long long>(FlatImage::buildHash() & 0xffffffffu));
+    return (std::filesystem::path{ dir } / name).string();
+}
+
+std::unique_ptr<PreparedProgram> ProgramStore::prepare(std::string_view source, RunStats* stats) {
+    {
+        RunStats::Phase phase{ stats, "load_image" };
+        std::unique_ptr<FlatImage> image{ new FlatImage() };
+        if (image->open(path(source), source, optionBits(opts))) {
+            n_hits++;
+            if (stats != nullptr) stats->from_image = true;
+            return std::unique_ptr<PreparedProgram>{ new PreparedProgram(std::move(image), opts) };
+        }
+    }
+    std::unique_ptr<PreparedProgram> program{ new PreparedProgram(source, opts, stats) };
+    RunStats::Phase phase{ stats, "store_image" };
+    if (store(source, *program)) n_stored++;
+    return program;
+}
+
+bool ProgramStore::store(std::string_view source, const PreparedProgram& program) {
+    std::error_code ec;
+    std::filesystem::create_directories(dir, ec);
+    std::string final_path = path(source);
+    std::string tmp_path = final_path + ".tmp" + std::to_string(processId());
+    {
+        std::ofstream out{ tmp_path, std::ios::binary | std::ios::trunc };
+        if (!out) return false;
+        std::string data = FlatImage::serialize(program.flatten(), source, optionBits(opts), program.get_report());
+        out.write(data.data(), data.size());
+        if (!out.flush()) {
+            out.close();
+            std::filesystem::remove(tmp_path, ec);
+            return false;
+        }
+    }
+    std::filesystem::rename(tmp_path, final_path, ec);
+    if (ec) std::filesystem::remove(tmp_path, ec);
+    return !ec;
+}
+
+size_t ProgramStore::precompile(const std::string& src_dir, std::ostream& log) {
+    std::error_code ec;
+    std::filesystem::directory_iterator it{ src_dir, ec };
+    if (ec) {
+        log << "(ERROR: fail to open directory \"" << src_dir << "\" )" << std::endl;
+        return 1;
+    }
+    // in the order of the names, so that the errors are always reported in the same order
+    std::vector<std::string> files;
+    for (const std::filesystem::directory_entry& entry : it) {
+        if (entry.is_regular_file(ec)) files.push_back(entry.path().string());
+    }
+    std::sort(files.begin(), files.end());
+
+    size_t n_failed = 0;
+    for (const std::string& file : files) {
+        SourceFile source{ file };
+        if (source.fail()) {
+            log << file << ": (ERROR: fail to open file \"" << file << "\" )" << std::endl;
+            n_failed++;
+            continue;
+        }
+        try {
+            prepare(source.text());
+        } catch (LexicalError& le) {
+            log << file << ": " << le.what() << std::endl;
+            n_failed++;
+        } catch (SyntaxError& pe) {
+            log << file << ": " << pe.what() << std::endl;
+            n_failed++;
+        } catch (std::exception& exc) {
+            log << file << ": (ERROR: generic error )" << std::endl << exc.what() << std::endl;
+            n_failed++;
+        }
+    }
+    return n_failed;
+}
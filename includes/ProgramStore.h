@@ -0,0 +1,49 @@
+#ifndef PROGRAM_STORE_H
+#define PROGRAM_STORE_H
+
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+#include "Options.h"
+#include "PreparedProgram.h"
+
+
+/* Cache on disk of the programs prepared by the interpreter (see --cache-dir). The optimized Program
+of a source is stored as a FlatImage in a file named after the hash of the source, the optimizations
+enabled and the FlatImage::VERSION: a later run of the same source with the same optimizations maps
+the image instead of tokenizing, parsing and optimizing the source again. An image is written
+in a temporary file renamed at the end, so a run never reads the half image of another one */
+class ProgramStore {
+public:
+    ProgramStore(const std::string& d, const Options& o) : dir{ d }, opts{ o } {}
+
+    /* Program of "source", loaded from its image or prepared and stored (if the directory
+    can't be written the program is just not stored), with the time of each phase in "stats" if given.
+    The LexicalErrors and SyntaxErrors are thrown */
+    std::unique_ptr<PreparedProgram> prepare(std::string_view source, RunStats* stats = nullptr);
+
+    /* Images of all the regular files of "src_dir" (the subdirectories are ignored): the files that can't
+    be read or parsed are reported on "log", with their error, and their number is returned */
+    size_t precompile(const std::string& src_dir, std::ostream& log);
+
+    // Path of the image of "source"
+    std::string path(std::string_view source) const;
+    // Optimizations of the Options that change the stored Program
+    static uint32_t optionBits(const Options& opts);
+
+    unsigned int get_n_hits() const { return n_hits; }
+    unsigned int get_n_stored() const { return n_stored; }
+
+private:
+    std::string dir;
+    Options opts;
+    unsigned int n_hits = 0;
+    unsigned int n_stored = 0;
+
+    bool store(std::string_view source, const PreparedProgram& program);
+};
+
+#endif /* PROGRAM_STORE_H */
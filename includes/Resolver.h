@@ -0,0 +1,94 @@
+#ifndef RESOLVER_H
+#define RESOLVER_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#include "Visitor.h"
+
+
+/* Class that extends Visitor superclass to bind every VARIABLE_ID to a dense integer slot.
+It runs between the parsing and the evaluation phase: each Variable node receives the index
+of its identifier and the Program receives the slot -> VARIABLE_ID table, so that the
+evaluator can store the variables in a flat array instead of looking them up by name */
+class ResolveVisitor : public Visitor {
+public:
+    ResolveVisitor() = default;
+    ResolveVisitor(const ResolveVisitor& other) = default;
+    ~ResolveVisitor() = default;
+    ResolveVisitor& operator=(const ResolveVisitor& other) = default;
+
+    void visitProgram(Program* prg) override {
+        slots.clear();
+        var_ids.clear();
+        if (prg->get_is_not_empty()) {
+            prg->get_blk()->accept(this);
+        }
+        prg->set_var_ids(var_ids);
+    }
+
+    void visitBlock(Block* blk) override {
+        for (Statement* s : blk->get_stmts())
+            s->accept(this);
+    }
+
+    void visitSet(SetStmt* s) override {
+        s->get_var()->accept(this);
+        s->get_nexpr()->accept(this);
+    }
+
+    void visitInput(InputStmt* s) override {
+        s->get_var()->accept(this);
+    }
+
+    void visitPrint(PrintStmt* s) override {
+        s->get_nexpr()->accept(this);
+    }
+
+    void visitIf(IfStmt* s) override {
+        s->get_bexpr()->accept(this);
+        s->get_stmt_block1()->accept(this);
+        s->get_stmt_block2()->accept(this);
+    }
+
+    void visitWhile(WhileStmt* s) override {
+        s->get_bexpr()->accept(this);
+        s->get_stmt_block()->accept(this);
+    }
+
+    void visitOperator(Operator* opNode) override {
+        opNode->getFirst()->accept(this);
+        opNode->getSecond()->accept(this);
+    }
+
+    void visitNumber(Number*) override {}
+
+    void visitVariable(Variable* varNode) override {
+        // Interning of the VARIABLE_ID: a new identifier takes the first free slot
+        auto it = slots.find(varNode->get_id());
+        if (it == slots.end()) {
+            it = slots.emplace(varNode->get_id(), static_cast<int>(var_ids.size())).first;
+            var_ids.push_back(varNode->get_id());
+        }
+        varNode->set_slot(it->second);
+    }
+
+    void visitRelOp(RelOp* rop) override {
+        rop->get_first_nexpr()->accept(this);
+        rop->get_second_nexpr()->accept(this);
+    }
+
+    void visitBoolConst(BoolConst*) override {}
+
+    void visitBoolOp(BoolOp* bop) override {
+        bop->get_f_bexpr()->accept(this);
+        if (bop->get_b_opcode() != BoolOp::NOT) bop->get_s_bexpr()->accept(this);
+    }
+
+private:
+    std::unordered_map<std::string, int> slots; // VARIABLE_ID -> slot, used only during the resolution
+    std::vector<std::string> var_ids; // slot -> VARIABLE_ID
+};
+
+#endif /* RESOLVER_H */
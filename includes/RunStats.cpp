@@ -0,0 +1,138 @@
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+
+#include "RunStats.h"
+#include "ProfilingVisitor.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+// Peak resident memory of the process in KiB (ru_maxrss is in bytes on macOS)
+static long maxResidentKib() {
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return -1;
+#if defined(__APPLE__)
+    return usage.ru_maxrss / 1024;
+#else
+    return usage.ru_maxrss;
+#endif
+}
+#else
+static long maxResidentKib() { return -1; }
+#endif
+
+
+RunStats::Phase::Phase(RunStats* s, const char* n) : stats{ s }, name{ n } {
+    if (stats == nullptr) return;
+    wall_start = std::chrono::steady_clock::now();
+    cpu_start = std::clock();
+}
+
+RunStats::Phase::~Phase() {
+    if (stats == nullptr) return;
+    double wall = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - wall_start).count();
+    double cpu = 1000.0 * static_cast<double>(std::clock() - cpu_start) / CLOCKS_PER_SEC;
+    stats->phases.push_back(Timing{ name, wall, cpu });
+}
+
+
+RunStats::NodeCounts RunStats::NodeCounts::of(const NodeFactory& nf) {
+    NodeCounts c;
+    c.blocks = nf.get_n_blocks();
+    c.statements = nf.get_n_statements();
+    c.num_exprs = nf.get_n_num_exprs();
+    c.bool_exprs = nf.get_n_bool_exprs();
+    c.arena_bytes_used = nf.get_arena().get_bytes_used();
+    c.arena_bytes_reserved = nf.get_arena().get_bytes_reserved();
+    return c;
+}
+
+
+// String literal of JSON
+static void writeString(std::ostream& out, std::string_view s) {
+    out << '"';
+    for (char ch : s) {
+        switch (ch) {
+            case '"': out << "\\\""; break;
+            case '\\': out << "\\\\"; break;
+            case '\n': out << "\\n"; break;
+            case '\r': out << "\\r"; break;
+            case '\t': out << "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(ch) < 0x20) {
+                    char esc[8];
+                    std::snprintf(esc, sizeof(esc), "\\u%04x", static_cast<unsigned int>(static_cast<unsigned char>(ch)));
+                    out << esc;
+                } else out << ch;
+        }
+    }
+    out << '"';
+}
+
+static void writeNodes(std::ostream& out, const RunStats::NodeCounts& c) {
+    out << "{\"blocks\":" << c.blocks << ",\"statements\":" << c.statements << ",\"num_exprs\":" << c.num_exprs
+        << ",\"bool_exprs\":" << c.bool_exprs << ",\"total\":" << (c.blocks + c.statements + c.num_exprs + c.bool_exprs)
+        << ",\"arena_bytes_used\":" << c.arena_bytes_used << ",\"arena_bytes_reserved\":" << c.arena_bytes_reserved << "}";
+}
+
+void RunStats::writeJson(std::ostream& out) const {
+    std::ios::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+    out << std::fixed;
+    out.precision(3);
+
+    out << "{\"file\":";
+    writeString(out, file);
+    out << ",\"status\":" << (error.empty() ? "\"ok\"" : "\"error\"");
+    if (!error.empty()) {
+        out << ",\"error\":";
+        writeString(out, error);
+    }
+
+    out << ",\"phases\":[";
+    double wall = 0, cpu = 0;
+    for (size_t i = 0; i < phases.size(); i++) {
+        out << (i > 0 ? "," : "") << "{\"name\":\"" << phases[i].name << "\",\"wall_ms\":" << phases[i].wall_ms
+            << ",\"cpu_ms\":" << phases[i].cpu_ms << "}";
+        wall += phases[i].wall_ms;
+        cpu += phases[i].cpu_ms;
+    }
+    out << "],\"total_wall_ms\":" << wall << ",\"total_cpu_ms\":" << cpu;
+
+    out << ",\"engine\":";
+    writeString(out, engine);
+    out << ",\"counted\":" << (run != nullptr ? "true" : "false");
+    out << ",\"source_bytes\":" << source_bytes << ",\"tokens\":" << n_tokens << ",\"from_image\":" << (from_image ? "true" : "false");
+    out << ",\"nodes\":{\"parsed\":";
+    writeNodes(out, parsed);
+    out << ",\"prepared\":";
+    writeNodes(out, prepared);
+    out << "},\"max_rss_kib\":" << maxResidentKib();
+
+    if (run != nullptr) {
+        out << ",\"run\":{\"statements\":" << run->get_n_statements() << ",\"expressions\":" << run->get_n_expressions()
+            << ",\"loop_iterations\":" << run->get_n_iterations() << ",\"variable_reads\":" << run->get_n_reads()
+            << ",\"variable_writes\":" << run->get_n_writes() << ",\"peak_accumulator_depth\":" << run->get_peak_depth()
+            << ",\"expressions_by_kind\":{";
+        for (int k = ProfilingVisitor::ADD; k < ProfilingVisitor::NULL_VAL; k++) {
+            ProfilingVisitor::ExprKind kind = static_cast<ProfilingVisitor::ExprKind>(k);
+            out << (k > 0 ? "," : "") << "\"" << ProfilingVisitor::exprKind2String(kind) << "\":" << run->get_n_evaluations(kind);
+        }
+        out << "}}";
+    }
+    out << "}" << std::endl;
+
+    out.flags(flags);
+    out.precision(precision);
+}
+
+bool RunStats::write(const std::string& path) const {
+    if (path.empty()) {
+        writeJson(std::cerr);
+        return true;
+    }
+    std::ofstream out{ path, std::ios::trunc };
+    if (!out) return false;
+    writeJson(out);
+    return static_cast<bool>(out.flush());
+}
@@ -0,0 +1,81 @@
+#ifndef RUN_STATS_H
+#define RUN_STATS_H
+
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "NodeFactory.h"
+
+
+class ProfilingVisitor;
+
+
+/* Statistics of a run of the interpreter written as JSON at its end (see --stats=json): the wall and CPU time
+of each phase (read of the source, tokenization, parsing, resolution, each optimization, translation for the engine,
+run), the tokens of the source, the nodes made of each kind, the memory of the NodeArena and of the process
+and, if asked, the counters of the run kept by a ProfilingVisitor, which is then the engine measured. Nothing is measured when the statistics are off:
+the phases take a nullptr RunStats, which their Phase ignores */
+class RunStats {
+public:
+    /* Measure of the phase "name" from the construction to the destruction (also when an error leaves it);
+    a nullptr "s" measures nothing */
+    class Phase {
+    public:
+        Phase(RunStats* s, const char* name);
+        ~Phase();
+        Phase(const Phase& other) = delete;
+        Phase& operator=(const Phase& other) = delete;
+
+    private:
+        RunStats* stats;
+        const char* name;
+        std::chrono::steady_clock::time_point wall_start;
+        std::clock_t cpu_start;
+    };
+
+    // Nodes made by a NodeFactory up to now
+    struct NodeCounts {
+        unsigned int blocks = 0;
+        unsigned int statements = 0;
+        unsigned int num_exprs = 0;
+        unsigned int bool_exprs = 0;
+        size_t arena_bytes_used = 0;
+        size_t arena_bytes_reserved = 0;
+
+        static NodeCounts of(const NodeFactory& nf);
+    };
+
+    std::string file;
+    size_t source_bytes = 0;
+    uint64_t n_tokens = 0;
+    NodeCounts parsed;    // made by the parser
+    NodeCounts prepared;  // made in total once the Program is optimized and translated
+    bool from_image = false;
+    std::string engine;   // engine of the "run" phase
+    const ProfilingVisitor* run = nullptr; // counters of the run, if it was made
+    std::string error;    // message of the error that stopped the run, if any
+
+    struct Timing {
+        const char* name;
+        double wall_ms;
+        double cpu_ms;
+    };
+
+    // Phases measured up to now, in the order they ended
+    const std::vector<Timing>& get_phases() const { return phases; }
+
+    // Writing of the statistics as a JSON object on a single line
+    void writeJson(std::ostream& out) const;
+    // Writing of the JSON in the file "path" (on stderr if empty): false if the file can't be written
+    bool write(const std::string& path) const;
+
+private:
+    std::vector<Timing> phases;
+};
+
+#endif /* RUN_STATS_H */
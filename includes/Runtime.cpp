@@ -0,0 +1,17 @@
+#include "Runtime.h"
+
+
+int64_t Runtime::input(const std::string& var_id) {
+    if (in->is_interactive()) {
+        out->write("INPUT \"");
+        out->write(var_id);
+        out->write("\": ");
+        out->flush();
+    }
+    return in->next();
+}
+
+Runtime& Runtime::standard() {
+    static Runtime rt;
+    return rt;
+}
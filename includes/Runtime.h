@@ -0,0 +1,39 @@
+#ifndef RUNTIME_H
+#define RUNTIME_H
+
+#include <string>
+#include <cstdint>
+
+#include "OutputSink.h"
+#include "InputSource.h"
+
+
+/* Class that collects the services used by every execution engine to talk with the user:
+the reading of the values requested by INPUT and the writing of the values given by PRINT.
+The values are read from an InputSource and written on an OutputSink, flushed before reading the user input */
+class Runtime {
+public:
+    Runtime() : Runtime(&OutputSink::standard()) {}
+    Runtime(OutputSink* o) : Runtime(o, &InputSource::standard()) {}
+    Runtime(OutputSink* o, InputSource* i) : out{ o }, in{ i } {}
+    Runtime(const Runtime& other) = default;
+    ~Runtime() = default;
+    Runtime& operator=(const Runtime& other) = default;
+
+    /* Read of the value of VARIABLE_ID "var_id", after a prompt if the InputSource is interactive;
+    a SemanticError is thrown if the value is not valid */
+    int64_t input(const std::string& var_id);
+    void print(int64_t val) { out->print(val); }
+
+    OutputSink* get_output() const { return out; }
+    InputSource* get_input() const { return in; }
+
+    // Runtime reading from std::cin and writing on the standard OutputSink
+    static Runtime& standard();
+
+private:
+    OutputSink* out;
+    InputSource* in;
+};
+
+#endif /* RUNTIME_H */
@@ -0,0 +1,88 @@
+#ifndef SLOT_SET_H
+#define SLOT_SET_H
+
+#include <vector>
+
+
+/* Flag for each variable slot of a Program (e.g. surely declared, live), for the analyses that save
+and restore the flags around the branches of IF and WHILE. Each change is recorded on a trail, so that
+the flags at a mark are restored undoing only the changes made after it, and two branches started from
+the same mark are merged looking only at the slots they changed: the cost of an IF or a WHILE is that of
+the changes made by its blocks, not of the number of variables of the Program */
+class SlotSet {
+public:
+    // New value of a slot changed by a branch
+    struct Change {
+        int slot;
+        unsigned char value;
+    };
+    using Changes = std::vector<Change>;
+
+    void assign(size_t n_slots, unsigned char value) {
+        flags.assign(n_slots, value);
+        pending.assign(n_slots, 0);
+        trail.clear();
+    }
+
+    size_t size() const { return flags.size(); }
+    unsigned char operator[](int slot) const { return flags[slot]; }
+
+    void set(int slot, unsigned char value = 1) {
+        if (flags[slot] == value) return;
+        trail.push_back(Change{ slot, flags[slot] });
+        flags[slot] = value;
+    }
+
+    // Mark of the current flags, restored by undo() and take()
+    size_t mark() const { return trail.size(); }
+
+    void undo(size_t m) {
+        while (trail.size() > m) {
+            flags[trail.back().slot] = trail.back().value;
+            trail.pop_back();
+        }
+    }
+
+    // Slots changed since the mark "m" with their current value
+    Changes since(size_t m) const {
+        Changes changes;
+        changes.reserve(trail.size() - m);
+        for (size_t i = m; i < trail.size(); i++) changes.push_back(Change{ trail[i].slot, flags[trail[i].slot] });
+        return changes;
+    }
+
+    // Slots changed since the mark "m" with their current value; the flags at the mark are restored
+    Changes take(size_t m) {
+        Changes changes = since(m);
+        undo(m);
+        return changes;
+    }
+
+    /* Merge of two branches taken from the current flags: each slot changed by one of them is set
+    to op(value after a, value after b), a branch that didn't change it giving the current value */
+    template <typename Op>
+    void merge(const Changes& a, const Changes& b, Op op) {
+        // pending: 0 slot not changed by a, 1 + value after a, DONE slot already merged
+        constexpr unsigned char DONE = 3;
+        for (const Change& c : a) pending[c.slot] = 1 + c.value;
+        for (const Change& c : b) {
+            if (pending[c.slot] == DONE) continue;
+            unsigned char value_a = pending[c.slot] ? pending[c.slot] - 1 : flags[c.slot];
+            pending[c.slot] = DONE;
+            set(c.slot, op(value_a, c.value));
+        }
+        for (const Change& c : a) {
+            if (pending[c.slot] != DONE) set(c.slot, op(c.value, flags[c.slot]));
+            pending[c.slot] = DONE;
+        }
+        for (const Change& c : a) pending[c.slot] = 0;
+        for (const Change& c : b) pending[c.slot] = 0;
+    }
+
+private:
+    std::vector<unsigned char> flags;
+    std::vector<unsigned char> pending; // scratch of merge(), all 0 between two calls
+    Changes trail;                      // slot and previous value of each change
+};
+
+#endif /* SLOT_SET_H */
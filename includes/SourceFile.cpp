@@ -0,0 +1,74 @@
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#include "SourceFile.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#define SOURCE_FILE_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+
+void SourceFile::open(const std::string& path) {
+    close();
+    failed = false;
+#ifdef SOURCE_FILE_MMAP
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        failed = true;
+        return;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        void* p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p != MAP_FAILED) {
+            ::close(fd);
+            data = static_cast<const char*>(p);
+            size = st.st_size;
+            mapped = true;
+            return;
+        }
+    }
+    // Not mappable: the contents are read until the end
+    char chunk[64 * 1024];
+    ssize_t n;
+    while ((n = ::read(fd, chunk, sizeof(chunk))) > 0) buffer.append(chunk, n);
+    /* A read error (e.g. on a directory) ends the text with the EOF character, which
+    std::ifstream::get() returned in this case without setting the end of file */
+    if (n < 0) buffer.push_back(static_cast<char>(std::char_traits<char>::eof()));
+    ::close(fd);
+#else
+    std::ifstream in{ path, std::ios::binary };
+    if (in.fail()) {
+        failed = true;
+        return;
+    }
+    buffer.assign(std::istreambuf_iterator<char>{ in }, std::istreambuf_iterator<char>{});
+#endif
+    data = buffer.data();
+    size = buffer.size();
+}
+
+void SourceFile::close() {
+#ifdef SOURCE_FILE_MMAP
+    if (mapped) munmap(const_cast<char*>(data), size);
+#endif
+    mapped = false;
+    data = nullptr;
+    size = 0;
+    buffer.clear();
+}
+
+
+uint64_t SourceFile::hash(std::string_view text) {
+    uint64_t h = 14695981039346656037ULL;
+    for (unsigned char c : text) {
+        h ^= c;
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
@@ -0,0 +1,40 @@
+#ifndef SOURCE_FILE_H
+#define SOURCE_FILE_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+
+/* Read-only contents of a source file.
+Regular files are mapped in memory with mmap (no copy); the other files (pipes, devices)
+and the platforms without mmap are read in a buffer */
+class SourceFile {
+public:
+    SourceFile() = default;
+    SourceFile(const std::string& path) { open(path); }
+    ~SourceFile() { close(); }
+
+    /* Deletion of the copy constructor and the assignment operator: the mapping has a single owner */
+    SourceFile(const SourceFile& other) = delete;
+    SourceFile& operator=(const SourceFile& other) = delete;
+
+    void open(const std::string& path);
+    void close();
+
+    // true if the last open() failed
+    bool fail() const { return failed; }
+    std::string_view text() const { return std::string_view{ data, size }; }
+
+    // FNV-1a hash of a text (the key of a source in the program caches)
+    static uint64_t hash(std::string_view text);
+
+private:
+    const char* data = nullptr;
+    size_t size = 0;
+    bool mapped = false;  // data comes from mmap, otherwise from buffer
+    bool failed = false;
+    std::string buffer;
+};
+
+#endif /* SOURCE_FILE_H */
@@ -0,0 +1,61 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+
+
+/* Lock-free ring of bytes shared by one producer thread and one consumer thread.
+The producer only moves "head" and the consumer only moves "tail": the bytes written before
+a release store of one of them are visible to the other thread after its acquire load */
+class SpscRing {
+public:
+    // capacity rounded up to a power of 2
+    explicit SpscRing(size_t capacity) {
+        cap = 1;
+        while (cap < capacity) cap <<= 1;
+        data.reset(new char[cap]);
+    }
+
+    // Deletion of copy constructor and assignment operator: the ring is shared by reference
+    SpscRing(const SpscRing& other) = delete;
+    SpscRing& operator=(const SpscRing& other) = delete;
+
+    /* PRODUCER: copy of at most n bytes of "src" in the free space.
+    It returns the number of bytes copied (0 if the ring is full) */
+    size_t push(const char* src, size_t n) {
+        size_t h = head.load(std::memory_order_relaxed);
+        size_t free_space = cap - (h - tail.load(std::memory_order_acquire));
+        if (n > free_space) n = free_space;
+        size_t first = n < cap - (h & (cap - 1)) ? n : cap - (h & (cap - 1));
+        std::memcpy(data.get() + (h & (cap - 1)), src, first);
+        std::memcpy(data.get(), src + first, n - first);
+        head.store(h + n, std::memory_order_release);
+        return n;
+    }
+
+    /* CONSUMER: contiguous bytes ready to be read, starting at "p" (0 if the ring is empty).
+    They stay in the ring until consume() */
+    size_t peek(const char*& p) const {
+        size_t t = tail.load(std::memory_order_relaxed);
+        size_t n = head.load(std::memory_order_acquire) - t;
+        size_t contiguous = cap - (t & (cap - 1));
+        p = data.get() + (t & (cap - 1));
+        return n < contiguous ? n : contiguous;
+    }
+
+    void consume(size_t n) { tail.store(tail.load(std::memory_order_relaxed) + n, std::memory_order_release); }
+
+    bool empty() const { return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire); }
+
+private:
+    std::unique_ptr<char[]> data;
+    size_t cap;
+    // positions grow without limit (the index in "data" is position & (cap - 1)); on separate cache lines
+    alignas(64) std::atomic<size_t> head{ 0 };
+    alignas(64) std::atomic<size_t> tail{ 0 };
+};
+
+#endif /* SPSC_RING_H */
@@ -10,18 +10,36 @@
 class Block;
 
 
-/* Statement superclass to identify the possible instructions */
+/* Statement superclass to identify the possible instructions.
+The nodes live in the NodeArena of a NodeFactory and are never deleted through the superclass */
 class Statement {
 public:
-    virtual ~Statement() {};
+    // Enumeration to identify the class of the node (see NumExpr::Kind)
+    enum Kind : uint8_t { SET, INPUT, PRINT, IF, WHILE };
+
+    Kind get_kind() const { return kind; }
+    // Line of the source where the statement starts (0 for the statements not made from a source)
+    uint32_t get_line() const { return line; }
+    void set_line(uint32_t l) { line = l; }
+
     virtual void accept(Visitor* v) = 0;
+
+protected:
+    Statement(Kind k) : kind{ k } {}
+    Statement(const Statement& other) = default;
+    Statement& operator=(const Statement& other) = default;
+    ~Statement() = default;
+
+private:
+    Kind kind;
+    uint32_t line = 0; // in the padding after "kind"
 };
 
 
 /* Class used to identify the instruction (SET variable_id num_expr) */
 class SetStmt : public Statement {
 public:
-    SetStmt(NumExpr* ne, Variable* va) : nexpr{ ne }, var{ va } {};
+    SetStmt(NumExpr* ne, Variable* va) : Statement(SET), nexpr{ ne }, var{ va } {};
     SetStmt(const SetStmt& other) = default;
     ~SetStmt() = default;
 
@@ -40,7 +58,7 @@ private:
 /* Class used to identify the instruction (INPUT variable_id) */
 class InputStmt : public Statement {
 public:
-    InputStmt(Variable* v) : var{ v } {};
+    InputStmt(Variable* v) : Statement(INPUT), var{ v } {};
     InputStmt(const InputStmt& other) = default;
     ~InputStmt() = default;
 
@@ -56,7 +74,7 @@ private:
 /* Class used to identify the instruction (PRINT num_expr) */
 class PrintStmt : public Statement {
 public:    
-    PrintStmt(NumExpr* ne) : nexpr{ ne } {};
+    PrintStmt(NumExpr* ne) : Statement(PRINT), nexpr{ ne } {};
     PrintStmt(const PrintStmt& other) = default;
     ~PrintStmt() = default;
 
@@ -72,7 +90,7 @@ private:
 /* CLass used to identify the instruction (IF bool_expr stmt_block1 stmt_block2) */
 class IfStmt : public Statement {
 public:
-    IfStmt(BoolExpr* be, Block* b1, Block* b2) : bexpr{ be }, stmt_block1{ b1 }, stmt_block2{ b2 } {};
+    IfStmt(BoolExpr* be, Block* b1, Block* b2) : Statement(IF), bexpr{ be }, stmt_block1{ b1 }, stmt_block2{ b2 } {};
     IfStmt(const IfStmt& other) = default;
     ~IfStmt() = default;
 
@@ -92,7 +110,7 @@ private:
 /* Class used to identify the instruction (WHILE bool_expr stmt_block) */
 class WhileStmt : public Statement {
 public:
-    WhileStmt(BoolExpr* be, Block* sb) : bexpr{ be }, stmt_block{ sb } {};
+    WhileStmt(BoolExpr* be, Block* sb) : Statement(WHILE), bexpr{ be }, stmt_block{ sb } {};
     WhileStmt(const WhileStmt& other) = default;
     ~WhileStmt() = default;
 
@@ -0,0 +1,120 @@
+#include "SwitchEvaluator.h"
+
+
+void SwitchEvaluator::run(Program* prg) {
+    // One slot for each VARIABLE_ID bound by the ResolveVisitor, all of them not declared yet
+    vars.assign(prg->get_n_vars(), 0);
+    declared.assign(prg->get_n_vars(), 0);
+    if (prg->get_is_not_empty()) exec(prg->get_blk());
+}
+
+
+/* STATEMENTS */
+void SwitchEvaluator::exec(Block* blk) {
+    StatementList stmts = blk->get_stmts();
+    if (stmts.size() == 0) throw SemanticError(SemanticMessage::emptyBlock());
+    for (Statement* s : stmts) exec(s);
+}
+
+void SwitchEvaluator::exec(Statement* s) {
+    switch (s->get_kind()) {
+        case Statement::SET: {
+            SetStmt* set = static_cast<SetStmt*>(s);
+            int64_t val = num(set->get_nexpr());
+            int slot = set->get_var()->get_slot();
+            vars[slot] = val;
+            declared[slot] = 1;
+            return;
+        }
+        case Statement::INPUT: {
+            Variable* v = static_cast<InputStmt*>(s)->get_var();
+            vars[v->get_slot()] = rt->input(v->get_id());
+            declared[v->get_slot()] = 1;
+            return;
+        }
+        case Statement::PRINT:
+            rt->print(num(static_cast<PrintStmt*>(s)->get_nexpr()));
+            return;
+        case Statement::IF: {
+            IfStmt* ifs = static_cast<IfStmt*>(s);
+            exec(cond(ifs->get_bexpr()) ? ifs->get_stmt_block1() : ifs->get_stmt_block2());
+            return;
+        }
+        case Statement::WHILE: {
+            WhileStmt* ws = static_cast<WhileStmt*>(s);
+            while (cond(ws->get_bexpr())) exec(ws->get_stmt_block());
+            return;
+        }
+    }
+}
+
+
+/* NUM_EXPR */
+inline int64_t SwitchEvaluator::operand(NumExpr* e) {
+    switch (e->get_kind()) {
+        case NumExpr::NUMBER: return static_cast<Number*>(e)->get_value();
+        case NumExpr::VARIABLE: return vars[static_cast<Variable*>(e)->get_slot()];
+        default: return num(e);
+    }
+}
+
+int64_t SwitchEvaluator::num(NumExpr* e) {
+    switch (e->get_kind()) {
+        case NumExpr::OPERATOR: {
+            Operator* opNode = static_cast<Operator*>(e);
+            int64_t fval = operand(opNode->getFirst());
+            int64_t sval = operand(opNode->getSecond());
+            switch (opNode->getOp()) {
+                case Operator::ADD: return fval + sval;
+                case Operator::SUB: return fval - sval;
+                case Operator::MUL: return fval * sval;
+                case Operator::DIV:
+                    if (sval == 0) throw SemanticError(SemanticMessage::divisionByZero());
+                    return fval / sval;
+                default: return 0;
+            }
+        }
+        case NumExpr::NUMBER:
+            return static_cast<Number*>(e)->get_value();
+        case NumExpr::VARIABLE:
+            // Read of a variable surely declared (see DefiniteAssignment)
+            return vars[static_cast<Variable*>(e)->get_slot()];
+        case NumExpr::CHECKED_VARIABLE: {
+            CheckedVariable* v = static_cast<CheckedVariable*>(e);
+            if (!declared[v->get_slot()]) throw SemanticError(v->undeclaredMessage());
+            return vars[v->get_slot()];
+        }
+    }
+    return 0;
+}
+
+
+/* BOOL_EXPR */
+bool SwitchEvaluator::cond(BoolExpr* e) {
+    switch (e->get_kind()) {
+        case BoolExpr::REL_OP: {
+            RelOp* rop = static_cast<RelOp*>(e);
+            int64_t fval = operand(rop->get_first_nexpr());
+            int64_t sval = operand(rop->get_second_nexpr());
+            switch (rop->get_r_opcode()) {
+                case RelOp::LT: return fval < sval;
+                case RelOp::GT: return fval > sval;
+                case RelOp::EQ: return fval == sval;
+                default: return false;
+            }
+        }
+        case BoolExpr::BOOL_CONST:
+            return static_cast<BoolConst*>(e)->get_bconst() == BoolConst::TRUE;
+        case BoolExpr::BOOL_OP: {
+            BoolOp* bop = static_cast<BoolOp*>(e);
+            // short-circuit: the 2nd operand is evaluated only if necessary
+            switch (bop->get_b_opcode()) {
+                case BoolOp::AND: return cond(bop->get_f_bexpr()) && cond(bop->get_s_bexpr());
+                case BoolOp::OR: return cond(bop->get_f_bexpr()) || cond(bop->get_s_bexpr());
+                case BoolOp::NOT: return !cond(bop->get_f_bexpr());
+                default: return false;
+            }
+        }
+    }
+    return false;
+}
@@ -0,0 +1,39 @@
+#ifndef SWITCH_EVALUATOR_H
+#define SWITCH_EVALUATOR_H
+
+#include <cstdint>
+#include <vector>
+
+#include "Program.h"
+#include "Runtime.h"
+#include "Exceptions.h"
+
+
+/* Evaluator of a resolved Program (see ResolveVisitor) walking the syntax tree without the Visitor:
+the set of the nodes is closed, so statements, NUM_EXPR and BOOL_EXPR are executed by three
+functions switching on the kind of the node, and the values are returned instead of being
+pushed on an accumulator. Errors and their messages are the same as the EvaluationVisitor */
+class SwitchEvaluator {
+public:
+    SwitchEvaluator() : SwitchEvaluator(&Runtime::standard()) {}
+    SwitchEvaluator(Runtime* r) : rt{ r } {}
+    SwitchEvaluator(const SwitchEvaluator& other) = default;
+    ~SwitchEvaluator() = default;
+    SwitchEvaluator& operator=(const SwitchEvaluator& other) = default;
+
+    void run(Program* prg);
+
+private:
+    Runtime* rt; // services used by INPUT and PRINT
+    std::vector<int64_t> vars; // flat storage of the variables, indexed by the slot assigned by the ResolveVisitor
+    std::vector<unsigned char> declared; // flag for each slot set when the variable gets its first value
+
+    void exec(Block* blk);
+    void exec(Statement* s);
+    int64_t num(NumExpr* e);
+    bool cond(BoolExpr* e);
+    // Value of an operand: the leaves are evaluated in place, the Operators by num()
+    int64_t operand(NumExpr* e);
+};
+
+#endif /* SWITCH_EVALUATOR_H */
@@ -7,7 +7,8 @@
 #include "Token.h"
 
 /* Function object to perform tokenize phase given a file in input.
-It returns a std::vector containing the read tokens */
+It returns a std::vector containing the read tokens.
+The interpreter reads the sources with the Lexer, which follows the same rules without the std::vector */
 class Tokenizer {
 public:
     std::vector<Token> operator()(std::ifstream& inputFile) {
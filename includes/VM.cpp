@@ -0,0 +1,146 @@
+#include "VM.h"
+
+
+/* With GCC and Clang the dispatch uses the "labels as values" extension: each handler jumps
+directly to the handler of the next instruction (one indirect branch for each opcode, easier
+to predict than the single branch of a switch). Otherwise it falls back to a switch */
+#if defined(__GNUC__)
+#define VM_COMPUTED_GOTO 1
+#endif
+
+#ifdef VM_COMPUTED_GOTO
+#define VM_DISPATCH() goto *labels[static_cast<int>((ip = code + pc++)->op)]
+#define VM_CASE(op) L_##op:
+#else
+#define VM_DISPATCH() break
+#define VM_CASE(op) case OpCode::op:
+#endif
+
+
+void VirtualMachine::run(const Chunk& chunk) {
+    stack.assign(chunk.max_stack + 1, 0);
+    vars.assign(chunk.var_ids.size(), 0);
+    declared.assign(chunk.var_ids.size(), 0);
+
+    const Instruction* code = chunk.code.data();
+    const int64_t* constants = chunk.constants.data();
+    int64_t* sp = stack.data(); // first free position of the stack
+    int64_t* v = vars.data();
+    unsigned char* decl = declared.data();
+    const Instruction* ip;
+    int32_t pc = 0;
+
+#ifdef VM_COMPUTED_GOTO
+    // Handlers in the same order of the OpCode enumeration
+    static void* labels[] = {
+        &&L_CONST, &&L_LOAD, &&L_LOAD_CHECKED, &&L_STORE, &&L_INPUT, &&L_PRINT,
+        &&L_ADD, &&L_SUB, &&L_MUL, &&L_DIV, &&L_LT, &&L_GT, &&L_EQ, &&L_NOT,
+        &&L_JUMP, &&L_JUMP_IF_FALSE, &&L_JUMP_IF_TRUE, &&L_JUMP_IF_FALSE_OR_POP, &&L_JUMP_IF_TRUE_OR_POP,
+        &&L_FAIL, &&L_HALT, &&L_NULL_VAL
+    };
+    VM_DISPATCH();
+#else
+    for (;;) {
+        ip = code + pc++;
+        switch (ip->op) {
+#endif
+
+    VM_CASE(CONST)
+        *sp++ = constants[ip->arg];
+        VM_DISPATCH();
+
+    VM_CASE(LOAD)
+        *sp++ = v[ip->arg];
+        VM_DISPATCH();
+
+    VM_CASE(LOAD_CHECKED) {
+        const ReadCheck& chk = chunk.checks[ip->arg];
+        if (!decl[chk.slot]) throw SemanticError(chk.message);
+        *sp++ = v[chk.slot];
+        VM_DISPATCH();
+    }
+
+    VM_CASE(STORE)
+        v[ip->arg] = *--sp;
+        decl[ip->arg] = 1;
+        VM_DISPATCH();
+
+    VM_CASE(INPUT)
+        v[ip->arg] = rt->input(chunk.var_ids[ip->arg]);
+        decl[ip->arg] = 1;
+        VM_DISPATCH();
+
+    VM_CASE(PRINT)
+        rt->print(*--sp);
+        VM_DISPATCH();
+
+    VM_CASE(ADD)
+        sp--; sp[-1] = sp[-1] + sp[0];
+        VM_DISPATCH();
+
+    VM_CASE(SUB)
+        sp--; sp[-1] = sp[-1] - sp[0];
+        VM_DISPATCH();
+
+    VM_CASE(MUL)
+        sp--; sp[-1] = sp[-1] * sp[0];
+        VM_DISPATCH();
+
+    VM_CASE(DIV)
+        sp--;
+        if (sp[0] == 0) throw SemanticError(SemanticMessage::divisionByZero());
+        sp[-1] = sp[-1] / sp[0];
+        VM_DISPATCH();
+
+    VM_CASE(LT)
+        sp--; sp[-1] = sp[-1] < sp[0];
+        VM_DISPATCH();
+
+    VM_CASE(GT)
+        sp--; sp[-1] = sp[-1] > sp[0];
+        VM_DISPATCH();
+
+    VM_CASE(EQ)
+        sp--; sp[-1] = sp[-1] == sp[0];
+        VM_DISPATCH();
+
+    VM_CASE(NOT)
+        sp[-1] = !sp[-1];
+        VM_DISPATCH();
+
+    VM_CASE(JUMP)
+        pc = ip->arg;
+        VM_DISPATCH();
+
+    VM_CASE(JUMP_IF_FALSE)
+        if (!*--sp) pc = ip->arg;
+        VM_DISPATCH();
+
+    VM_CASE(JUMP_IF_TRUE)
+        if (*--sp) pc = ip->arg;
+        VM_DISPATCH();
+
+    VM_CASE(JUMP_IF_FALSE_OR_POP)
+        if (!sp[-1]) pc = ip->arg;
+        else sp--;
+        VM_DISPATCH();
+
+    VM_CASE(JUMP_IF_TRUE_OR_POP)
+        if (sp[-1]) pc = ip->arg;
+        else sp--;
+        VM_DISPATCH();
+
+    VM_CASE(FAIL)
+        throw SemanticError(chunk.errors[ip->arg]);
+
+    VM_CASE(HALT)
+        return;
+
+    VM_CASE(NULL_VAL)
+        return;
+
+#ifndef VM_COMPUTED_GOTO
+        }
+    }
+#endif
+}
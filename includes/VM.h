@@ -0,0 +1,32 @@
+#ifndef VM_H
+#define VM_H
+
+#include <cstdint>
+#include <vector>
+
+#include "Bytecode.h"
+#include "Runtime.h"
+#include "Exceptions.h"
+
+
+/* Stack based virtual machine executing the Chunk produced by the BytecodeCompiler.
+The variables live in a flat array indexed by slot and the values in a stack whose size
+is computed by the compiler, so the dispatch loop never allocates */
+class VirtualMachine {
+public:
+    VirtualMachine() : VirtualMachine(&Runtime::standard()) {}
+    VirtualMachine(Runtime* r) : rt{ r } {}
+    VirtualMachine(const VirtualMachine& other) = default;
+    ~VirtualMachine() = default;
+    VirtualMachine& operator=(const VirtualMachine& other) = default;
+
+    void run(const Chunk& chunk);
+
+private:
+    Runtime* rt; // services used by INPUT and PRINT
+    std::vector<int64_t> stack;
+    std::vector<int64_t> vars;
+    std::vector<unsigned char> declared;
+};
+
+#endif /* VM_H */
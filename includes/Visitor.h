@@ -5,13 +5,13 @@
 #include <iostream>
 #include <string>
 #include <sstream>
-#include <map>
 
 #include "Program.h"
 #include "Block.h"
 #include "Statement.h"
 #include "NumExpr.h"
 #include "Exceptions.h"
+#include "Runtime.h"
 
 
 /* Superclass visitor made for visit the syntactic tree */
@@ -33,6 +33,8 @@ public:
     virtual void visitOperator(Operator* opNode) = 0;
     virtual void visitNumber(Number* numNode) = 0;
     virtual void visitVariable(Variable* varNode) = 0;
+    // A read whose declaration is checked is a Variable for the visitors that don't tell them apart
+    virtual void visitCheckedVariable(CheckedVariable* varNode) { visitVariable(varNode); }
 
     virtual void visitRelOp(RelOp* rop) = 0;
     virtual void visitBoolConst(BoolConst* bconst) = 0;
@@ -54,7 +56,7 @@ public:
 
     void visitBlock(Block* blk) override {
         std::cout << "(BLOCK" << std::endl;
-        std::vector<Statement*> stmts = blk->get_stmts();
+        StatementList stmts = blk->get_stmts();
         auto i = stmts.begin();
         for (; i != stmts.end(); i++) {
             std::cout << "\t";
@@ -141,21 +143,25 @@ public:
 /* Class that extends Visitor superclass to visit and evaluate the sintactic tree */
 class EvaluationVisitor : public Visitor {
 public: 
-    EvaluationVisitor() : accumulator{ } {}
+    EvaluationVisitor() : EvaluationVisitor(&Runtime::standard()) {}
+    EvaluationVisitor(Runtime* r) : rt{ r }, accumulator{ }, vars{ }, declared{ } {}
     EvaluationVisitor(const EvaluationVisitor& other) = default;
     ~EvaluationVisitor() = default;
     EvaluationVisitor& operator=(const EvaluationVisitor& other) = default;
    
     void visitProgram(Program* prg) override {
+        // One slot for each VARIABLE_ID bound by the ResolveVisitor, all of them not declared yet
+        vars.assign(prg->get_n_vars(), 0);
+        declared.assign(prg->get_n_vars(), 0);
         if (prg->get_is_not_empty()) {
             prg->get_blk()->accept(this);
         }
     }
 
     void visitBlock(Block* blk) override {
-        std::vector<Statement*> stmts = blk->get_stmts();
+        StatementList stmts = blk->get_stmts();
         unsigned int vecSize = stmts.size();
-        if (vecSize == 0) throw SemanticError("(ERROR (semantic): empty block given )");
+        if (vecSize == 0) throw SemanticError(SemanticMessage::emptyBlock());
         // Visit of each statement in the analysed block
         for(unsigned int i = 0; i < vecSize; i++) 
             stmts[i]->accept(this);
@@ -169,72 +175,28 @@ public:
         s->get_nexpr()->accept(this); // NUM_EXPR visit
 
         int64_t val = accumulator.back(); accumulator.pop_back();
-        v->set_value(val);
-
-        // VARIABLE_ID look up 
-        std::map<std::string, int64_t>::iterator it = vars.find(v->get_id());
-        /* If the variable has been already declared, the value "val" is assigned to it.
-        Otherwise it's created. */
-        if (it != vars.end()) it->second = val;
-        else vars.insert(std::pair<std::string, int64_t>(v->get_id(), v->get_value()));
+
+        // The value "val" is written in the slot of the variable, which is declared from now on
+        vars[v->get_slot()] = val;
+        declared[v->get_slot()] = 1;
     }
 
     void visitInput(InputStmt* s) override {
-        std::string tmp_input;
-        std::cout << "INPUT \"" << s->get_var()->get_id() << "\": ";
-        std::cin >> tmp_input;
-
-        bool valid_input = 1; // flag to verify the correctness of the value given in input
-        if (((tmp_input[0] == '0') && tmp_input.size() > 1) 
-                || (tmp_input[0] == '-' && tmp_input.size() > 2 && tmp_input[1] == '0' )) {
-            // value not valid because is made of a 0 followed by other significant digits
-            // or a '-', followed by a 0, followed by significant digits
-            valid_input = 0; 
-        } else {
-            // analysis that each character given in input is a number
-            for (char c : tmp_input) {
-                if ((c < 48 || c > 57) && c != '-') {
-                    valid_input = 0;
-                    break;
-                }
-            }
-        }
-
-        if (valid_input) {
-            // std::string to int64_t conversion
-            int64_t tmp = std::stoll(tmp_input);
-
-            Variable* v = s->get_var();
-            /* VARIABLE_ID look up in vars map.
-            If it's already there, the value given in input is assigned to it.
-            Otherwise the variable is created. */
-            std::map<std::string, int64_t>::iterator it = vars.find(v->get_id());
-            if (it != vars.end()) it->second = tmp;
-            else vars.insert(std::pair<std::string, int64_t>(v->get_id(), tmp));
-
-        } else {
-            std::stringstream tmp{};
-            tmp << "(ERROR (semantic): input value can only be a NUMBER and significant digits can't be after a series of 0, \"" << tmp_input << "\" given )";
-            throw SemanticError(tmp.str());
-        }
+        Variable* v = s->get_var();
+        // Value given in input (its validation is performed by the Runtime)
+        int64_t tmp = rt->input(v->get_id());
+        // The value given in input is written in the slot of the variable, which is declared from now on
+        vars[v->get_slot()] = tmp;
+        declared[v->get_slot()] = 1;
     }
 
     void visitPrint(PrintStmt* s) override {
-        // dynamic_cast<Variable*> used to verify if the NumExpr* in the statement is a Variable* object: if so, dynamic_cast returns a pointer other than nullptr 
-        if (dynamic_cast<Variable*> (s->get_nexpr()) != nullptr) {
-            // Look up if a variable has already been declared before (dynamic_cast is necessary to call "get_id()" method of Variable class)
-            if (vars.find(dynamic_cast<Variable*> (s->get_nexpr())->get_id()) != vars.end()) 
-                s->get_nexpr()->accept(this);
-            else {
-                std::stringstream tmp{};
-                tmp << "(ERROR (semantic): PRINT of VARIABLE_ID \"" << dynamic_cast<Variable*> (s->get_nexpr())->get_id() << "\" not declared before )";
-                throw SemanticError(tmp.str());   
-            } 
-        } else s->get_nexpr()->accept(this);
+        // NUM_EXPR visit (a variable not declared before is reported by its CheckedVariable node)
+        s->get_nexpr()->accept(this);
 
         // Print of the value using the accumulator
         int64_t val = accumulator.back(); accumulator.pop_back();
-        std::cout << val << std::endl;
+        rt->print(val);
     }
     
     void visitIf(IfStmt* s) override {
@@ -268,34 +230,10 @@ public:
     /* NUM_EXPR */
     void visitOperator(Operator* opNode) override {
         Operator::OpCode op_code = opNode->getOp();
-        NumExpr* first = opNode->getFirst();
-
-        // dynamic_cast<Variable*> used to verify if the NumExpr* in statement is a Variable* object: if so, dynamic_cast returns a pointer other than nullptr
-        if (dynamic_cast<Variable*> (first) != nullptr) {
-            // Look up if the variable has already been declared before (dynamic_cast is needed to call "get_id()" method of the Variable class)
-            if (vars.find(dynamic_cast<Variable*> (first)->get_id()) != vars.end()) 
-                first->accept(this);
-            else {
-                std::stringstream tmp{};
-                tmp << "(ERROR (semantic): ARITHMETIC_OPERATOR \"" << Operator::opCode2String(op_code) << "\" is using VARIABLE_ID \"" << dynamic_cast<Variable*> (first)->get_id() << "\" not declared before )";
-                throw SemanticError(tmp.str());   
-            } 
-        } else first->accept(this);
-        
-
-        NumExpr* second = opNode->getSecond();
-        // dynamic_cast<Variable*> used to verify if the NumExpr* in statement is a Variable* object: if so, dynamic_cast returns a pointer other than nullptr
-        if (dynamic_cast<Variable*> (second) != nullptr) {
-            // Look up if the variable has already been declared before (dynamic_cast is needed to call "get_id()" method of the Variable class)
-            if (vars.find(dynamic_cast<Variable*> (second)->get_id()) != vars.end()) 
-                second->accept(this);
-            else {
-                std::stringstream tmp{};
-                tmp << "(ERROR (semantic): ARITHMETIC_OPERATOR \"" << Operator::opCode2String(op_code) << "\" is using VARIABLE_ID \"" << dynamic_cast<Variable*> (second)->get_id() << "\" not declared before )";
-                throw SemanticError(tmp.str());   
-            } 
-        } else second->accept(this);
-        
+        // Visit of the two operands (a variable not declared before is reported by its CheckedVariable node)
+        opNode->getFirst()->accept(this);
+        opNode->getSecond()->accept(this);
+
         // Read the two values calculated from the accumulator
         int64_t sval = accumulator.back();
         accumulator.pop_back();
@@ -311,7 +249,7 @@ public:
                 accumulator.push_back(fval * sval); return;
             case Operator::DIV:
                 if (sval != 0) accumulator.push_back(fval / sval); 
-                else throw SemanticError("(ERROR (semantic): DIV by 0 )"); 
+                else throw SemanticError(SemanticMessage::divisionByZero()); 
                 return;
             default: return; 
         }
@@ -322,48 +260,25 @@ public:
     }
 
     void visitVariable(Variable* varNode) override {
-        // Look up of the variable and writing the value on the accumulator
-        std::map<std::string, int64_t>::const_iterator it = vars.find(varNode->get_id());
-        if (it != vars.end()) {
-            accumulator.push_back(it->second);
-        } else {
-            std::stringstream tmp{};
-            tmp << "(ERROR (semantic): variable \"" << varNode->get_id() << "\" NOT declared before )" << std::endl;
-            throw SemanticError(tmp.str());
-        }
+        // Read of the slot of a variable surely declared (see DefiniteAssignment) and writing the value on the accumulator
+        accumulator.push_back(vars[varNode->get_slot()]);
+    }
+
+    void visitCheckedVariable(CheckedVariable* varNode) override {
+        // Read of the slot of the variable, if it has already been declared before
+        if (declared[varNode->get_slot()]) {
+            accumulator.push_back(vars[varNode->get_slot()]);
+        } else throw SemanticError(varNode->undeclaredMessage());
     }
 
 
     /* ============ BOOL_EXPR ============*/
     void visitRelOp(RelOp* rop) override { 
         RelOp::RelOpCode r_opcode = rop->get_r_opcode();
-        NumExpr* f_nexpr = rop->get_first_nexpr();
-
-        // dynamic_cast<Variable*> used to verify if the NumExpr* in the statement is a Variable* object: if so, dynamic_cast returns a value other than nullptr
-        if (dynamic_cast<Variable*> (f_nexpr) != nullptr) {
-            // Look up if the variable has already been declared before (dynamic_cast is needed to call "get_id()" method of the Variable class)
-            if (vars.find(dynamic_cast<Variable*> (f_nexpr)->get_id()) != vars.end()) 
-                f_nexpr->accept(this); 
-            else {
-                std::stringstream tmp{};
-                tmp << "(ERROR (semantic): REL_OP \"" << RelOp::relOpCode2String(r_opcode) << "\" is using VARIABLE_ID \"" << dynamic_cast<Variable*> (f_nexpr)->get_id() << "\" not declared before )";
-                throw SemanticError(tmp.str());   
-            } 
-        } else f_nexpr->accept(this);
-
-        NumExpr* s_nexpr = rop->get_second_nexpr();
-        // dynamic_cast<Variable*> used to verify if the NumExpr* in the statement is a Variable* object: if so, dynamic_cast returns a value other than nullptr
-        if (dynamic_cast<Variable*> (s_nexpr) != nullptr) {
-            // Look up if the variable has already been declared before (dynamic_cast is needed to call "get_id()" method of the Variable class)
-            if (vars.find(dynamic_cast<Variable*> (s_nexpr)->get_id()) != vars.end()) 
-                s_nexpr->accept(this);
-            else {
-                std::stringstream tmp{};
-                tmp << "(ERROR (semantic): REL_OP \""  << RelOp::relOpCode2String(r_opcode) << "\" is using VARIABLE_ID \"" << dynamic_cast<Variable*> (s_nexpr)->get_id() << "\" not declared before )";
-                throw SemanticError(tmp.str());   
-            } 
-        } else s_nexpr->accept(this);
-        
+        // Visit of the two operands (a variable not declared before is reported by its CheckedVariable node)
+        rop->get_first_nexpr()->accept(this);
+        rop->get_second_nexpr()->accept(this);
+
         // Read from the accumulator of the two values calculated 
         int64_t sval = accumulator.back(); accumulator.pop_back();
         int64_t fval = accumulator.back(); accumulator.pop_back();
@@ -425,9 +340,15 @@ public:
         }
     }
 
+protected:
+    // Values computed and not yet used by their expression or statement
+    size_t get_accumulator_depth() const { return accumulator.size(); }
+
 private:
+    Runtime* rt; // services used by INPUT and PRINT
     std::vector<int64_t> accumulator; // stack method to store int values (int64_t) 
-    std::map<std::string, int64_t> vars; // use of std::map to store and manage the variables as combination of a std::string (VARIABLE_ID) and an int64_t (VARIABLE_VALUE)
+    std::vector<int64_t> vars; // flat storage of the variables, indexed by the slot assigned by the ResolveVisitor (VARIABLE_VALUE)
+    std::vector<unsigned char> declared; // flag for each slot set when the variable gets its first value
 };
 
 #endif /* VISITOR_H */
\ No newline at end of file
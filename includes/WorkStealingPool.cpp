@@ -0,0 +1,68 @@
+#include "WorkStealingPool.h"
+
+
+WorkStealingPool::WorkStealingPool(unsigned int n_threads) {
+    if (n_threads == 0) n_threads = 1;
+    for (unsigned int i = 0; i < n_threads; i++) workers.emplace_back(new Worker{});
+    for (unsigned int i = 0; i < n_threads; i++) threads.emplace_back(&WorkStealingPool::loop, this, i);
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lock{ idle_m };
+        stop = true;
+    }
+    idle_cv.notify_all();
+    for (std::thread& t : threads) t.join();
+}
+
+void WorkStealingPool::submit(Task task) {
+    Worker& w = *workers[next.fetch_add(1, std::memory_order_relaxed) % workers.size()];
+    {
+        std::lock_guard<std::mutex> lock{ w.m };
+        w.tasks.push_back(std::move(task));
+    }
+    {
+        std::lock_guard<std::mutex> lock{ idle_m };
+        pending.fetch_add(1, std::memory_order_release);
+    }
+    idle_cv.notify_one();
+}
+
+unsigned int WorkStealingPool::defaultThreads() {
+    unsigned int n = std::thread::hardware_concurrency();
+    return (n == 0) ? 1 : n;
+}
+
+
+bool WorkStealingPool::take(unsigned int self, Task& task) {
+    // own deque first (back), then the others (front), starting from the next worker
+    for (size_t k = 0; k < workers.size(); k++) {
+        Worker& w = *workers[(self + k) % workers.size()];
+        std::lock_guard<std::mutex> lock{ w.m };
+        if (w.tasks.empty()) continue;
+        if (k == 0) {
+            task = std::move(w.tasks.back());
+            w.tasks.pop_back();
+        } else {
+            task = std::move(w.tasks.front());
+            w.tasks.pop_front();
+        }
+        pending.fetch_sub(1, std::memory_order_acq_rel);
+        return true;
+    }
+    return false;
+}
+
+void WorkStealingPool::loop(unsigned int self) {
+    for (;;) {
+        Task task;
+        if (take(self, task)) {
+            task();
+            continue;
+        }
+        std::unique_lock<std::mutex> lock{ idle_m };
+        idle_cv.wait(lock, [this] { return stop || pending.load(std::memory_order_acquire) > 0; });
+        if (stop && pending.load(std::memory_order_acquire) == 0) return;
+    }
+}
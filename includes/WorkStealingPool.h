@@ -0,0 +1,58 @@
+#ifndef WORK_STEALING_POOL_H
+#define WORK_STEALING_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+/* Pool of threads running tasks. Each worker has its own deque: it takes its tasks from the back
+(the most recent one) and, when its deque is empty, steals the oldest task from the front of the
+deque of another worker, so the load stays balanced without a queue shared by all the threads.
+The tasks must not throw */
+class WorkStealingPool {
+public:
+    using Task = std::function<void()>;
+
+    explicit WorkStealingPool(unsigned int n_threads);
+    // The tasks submitted are all run before the threads end
+    ~WorkStealingPool();
+
+    // Deletion of copy constructor and assignment operator: the threads have a single owner
+    WorkStealingPool(const WorkStealingPool& other) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool& other) = delete;
+
+    // The task is given to the workers in turn
+    void submit(Task task);
+
+    unsigned int get_n_threads() const { return threads.size(); }
+
+    // Number of hardware threads (1 if it is not known)
+    static unsigned int defaultThreads();
+
+private:
+    struct Worker {
+        std::mutex m;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<std::thread> threads;
+    std::atomic<unsigned int> next{ 0 }; // worker receiving the next task
+
+    // the idle workers sleep until a task is submitted (pending is changed only under idle_m when it grows)
+    std::mutex idle_m;
+    std::condition_variable idle_cv;
+    std::atomic<size_t> pending{ 0 };
+    bool stop = false;
+
+    void loop(unsigned int self);
+    bool take(unsigned int self, Task& task);
+};
+
+#endif /* WORK_STEALING_POOL_H */
@@ -0,0 +1,114 @@
+#ifndef X86_ASSEMBLER_H
+#define X86_ASSEMBLER_H
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+
+/* Minimal x86-64 assembler used by the JitCompiler: it encodes only the instructions
+needed by the generated code (64bit integer arithmetic, comparisons, jumps, calls) */
+class X86Assembler {
+public:
+    /* Enumeration of the general purpose registers with their hardware number */
+    enum Reg { RAX, RCX, RDX, RBX, RSP, RBP, RSI, RDI, R8, R9, R10, R11, R12, R13, R14, R15 };
+
+    /* Condition codes of the conditional jumps */
+    enum Cond { OVERFLOW = 0x0, EQUAL = 0x4, NOT_EQUAL = 0x5, LESS = 0xC, GREATER_EQUAL = 0xD, LESS_EQUAL = 0xE, GREATER = 0xF };
+
+    /* Position in the code that can be the destination of jumps emitted before it is bound */
+    struct Label {
+        int pos = -1;
+        std::vector<int> fixups; // positions of the rel32 fields waiting for the label
+    };
+
+    X86Assembler() = default;
+    X86Assembler(const X86Assembler& other) = delete;
+    X86Assembler& operator=(const X86Assembler& other) = delete;
+
+    const std::vector<uint8_t>& get_code() const { return code; }
+    int size() const { return static_cast<int>(code.size()); }
+
+    static Cond negate(Cond c) { return static_cast<Cond>(c ^ 1); }
+
+    void bind(Label& l) {
+        l.pos = size();
+        for (int at : l.fixups) patch32(at, l.pos - (at + 4));
+        l.fixups.clear();
+    }
+
+    /* DATA MOVEMENT */
+    void mov(Reg dst, Reg src) { rex(true, src, dst); byte(0x89); modrmReg(src, dst); }
+    void movImm(Reg dst, int64_t imm) {
+        if (imm >= INT32_MIN && imm <= INT32_MAX) {
+            // mov r/m64, imm32 (sign extended)
+            rex(true, RAX, dst); byte(0xC7); modrmReg(RAX, dst); imm32(static_cast<int32_t>(imm));
+        } else {
+            rex(true, RAX, dst); byte(0xB8 + (dst & 7)); imm64(imm);
+        }
+    }
+    void load(Reg dst, Reg base, int32_t disp) { rex(true, dst, base); byte(0x8B); modrmMem(dst, base, disp); }
+    void store(Reg base, int32_t disp, Reg src) { rex(true, src, base); byte(0x89); modrmMem(src, base, disp); }
+    void storeByte(Reg base, int32_t disp, uint8_t imm) { rex(false, RAX, base); byte(0xC6); modrmMem(RAX, base, disp); byte(imm); }
+    void push(Reg r) { if (r >= R8) byte(0x41); byte(0x50 + (r & 7)); }
+    void pop(Reg r) { if (r >= R8) byte(0x41); byte(0x58 + (r & 7)); }
+    void xor32(Reg dst, Reg src) { rex(false, src, dst); byte(0x31); modrmReg(src, dst); }
+
+    /* ARITHMETIC (dst = dst op src) */
+    void add(Reg dst, Reg src) { rex(true, dst, src); byte(0x03); modrmReg(dst, src); }
+    void sub(Reg dst, Reg src) { rex(true, dst, src); byte(0x2B); modrmReg(dst, src); }
+    void imul(Reg dst, Reg src) { rex(true, dst, src); byte(0x0F); byte(0xAF); modrmReg(dst, src); }
+    void cmp(Reg a, Reg b) { rex(true, a, b); byte(0x3B); modrmReg(a, b); }
+    void test(Reg a, Reg b) { rex(true, b, a); byte(0x85); modrmReg(b, a); }
+    void addMem(Reg dst, Reg base, int32_t disp) { rex(true, dst, base); byte(0x03); modrmMem(dst, base, disp); }
+    void subMem(Reg dst, Reg base, int32_t disp) { rex(true, dst, base); byte(0x2B); modrmMem(dst, base, disp); }
+    void imulMem(Reg dst, Reg base, int32_t disp) { rex(true, dst, base); byte(0x0F); byte(0xAF); modrmMem(dst, base, disp); }
+    void cmpMem(Reg a, Reg base, int32_t disp) { rex(true, a, base); byte(0x3B); modrmMem(a, base, disp); }
+    void addImm(Reg dst, int32_t imm) { rex(true, RAX, dst); byte(0x81); modrmReg(static_cast<Reg>(0), dst); imm32(imm); }
+    void subImm(Reg dst, int32_t imm) { rex(true, RAX, dst); byte(0x81); modrmReg(static_cast<Reg>(5), dst); imm32(imm); }
+    void cmpImm(Reg a, int32_t imm) { rex(true, RAX, a); byte(0x81); modrmReg(static_cast<Reg>(7), a); imm32(imm); }
+    void imulImm(Reg dst, Reg src, int32_t imm) { rex(true, dst, src); byte(0x69); modrmReg(dst, src); imm32(imm); }
+    void cmpByteImm(Reg base, int32_t disp, uint8_t imm) { rex(false, static_cast<Reg>(0), base); byte(0x80); modrmMem(static_cast<Reg>(7), base, disp); byte(imm); }
+    // rdx:rax = sign extension of rax, then rax = rdx:rax / src
+    void cqo() { byte(0x48); byte(0x99); }
+    void idiv(Reg src) { rex(true, RAX, src); byte(0xF7); modrmReg(static_cast<Reg>(7), src); }
+
+    /* CONTROL FLOW */
+    void jmp(Label& l) { byte(0xE9); rel32(l); }
+    void jcc(Cond c, Label& l) { byte(0x0F); byte(0x80 + c); rel32(l); }
+    // Absolute call through RAX (the destination can be anywhere in the address space)
+    void call(const void* fn) { movImm(RAX, static_cast<int64_t>(reinterpret_cast<intptr_t>(fn))); byte(0xFF); byte(0xD0); }
+    void ret() { byte(0xC3); }
+    // lea rsp, [rbp + disp8]
+    void leaRspFromRbp(int8_t disp) { byte(0x48); byte(0x8D); byte(0x65); byte(static_cast<uint8_t>(disp)); }
+
+private:
+    std::vector<uint8_t> code;
+
+    void byte(uint8_t b) { code.push_back(b); }
+    void imm32(int32_t v) { uint8_t b[4]; std::memcpy(b, &v, 4); code.insert(code.end(), b, b + 4); }
+    void imm64(int64_t v) { uint8_t b[8]; std::memcpy(b, &v, 8); code.insert(code.end(), b, b + 8); }
+    void patch32(int at, int32_t v) { std::memcpy(&code[at], &v, 4); }
+
+    void rel32(Label& l) {
+        int at = size();
+        imm32(0);
+        if (l.pos >= 0) patch32(at, l.pos - (at + 4));
+        else l.fixups.push_back(at);
+    }
+
+    // REX prefix: W for 64bit operands, R extends the ModRM reg field, B extends the ModRM r/m (or base) field
+    void rex(bool w, Reg reg, Reg rm) {
+        uint8_t r = 0x40 | (w ? 0x08 : 0) | ((reg >= R8) ? 0x04 : 0) | ((rm >= R8) ? 0x01 : 0);
+        if (r != 0x40) byte(r);
+    }
+    void modrmReg(Reg reg, Reg rm) { byte(0xC0 | ((reg & 7) << 3) | (rm & 7)); }
+    // [base + disp32]; RSP and R12 as base require the SIB byte
+    void modrmMem(Reg reg, Reg base, int32_t disp) {
+        byte(0x80 | ((reg & 7) << 3) | (base & 7));
+        if ((base & 7) == RSP) byte(0x24);
+        imm32(disp);
+    }
+};
+
+#endif /* X86_ASSEMBLER_H */
@@ -1,95 +1,197 @@
 #include <iostream>
 #include <string>
 #include <stdlib.h>
-#include <fstream>
+#include <memory>
 
-#include "includes/Token.h"
-#include "includes/Tokenizer.h"
+#include "includes/SourceFile.h"
 #include "includes/Exceptions.h"
-#include "includes/Parser.h"
-#include "includes/Visitor.h"
+#include "includes/Options.h"
+#include "includes/OutputSink.h"
+#include "includes/InputSource.h"
+#include "includes/PreparedProgram.h"
+#include "includes/CppEmitter.h"
+#include "includes/BatchRunner.h"
+#include "includes/WorkStealingPool.h"
+#include "includes/Daemon.h"
+#include "includes/ProgramStore.h"
+#include "includes/ProfilingVisitor.h"
+#include "includes/RunStats.h"
 
 
 int main(int argc, char* argv[]) {
 
-    /* Check number of params */
-    if (argc < 2) {
-        std::cerr << "(ERROR: File not specified! )" << std::endl;
-        std::cerr << "USAGE: " << argv[0] << " <FILE_PATH>" << std::endl;
+    /* Check of the params */
+    Options opts;
+    try {
+        ParseOptions parseOptions;
+        opts = parseOptions(argc, argv);
+    } catch (std::invalid_argument& ia) {
+        std::cerr << "(ERROR: " << ia.what() << " )" << std::endl;
+        std::cerr << "USAGE: " << argv[0] << " [OPTIONS] <FILE_PATH>" << std::endl;
+        std::cerr << ParseOptions::help();
         return EXIT_FAILURE;
     }
 
 
-    /* Tokenizer */
-    Tokenizer tokenize;
-    std::vector<Token> inputTokens;
-    std::ifstream inputFile;
+    /* Daemon: the programs and their values of INPUT are sent by the clients of the socket */
+    if (!opts.serve_path.empty()) {
+        if (!Daemon::supported()) {
+            std::cerr << "(ERROR: --serve not supported on this platform )" << std::endl;
+            return EXIT_FAILURE;
+        }
+        Daemon daemon{ opts };
+        if (!daemon.serve(opts.serve_path)) {
+            std::cerr << "(ERROR: fail to listen on socket \"" << opts.serve_path << "\" )" << std::endl;
+            return EXIT_FAILURE;
+        }
+        return EXIT_SUCCESS;
+    }
+
+
+    if (!opts.compile_output.empty() && !CppEmitter::canBuild()) {
+        std::cerr << "(ERROR: --compile not supported on this platform )" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+
+    /* Programs of a directory optimized and stored in the cache, without running them */
+    if (!opts.precompile_dir.empty()) {
+        ProgramStore store{ opts.cache_dir, opts };
+        return (store.precompile(opts.precompile_dir, std::cerr) == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+
+    /* Statistics of the run (--stats=json), written at any exit from here on; the ProfilingVisitor keeps the counters of the run
+    (--stats-counters) */
+    std::unique_ptr<RunStats> stats;
+    std::unique_ptr<ProfilingVisitor> profile;
+    if (opts.stats) {
+        stats.reset(new RunStats{});
+        stats->file = opts.file;
+    }
+    struct StatsWriter {
+        const RunStats* stats;
+        const std::string& path;
+        ~StatsWriter() {
+            if (stats != nullptr && !stats->write(path)) std::cerr << "(ERROR: fail to write file \"" << path << "\" )" << std::endl;
+        }
+    } stats_writer{ stats.get(), opts.stats_file };
+
+
+    /* Source file (tokenized by the Lexer while it is parsed) */
+    SourceFile source;
     try {
-        inputFile.open(argv[1]);
-        if (inputFile.fail()) {
-            std::cerr << "(ERROR: fail to open file \"" << argv[1] << "\" )" <<  std::endl;
+        RunStats::Phase phase{ stats.get(), "read" };
+        source.open(opts.file);
+        if (source.fail()) {
+            std::cerr << "(ERROR: fail to open file \"" << opts.file << "\" )" <<  std::endl;
             return EXIT_FAILURE;
         }
     } catch (std::exception& exc) {
-        std::cerr << "(ERROR: it is not possible to open file \"" << argv[1] << "\" )" << std::endl;
+        std::cerr << "(ERROR: it is not possible to open file \"" << opts.file << "\" )" << std::endl;
         std::cerr << exc.what() << std::endl;
         return EXIT_FAILURE;
     }
+    if (stats) stats->source_bytes = source.text().size();
 
 
-    try {
-        inputTokens = std::move(tokenize(inputFile));
-        inputFile.close();
-    } catch (LexicalError& le) {
-        std::cerr << le.what() << std::endl;
-        return EXIT_FAILURE;
-    } catch (std::exception& exc) {
-        std::cerr << "(ERROR: it is not possible to read from (" << argv[1] << "\" )" << std::endl;
-        std::cerr << exc.what();
+    /* Values of INPUT: from the console after a prompt, or from a file (stdin with "-") without prompts */
+    std::unique_ptr<InputSource> batch_input;
+    if (!opts.input_file.empty()) {
+        std::FILE* f = (opts.input_file == "-") ? stdin : std::fopen(opts.input_file.c_str(), "rb");
+        if (f == nullptr) {
+            std::cerr << "(ERROR: fail to open file \"" << opts.input_file << "\" )" << std::endl;
+            return EXIT_FAILURE;
+        }
+        batch_input.reset(new InputSource(f, f != stdin));
+        if (opts.preload_input) batch_input->preload();
     }
 
 
-    // PARSING
-    BlockManager block_manager;
-    StatementManager stmt_manager;
-    NumExprManager numexpr_manager;
-    BoolExprManager bexpr_manager;
-    ParseProgram parse{ block_manager, stmt_manager, numexpr_manager, bexpr_manager }; // function object per la fase di parsing
+    // PARSING, RESOLUTION, OPTIMIZATION and TRANSLATION for the engine (see PreparedProgram),
+    // or load of the optimized program from the cache on disk (see ProgramStore)
+    std::unique_ptr<PreparedProgram> program;
 
 
     // EVALUATION
-    Program* prg;
-    EvaluationVisitor* v = new EvaluationVisitor();
+    // the output is flushed before any error message, to keep the order of the two streams, and before a crash of the run
+    OutputSink out{ stdout, opts.flush, opts.async_output };
+    out.flushOnFatalSignal();
+    Runtime rt{ &out, batch_input ? batch_input.get() : &InputSource::standard() };
     
     try {
-        prg = parse(inputTokens);
-        prg->accept(v);
-        
-        delete(prg);
-        delete(v); 
+        // the images of the cache don't keep the lines of the statements shown by --profile
+        if (opts.cache_dir.empty() || opts.profile) program.reset(new PreparedProgram(source.text(), opts, stats.get()));
+        else program = ProgramStore{ opts.cache_dir, opts }.prepare(source.text(), stats.get());
+        if (opts.opt_report) std::cerr << program->get_report() << std::endl;
+
+        if (opts.engine == Options::JIT && program->get_engine_kind() != Options::JIT) {
+            std::cerr << "(WARNING: native code generation not supported on this platform, --engine=tree used )" << std::endl;
+        }
+        if (opts.dump_bytecode && program->get_engine_kind() == Options::VM) std::cerr << program->get_chunk();
+        if (stats) stats->engine = (opts.profile || opts.stats_counters) ? "tree (ProfilingVisitor)" : Options::engine2String(program->get_engine_kind());
+
+        if (opts.emit_cpp || !opts.compile_output.empty()) {
+            // Translation to C++ and build of a native executable, without running the program
+            CppEmitter emit;
+            std::string cpp = emit(program->get_program());
+            if (opts.emit_cpp) std::cout << cpp;
+            if (!opts.compile_output.empty() && !CppEmitter::buildExecutable(cpp, opts.compile_output)) {
+                std::cerr << "(ERROR: fail to build the executable \"" << opts.compile_output << "\" )" << std::endl;
+                return EXIT_FAILURE;
+            }
+        } else if (opts.profile || opts.stats_counters) {
+            // Run counted by the ProfilingVisitor, measured statement by statement for --profile (with the report also after an error)
+            profile.reset(new ProfilingVisitor{ &rt, opts.profile });
+            if (stats) stats->run = profile.get();
+            try {
+                RunStats::Phase phase{ stats.get(), "run" };
+                program->get_program()->accept(profile.get());
+                out.flush();
+            } catch (...) {
+                out.flush();
+                if (opts.profile) profile->report(std::cerr, source.text());
+                throw;
+            }
+            if (opts.profile) profile->report(std::cerr, source.text());
+        } else if (opts.batch_file.empty()) {
+            RunStats::Phase phase{ stats.get(), "run" };
+            program->run(&rt);
+            out.flush();
+        } else {
+            // One run for each row of the batch file: the runs share the PreparedProgram, which is never written
+            SourceFile rows{ opts.batch_file };
+            if (rows.fail()) {
+                std::cerr << "(ERROR: fail to open file \"" << opts.batch_file << "\" )" << std::endl;
+                return EXIT_FAILURE;
+            }
+            BatchRunner batch{ program->get_engine(), (opts.jobs > 0) ? opts.jobs : WorkStealingPool::defaultThreads() };
+            if (batch(rows.text(), out, std::cerr) > 0) return EXIT_FAILURE;
+        }
 
     } catch (LexicalError& le) {
+        out.flush();
         std::cerr << le.what() << std::endl;
-        delete(prg);
-        delete(v);
+        if (stats) stats->error = le.what();
         return EXIT_FAILURE;
 
     } catch (SyntaxError& pe) {
+        out.flush();
         std::cerr << pe.what() << std::endl;
-        delete(v);
+        if (stats) stats->error = pe.what();
         return EXIT_FAILURE;
 
     } catch (SemanticError& se) {
+        out.flush();
         std::cerr << se.what() << std::endl;
-        delete(prg);
-        delete(v);
+        if (stats) stats->error = se.what();
         return EXIT_FAILURE;
         
     } catch (std::exception& exc) {
+        out.flush();
         std::cerr << "(ERROR: generic error )" << std::endl;
         std::cerr << exc.what() << std::endl;
-        delete(prg);
-        delete(v);
+        if (stats) stats->error = exc.what();
         return EXIT_FAILURE;
     }
 